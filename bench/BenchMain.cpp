@@ -0,0 +1,46 @@
+#include <QGuiApplication>
+#include <QTemporaryDir>
+#include <QtTest>
+#include "BenchReport.h"
+#include "OrganizerBench.h"
+
+// ro_bench takes the usual QtTest options plus "--json FILE", which writes
+// the results as JSON for comparing runs across versions.
+int main(int argc, char* argv[]) {
+    // The highlighter needs fonts, not a screen
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    QString jsonFile;
+    int json = args.indexOf("--json");
+    if (json >= 0) {
+        if (json + 1 >= args.size()) {
+            qWarning("--json needs a file name");
+            return 2;
+        }
+        jsonFile = args[json + 1];
+        args.remove(json, 2);
+    }
+
+    // QtTest logs XML to a scratch file alongside the normal console output
+    QTemporaryDir logDir;
+    const QString xmlLog = logDir.filePath("ro_bench.xml");
+    if (!jsonFile.isEmpty()) {
+        args << "-o" << xmlLog + ",xml" << "-o" << "-,txt";
+    }
+
+    OrganizerBench bench;
+    int result = QTest::qExec(&bench, args);
+
+    if (!jsonFile.isEmpty()) {
+        QString error;
+        if (!BenchReport::writeJson(xmlLog, jsonFile, &error)) {
+            qWarning("%s", qPrintable(error));
+            return result ? result : 1;
+        }
+    }
+    return result;
+}
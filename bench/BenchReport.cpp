@@ -0,0 +1,83 @@
+#include "BenchReport.h"
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QXmlStreamReader>
+
+namespace {
+    QHash<QString, qint64>& payloads() {
+        static QHash<QString, qint64> bytes;
+        return bytes;
+    }
+
+    QString payloadKey(const QString& function, const QString& tag) {
+        return function + '/' + tag;
+    }
+}
+
+void BenchReport::setPayloadBytes(const QString& function, const QString& tag, qint64 bytes) {
+    payloads().insert(payloadKey(function, tag), bytes);
+}
+
+bool BenchReport::writeJson(const QString& xmlLog, const QString& jsonFile, QString* error) {
+    QFile log(xmlLog);
+    if (!log.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Could not open " + xmlLog;
+        return false;
+    }
+
+    // <TestFunction name="..."><BenchmarkResult metric tag value iterations/>
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml(&log);
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) continue;
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            const QString tag = attributes.value("tag").toString();
+            const QString metric = attributes.value("metric").toString();
+            const double value = attributes.value("value").toDouble();
+            QJsonObject result;
+            result["name"] = function;
+            result["tag"] = tag;
+            result["metric"] = metric;
+            result["value"] = value;
+            result["iterations"] = attributes.value("iterations").toInt();
+            const qint64 bytes = payloads().value(payloadKey(function, tag), 0);
+            if (bytes > 0) {
+                result["bytes"] = bytes;
+                if (metric == QLatin1String("WalltimeMilliseconds") && value > 0) {
+                    result["mbPerSecond"] = (bytes / (1024.0 * 1024.0)) / (value / 1000.0);
+                }
+            }
+            results.append(result);
+        }
+    }
+    if (xml.hasError()) {
+        if (error) *error = "Could not parse the QtTest log: " + xml.errorString();
+        return false;
+    }
+
+    QJsonObject report;
+    report["suite"] = "ro_bench";
+    report["version"] = RO_VERSION;
+    report["qt"] = qVersion();
+    report["cpu"] = QSysInfo::currentCpuArchitecture();
+    report["os"] = QSysInfo::prettyProductName();
+    report["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["results"] = results;
+
+    QFile out(jsonFile);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = "Could not write " + jsonFile;
+        return false;
+    }
+    out.write(QJsonDocument(report).toJson());
+    return true;
+}
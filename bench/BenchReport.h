@@ -0,0 +1,17 @@
+#ifndef BENCHREPORT_H
+#define BENCHREPORT_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Turns a QtTest XML log into a JSON file that can be diffed across
+// versions. Benchmarks that process a payload record its size here so the
+// report can show throughput next to the raw time.
+namespace BenchReport {
+
+void setPayloadBytes(const QString& function, const QString& tag, qint64 bytes);
+bool writeJson(const QString& xmlLog, const QString& jsonFile, QString* error = nullptr);
+
+} // namespace BenchReport
+
+#endif // BENCHREPORT_H
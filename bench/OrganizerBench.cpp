@@ -0,0 +1,359 @@
+#include "OrganizerBench.h"
+#include "BenchReport.h"
+#include "BodyCodec.h"
+#include "BurpXmlSource.h"
+#include "BurpXmlWriter.h"
+#include "DatabaseManager.h"
+#include "HttpDecoder.h"
+#include "HttpSyntaxHighlighter.h"
+#include "ImportPipeline.h"
+#include "OrganizerModel.h"
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSqlQuery>
+#include <QTextDocument>
+#include <QXmlStreamReader>
+#include <QtTest>
+#include <zlib.h>
+
+namespace {
+    const quint32 Seed = 0x5EED;
+
+    // Pretty-printed JSON, one value per line like a typical API response
+    QByteArray jsonBody(QRandomGenerator& rng, qsizetype size) {
+        QByteArray body;
+        body.reserve(size + 128);
+        body.append("{\n  \"items\": [\n");
+        while (body.size() < size) {
+            body.append("    {\n      \"id\": ").append(QByteArray::number(rng.bounded(1000000)))
+                .append(",\n      \"name\": \"item-").append(QByteArray::number(rng.generate(), 16))
+                .append("\",\n      \"price\": ").append(QByteArray::number(rng.bounded(10000) / 100.0))
+                .append(",\n      \"active\": true\n    },\n");
+        }
+        body.chop(2);
+        body.append("\n  ]\n}\n");
+        return body;
+    }
+
+    QByteArray responseMessage(const QByteArray& body, const QByteArray& extraHeaders = QByteArray()) {
+        QByteArray message = "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\n";
+        message.append(extraHeaders);
+        if (!extraHeaders.contains("Transfer-Encoding")) {
+            message.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+        }
+        return message.append("\r\n").append(body);
+    }
+
+    OrganizerItem* makeRequest(int i, QRandomGenerator& rng) {
+        const QString host = QString("api%1.example.com").arg(i % 50);
+        const QString path = QString("/v1/resource/%1").arg(i);
+        const QString query = QString("page=%1").arg(rng.bounded(100));
+        QByteArray request = "GET " + path.toLatin1() + "?" + query.toLatin1() + " HTTP/1.1\r\n"
+                             "Host: " + host.toLatin1() + "\r\n"
+                             "User-Agent: ro-bench\r\n"
+                             "Accept: application/json\r\n\r\n";
+        QByteArray response = responseMessage(jsonBody(rng, 512 + rng.bounded(4096)));
+
+        OrganizerItem* item = new OrganizerItem(ItemType::Request, "GET " + path);
+        item->setHost(host);
+        item->setUrl(path);
+        item->setMethod("GET");
+        item->setQuery(query);
+        item->setStatus(200);
+        item->setLength(response.size());
+        item->setResponseTime(rng.bounded(500));
+        item->setTimestamp(1700000000 + i);
+        item->setRequest(request);
+        item->setResponse(response);
+        return item;
+    }
+
+    QByteArray gzip(QByteArrayView data) {
+        z_stream stream = {};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        QByteArray out(deflateBound(&stream, uLong(data.size())), Qt::Uninitialized);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = uInt(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = uInt(out.size());
+        deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return out;
+    }
+
+    QByteArray chunked(QByteArrayView data, qsizetype chunkSize) {
+        QByteArray out;
+        for (qsizetype pos = 0; pos < data.size(); pos += chunkSize) {
+            QByteArrayView chunk = data.sliced(pos, qMin(chunkSize, data.size() - pos));
+            out.append(QByteArray::number(chunk.size(), 16)).append("\r\n").append(chunk).append("\r\n");
+        }
+        return out.append("0\r\n\r\n");
+    }
+
+    // Runs a whole import and waits for it; returns the number of saved items
+    int runImport(ImportSource* source) {
+        ImportPipeline pipeline(source, -1);
+        QEventLoop loop;
+        int imported = 0;
+        QObject::connect(&pipeline, &ImportPipeline::batchReady, &loop, [&pipeline](const QList<OrganizerItem*>& items) {
+            qDeleteAll(items);
+            pipeline.batchConsumed();
+        });
+        QObject::connect(&pipeline, &ImportPipeline::finished, &loop, [&](int count, int, int, bool, const QString&) {
+            imported = count;
+            loop.quit();
+        });
+        pipeline.start();
+        loop.exec();
+        return imported;
+    }
+}
+
+void OrganizerBench::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    DatabaseManager::instance().setDatabasePath(m_dir.filePath("bench.db"));
+    QVERIFY(DatabaseManager::instance().initialize());
+}
+
+void OrganizerBench::cleanupTestCase() {
+    resetProject();
+}
+
+void OrganizerBench::resetProject() {
+    QSqlQuery query(DatabaseManager::instance().database());
+    query.exec("DELETE FROM items");
+}
+
+void OrganizerBench::fillProject(int count) {
+    QRandomGenerator rng(Seed);
+    QList<OrganizerItem*> batch;
+    for (int i = 0; i < count; ++i) {
+        batch.append(makeRequest(i, rng));
+        if (batch.size() == 1000 || i == count - 1) {
+            DatabaseManager::instance().insertItems(DatabaseManager::instance().database(), batch, -1);
+            qDeleteAll(batch);
+            batch.clear();
+        }
+    }
+}
+
+void OrganizerBench::loadTree_data() {
+    QTest::addColumn<int>("count");
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void OrganizerBench::loadTree() {
+    // What the model does at startup
+    QFETCH(int, count);
+    resetProject();
+    fillProject(count);
+
+    QBENCHMARK {
+        OrganizerItem root(ItemType::Folder, "Root");
+        DatabaseManager::instance().loadTree(&root);
+    }
+}
+
+void OrganizerBench::burpImport_data() {
+    QTest::addColumn<int>("count");
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("20000") << 20000;
+}
+
+void OrganizerBench::burpImport() {
+    // The export is made by our own writer, then imported into an empty project
+    QFETCH(int, count);
+    resetProject();
+    fillProject(count);
+    const QString fileName = m_dir.filePath("bench.xml");
+    {
+        OrganizerItem root(ItemType::Folder, "Root");
+        QVERIFY(DatabaseManager::instance().loadTree(&root));
+        QVERIFY(BurpXmlWriter::exportItems(BurpXmlWriter::collectIds(&root), fileName));
+    }
+    BenchReport::setPayloadBytes(QTest::currentTestFunction(), QTest::currentDataTag(), QFileInfo(fileName).size());
+    resetProject();
+
+    int imported = 0;
+    QBENCHMARK_ONCE {
+        imported = runImport(new BurpXmlSource(fileName));
+    }
+    QCOMPARE(imported, count);
+}
+
+void OrganizerBench::burpRoundTrip_data() {
+    QTest::addColumn<QString>("url");
+    QTest::addColumn<QString>("protocol");
+    QTest::addColumn<int>("port");
+    QTest::newRow("https") << "https://example.com/a?x=1" << "https" << 443;
+    QTest::newRow("http") << "http://example.com/a?x=1" << "http" << 80;
+    QTest::newRow("http-8080") << "http://example.com:8080/a?x=1" << "http" << 8080;
+}
+
+void OrganizerBench::burpRoundTrip() {
+    // A Burp export imported and exported again keeps its <url>, <path>,
+    // <protocol> and <port>; the Host header never has the port here
+    QFETCH(QString, url);
+    QFETCH(QString, protocol);
+    QFETCH(int, port);
+    resetProject();
+    const QByteArray request = "GET /a?x=1 HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    const QString sourceName = m_dir.filePath("roundtrip-in.xml");
+    {
+        QFile source(sourceName);
+        QVERIFY(source.open(QIODevice::WriteOnly));
+        source.write("<?xml version=\"1.0\"?>\n<items>\n<item>\n"
+                     "<time>Tue Nov 14 22:13:20 UTC 2023</time>\n"
+                     "<url><![CDATA[" + url.toUtf8() + "]]></url>\n"
+                     "<host ip=\"\">example.com</host>\n<port>" + QByteArray::number(port) + "</port>\n"
+                     "<protocol>" + protocol.toUtf8() + "</protocol>\n"
+                     "<method><![CDATA[GET]]></method>\n<path><![CDATA[/a?x=1]]></path>\n"
+                     "<request base64=\"true\"><![CDATA[" + request.toBase64() + "]]></request>\n"
+                     "<status>200</status>\n<responselength>0</responselength>\n"
+                     "<response base64=\"true\"></response>\n<comment></comment>\n"
+                     "</item>\n</items>\n");
+    }
+    QCOMPARE(runImport(new BurpXmlSource(sourceName)), 1);
+
+    const QString fileName = m_dir.filePath("roundtrip-out.xml");
+    {
+        OrganizerItem root(ItemType::Folder, "Root");
+        QVERIFY(DatabaseManager::instance().loadTree(&root));
+        QVERIFY(BurpXmlWriter::exportItems(BurpXmlWriter::collectIds(&root), fileName));
+    }
+    QFile exported(fileName);
+    QVERIFY(exported.open(QIODevice::ReadOnly));
+    QXmlStreamReader xml(&exported);
+    QHash<QString, QString> fields;
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) continue;
+        const QString name = xml.name().toString();
+        if (name == "url" || name == "path" || name == "protocol" || name == "port") {
+            fields.insert(name, xml.readElementText());
+        }
+    }
+    QVERIFY(!xml.hasError());
+    QCOMPARE(fields.value("url"), url);
+    QCOMPARE(fields.value("path"), QString("/a?x=1"));
+    QCOMPARE(fields.value("protocol"), protocol);
+    QCOMPARE(fields.value("port"), QString::number(port));
+}
+
+void OrganizerBench::modelIndexWide() {
+    // One folder with many direct children: row() lookups dominate
+    resetProject();
+    OrganizerModel model;
+    OrganizerItem* folder = new OrganizerItem(ItemType::Folder, "wide");
+    const int rows = 100000;
+    for (int i = 0; i < rows; ++i) {
+        folder->appendChild(new OrganizerItem(ItemType::Request, QString("r%1").arg(i)));
+    }
+    model.addTree(QModelIndex(), folder);
+    const QModelIndex parent = model.index(model.rowCount() - 1, 0);
+    QCOMPARE(model.rowCount(parent), rows);
+
+    int mismatches = 0;
+    QBENCHMARK {
+        for (int row = 0; row < rows; ++row) {
+            QModelIndex child = model.index(row, 0, parent);
+            if (model.parent(child) != parent) ++mismatches;
+        }
+    }
+    QCOMPARE(mismatches, 0);
+}
+
+void OrganizerBench::modelIndexDeep() {
+    // A long chain of nested folders, walked down and back up
+    resetProject();
+    OrganizerModel model;
+    const int depth = 1000;
+    OrganizerItem* top = new OrganizerItem(ItemType::Folder, "deep");
+    OrganizerItem* current = top;
+    for (int i = 1; i < depth; ++i) {
+        OrganizerItem* child = new OrganizerItem(ItemType::Folder, QString("d%1").arg(i));
+        current->appendChild(child);
+        current = child;
+    }
+    model.addTree(QModelIndex(), top);
+    const QModelIndex topIndex = model.index(model.rowCount() - 1, 0);
+
+    int levels = 0;
+    QBENCHMARK {
+        QModelIndex index = topIndex;
+        levels = 1;
+        while (model.rowCount(index) > 0) {
+            index = model.index(0, 0, index);
+            ++levels;
+        }
+        while (index.isValid()) {
+            index = model.parent(index);
+        }
+    }
+    QCOMPARE(levels, depth);
+}
+
+void OrganizerBench::saveItem() {
+    // One edited request written back, as after every edit in the viewer
+    resetProject();
+    QRandomGenerator rng(Seed);
+    OrganizerItem* item = makeRequest(0, rng);
+    QVERIFY(DatabaseManager::instance().insertItems(DatabaseManager::instance().database(), {item}, -1));
+
+    QBENCHMARK {
+        DatabaseManager::instance().saveItem(item->dbId(), item->type(), item->name(), item->annotation(), item->color(),
+                                             item->request(), item->response(), -1, item->host(), item->url(),
+                                             item->method(), item->responseTime(), item->query(), item->status(),
+                                             item->length(), item->timestamp(), item->screenshot(), item->thumbnail());
+    }
+    delete item;
+}
+
+void OrganizerBench::highlighter_data() {
+    QTest::addColumn<int>("bytes");
+    QTest::newRow("64KB") << 64 * 1024;
+    QTest::newRow("1MB") << 1024 * 1024;
+}
+
+void OrganizerBench::highlighter() {
+    QFETCH(int, bytes);
+    QRandomGenerator rng(Seed);
+    const QString text = QString::fromUtf8(responseMessage(jsonBody(rng, bytes)));
+    BenchReport::setPayloadBytes(QTest::currentTestFunction(), QTest::currentDataTag(), text.size());
+
+    QTextDocument document;
+    document.setPlainText(text);
+    HttpSyntaxHighlighter highlighter(&document);
+
+    QBENCHMARK {
+        highlighter.rehighlight();
+    }
+}
+
+void OrganizerBench::viewerDecode_data() {
+    QTest::addColumn<int>("bytes");
+    QTest::newRow("64KB") << 64 * 1024;
+    QTest::newRow("1MB") << 1024 * 1024;
+}
+
+void OrganizerBench::viewerDecode() {
+    // Chunked gzip, the common case behind CDNs: dechunk, inflate, then to text
+    QFETCH(int, bytes);
+    QRandomGenerator rng(Seed);
+    const QByteArray body = jsonBody(rng, bytes);
+    const QByteArray raw = responseMessage(chunked(gzip(body), 8192),
+                                           "Content-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n");
+    BenchReport::setPayloadBytes(QTest::currentTestFunction(), QTest::currentDataTag(), body.size());
+
+    qsizetype decodedSize = 0;
+    QBENCHMARK {
+        QByteArray decoded = HttpDecoder::decode(raw);
+        BodyCodec::Decoded text = BodyCodec::decode(decoded);
+        decodedSize = text.text.size();
+    }
+    QVERIFY(decodedSize > body.size());
+}
@@ -0,0 +1,37 @@
+#ifndef ORGANIZERBENCH_H
+#define ORGANIZERBENCH_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+// Benchmarks over a scratch project in a temporary directory. Data comes
+// from a fixed-seed generator, so runs on the same machine are comparable.
+class OrganizerBench : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void loadTree_data();
+    void loadTree();
+    void burpImport_data();
+    void burpImport();
+    void burpRoundTrip_data();
+    void burpRoundTrip();
+    void modelIndexWide();
+    void modelIndexDeep();
+    void saveItem();
+    void highlighter_data();
+    void highlighter();
+    void viewerDecode_data();
+    void viewerDecode();
+
+private:
+    void resetProject();
+    void fillProject(int count);
+
+    QTemporaryDir m_dir;
+};
+
+#endif // ORGANIZERBENCH_H
@@ -0,0 +1,128 @@
+#include "BodyCodec.h"
+#include <QStringDecoder>
+#include <QStringEncoder>
+#include <optional>
+
+namespace BodyCodec {
+
+namespace {
+    // Only these charsets legitimately contain NUL bytes in text
+    bool isWideCharset(QByteArrayView charset) {
+        return charset.startsWith("utf-16") || charset.startsWith("UTF-16") ||
+               charset.startsWith("utf-32") || charset.startsWith("UTF-32") ||
+               charset.startsWith("ucs-2") || charset.startsWith("UCS-2");
+    }
+}
+
+qsizetype headerEnd(const QString& text) {
+    qsizetype crlf = text.indexOf(QLatin1String("\r\n\r\n"));
+    qsizetype lf = text.indexOf(QLatin1String("\n\n"));
+    if (crlf >= 0 && (lf < 0 || crlf < lf)) return crlf + 4;
+    if (lf >= 0) return lf + 2;
+    return -1;
+}
+
+QByteArray charsetFromContentType(QByteArrayView contentType) {
+    QByteArray value = contentType.toByteArray().toLower();
+    qsizetype pos = value.indexOf("charset=");
+    if (pos < 0) return QByteArray();
+
+    QByteArray charset = value.mid(pos + 8);
+    qsizetype end = charset.indexOf(';');
+    if (end >= 0) charset.truncate(end);
+    charset = charset.trimmed();
+    if (charset.startsWith('"') || charset.startsWith('\'')) {
+        charset = charset.mid(1, charset.size() - 2);
+    }
+    return charset;
+}
+
+bool looksBinary(QByteArrayView body) {
+    // Random bytes are ~10% control characters; real text almost never exceeds a few
+    QByteArrayView sample = body.first(qMin<qsizetype>(body.size(), 8192));
+    qsizetype controls = 0;
+    for (char c : sample) {
+        uchar byte = static_cast<uchar>(c);
+        if (byte == 0) return true;
+        if (byte < 0x20 && byte != '\t' && byte != '\n' && byte != '\r' && byte != '\f' && byte != '\v' && byte != 0x1b) {
+            ++controls;
+        }
+    }
+    return controls * 20 > sample.size();
+}
+
+Decoded decode(const QByteArray& data) {
+    return decode(data, HttpMessageIndex::parse(data));
+}
+
+Decoded decode(const QByteArray& data, const HttpMessageIndex& index) {
+    Decoded result;
+    qsizetype offset = index.bodyOffset();
+    QByteArrayView head = offset < 0 ? QByteArrayView() : QByteArrayView(data).first(offset);
+    QByteArrayView body = offset < 0 ? QByteArrayView(data) : QByteArrayView(data).sliced(offset);
+    result.bodyCrlf = body.contains("\r\n");
+    result.headCrlf = offset < 0 ? result.bodyCrlf : head.contains("\r\n");
+
+    QByteArray charset = offset < 0 ? QByteArray() : charsetFromContentType(index.header(data, "content-type"));
+    std::optional<QStringConverter::Encoding> bom = QStringConverter::encodingForData(body);
+
+    bool wide = (bom && *bom != QStringConverter::Utf8) || isWideCharset(charset);
+    if (!wide && looksBinary(body)) {
+        result.binary = true;
+        return result;
+    }
+
+    // Keep a BOM as U+FEFF so re-encoding writes it back
+    const QStringDecoder::Flags flags = QStringDecoder::Flag::Stateless | QStringDecoder::Flag::ConvertInitialBom;
+    QStringDecoder decoder;
+    if (bom) {
+        decoder = QStringDecoder(*bom, flags);
+    } else if (!charset.isEmpty()) {
+        decoder = QStringDecoder(charset.constData(), flags);
+    }
+    if (!decoder.isValid()) {
+        decoder = QStringDecoder(QStringConverter::Utf8, flags);
+    }
+
+    QString bodyText = decoder.decode(body);
+    if (decoder.hasError()) {
+        // Latin-1 maps every byte to one code point, so editing can never lose data
+        decoder = QStringDecoder(QStringConverter::Latin1, flags);
+        bodyText = decoder.decode(body);
+    }
+
+    result.encoding = decoder.name();
+    result.text = QString::fromLatin1(head) + bodyText;
+    return result;
+}
+
+QByteArray encode(const QString& text, const Decoded& original) {
+    // Text views hand back LF only; put CRLF back where the original had it,
+    // separately for the header block and the body
+    QString normalized = text;
+    if ((original.headCrlf || original.bodyCrlf) && !normalized.contains(QLatin1Char('\r'))) {
+        const qsizetype end = headerEnd(normalized);
+        QString head = end < 0 ? normalized : normalized.first(end);
+        QString body = end < 0 ? QString() : normalized.sliced(end);
+        if (original.headCrlf) head.replace(QLatin1String("\n"), QLatin1String("\r\n"));
+        if (original.bodyCrlf) body.replace(QLatin1String("\n"), QLatin1String("\r\n"));
+        normalized = head + body;
+    }
+
+    QByteArray encoding = original.encoding.isEmpty() ? QByteArray("UTF-8") : original.encoding;
+    QStringEncoder encoder(encoding.constData(), QStringEncoder::Flag::Stateless);
+    if (!encoder.isValid()) {
+        encoder = QStringEncoder(QStringConverter::Utf8, QStringEncoder::Flag::Stateless);
+    }
+
+    qsizetype split = headerEnd(normalized);
+    if (split < 0) {
+        return encoder.encode(normalized);
+    }
+    QByteArray result = QStringView(normalized).first(split).toLatin1();
+    QByteArray body = encoder.encode(QStringView(normalized).sliced(split));
+    result.append(body);
+    return result;
+}
+
+} // namespace BodyCodec
@@ -0,0 +1,38 @@
+#ifndef BODYCODEC_H
+#define BODYCODEC_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include "HttpMessageIndex.h"
+
+// Converts raw HTTP messages to text for display and back, without ever
+// touching bytes that were not edited. Headers are always Latin-1; the body
+// uses the declared charset, a BOM, or UTF-8 when it validates.
+namespace BodyCodec {
+
+struct Decoded {
+    bool binary = false;
+    QString text;
+    QByteArray encoding; // Charset used for the body, e.g. "UTF-8"
+    bool headCrlf = false; // Original header lines ended in CRLF
+    bool bodyCrlf = false; // Original body had CRLF line breaks
+};
+
+Decoded decode(const QByteArray& data);
+Decoded decode(const QByteArray& data, const HttpMessageIndex& index);
+
+// Re-encodes edited text with the charset and line breaks it was decoded
+// with; the header block and the body each keep their own line breaks
+QByteArray encode(const QString& text, const Decoded& original);
+
+// Offset just past the blank line that ends the header block in text, or -1
+qsizetype headerEnd(const QString& text);
+
+// Lowercased charset parameter of a Content-Type value, if any
+QByteArray charsetFromContentType(QByteArrayView contentType);
+bool looksBinary(QByteArrayView body);
+
+} // namespace BodyCodec
+
+#endif // BODYCODEC_H
@@ -0,0 +1,91 @@
+#include "BurpXmlSource.h"
+
+BurpXmlSource::BurpXmlSource(const QString& fileName, const QByteArray& xml)
+    : m_fileName(fileName)
+    , m_xmlData(xml)
+    , m_device(nullptr)
+{
+}
+
+bool BurpXmlSource::open() {
+    if (!m_fileName.isEmpty()) {
+        m_file.setFileName(m_fileName);
+        m_device = &m_file;
+    } else {
+        m_buffer.setData(m_xmlData);
+        m_device = &m_buffer;
+    }
+    if (!m_device->open(QIODevice::ReadOnly)) {
+        m_error = "Could not open file: " + m_fileName;
+        return false;
+    }
+    m_xml.setDevice(m_device);
+    return true;
+}
+
+bool BurpXmlSource::next(ImportRecord& record) {
+    while (!m_xml.atEnd() && !m_xml.hasError()) {
+        QXmlStreamReader::TokenType token = m_xml.readNext();
+        if (token == QXmlStreamReader::StartElement && m_xml.name() == QLatin1String("item")) {
+            readItem(record);
+            return !m_xml.hasError();
+        }
+    }
+    return false;
+}
+
+qint64 BurpXmlSource::bytesRead() const {
+    // The reader pulls the device in chunks, so pos() tracks bytes consumed
+    return m_device ? m_device->pos() : 0;
+}
+
+qint64 BurpXmlSource::totalBytes() const {
+    return m_device ? m_device->size() : 0;
+}
+
+QString BurpXmlSource::errorString() const {
+    if (!m_error.isEmpty()) return m_error;
+    if (m_xml.hasError()) return "XML parsing error: " + m_xml.errorString();
+    return QString();
+}
+
+void BurpXmlSource::readItem(ImportRecord& record) {
+    while (!m_xml.atEnd() && !(m_xml.tokenType() == QXmlStreamReader::EndElement && m_xml.name() == QLatin1String("item"))) {
+        m_xml.readNext();
+
+        if (m_xml.tokenType() == QXmlStreamReader::StartElement) {
+            QStringView elementName = m_xml.name();
+
+            if (elementName == QLatin1String("time")) {
+                record.time = m_xml.readElementText();
+            } else if (elementName == QLatin1String("url")) {
+                record.url = m_xml.readElementText();
+            } else if (elementName == QLatin1String("host")) {
+                record.host = m_xml.readElementText();
+            } else if (elementName == QLatin1String("protocol")) {
+                record.scheme = m_xml.readElementText().toLower();
+            } else if (elementName == QLatin1String("port")) {
+                record.port = m_xml.readElementText().toInt();
+            } else if (elementName == QLatin1String("method")) {
+                record.method = m_xml.readElementText();
+            } else if (elementName == QLatin1String("path")) {
+                record.path = m_xml.readElementText();
+            } else if (elementName == QLatin1String("request")) {
+                // Base64 is decoded later on a worker thread
+                record.requestBase64 = m_xml.attributes().value("base64") == QLatin1String("true");
+                QString text = m_xml.readElementText();
+                record.request = record.requestBase64 ? text.toLatin1() : text.toUtf8();
+            } else if (elementName == QLatin1String("status")) {
+                record.status = m_xml.readElementText().toInt();
+            } else if (elementName == QLatin1String("responselength")) {
+                record.responseLength = m_xml.readElementText().toLongLong();
+            } else if (elementName == QLatin1String("response")) {
+                record.responseBase64 = m_xml.attributes().value("base64") == QLatin1String("true");
+                QString text = m_xml.readElementText();
+                record.response = record.responseBase64 ? text.toLatin1() : text.toUtf8();
+            } else if (elementName == QLatin1String("comment")) {
+                record.comment = m_xml.readElementText();
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef BURPXMLSOURCE_H
+#define BURPXMLSOURCE_H
+
+#include <QBuffer>
+#include <QFile>
+#include <QXmlStreamReader>
+#include "ImportSource.h"
+
+// Reads the <item> elements of a Burp Suite XML export. The XML is streamed
+// from the file, never loaded whole.
+class BurpXmlSource : public ImportSource {
+public:
+    // Reads fileName, or xml when fileName is empty (pasted content)
+    explicit BurpXmlSource(const QString& fileName, const QByteArray& xml = QByteArray());
+
+    bool open() override;
+    bool next(ImportRecord& record) override;
+    qint64 bytesRead() const override;
+    qint64 totalBytes() const override;
+    QString errorString() const override;
+
+private:
+    void readItem(ImportRecord& record);
+
+    QString m_fileName;
+    QByteArray m_xmlData;
+    QFile m_file;
+    QBuffer m_buffer;
+    QIODevice* m_device;
+    QXmlStreamReader m_xml;
+    QString m_error;
+};
+
+#endif // BURPXMLSOURCE_H
@@ -0,0 +1,199 @@
+#include "BurpXmlWriter.h"
+#include "DatabaseManager.h"
+#include "HttpMessageIndex.h"
+#include "RequestOrigin.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QLocale>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+namespace {
+    void collect(const OrganizerItem* item, QList<int>& ids) {
+        if (item->type() == ItemType::Request && item->dbId() != -1) {
+            ids.append(item->dbId());
+        }
+        for (const OrganizerItem* child : item->children()) {
+            collect(child, ids);
+        }
+    }
+
+    QString burpTime(qint64 timestamp) {
+        // Same shape ImportPipeline::parseTimestamp reads: "Tue Mar 05 14:22:11 CST 2024"
+        QDateTime dateTime = QDateTime::fromSecsSinceEpoch(timestamp);
+        QString zone = dateTime.timeZoneAbbreviation();
+        QString format = zone.isEmpty() || zone.contains(' ') ? "ddd MMM dd HH:mm:ss yyyy"
+                                                               : "ddd MMM dd HH:mm:ss '" + zone + "' yyyy";
+        return QLocale::c().toString(dateTime, format);
+    }
+
+    struct ItemFields {
+        QByteArray request;
+        QByteArray response;
+        QString host;
+        QString path;
+        QString method;
+        QString query;
+        int status;
+        qint64 length;
+        qint64 timestamp;
+        QString comment;
+        QString scheme;
+        int port;
+    };
+
+    void writeFields(QXmlStreamWriter& xml, const ItemFields& item) {
+        const QByteArray& request = item.request;
+        HttpMessageIndex index = HttpMessageIndex::parse(request);
+        const QString hostHeader = index.isValid() && index.isRequest()
+            ? QString::fromLatin1(index.header(request, "host")) : QString();
+        const RequestOrigin origin = RequestOrigin::resolve(item.scheme, item.port, item.host, hostHeader);
+
+        QString path = item.path;
+        if (!path.startsWith('/') && !path.startsWith("http")) path.prepend('/');
+        // Items imported from Burp keep its <path>, query included
+        if (!item.query.isEmpty() && !path.contains('?')) path += "?" + item.query;
+        const QString url = origin.url(path);
+
+        xml.writeStartElement("item");
+        xml.writeTextElement("time", burpTime(item.timestamp));
+        xml.writeStartElement("url");
+        xml.writeCDATA(url);
+        xml.writeEndElement();
+        xml.writeStartElement("host");
+        xml.writeAttribute("ip", "");
+        xml.writeCharacters(origin.host);
+        xml.writeEndElement();
+        xml.writeTextElement("port", QString::number(origin.port));
+        xml.writeTextElement("protocol", origin.scheme);
+        xml.writeStartElement("method");
+        xml.writeCDATA(item.method);
+        xml.writeEndElement();
+        xml.writeStartElement("path");
+        xml.writeCDATA(path);
+        xml.writeEndElement();
+        xml.writeTextElement("extension", "null");
+        xml.writeStartElement("request");
+        xml.writeAttribute("base64", "true");
+        xml.writeCDATA(QString::fromLatin1(request.toBase64()));
+        xml.writeEndElement();
+        xml.writeTextElement("status", QString::number(item.status));
+        xml.writeTextElement("responselength", QString::number(item.length));
+        xml.writeTextElement("mimetype", "");
+        xml.writeStartElement("response");
+        xml.writeAttribute("base64", "true");
+        xml.writeCDATA(QString::fromLatin1(item.response.toBase64()));
+        xml.writeEndElement();
+        xml.writeTextElement("comment", item.comment);
+        xml.writeEndElement();
+    }
+
+    void writeRow(QXmlStreamWriter& xml, const QSqlRecord& row) {
+        writeFields(xml, {row.value(1).toByteArray(), row.value(2).toByteArray(), row.value(3).toString(),
+                          row.value(4).toString(), row.value(5).toString(), row.value(6).toString(),
+                          row.value(7).toInt(), row.value(8).toLongLong(), row.value(9).toLongLong(),
+                          row.value(10).toString(), row.value(11).toString(), row.value(12).toInt()});
+    }
+
+    bool writeItems(QSqlDatabase& db, const QList<int>& ids, QXmlStreamWriter& xml, QFile& file,
+                    QString* error, const std::atomic_bool* cancel) {
+        for (qsizetype start = 0; start < ids.size(); start += BurpXmlWriter::PageSize) {
+            if (cancel && cancel->load()) return false;
+
+            const QList<int> page = ids.mid(start, BurpXmlWriter::PageSize);
+            QString placeholders = QString("?,").repeated(page.size());
+            placeholders.chop(1);
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare("SELECT id, request, response, host, url, method, query, status, length, timestamp, annotation, "
+                          "COALESCE(scheme, ''), COALESCE(port, 0) "
+                          "FROM items WHERE id IN (" + placeholders + ")");
+            for (int id : page) {
+                query.addBindValue(id);
+            }
+            if (!query.exec()) {
+                qDebug() << "Error loading items for export:" << query.lastError().text();
+                if (error) *error = "Database error: " + query.lastError().text();
+                return false;
+            }
+
+            // Rows come back in id order; they are written in tree order, so
+            // one page of rows is held at a time
+            QHash<int, QSqlRecord> rows;
+            while (query.next()) {
+                rows.insert(query.value(0).toInt(), query.record());
+            }
+            for (int id : page) {
+                auto it = rows.constFind(id);
+                if (it == rows.constEnd()) continue; // Deleted meanwhile
+                writeRow(xml, it.value());
+            }
+            if (xml.hasError()) {
+                if (error) *error = "Error writing file: " + file.errorString();
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+QList<int> BurpXmlWriter::collectIds(const OrganizerItem* root) {
+    QList<int> ids;
+    collect(root, ids);
+    return ids;
+}
+
+bool BurpXmlWriter::exportItems(const QList<int>& ids, const QString& fileName, QString* error,
+                                const std::atomic_bool* cancel) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = "Could not open file: " + fileName;
+        return false;
+    }
+
+    QXmlStreamWriter xml(&file);
+    writeStart(xml);
+
+    // This runs off the GUI thread, so it reads through a connection of its own
+    const QString connectionName = QString("burp-export-%1").arg(quintptr(&file));
+    bool ok;
+    {
+        QSqlDatabase db = DatabaseManager::instance().openConnection(connectionName);
+        ok = db.isOpen() && writeItems(db, ids, xml, file, error, cancel);
+        if (!db.isOpen() && error) *error = "Could not open the database";
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (!ok) {
+        file.remove();
+        return false;
+    }
+
+    writeEnd(xml);
+    if (xml.hasError()) {
+        if (error) *error = "Error writing file: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void BurpXmlWriter::writeStart(QXmlStreamWriter& xml) {
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("items");
+    xml.writeAttribute("burpVersion", "");
+    xml.writeAttribute("exportTime", burpTime(QDateTime::currentSecsSinceEpoch()));
+}
+
+void BurpXmlWriter::writeItem(QXmlStreamWriter& xml, const OrganizerItem* item) {
+    writeFields(xml, {item->request(), item->response(), item->host(), item->url(), item->method(), item->query(),
+                      item->status(), item->length(), item->timestamp(), item->annotation(), item->scheme(), item->port()});
+}
+
+void BurpXmlWriter::writeEnd(QXmlStreamWriter& xml) {
+    xml.writeEndElement();
+    xml.writeEndDocument();
+}
@@ -0,0 +1,34 @@
+#ifndef BURPXMLWRITER_H
+#define BURPXMLWRITER_H
+
+#include <QList>
+#include <QString>
+#include <QXmlStreamWriter>
+#include <atomic>
+#include "OrganizerItem.h"
+
+// Writes the <items>/<item> document Burp Suite exports and BurpXmlSource
+// reads back. Requests and responses go out as base64 of the stored bytes,
+// so a round trip is byte-exact.
+class BurpXmlWriter {
+public:
+    // Database ids of every saved request under root, depth first.
+    // Must run on the thread that owns the items.
+    static QList<int> collectIds(const OrganizerItem* root);
+
+    // Loads the items from the database a page at a time on its own
+    // connection and streams them to fileName; safe to run on a worker
+    static bool exportItems(const QList<int>& ids, const QString& fileName, QString* error = nullptr,
+                            const std::atomic_bool* cancel = nullptr);
+
+    // Streaming use for items that are already in memory: writeStart, then
+    // writeItem per request, then writeEnd
+    static void writeStart(QXmlStreamWriter& xml);
+    static void writeItem(QXmlStreamWriter& xml, const OrganizerItem* item);
+    static void writeEnd(QXmlStreamWriter& xml);
+
+    // Rows fetched per query
+    static constexpr int PageSize = 256;
+};
+
+#endif // BURPXMLWRITER_H
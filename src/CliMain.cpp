@@ -0,0 +1,393 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QHash>
+#include <QMap>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <algorithm>
+#include "BurpXmlSource.h"
+#include "BurpXmlWriter.h"
+#include "CurlSource.h"
+#include "DatabaseManager.h"
+#include "HarSource.h"
+#include "HarWriter.h"
+#include "ImportPipeline.h"
+#include "OpenApiImporter.h"
+#include "OutboundScheduler.h"
+#include "PcapImporter.h"
+#include "PostmanImporter.h"
+#include "ReplayEngine.h"
+#include "RequestExporter.h"
+
+// ro-cli: the import, export, search and stats parts of the GUI for nightly
+// pipelines and other places without a display. Works on the same project
+// database as the GUI unless --db points elsewhere.
+namespace {
+    QTextStream& out() {
+        static QTextStream stream(stdout);
+        return stream;
+    }
+
+    QTextStream& err() {
+        static QTextStream stream(stderr);
+        return stream;
+    }
+
+    int fail(const QString& message) {
+        err() << "ro-cli: " << message << Qt::endl;
+        return 1;
+    }
+
+    // Export formats are named by the last word of their menu name: curl, requests, libcurl...
+    QString formatKey(const ExportFormat& format) {
+        return format.name.section(' ', -1).toLower();
+    }
+
+    const OrganizerItem* findById(const OrganizerItem* item, int id) {
+        if (item->dbId() == id) return item;
+        for (const OrganizerItem* child : item->children()) {
+            const OrganizerItem* found = findById(child, id);
+            if (found) return found;
+        }
+        return nullptr;
+    }
+
+    template <typename Visit>
+    void forEachRequest(const OrganizerItem* item, const Visit& visit) {
+        if (item->type() == ItemType::Request) visit(item);
+        for (const OrganizerItem* child : item->children()) {
+            forEachRequest(child, visit);
+        }
+    }
+
+    void countItems(const OrganizerItem* item, int& folders, int& requests) {
+        for (const OrganizerItem* child : item->children()) {
+            if (child->type() == ItemType::Folder) {
+                ++folders;
+            } else {
+                ++requests;
+            }
+            countItems(child, folders, requests);
+        }
+    }
+
+    bool isFolder(int id) {
+        QSqlQuery query(DatabaseManager::instance().database());
+        query.prepare("SELECT type FROM items WHERE id = ?");
+        query.addBindValue(id);
+        return query.exec() && query.next() && query.value(0).toInt() == static_cast<int>(ItemType::Folder);
+    }
+
+    int runPipeline(ImportSource* source, int parentId, ImportPipeline::Duplicates duplicates) {
+        ImportPipeline pipeline(source, parentId);
+        pipeline.setDuplicates(duplicates);
+        QEventLoop loop;
+        int result = 0;
+        int lastPercent = -1;
+
+        QObject::connect(&pipeline, &ImportPipeline::batchReady, &loop, [&pipeline, parentId](const QList<OrganizerItem*>& items) {
+            // Items the writer couldn't save get one more try on the main connection
+            QList<OrganizerItem*> unsaved;
+            for (OrganizerItem* item : items) {
+                if (item->dbId() == -1) unsaved.append(item);
+            }
+            if (!unsaved.isEmpty()) {
+                DatabaseManager::instance().insertItems(DatabaseManager::instance().database(), unsaved, parentId);
+            }
+            qDeleteAll(items);
+            pipeline.batchConsumed();
+        });
+        QObject::connect(&pipeline, &ImportPipeline::itemsReplaced, &loop, [](const QList<QPair<int, OrganizerItem*>>& replacements) {
+            // Already written to the database; nothing in memory to update
+            for (const auto& replacement : replacements) {
+                delete replacement.second;
+            }
+        });
+        QObject::connect(&pipeline, &ImportPipeline::progress, &loop, [&lastPercent](qint64 bytesRead, qint64 totalBytes) {
+            int percent = totalBytes > 0 ? int(bytesRead * 100 / totalBytes) : 0;
+            if (percent / 10 != lastPercent / 10) {
+                lastPercent = percent;
+                err() << percent << "%" << Qt::endl;
+            }
+        });
+        QObject::connect(&pipeline, &ImportPipeline::finished, &loop,
+                         [&](int imported, int duplicateCount, int errors, bool, const QString& error) {
+            out() << QString("Imported %1 requests, %2 duplicates, %3 errors").arg(imported).arg(duplicateCount).arg(errors)
+                  << Qt::endl;
+            if (!error.isEmpty()) result = fail(error);
+            loop.quit();
+        });
+
+        pipeline.start();
+        loop.exec();
+        return result;
+    }
+
+    int saveTree(OrganizerItem* root, const QString& error, int parentId) {
+        if (!root) return fail(error);
+        int folders = 0;
+        int requests = 0;
+        countItems(root, folders, requests);
+        bool saved = DatabaseManager::instance().insertTree(DatabaseManager::instance().database(), root, parentId);
+        delete root;
+        if (!saved) return fail("Could not save the imported items");
+        out() << QString("Imported %1 requests in %2 folders").arg(requests).arg(folders) << Qt::endl;
+        return 0;
+    }
+
+    int runImport(const QString& format, const QString& fileName, int parentId, ImportPipeline::Duplicates duplicates) {
+        QString error;
+        if (format == "burp") return runPipeline(new BurpXmlSource(fileName), parentId, duplicates);
+        if (format == "har") return runPipeline(new HarSource(fileName), parentId, duplicates);
+        if (format == "curl") return runPipeline(new CurlSource(fileName), parentId, duplicates);
+        if (format == "postman") return saveTree(PostmanImporter::importFile(fileName, &error), error, parentId);
+        if (format == "openapi") return saveTree(OpenApiImporter::importFile(fileName, &error), error, parentId);
+        if (format == "pcap") return saveTree(PcapImporter::importFile(fileName, &error), error, parentId);
+        return fail("Unknown import format: " + format);
+    }
+
+    int runExport(const QString& format, const QString& fileName, const OrganizerItem* root) {
+        QString error;
+        bool exported = false;
+        if (format == "har") {
+            exported = HarWriter::exportItems(root, fileName, &error);
+        } else if (format == "burp") {
+            // Bodies are paged from the database, not taken from the loaded tree
+            exported = BurpXmlWriter::exportItems(BurpXmlWriter::collectIds(root), fileName, &error);
+        } else {
+            const QList<ExportFormat>& formats = RequestExporter::formats();
+            auto match = std::find_if(formats.cbegin(), formats.cend(),
+                                      [&format](const ExportFormat& candidate) { return formatKey(candidate) == format; });
+            if (match == formats.cend()) return fail("Unknown export format: " + format);
+            exported = RequestExporter::exportRequests(*match, RequestExporter::snapshot(root), fileName, &error);
+        }
+        return exported ? 0 : fail(error);
+    }
+
+    int runSearch(const QByteArray& term, const OrganizerItem* root) {
+        // Same matching as Find in Bodies: decoded bodies, case-insensitive
+        int matches = 0;
+        forEachRequest(root, [&](const OrganizerItem* item) {
+            QLatin1String needle(term);
+            if (QLatin1String(item->decodedRequestUncached()).contains(needle, Qt::CaseInsensitive) ||
+                QLatin1String(item->decodedResponseUncached()).contains(needle, Qt::CaseInsensitive)) {
+                QString url = item->url() + (item->query().isEmpty() ? QString() : "?" + item->query());
+                out() << item->dbId() << '\t' << item->method() << '\t' << item->status() << '\t'
+                      << item->host() << '\t' << url << '\t' << item->name() << '\n';
+                ++matches;
+            }
+        });
+        out().flush();
+        // Like grep: 1 when nothing matched
+        return matches > 0 ? 0 : 1;
+    }
+
+    void printCounts(const QString& title, const QList<QPair<QString, int>>& counts) {
+        out() << '\n' << title << ":\n";
+        for (const auto& count : counts) {
+            out() << "  " << count.first.leftJustified(40) << ' ' << count.second << '\n';
+        }
+    }
+
+    QList<QPair<QString, int>> sortedCounts(const QHash<QString, int>& counts, int limit) {
+        QList<QPair<QString, int>> sorted;
+        for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+            sorted.append({it.key(), it.value()});
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const QPair<QString, int>& a, const QPair<QString, int>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        if (limit > 0 && sorted.size() > limit) sorted.resize(limit);
+        return sorted;
+    }
+
+    // Results are saved in the engine's batches: onto the originals, or as
+    // new rows in the originals' folders
+    int runReplay(const OrganizerItem* root, const ReplayEngine::Options& options, bool copies) {
+        QHash<int, int> parents; // Original id -> parent folder id
+        ReplayEngine engine(options);
+        forEachRequest(root, [&](const OrganizerItem* item) {
+            parents.insert(item->dbId(), item->parent() ? item->parent()->dbId() : -1);
+            engine.replay(item);
+        });
+        if (!engine.isRunning()) return fail("Nothing to replay");
+
+        QSqlDatabase& db = DatabaseManager::instance().database();
+        QEventLoop loop;
+        int succeeded = 0;
+        int failed = 0;
+        QString lastError;
+        QObject::connect(&engine, &ReplayEngine::resultsReady, &loop,
+                         [&](const QList<QPair<int, OrganizerItem*>>& results) {
+            if (copies) {
+                QHash<int, QList<OrganizerItem*>> byParent;
+                for (const auto& result : results) {
+                    byParent[parents.value(result.first, -1)].append(result.second);
+                }
+                for (auto it = byParent.cbegin(); it != byParent.cend(); ++it) {
+                    DatabaseManager::instance().insertItems(db, it.value(), it.key());
+                }
+            } else {
+                DatabaseManager::instance().replaceItems(db, results);
+            }
+            for (const auto& result : results) {
+                delete result.second;
+            }
+        });
+        QObject::connect(&engine, &ReplayEngine::finished, &loop, [&](int ok, int errors, const QString& error) {
+            succeeded = ok;
+            failed = errors;
+            lastError = error;
+            loop.quit();
+        });
+        loop.exec();
+
+        out() << "Replayed " << succeeded << " requests, " << failed << " failed" << Qt::endl;
+        if (failed > 0) err() << "Last error: " << lastError << Qt::endl;
+        return failed > 0 ? 1 : 0;
+    }
+
+    int runStats(const OrganizerItem* root) {
+        int folders = 0;
+        int requests = 0;
+        countItems(root, folders, requests);
+
+        qint64 requestBytes = 0;
+        qint64 responseBytes = 0;
+        QHash<QString, int> methods;
+        QHash<QString, int> statuses;
+        QHash<QString, int> hosts;
+        forEachRequest(root, [&](const OrganizerItem* item) {
+            requestBytes += item->request().size();
+            responseBytes += item->response().size();
+            methods[item->method().isEmpty() ? "(none)" : item->method()]++;
+            statuses[item->status() > 0 ? QString("%1xx").arg(item->status() / 100) : "(no response)"]++;
+            hosts[item->host().isEmpty() ? "(none)" : item->host()]++;
+        });
+
+        out() << "Requests:       " << requests << '\n'
+              << "Folders:        " << folders << '\n'
+              << "Request bytes:  " << requestBytes << '\n'
+              << "Response bytes: " << responseBytes << '\n';
+        printCounts("Methods", sortedCounts(methods, 0));
+        printCounts("Status", sortedCounts(statuses, 0));
+        printCounts("Top hosts", sortedCounts(hosts, 20));
+        out().flush();
+        return 0;
+    }
+
+    bool parseDuplicates(const QString& text, ImportPipeline::Duplicates& duplicates) {
+        static const QMap<QString, ImportPipeline::Duplicates> policies = {
+            {"all", ImportPipeline::Duplicates::ImportAll},
+            {"skip", ImportPipeline::Duplicates::SkipRequest},
+            {"skip-exact", ImportPipeline::Duplicates::SkipExchange},
+            {"replace", ImportPipeline::Duplicates::Replace},
+        };
+        auto it = policies.constFind(text);
+        if (it == policies.cend()) return false;
+        duplicates = it.value();
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    // The GUI's name, so the default project is the GUI's
+    QCoreApplication::setApplicationName("RequestOrganizer");
+
+    QStringList exportKeys = {"har", "burp"};
+    for (const ExportFormat& format : RequestExporter::formats()) {
+        exportKeys.append(formatKey(format));
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Batch import, export, search and stats on a Request Organizer project.\n\n"
+        "Commands:\n"
+        "  import <burp|har|curl|postman|openapi|pcap> FILE\n"
+        "  export <" + exportKeys.join('|') + "> FILE\n"
+        "  search TERM     Requests whose decoded request or response contains TERM\n"
+        "  stats           Counts by method, status class and host\n"
+        "  replay          Re-send requests and save the new responses");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "Project database (default: the GUI's project).", "file");
+    QCommandLineOption parentOption("parent", "Folder id to import into (default: top level).", "id");
+    QCommandLineOption idOption("id", "Only export, search or count under this item.", "id");
+    QCommandLineOption duplicatesOption("duplicates",
+        "Requests already in the project: all (import anyway), skip, skip-exact or replace.", "policy", "all");
+    QCommandLineOption copyOption("copy", "replay: add the results as new requests instead of updating.");
+    QCommandLineOption httpOption("http", "replay: use plain HTTP when the Host header names no port.");
+    QCommandLineOption connectionsOption("connections", "replay: connections in total and per host.",
+                                         "total,per-host", "32,6");
+    QCommandLineOption rateOption("rate", "replay: requests per second to each host, and optionally in total.",
+                                  "per-host[,total]");
+    parser.addOptions({dbOption, parentOption, idOption, duplicatesOption, copyOption, httpOption, connectionsOption,
+                       rateOption});
+    parser.addPositionalArgument("command", "import, export, search, stats or replay.");
+    parser.addPositionalArgument("args", "Command arguments.", "[args...]");
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    const QString command = args.value(0);
+    const int expected = command == "import" || command == "export" ? 3 : command == "search" ? 2 : 1;
+    if (args.isEmpty() || args.size() != expected || (expected == 1 && command != "stats" && command != "replay")) {
+        parser.showHelp(2);
+    }
+
+    ImportPipeline::Duplicates duplicates = ImportPipeline::Duplicates::ImportAll;
+    if (!parseDuplicates(parser.value(duplicatesOption), duplicates)) {
+        return fail("Unknown --duplicates policy: " + parser.value(duplicatesOption));
+    }
+    bool idOk = true;
+    const int parentId = parser.isSet(parentOption) ? parser.value(parentOption).toInt(&idOk) : -1;
+    if (!idOk) return fail("--parent takes a folder id");
+    const int itemId = parser.isSet(idOption) ? parser.value(idOption).toInt(&idOk) : -1;
+    if (!idOk) return fail("--id takes an item id");
+
+    DatabaseManager& db = DatabaseManager::instance();
+    if (parser.isSet(dbOption)) {
+        db.setDatabasePath(parser.value(dbOption));
+    }
+    if (!db.initialize()) {
+        return fail("Could not open " + db.databasePath());
+    }
+
+    if (command == "import") {
+        if (parentId != -1 && !isFolder(parentId)) return fail(QString("No folder with id %1").arg(parentId));
+        return runImport(args[1].toLower(), args[2], parentId, duplicates);
+    }
+
+    // The rest work on the loaded tree
+    OrganizerItem root(ItemType::Folder, "Root");
+    if (!db.loadTree(&root)) return fail("Could not read " + db.databasePath());
+    const OrganizerItem* start = itemId == -1 ? &root : findById(&root, itemId);
+    if (!start) return fail(QString("No item with id %1").arg(itemId));
+
+    if (command == "export") return runExport(args[1].toLower(), args[2], start);
+    if (command == "search") return runSearch(args[1].toUtf8(), start);
+    if (command == "replay") {
+        ReplayEngine::Options options;
+        options.tls = !parser.isSet(httpOption);
+        const QStringList connections = parser.value(connectionsOption).split(',');
+        options.maxConnections = connections.value(0).toInt();
+        options.maxConnectionsPerHost = connections.value(1, connections.value(0)).toInt();
+        if (options.maxConnections < 1 || options.maxConnectionsPerHost < 1) {
+            return fail("--connections takes two positive numbers, e.g. 32,6");
+        }
+        if (parser.isSet(rateOption)) {
+            const QStringList rates = parser.value(rateOption).split(',');
+            OutboundScheduler::Limits limits;
+            bool hostOk = false;
+            bool totalOk = true;
+            limits.hostRate = rates.value(0).toDouble(&hostOk);
+            if (rates.size() > 1) limits.globalRate = rates.value(1).toDouble(&totalOk);
+            if (!hostOk || !totalOk || rates.size() > 2 || limits.hostRate < 0 || limits.globalRate < 0) {
+                return fail("--rate takes requests per second per host and optionally in total, e.g. 5,20");
+            }
+            OutboundScheduler::instance().setLimits(limits);
+        }
+        return runReplay(start, options, parser.isSet(copyOption));
+    }
+    return runStats(start);
+}
@@ -0,0 +1,77 @@
+#include "ContentHash.h"
+#include <QtEndian>
+
+namespace {
+    const quint64 Prime1 = 11400714785074694791ULL;
+    const quint64 Prime2 = 14029467366897019727ULL;
+    const quint64 Prime3 = 1609587929392839161ULL;
+    const quint64 Prime4 = 9650029242287828579ULL;
+    const quint64 Prime5 = 2870177450012600261ULL;
+
+    inline quint64 rotl(quint64 value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline quint64 accumulate(quint64 acc, quint64 input) {
+        acc += input * Prime2;
+        return rotl(acc, 31) * Prime1;
+    }
+
+    inline quint64 mergeLane(quint64 hash, quint64 lane) {
+        hash ^= accumulate(0, lane);
+        return hash * Prime1 + Prime4;
+    }
+}
+
+quint64 ContentHash::hash(QByteArrayView data, quint64 seed) {
+    const uchar* p = reinterpret_cast<const uchar*>(data.data());
+    const uchar* const end = p + data.size();
+    quint64 hash;
+
+    if (data.size() >= 32) {
+        // Four independent lanes keep the multiplier pipelines busy
+        quint64 v1 = seed + Prime1 + Prime2;
+        quint64 v2 = seed + Prime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - Prime1;
+        const uchar* const limit = end - 32;
+        do {
+            v1 = accumulate(v1, qFromLittleEndian<quint64>(p));
+            v2 = accumulate(v2, qFromLittleEndian<quint64>(p + 8));
+            v3 = accumulate(v3, qFromLittleEndian<quint64>(p + 16));
+            v4 = accumulate(v4, qFromLittleEndian<quint64>(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = mergeLane(hash, v1);
+        hash = mergeLane(hash, v2);
+        hash = mergeLane(hash, v3);
+        hash = mergeLane(hash, v4);
+    } else {
+        hash = seed + Prime5;
+    }
+
+    hash += quint64(data.size());
+    while (p + 8 <= end) {
+        hash ^= accumulate(0, qFromLittleEndian<quint64>(p));
+        hash = rotl(hash, 27) * Prime1 + Prime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        hash ^= quint64(qFromLittleEndian<quint32>(p)) * Prime1;
+        hash = rotl(hash, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= *p * Prime5;
+        hash = rotl(hash, 11) * Prime1;
+        ++p;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
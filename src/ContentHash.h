@@ -0,0 +1,16 @@
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <QByteArrayView>
+#include <QtGlobal>
+
+// Stable 64-bit hash of raw message bytes (xxHash64). Unlike qHash the
+// result never depends on the process seed or the CPU, so it can be stored
+// in the database and compared across sessions.
+namespace ContentHash {
+
+quint64 hash(QByteArrayView data, quint64 seed = 0);
+
+} // namespace ContentHash
+
+#endif // CONTENTHASH_H
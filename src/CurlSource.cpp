@@ -0,0 +1,481 @@
+#include "CurlSource.h"
+#include "TextEscapes.h"
+
+namespace {
+    // Commands left open (unterminated quote) are dropped past this size
+    const qsizetype MaxCommandSize = 16 * 1024 * 1024;
+
+    struct ShortOption {
+        char name;
+        const char* longName;
+        bool hasArg;
+    };
+
+    // Short options we map to their long names; unknown ones are treated as flags
+    const ShortOption ShortOptions[] = {
+        {'X', "request", true}, {'H', "header", true}, {'d', "data", true},
+        {'b', "cookie", true}, {'u', "user", true}, {'A', "user-agent", true},
+        {'e', "referer", true}, {'F', "form", true}, {'G', "get", false},
+        {'I', "head", false}, {'o', "output", true}, {'x', "proxy", true},
+        {'m', "max-time", true}, {'w', "write-out", true}, {'T', "upload-file", true},
+        {'E', "cert", true}, {'K', "config", true}, {'r', "range", true},
+        {'c', "cookie-jar", true}, {'D', "dump-header", true}, {'U', "proxy-user", true},
+        {'C', "continue-at", true}, {'y', "speed-time", true}, {'Y', "speed-limit", true},
+        {'z', "time-cond", true}, {'Q', "quote", true}
+    };
+
+    const char* const LongOptionsWithArg[] = {
+        "request", "header", "data", "data-raw", "data-binary", "data-ascii", "data-urlencode",
+        "json", "cookie", "user", "user-agent", "referer", "form", "form-string", "url",
+        "output", "proxy", "max-time", "connect-timeout", "write-out", "upload-file", "cert",
+        "key", "cacert", "capath", "config", "range", "cookie-jar", "dump-header", "proxy-user",
+        "resolve", "connect-to", "retry", "retry-delay", "retry-max-time", "limit-rate",
+        "interface", "oauth2-bearer", "max-redirs", "continue-at", "speed-time", "speed-limit",
+        "time-cond", "quote", "unix-socket", "cert-type", "key-type", "pass", "ciphers"
+    };
+
+    bool longOptionHasArg(const QByteArray& name) {
+        for (const char* option : LongOptionsWithArg) {
+            if (name == option) return true;
+        }
+        return false;
+    }
+
+    const ShortOption* findShortOption(char name) {
+        for (const ShortOption& option : ShortOptions) {
+            if (option.name == name) return &option;
+        }
+        return nullptr;
+    }
+
+    // Reads up to maxDigits digits in base at text[pos], advancing pos
+    uint readNumber(QByteArrayView text, qsizetype& pos, int base, int maxDigits) {
+        uint value = 0;
+        for (int digits = 0; digits < maxDigits && pos < text.size(); ++digits) {
+            int digit = TextEscapes::hexValue(text[pos]);
+            if (digit < 0 || digit >= base) break;
+            value = value * base + uint(digit);
+            ++pos;
+        }
+        return value;
+    }
+
+    // True when the line ends in an unescaped backslash: a continuation, or
+    // inside a quote, so no command can end with this line (a comment ending
+    // in one only waits for the next line)
+    bool endsInContinuation(QByteArrayView line) {
+        qsizetype end = line.size();
+        if (end > 0 && line[end - 1] == '\n') --end;
+        if (end > 0 && line[end - 1] == '\r') --end;
+        qsizetype backslashes = 0;
+        while (backslashes < end && line[end - 1 - backslashes] == '\\') ++backslashes;
+        return backslashes % 2 == 1;
+    }
+
+    QByteArray headerName(const QByteArray& line) {
+        qsizetype colon = line.indexOf(':');
+        qsizetype semicolon = line.indexOf(';');
+        qsizetype end = colon >= 0 ? colon : semicolon;
+        return (end >= 0 ? line.left(end) : line).trimmed().toLower();
+    }
+}
+
+CurlSource::CurlSource(const QString& fileName, const QByteArray& text)
+    : m_fileName(fileName)
+    , m_text(text)
+    , m_device(nullptr)
+{
+}
+
+bool CurlSource::open() {
+    if (!m_fileName.isEmpty()) {
+        m_file.setFileName(m_fileName);
+        m_device = &m_file;
+    } else {
+        m_buffer.setData(m_text);
+        m_device = &m_buffer;
+    }
+    if (!m_device->open(QIODevice::ReadOnly)) {
+        m_error = "Could not open file: " + m_fileName;
+        return false;
+    }
+    return true;
+}
+
+bool CurlSource::next(ImportRecord& record) {
+    QByteArray pending;
+    forever {
+        while (!m_commands.isEmpty()) {
+            Words words = m_commands.dequeue();
+            // Skip everything that isn't curl: cd, export, echo, ...
+            QByteArray program = words.first().mid(words.first().lastIndexOf('/') + 1);
+            if (program != "curl" && program != "curl.exe") continue;
+            // Commands without a URL still go out, so the pipeline counts them as errors
+            parseCommand(words, record);
+            return true;
+        }
+
+        if (m_device->atEnd()) return false;
+
+        // Lines are gathered until quotes and continuations are closed. A line
+        // ending in a continuation can't complete a command, so pending is only
+        // split again once the continuation ends
+        const QByteArray line = m_device->readLine();
+        pending.append(line);
+        if (endsInContinuation(line) && !m_device->atEnd()) {
+            if (pending.size() > MaxCommandSize) pending.clear();
+            continue;
+        }
+        QList<Words> commands;
+        if (splitCommands(pending, commands) == SplitResult::Complete || m_device->atEnd()) {
+            for (const Words& words : commands) {
+                m_commands.enqueue(words);
+            }
+            pending.clear();
+        } else if (pending.size() > MaxCommandSize) {
+            pending.clear();
+        }
+    }
+}
+
+qint64 CurlSource::bytesRead() const {
+    return m_device ? m_device->pos() : 0;
+}
+
+qint64 CurlSource::totalBytes() const {
+    return m_device ? m_device->size() : 0;
+}
+
+QString CurlSource::errorString() const {
+    return m_error;
+}
+
+CurlSource::SplitResult CurlSource::splitCommands(QByteArrayView text, QList<Words>& commands) {
+    QList<Words> found;
+    Words words;
+    QByteArray word;
+    bool inWord = false; // Set by quotes too, so '' is an (empty) word
+    const qsizetype size = text.size();
+    qsizetype i = 0;
+
+    auto endWord = [&]() {
+        if (inWord) {
+            words.append(word);
+            word.clear();
+            inWord = false;
+        }
+    };
+    auto endCommand = [&]() {
+        endWord();
+        if (!words.isEmpty()) {
+            found.append(words);
+            words.clear();
+        }
+    };
+
+    while (i < size) {
+        char c = text[i];
+
+        if (c == '\\') {
+            if (i + 1 >= size) return SplitResult::NeedMore;
+            char next = text[i + 1];
+            if (next == '\n') {
+                i += 2; // Line continuation
+            } else if (next == '\r') {
+                if (i + 2 >= size) return SplitResult::NeedMore;
+                i += text[i + 2] == '\n' ? 3 : 2;
+            } else {
+                word.append(next);
+                inWord = true;
+                i += 2;
+                continue;
+            }
+            // The command carries on in the next line
+            if (i >= size) return SplitResult::NeedMore;
+            continue;
+        }
+
+        if (c == '\'') {
+            qsizetype end = text.indexOf('\'', i + 1);
+            if (end < 0) return SplitResult::NeedMore;
+            word.append(text.sliced(i + 1, end - i - 1));
+            inWord = true;
+            i = end + 1;
+            continue;
+        }
+
+        if (c == '$' && i + 1 < size && text[i + 1] == '\'') {
+            // ANSI-C quoting, as emitted by browsers' "Copy as cURL"
+            i += 2;
+            inWord = true;
+            forever {
+                if (i >= size) return SplitResult::NeedMore;
+                char ch = text[i];
+                if (ch == '\'') {
+                    ++i;
+                    break;
+                }
+                if (ch != '\\') {
+                    word.append(ch);
+                    ++i;
+                    continue;
+                }
+                if (i + 1 >= size) return SplitResult::NeedMore;
+                char escape = text[i + 1];
+                i += 2;
+                switch (escape) {
+                case 'n': word.append('\n'); break;
+                case 't': word.append('\t'); break;
+                case 'r': word.append('\r'); break;
+                case 'a': word.append('\a'); break;
+                case 'b': word.append('\b'); break;
+                case 'f': word.append('\f'); break;
+                case 'v': word.append('\v'); break;
+                case 'e':
+                case 'E': word.append('\x1b'); break;
+                case 'x': word.append(char(readNumber(text, i, 16, 2))); break;
+                case 'u': TextEscapes::appendUtf8(word, readNumber(text, i, 16, 4)); break;
+                case 'U': TextEscapes::appendUtf8(word, readNumber(text, i, 16, 8)); break;
+                case '0': case '1': case '2': case '3':
+                case '4': case '5': case '6': case '7':
+                    --i;
+                    word.append(char(readNumber(text, i, 8, 3)));
+                    break;
+                default: word.append(escape); break; // \\ \' \" \?
+                }
+            }
+            continue;
+        }
+
+        if (c == '"') {
+            ++i;
+            inWord = true;
+            forever {
+                if (i >= size) return SplitResult::NeedMore;
+                char ch = text[i];
+                if (ch == '"') {
+                    ++i;
+                    break;
+                }
+                if (ch == '\\') {
+                    if (i + 1 >= size) return SplitResult::NeedMore;
+                    char next = text[i + 1];
+                    // Inside double quotes a backslash only escapes these
+                    if (next == '"' || next == '\\' || next == '$' || next == '`') {
+                        word.append(next);
+                        i += 2;
+                    } else if (next == '\n') {
+                        i += 2;
+                    } else {
+                        word.append('\\');
+                        ++i;
+                    }
+                    continue;
+                }
+                word.append(ch);
+                ++i;
+            }
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r') {
+            endWord();
+            ++i;
+        } else if (c == '\n' || c == ';' || c == '&' || c == '|') {
+            endCommand();
+            ++i;
+        } else if (c == '#' && !inWord) {
+            // Comment to the end of the line
+            while (i < size && text[i] != '\n') ++i;
+        } else {
+            word.append(c);
+            inWord = true;
+            ++i;
+        }
+    }
+
+    endCommand();
+    commands += found;
+    return SplitResult::Complete;
+}
+
+bool CurlSource::parseCommand(const Words& words, ImportRecord& record) {
+    QByteArray url, method, user, cookie, userAgent, referer;
+    QList<QByteArray> headers;
+    QList<QByteArray> data;
+    QList<QByteArray> formParts;
+    bool get = false;
+    bool head = false;
+    bool json = false;
+
+    auto handle = [&](const QByteArray& option, const QByteArray& value) {
+        if (option == "request") {
+            method = value;
+        } else if (option == "header") {
+            headers.append(value.trimmed());
+        } else if (option == "data" || option == "data-ascii" || option == "data-raw" || option == "data-binary") {
+            // curl only strips newlines from -d @file contents, and files
+            // aren't read here, so inline values go in as given
+            data.append(value);
+        } else if (option == "data-urlencode") {
+            qsizetype equals = value.indexOf('=');
+            if (equals < 0) {
+                data.append(value.toPercentEncoding());
+            } else {
+                QByteArray name = value.left(equals);
+                QByteArray encoded = value.mid(equals + 1).toPercentEncoding();
+                data.append(name.isEmpty() ? encoded : name + "=" + encoded);
+            }
+        } else if (option == "json") {
+            data.append(value);
+            json = true;
+        } else if (option == "form" || option == "form-string") {
+            formParts.append(value);
+        } else if (option == "cookie") {
+            // Without '=' the argument names a cookie file, which we can't read
+            if (value.contains('=')) cookie = cookie.isEmpty() ? value : cookie + "; " + value;
+        } else if (option == "user") {
+            user = value;
+        } else if (option == "user-agent") {
+            userAgent = value;
+        } else if (option == "referer") {
+            referer = value;
+        } else if (option == "url") {
+            url = value;
+        } else if (option == "get") {
+            get = true;
+        } else if (option == "head") {
+            head = true;
+        }
+    };
+
+    for (int i = 1; i < words.size(); ++i) {
+        const QByteArray& word = words[i];
+        if (word.startsWith("--") && word.size() > 2) {
+            QByteArray option = word.mid(2);
+            QByteArray value;
+            if (longOptionHasArg(option) && i + 1 < words.size()) {
+                value = words[++i];
+            }
+            handle(option, value);
+        } else if (word.startsWith('-') && word.size() > 1) {
+            // Clustered flags (-sSL) and attached values (-XPOST)
+            for (qsizetype j = 1; j < word.size(); ++j) {
+                const ShortOption* option = findShortOption(word[j]);
+                if (!option) continue;
+                if (!option->hasArg) {
+                    handle(option->longName, QByteArray());
+                    continue;
+                }
+                QByteArray value = j + 1 < word.size() ? word.mid(j + 1) : (i + 1 < words.size() ? words[++i] : QByteArray());
+                handle(option->longName, value);
+                break;
+            }
+        } else if (url.isEmpty()) {
+            url = word;
+        }
+    }
+
+    if (url.isEmpty()) return false;
+
+    // Split the URL into authority and origin-form target
+    if (!url.contains("://")) url.prepend("http://");
+    qsizetype authorityStart = url.indexOf("://") + 3;
+    qsizetype authorityEnd = authorityStart;
+    while (authorityEnd < url.size() && url[authorityEnd] != '/' && url[authorityEnd] != '?' && url[authorityEnd] != '#') {
+        ++authorityEnd;
+    }
+    QByteArray authority = url.mid(authorityStart, authorityEnd - authorityStart);
+    qsizetype at = authority.lastIndexOf('@');
+    if (at >= 0) {
+        if (user.isEmpty()) user = QByteArray::fromPercentEncoding(authority.left(at));
+        authority = authority.mid(at + 1);
+        url.remove(authorityStart, at + 1);
+        authorityEnd -= at + 1;
+    }
+    QByteArray target = url.mid(authorityEnd);
+    qsizetype fragment = target.indexOf('#');
+    if (fragment >= 0) target.truncate(fragment);
+    if (target.isEmpty() || target.startsWith('?')) target.prepend('/');
+
+    QByteArray body = data.join('&');
+    if (get && !body.isEmpty()) {
+        target += (target.contains('?') ? "&" : "?") + body;
+        body.clear();
+    }
+
+    QByteArray contentType;
+    if (!formParts.isEmpty()) {
+        // Multipart form; @file parts become empty file fields
+        const QByteArray boundary = "------------------------RequestOrganizerBoundary";
+        for (const QByteArray& part : formParts) {
+            qsizetype equals = part.indexOf('=');
+            QByteArray name = equals < 0 ? part : part.left(equals);
+            QByteArray value = equals < 0 ? QByteArray() : part.mid(equals + 1);
+            body += "--" + boundary + "\r\n";
+            if (value.startsWith('@') || value.startsWith('<')) {
+                QByteArray fileName = value.mid(1).split(';').first();
+                fileName = fileName.mid(fileName.lastIndexOf('/') + 1);
+                body += "Content-Disposition: form-data; name=\"" + name + "\"; filename=\"" + fileName + "\"\r\n";
+                body += "Content-Type: application/octet-stream\r\n\r\n\r\n";
+            } else {
+                body += "Content-Disposition: form-data; name=\"" + name + "\"\r\n\r\n" + value + "\r\n";
+            }
+        }
+        body += "--" + boundary + "--\r\n";
+        contentType = "multipart/form-data; boundary=" + boundary;
+    } else if (json) {
+        contentType = "application/json";
+    } else if (!data.isEmpty() && !get) {
+        contentType = "application/x-www-form-urlencoded";
+    }
+
+    if (method.isEmpty()) {
+        method = head ? "HEAD" : (!body.isEmpty() || !formParts.isEmpty() ? "POST" : "GET");
+    }
+
+    // Custom headers override the defaults curl would send; "Name:" removes one
+    QList<QByteArray> names;
+    for (const QByteArray& header : headers) {
+        names.append(headerName(header));
+    }
+    auto custom = [&names](const char* name) { return names.contains(QByteArray(name)); };
+
+    QByteArray message;
+    message.reserve(target.size() + body.size() + 256);
+    message.append(method).append(' ').append(target).append(" HTTP/1.1\r\n");
+    if (!custom("host")) message.append("Host: ").append(authority).append("\r\n");
+    if (!user.isEmpty() && !custom("authorization")) {
+        message.append("Authorization: Basic ").append(user.toBase64()).append("\r\n");
+    }
+    if (!userAgent.isEmpty() && !custom("user-agent")) message.append("User-Agent: ").append(userAgent).append("\r\n");
+    if (!custom("accept")) message.append(json ? "Accept: application/json\r\n" : "Accept: */*\r\n");
+    if (!referer.isEmpty() && !custom("referer")) message.append("Referer: ").append(referer).append("\r\n");
+    if (!cookie.isEmpty() && !custom("cookie")) message.append("Cookie: ").append(cookie).append("\r\n");
+    for (const QByteArray& header : headers) {
+        qsizetype colon = header.indexOf(':');
+        if (colon >= 0 && header.mid(colon + 1).trimmed().isEmpty()) continue; // "Name:" disables it
+        if (colon < 0) {
+            // "Name;" sends the header with an empty value
+            qsizetype semicolon = header.indexOf(';');
+            if (semicolon >= 0) message.append(header.left(semicolon)).append(":\r\n");
+            continue;
+        }
+        if (headerName(header) == "content-length") continue;
+        message.append(header).append("\r\n");
+    }
+    if (!contentType.isEmpty() && !custom("content-type")) {
+        message.append("Content-Type: ").append(contentType).append("\r\n");
+    }
+    if (!body.isEmpty()) {
+        message.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    }
+    message.append("\r\n");
+    message.append(body);
+
+    record.method = QString::fromLatin1(method);
+    record.url = QString::fromUtf8(url.left(authorityEnd) + target);
+    record.host = QString::fromUtf8(authority);
+    record.request = message;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef CURLSOURCE_H
+#define CURLSOURCE_H
+
+#include <QBuffer>
+#include <QFile>
+#include <QList>
+#include <QQueue>
+#include "ImportSource.h"
+
+// Reads curl command lines from a script or pasted text and turns each into
+// a raw HTTP request. Words are split with POSIX shell quoting rules ('...',
+// "...", $'...', backslash escapes and line continuations); anything that is
+// not a curl invocation is skipped.
+class CurlSource : public ImportSource {
+public:
+    // Reads fileName, or text when fileName is empty (pasted content)
+    explicit CurlSource(const QString& fileName, const QByteArray& text = QByteArray());
+
+    bool open() override;
+    bool next(ImportRecord& record) override;
+    qint64 bytesRead() const override;
+    qint64 totalBytes() const override;
+    QString errorString() const override;
+
+    typedef QList<QByteArray> Words;
+
+    enum class SplitResult { Complete, NeedMore };
+    // Splits shell text into commands. NeedMore means the text ends inside a
+    // quote or after a continuation backslash, so more lines must be appended.
+    static SplitResult splitCommands(QByteArrayView text, QList<Words>& commands);
+    // Builds the request for one curl command; false if it has no URL
+    static bool parseCommand(const Words& words, ImportRecord& record);
+
+private:
+    QString m_fileName;
+    QByteArray m_text;
+    QFile m_file;
+    QBuffer m_buffer;
+    QIODevice* m_device;
+    QQueue<Words> m_commands;
+    QString m_error;
+};
+
+#endif // CURLSOURCE_H
@@ -1,9 +1,17 @@
 #include "DatabaseManager.h"
+#include "ContentHash.h"
 #include "OrganizerItem.h"
+#include "PerfCounters.h"
+#include "Trace.h"
 #include <QStandardPaths>
 #include <QDir>
+#include <QMap>
 #include <QDebug>
 #include <QSqlError>
+#ifdef RO_SQLITE_STATS
+#include <QSqlDriver>
+#include <sqlite3.h>
+#endif
 
 DatabaseManager::DatabaseManager() {
     QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -22,7 +30,15 @@ DatabaseManager& DatabaseManager::instance() {
     return instance;
 }
 
+void DatabaseManager::setDatabasePath(const QString& path) {
+    m_dbPath = path;
+}
+
 bool DatabaseManager::initialize() {
+    // Several models (or a model and a benchmark) share the one connection
+    if (m_database.isOpen()) {
+        return true;
+    }
     m_database = QSqlDatabase::addDatabase("QSQLITE");
     m_database.setDatabaseName(m_dbPath);
     
@@ -34,6 +50,15 @@ bool DatabaseManager::initialize() {
     return createTables();
 }
 
+QSqlDatabase DatabaseManager::openConnection(const QString& connectionName) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(m_dbPath);
+    if (!db.open()) {
+        qDebug() << "Error opening database connection:" << db.lastError().text();
+    }
+    return db;
+}
+
 bool DatabaseManager::createTables() {
     QSqlQuery query(m_database);
     
@@ -44,8 +69,8 @@ bool DatabaseManager::createTables() {
             name TEXT NOT NULL,
             annotation TEXT,
             color TEXT,
-            request TEXT,
-            response TEXT,
+            request BLOB,
+            response BLOB,
             parent_id INTEGER,
             host TEXT,
             url TEXT,
@@ -56,6 +81,12 @@ bool DatabaseManager::createTables() {
             length INTEGER,
             timestamp INTEGER,
             screenshot TEXT,
+            thumbnail BLOB,
+            request_hash INTEGER,
+            response_hash INTEGER,
+            scheme TEXT,
+            port INTEGER,
+            thumbnail_unavailable INTEGER,
             FOREIGN KEY (parent_id) REFERENCES items(id) ON DELETE CASCADE
         )
     )";
@@ -66,8 +97,8 @@ bool DatabaseManager::createTables() {
     }
     
     // Add new columns if they don't exist (for existing databases)
-    QStringList textColumns = {"host", "url", "method", "query", "screenshot"};
-    QStringList intColumns = {"response_time", "status", "length", "timestamp"};
+    QStringList textColumns = {"host", "url", "method", "query", "screenshot", "scheme"};
+    QStringList intColumns = {"response_time", "status", "length", "timestamp", "request_hash", "response_hash", "port", "thumbnail_unavailable"};
     
     for (const QString& column : textColumns) {
         QString alterTable = QString("ALTER TABLE items ADD COLUMN %1 TEXT").arg(column);
@@ -79,32 +110,134 @@ bool DatabaseManager::createTables() {
         query.exec(alterTable); // Ignore errors if column already exists
     }
     
+    query.exec("ALTER TABLE items ADD COLUMN thumbnail BLOB"); // Ignore errors if column already exists
+    
     if (!query.exec(createTable)) {
         qDebug() << "Error creating table:" << query.lastError().text();
         return false;
     }
     
+    // Fuzz runs; results are stored a batch per row, one blob per column
+    // (see FuzzResultStore)
+    const QStringList fuzzTables = {
+        R"(
+        CREATE TABLE IF NOT EXISTS fuzz_runs (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            item_id INTEGER NOT NULL,
+            created INTEGER,
+            mode TEXT,
+            target TEXT,
+            request BLOB
+        )
+        )",
+        R"(
+        CREATE TABLE IF NOT EXISTS fuzz_chunks (
+            run_id INTEGER NOT NULL,
+            first_row INTEGER NOT NULL,
+            row_count INTEGER NOT NULL,
+            payload_ids BLOB,
+            positions BLOB,
+            statuses BLOB,
+            lengths BLOB,
+            words BLOB,
+            lines BLOB,
+            times BLOB,
+            hashes BLOB,
+            payloads BLOB,
+            payload_ends BLOB,
+            errors BLOB,
+            PRIMARY KEY (run_id, first_row)
+        )
+        )",
+        "CREATE INDEX IF NOT EXISTS fuzz_runs_item ON fuzz_runs(item_id)"
+    };
+    for (const QString& statement : fuzzTables) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error creating fuzz tables:" << query.lastError().text();
+            return false;
+        }
+    }
+    
+    return migrateSchema();
+}
+
+bool DatabaseManager::migrateSchema() {
+    QSqlQuery query(m_database);
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        version = query.value(0).toInt();
+    }
+    
+    if (version < 1) {
+        // Bodies used to be stored as base64 text; store the raw bytes instead
+        m_database.transaction();
+        QSqlQuery select("SELECT id, request, response FROM items", m_database);
+        QSqlQuery update(m_database);
+        update.prepare("UPDATE items SET request = :request, response = :response WHERE id = :id");
+        while (select.next()) {
+            update.bindValue(":request", QByteArray::fromBase64(select.value(1).toByteArray()));
+            update.bindValue(":response", QByteArray::fromBase64(select.value(2).toByteArray()));
+            update.bindValue(":id", select.value(0).toInt());
+            if (!update.exec()) {
+                qDebug() << "Error migrating item bodies:" << update.lastError().text();
+                m_database.rollback();
+                return false;
+            }
+        }
+        m_database.commit();
+        query.exec("PRAGMA user_version = 1");
+    }
+    
+    if (version < 2) {
+        // Content hashes for duplicate detection on import
+        m_database.transaction();
+        QSqlQuery select("SELECT id, request, response FROM items WHERE type = 1", m_database);
+        QSqlQuery update(m_database);
+        update.prepare("UPDATE items SET request_hash = :request_hash, response_hash = :response_hash WHERE id = :id");
+        while (select.next()) {
+            update.bindValue(":request_hash", qint64(ContentHash::hash(select.value(1).toByteArray())));
+            update.bindValue(":response_hash", qint64(ContentHash::hash(select.value(2).toByteArray())));
+            update.bindValue(":id", select.value(0).toInt());
+            if (!update.exec()) {
+                qDebug() << "Error hashing item bodies:" << update.lastError().text();
+                m_database.rollback();
+                return false;
+            }
+        }
+        if (!query.exec("CREATE INDEX IF NOT EXISTS items_request_hash ON items(request_hash)")) {
+            qDebug() << "Error creating hash index:" << query.lastError().text();
+            m_database.rollback();
+            return false;
+        }
+        m_database.commit();
+        query.exec("PRAGMA user_version = 2");
+    }
+    
     return true;
 }
 
 int DatabaseManager::saveItem(int id, ItemType type, const QString& name, const QString& annotation,
-                               const QColor& color, const QString& request, const QString& response, int parentId,
+                               const QColor& color, const QByteArray& request, const QByteArray& response, int parentId,
                                const QString& host, const QString& url, const QString& method, qint64 responseTime,
                                const QString& query, int status, qint64 length, qint64 timestamp,
-                               const QString& screenshot) {
+                               const QString& screenshot, const QByteArray& thumbnail,
+                               const QString& scheme, int port) {
+    RO_TRACE("DatabaseManager::saveItem");
+    PerfCounters::Timer timer(PerfCounters::saveItem);
     QSqlQuery queryObj(m_database);
     
     if (id == -1) {
         // Insert new item
-        queryObj.prepare("INSERT INTO items (type, name, annotation, color, request, response, parent_id, host, url, method, response_time, query, status, length, timestamp, screenshot) "
-                     "VALUES (:type, :name, :annotation, :color, :request, :response, :parent_id, :host, :url, :method, :response_time, :query, :status, :length, :timestamp, :screenshot)");
+        queryObj.prepare("INSERT INTO items (type, name, annotation, color, request, response, parent_id, host, url, method, response_time, query, status, length, timestamp, screenshot, thumbnail, request_hash, response_hash, scheme, port) "
+                     "VALUES (:type, :name, :annotation, :color, :request, :response, :parent_id, :host, :url, :method, :response_time, :query, :status, :length, :timestamp, :screenshot, :thumbnail, :request_hash, :response_hash, :scheme, :port)");
     } else {
         // Update existing item
         queryObj.prepare("UPDATE items SET type = :type, name = :name, annotation = :annotation, "
                      "color = :color, request = :request, response = :response, parent_id = :parent_id, "
                      "host = :host, url = :url, method = :method, response_time = :response_time, "
-                     "query = :query, status = :status, length = :length, timestamp = :timestamp, screenshot = :screenshot "
-                     "WHERE id = :id");
+                     "query = :query, status = :status, length = :length, timestamp = :timestamp, screenshot = :screenshot, "
+                     "thumbnail = :thumbnail, request_hash = :request_hash, response_hash = :response_hash, "
+                     "scheme = :scheme, port = :port WHERE id = :id");
         queryObj.bindValue(":id", id);
     }
     
@@ -124,6 +257,11 @@ int DatabaseManager::saveItem(int id, ItemType type, const QString& name, const
     queryObj.bindValue(":length", length);
     queryObj.bindValue(":timestamp", timestamp);
     queryObj.bindValue(":screenshot", screenshot);
+    queryObj.bindValue(":thumbnail", thumbnail);
+    queryObj.bindValue(":request_hash", qint64(ContentHash::hash(request)));
+    queryObj.bindValue(":response_hash", qint64(ContentHash::hash(response)));
+    queryObj.bindValue(":scheme", scheme);
+    queryObj.bindValue(":port", port);
     
     if (!queryObj.exec()) {
         qDebug() << "Error saving item:" << queryObj.lastError().text();
@@ -138,6 +276,277 @@ int DatabaseManager::saveItem(int id, ItemType type, const QString& name, const
     return id;
 }
 
+namespace {
+    const char InsertItemSql[] =
+        "INSERT INTO items (type, name, annotation, color, request, response, parent_id, host, url, method, response_time, query, status, length, timestamp, screenshot, thumbnail, request_hash, response_hash, scheme, port) "
+        "VALUES (:type, :name, :annotation, :color, :request, :response, :parent_id, :host, :url, :method, :response_time, :query, :status, :length, :timestamp, :screenshot, :thumbnail, :request_hash, :response_hash, :scheme, :port)";
+
+    bool insertItem(QSqlQuery& queryObj, OrganizerItem* item, int parentId) {
+        queryObj.bindValue(":type", static_cast<int>(item->type()));
+        queryObj.bindValue(":name", item->name());
+        queryObj.bindValue(":annotation", item->annotation());
+        queryObj.bindValue(":color", item->color().name());
+        queryObj.bindValue(":request", item->request());
+        queryObj.bindValue(":response", item->response());
+        queryObj.bindValue(":parent_id", parentId == -1 ? QVariant() : parentId);
+        queryObj.bindValue(":host", item->host());
+        queryObj.bindValue(":url", item->url());
+        queryObj.bindValue(":method", item->method());
+        queryObj.bindValue(":response_time", item->responseTime());
+        queryObj.bindValue(":query", item->query());
+        queryObj.bindValue(":status", item->status());
+        queryObj.bindValue(":length", item->length());
+        queryObj.bindValue(":timestamp", item->timestamp());
+        queryObj.bindValue(":screenshot", item->screenshot());
+        queryObj.bindValue(":thumbnail", item->thumbnail());
+        queryObj.bindValue(":request_hash", qint64(item->requestHash()));
+        queryObj.bindValue(":response_hash", qint64(item->responseHash()));
+        queryObj.bindValue(":scheme", item->scheme());
+        queryObj.bindValue(":port", item->port());
+        
+        if (!queryObj.exec()) {
+            qDebug() << "Error saving item:" << queryObj.lastError().text();
+            return false;
+        }
+        item->setDbId(queryObj.lastInsertId().toInt());
+        return true;
+    }
+
+    // Parents are inserted before their children so every parent_id is known
+    bool insertSubtree(QSqlQuery& queryObj, OrganizerItem* item, int parentId) {
+        if (!insertItem(queryObj, item, parentId)) return false;
+        for (OrganizerItem* child : item->children()) {
+            if (!insertSubtree(queryObj, child, item->dbId())) return false;
+        }
+        return true;
+    }
+
+    void resetIds(OrganizerItem* item) {
+        item->setDbId(-1);
+        for (OrganizerItem* child : item->children()) {
+            resetIds(child);
+        }
+    }
+}
+
+bool DatabaseManager::insertItems(QSqlDatabase& db, const QList<OrganizerItem*>& items, int parentId) {
+    PerfCounters::Timer timer(PerfCounters::insertBatch);
+    if (!db.transaction()) {
+        qDebug() << "Error starting transaction:" << db.lastError().text();
+        return false;
+    }
+    
+    // Prepared once for the whole batch
+    QSqlQuery queryObj(db);
+    queryObj.prepare(InsertItemSql);
+    
+    for (OrganizerItem* item : items) {
+        if (!insertItem(queryObj, item, parentId)) {
+            db.rollback();
+            for (OrganizerItem* saved : items) {
+                saved->setDbId(-1);
+            }
+            return false;
+        }
+    }
+    
+    if (!db.commit()) {
+        qDebug() << "Error committing items:" << db.lastError().text();
+        for (OrganizerItem* item : items) {
+            item->setDbId(-1);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::insertTree(QSqlDatabase& db, OrganizerItem* root, int parentId) {
+    if (!db.transaction()) {
+        qDebug() << "Error starting transaction:" << db.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery queryObj(db);
+    queryObj.prepare(InsertItemSql);
+    
+    if (!insertSubtree(queryObj, root, parentId)) {
+        db.rollback();
+        resetIds(root);
+        return false;
+    }
+    
+    if (!db.commit()) {
+        qDebug() << "Error committing items:" << db.lastError().text();
+        resetIds(root);
+        return false;
+    }
+    return true;
+}
+
+QMultiHash<quint64, DatabaseManager::StoredHash> DatabaseManager::findRequestHashes(QSqlDatabase& db, const QList<quint64>& hashes) {
+    QMultiHash<quint64, StoredHash> found;
+    // SQLite caps bound parameters; stay well under the oldest limit of 999
+    const int ChunkSize = 500;
+    for (int start = 0; start < hashes.size(); start += ChunkSize) {
+        const int count = qMin(ChunkSize, int(hashes.size()) - start);
+        QString placeholders = QString("?,").repeated(count);
+        placeholders.chop(1);
+        
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare("SELECT id, request_hash, response_hash FROM items WHERE type = 1 AND request_hash IN (" + placeholders + ")");
+        for (int i = 0; i < count; ++i) {
+            query.addBindValue(qint64(hashes[start + i]));
+        }
+        if (!query.exec()) {
+            qDebug() << "Error looking up request hashes:" << query.lastError().text();
+            continue;
+        }
+        while (query.next()) {
+            StoredHash stored{query.value(0).toInt(), quint64(query.value(2).toLongLong())};
+            found.insert(quint64(query.value(1).toLongLong()), stored);
+        }
+    }
+    return found;
+}
+
+bool DatabaseManager::replaceItems(QSqlDatabase& db, const QList<QPair<int, OrganizerItem*>>& replacements) {
+    if (!db.transaction()) {
+        qDebug() << "Error starting transaction:" << db.lastError().text();
+        return false;
+    }
+    
+    // The existing row keeps its name, place, annotation, color, screenshot, scheme and port
+    QSqlQuery queryObj(db);
+    queryObj.prepare("UPDATE items SET request = :request, response = :response, response_time = :response_time, "
+                     "status = :status, length = :length, timestamp = :timestamp, "
+                     "request_hash = :request_hash, response_hash = :response_hash WHERE id = :id");
+    for (const auto& replacement : replacements) {
+        const OrganizerItem* item = replacement.second;
+        queryObj.bindValue(":request", item->request());
+        queryObj.bindValue(":response", item->response());
+        queryObj.bindValue(":response_time", item->responseTime());
+        queryObj.bindValue(":status", item->status());
+        queryObj.bindValue(":length", item->length());
+        queryObj.bindValue(":timestamp", item->timestamp());
+        queryObj.bindValue(":request_hash", qint64(item->requestHash()));
+        queryObj.bindValue(":response_hash", qint64(item->responseHash()));
+        queryObj.bindValue(":id", replacement.first);
+        if (!queryObj.exec()) {
+            qDebug() << "Error replacing item:" << queryObj.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    
+    if (!db.commit()) {
+        qDebug() << "Error committing replacements:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::saveThumbnail(int id, const QByteArray& thumbnail, bool unavailable) {
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE items SET thumbnail = :thumbnail, thumbnail_unavailable = :unavailable WHERE id = :id");
+    query.bindValue(":thumbnail", thumbnail);
+    query.bindValue(":unavailable", unavailable ? 1 : 0);
+    query.bindValue(":id", id);
+    
+    if (!query.exec()) {
+        qDebug() << "Error saving thumbnail:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool DatabaseManager::loadTree(OrganizerItem* root) {
+    QSqlQuery query("SELECT id, type, name, annotation, color, request, response, parent_id, "
+                    "COALESCE(host, '') as host, COALESCE(url, '') as url, "
+                    "COALESCE(method, '') as method, COALESCE(response_time, 0) as response_time, "
+                    "COALESCE(query, '') as query, COALESCE(status, 0) as status, "
+                    "COALESCE(length, 0) as length, COALESCE(timestamp, 0) as timestamp, "
+                    "COALESCE(screenshot, '') as screenshot, thumbnail, "
+                    "COALESCE(scheme, '') as scheme, COALESCE(port, 0) as port, "
+                    "COALESCE(thumbnail_unavailable, 0) as thumbnail_unavailable "
+                    "FROM items ORDER BY id", 
+                    m_database);
+    if (!query.isActive()) {
+        qDebug() << "Error loading items:" << query.lastError().text();
+        return false;
+    }
+    
+    QMap<int, OrganizerItem*> itemsMap;
+    QMap<int, int> parentMap; // Maps item id to parent id
+    
+    // First pass: create all items
+    while (query.next()) {
+        int id = query.value(0).toInt();
+        ItemType type = static_cast<ItemType>(query.value(1).toInt());
+        QString name = query.value(2).toString();
+        QString annotation = query.value(3).toString();
+        QColor color = QColor(query.value(4).toString());
+        QByteArray request = query.value(5).toByteArray();
+        QByteArray response = query.value(6).toByteArray();
+        int parentId = query.value(7).toInt();
+        QString host = query.value(8).toString();
+        QString url = query.value(9).toString();
+        QString method = query.value(10).toString();
+        qint64 responseTime = query.value(11).toLongLong();
+        QString queryStr = query.value(12).toString();
+        int status = query.value(13).toInt();
+        qint64 length = query.value(14).toLongLong();
+        qint64 timestamp = query.value(15).toLongLong();
+        QString screenshot = query.value(16).toString();
+        QByteArray thumbnail = query.value(17).toByteArray();
+        QString scheme = query.value(18).toString();
+        int port = query.value(19).toInt();
+        bool thumbnailUnavailable = query.value(20).toInt() != 0;
+        
+        OrganizerItem* item = new OrganizerItem(type, name);
+        item->setDbId(id);
+        item->setAnnotation(annotation);
+        item->setColor(color);
+        item->setRequest(request);
+        item->setResponse(response);
+        item->setHost(host);
+        item->setUrl(url);
+        item->setScheme(scheme);
+        item->setPort(port);
+        item->setMethod(method);
+        item->setResponseTime(responseTime);
+        item->setQuery(queryStr);
+        item->setStatus(status);
+        item->setLength(length);
+        item->setTimestamp(timestamp);
+        item->setScreenshot(screenshot);
+        item->setThumbnail(thumbnail);
+        item->setThumbnailUnavailable(thumbnailUnavailable);
+        
+        itemsMap[id] = item;
+        parentMap[id] = parentId;
+    }
+    
+    // Second pass: establish parent-child relationships
+    for (auto it = itemsMap.begin(); it != itemsMap.end(); ++it) {
+        int id = it.key();
+        OrganizerItem* item = it.value();
+        int parentId = parentMap[id];
+        
+        if (parentId == 0 || !itemsMap.contains(parentId)) {
+            // Root level item
+            root->appendChild(item);
+        } else {
+            // Child item
+            OrganizerItem* parent = itemsMap[parentId];
+            parent->appendChild(item);
+        }
+    }
+    
+    return true;
+}
+
 bool DatabaseManager::loadItems() {
     QSqlQuery query("SELECT id, type, name, annotation, color, request, response, parent_id FROM items ORDER BY id", m_database);
     
@@ -159,6 +568,14 @@ bool DatabaseManager::deleteItem(int id) {
         return false;
     }
     
+    // Fuzz runs of the item go with it
+    query.prepare("DELETE FROM fuzz_chunks WHERE run_id IN (SELECT id FROM fuzz_runs WHERE item_id = :id)");
+    query.bindValue(":id", id);
+    query.exec();
+    query.prepare("DELETE FROM fuzz_runs WHERE item_id = :id");
+    query.bindValue(":id", id);
+    query.exec();
+    
     return true;
 }
 
@@ -169,3 +586,25 @@ int DatabaseManager::getNextId() {
     }
     return 1;
 }
+
+bool DatabaseManager::pageCacheStats(qint64* hits, qint64* misses) {
+#ifdef RO_SQLITE_STATS
+    // The driver hands out its sqlite3 handle; this only works when Qt's
+    // SQLite plugin and this build use the same SQLite library
+    QVariant handle = m_database.driver()->handle();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0) return false;
+    sqlite3* connection = *static_cast<sqlite3**>(handle.data());
+    if (!connection) return false;
+    int current = 0;
+    int highwater = 0;
+    if (sqlite3_db_status(connection, SQLITE_DBSTATUS_CACHE_HIT, &current, &highwater, 0) != SQLITE_OK) return false;
+    *hits = current;
+    if (sqlite3_db_status(connection, SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 0) != SQLITE_OK) return false;
+    *misses = current;
+    return true;
+#else
+    Q_UNUSED(hits);
+    Q_UNUSED(misses);
+    return false;
+#endif
+}
@@ -5,22 +5,51 @@
 #include <QSqlQuery>
 #include <QString>
 #include <QColor>
+#include <QMultiHash>
+#include <QPair>
 #include "OrganizerItem.h"
 
 class DatabaseManager {
 public:
     static DatabaseManager& instance();
+    // Overrides the default project file in the app data directory; call before initialize()
+    void setDatabasePath(const QString& path);
+    QString databasePath() const { return m_dbPath; }
     bool initialize();
     int saveItem(int id, ItemType type, const QString& name, const QString& annotation, 
-                  const QColor& color, const QString& request, const QString& response, int parentId,
+                  const QColor& color, const QByteArray& request, const QByteArray& response, int parentId,
                   const QString& host = "", const QString& url = "", const QString& method = "", qint64 responseTime = 0,
                   const QString& query = "", int status = 0, qint64 length = 0, qint64 timestamp = 0,
-                  const QString& screenshot = "");
+                  const QString& screenshot = "", const QByteArray& thumbnail = QByteArray(),
+                  const QString& scheme = "", int port = 0);
+    // An empty thumbnail with unavailable set marks a screenshot that can't be decoded
+    bool saveThumbnail(int id, const QByteArray& thumbnail, bool unavailable = false);
+    // Inserts new items under parentId in one transaction and assigns their ids
+    bool insertItems(QSqlDatabase& db, const QList<OrganizerItem*>& items, int parentId);
+    // Inserts root and everything under it in one transaction, parents first
+    bool insertTree(QSqlDatabase& db, OrganizerItem* root, int parentId);
+    
+    struct StoredHash {
+        int id;
+        quint64 responseHash;
+    };
+    // Saved requests whose request_hash is one of hashes, keyed by that hash.
+    // One indexed query per few hundred hashes.
+    QMultiHash<quint64, StoredHash> findRequestHashes(QSqlDatabase& db, const QList<quint64>& hashes);
+    // Overwrites the exchange of each existing id with the item's, in one transaction
+    bool replaceItems(QSqlDatabase& db, const QList<QPair<int, OrganizerItem*>>& replacements);
+    // Reads every saved item and attaches the top-level ones to root
+    bool loadTree(OrganizerItem* root);
     bool loadItems();
     bool deleteItem(int id);
     int getNextId();
     
     QSqlDatabase& database() { return m_database; }
+    // Page cache hits and misses of the main connection since it opened.
+    // Only available when built with RO_SQLITE_STATS; false otherwise.
+    bool pageCacheStats(qint64* hits, qint64* misses);
+    // Extra connection for a worker thread; remove it with QSqlDatabase::removeDatabase
+    QSqlDatabase openConnection(const QString& connectionName);
 
 private:
     DatabaseManager();
@@ -29,6 +58,7 @@ private:
     DatabaseManager& operator=(const DatabaseManager&) = delete;
     
     bool createTables();
+    bool migrateSchema();
     QString m_dbPath;
     QSqlDatabase m_database;
 };
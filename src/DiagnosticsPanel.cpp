@@ -0,0 +1,225 @@
+#include "DiagnosticsPanel.h"
+#include "DatabaseManager.h"
+#include "PerfCounters.h"
+#include "Trace.h"
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QLocale>
+#include <QSqlQuery>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+    // Memory and database figures are refreshed every this many ticks
+    const int SlowRefresh = 5;
+    // The memory walk hands the GUI thread back after this long
+    const qint64 MemoryWalkSlice = 4000000; // ns
+
+    QString size(qint64 bytes) {
+        return QLocale().formattedDataSize(bytes);
+    }
+
+    QString latency(const PerfCounters::Latency& latency) {
+        if (latency.last() < 0) return "-";
+        return QString("%1 ms last, %2 ms max, %3 total")
+            .arg(latency.last() / 1e6, 0, 'f', 1)
+            .arg(latency.max() / 1e6, 0, 'f', 1)
+            .arg(latency.count());
+    }
+}
+
+DiagnosticsPanel::DiagnosticsPanel(OrganizerModel* model, QWidget* parent)
+    : QDockWidget("Diagnostics", parent)
+    , m_model(model)
+    , m_refreshes(0)
+    , m_loadedItems(0)
+    , m_databaseItems(-1)
+    , m_memoryItems(0)
+{
+    setObjectName("DiagnosticsPanel");
+    QWidget* contents = new QWidget(this);
+    QFormLayout* layout = new QFormLayout(contents);
+    auto addRow = [layout, contents](const QString& title) {
+        QLabel* label = new QLabel("-", contents);
+        label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        layout->addRow(title, label);
+        return label;
+    };
+    m_itemsLabel = addRow("Items:");
+    m_memoryLabel = addRow("Item memory:");
+    m_databaseLabel = addRow("Database:");
+    m_cacheLabel = addRow("Page cache:");
+    m_pendingLabel = addRow("Pending writes:");
+    m_saveLabel = addRow("Save:");
+    m_insertLabel = addRow("Batch insert:");
+    m_importLabel = addRow("Last import:");
+    m_stallLabel = addRow("Event loop stalls:");
+    setWidget(contents);
+
+    m_watchdog.setTimerType(Qt::PreciseTimer);
+    m_watchdog.setInterval(WatchdogInterval);
+    connect(&m_watchdog, &QTimer::timeout, this, &DiagnosticsPanel::onWatchdog);
+    m_sinceTick.start();
+    m_watchdog.start();
+
+    m_refreshTimer.setInterval(1000);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::refresh);
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) {
+            m_refreshes = 0;
+            refresh();
+            m_refreshTimer.start();
+        } else {
+            m_refreshTimer.stop();
+            m_memoryTimer.stop();
+        }
+    });
+    m_memoryTimer.setInterval(10);
+    connect(&m_memoryTimer, &QTimer::timeout, this, &DiagnosticsPanel::continueMemoryWalk);
+    // Removed or moved rows may be on the walk's path, so it starts over
+    auto restartMemoryWalk = [this]() {
+        if (m_memoryTimer.isActive()) startMemoryWalk();
+    };
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this, restartMemoryWalk);
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeMoved, this, restartMemoryWalk);
+    connect(&m_databaseWatcher, &QFutureWatcher<DatabaseStats>::finished, this, [this]() {
+        updateDatabase(m_databaseWatcher.result());
+    });
+}
+
+void DiagnosticsPanel::onWatchdog() {
+    // A tick that comes late means the event loop was busy for that long
+    const qint64 elapsed = m_sinceTick.nsecsElapsed();
+    m_sinceTick.restart();
+    const qint64 late = elapsed - qint64(WatchdogInterval) * 1000000;
+    if (late > qint64(StallThreshold) * 1000000) {
+        PerfCounters::eventLoopStall.record(late);
+        if (Trace::enabled()) {
+            const qint64 now = Trace::now();
+            Trace::record("event loop stall", now - late, now);
+        }
+    }
+}
+
+void DiagnosticsPanel::refresh() {
+    if (m_refreshes++ % SlowRefresh == 0) {
+        if (!m_memoryTimer.isActive()) startMemoryWalk();
+        if (!m_databaseWatcher.isRunning()) {
+            m_databaseWatcher.setFuture(QtConcurrent::run(&DiagnosticsPanel::queryDatabase,
+                                                          DatabaseManager::instance().databasePath()));
+        }
+    }
+
+    qint64 hits = 0;
+    qint64 misses = 0;
+    if (DatabaseManager::instance().pageCacheStats(&hits, &misses)) {
+        const qint64 total = hits + misses;
+        m_cacheLabel->setText(total == 0 ? QString("no reads yet")
+            : QString("%1% hit rate (%2 hits, %3 misses)").arg(hits * 100.0 / total, 0, 'f', 1).arg(hits).arg(misses));
+    } else {
+        m_cacheLabel->setText("not available in this build");
+    }
+
+    m_pendingLabel->setText(QString("%1 imported items, %2 thumbnails")
+        .arg(PerfCounters::pendingWrites.load()).arg(m_model->screenshotLoader()->pendingThumbnailCount()));
+    m_saveLabel->setText(latency(PerfCounters::saveItem));
+    m_insertLabel->setText(latency(PerfCounters::insertBatch));
+    if (PerfCounters::import.last() < 0) {
+        m_importLabel->setText("-");
+    } else {
+        const double seconds = PerfCounters::import.last() / 1e9;
+        const qint64 items = PerfCounters::lastImportItems.load();
+        m_importLabel->setText(QString("%1 items in %2 s (%3 items/s)")
+            .arg(items).arg(seconds, 0, 'f', 2).arg(seconds > 0 ? qint64(items / seconds) : items));
+    }
+    const PerfCounters::Latency& stalls = PerfCounters::eventLoopStall;
+    m_stallLabel->setText(stalls.last() < 0 ? QString("none over %1 ms").arg(StallThreshold)
+        : QString("%1 over %2 ms; last %3 ms, longest %4 ms")
+              .arg(stalls.count()).arg(StallThreshold)
+              .arg(stalls.last() / 1e6, 0, 'f', 0).arg(stalls.max() / 1e6, 0, 'f', 0));
+}
+
+void DiagnosticsPanel::startMemoryWalk() {
+    m_memoryUsage = OrganizerItem::MemoryUsage();
+    m_memoryItems = 0;
+    m_memoryWalk.clear();
+    m_memoryWalk.append({m_model->rootItem(), 0});
+    m_memoryTimer.start();
+}
+
+void DiagnosticsPanel::continueMemoryWalk() {
+    QElapsedTimer slice;
+    slice.start();
+    int steps = 0;
+    while (!m_memoryWalk.isEmpty()) {
+        if (++steps % 256 == 0 && slice.nsecsElapsed() >= MemoryWalkSlice) return;
+        QPair<const OrganizerItem*, int>& top = m_memoryWalk.last();
+        if (top.second >= top.first->childCount()) {
+            m_memoryWalk.removeLast();
+            continue;
+        }
+        const OrganizerItem* child = top.first->children().at(top.second++);
+        child->addMemoryUsage(m_memoryUsage);
+        ++m_memoryItems;
+        if (child->childCount() > 0) m_memoryWalk.append({child, 0});
+    }
+    m_memoryTimer.stop();
+    m_loadedItems = m_memoryItems;
+
+    const OrganizerItem::MemoryUsage& usage = m_memoryUsage;
+    const qint64 total = usage.bodies + usage.decoded + usage.indexes + usage.screenshots + usage.metadata;
+    m_memoryLabel->setText(QString("%1: bodies %2, decoded %3, indexes %4, screenshots %5, items %6")
+        .arg(size(total), size(usage.bodies), size(usage.decoded), size(usage.indexes),
+             size(usage.screenshots), size(usage.metadata)));
+    updateItems();
+}
+
+void DiagnosticsPanel::updateItems() {
+    if (m_databaseItems < 0) {
+        m_itemsLabel->setText(QString("%1 loaded").arg(m_loadedItems));
+    } else {
+        m_itemsLabel->setText(QString("%1 loaded of %2 in the database").arg(m_loadedItems).arg(m_databaseItems));
+    }
+}
+
+DiagnosticsPanel::DatabaseStats DiagnosticsPanel::queryDatabase(const QString& path) {
+    DatabaseStats stats;
+    const QString connectionName = QString("diagnostics-%1").arg(quintptr(QThread::currentThreadId()));
+    {
+        QSqlDatabase db = DatabaseManager::instance().openConnection(connectionName);
+        QSqlQuery query(db);
+        if (query.exec("SELECT COUNT(*) FROM items") && query.next()) {
+            stats.items = query.value(0).toLongLong();
+        }
+        qint64 pageSize = 0;
+        if (query.exec("PRAGMA page_size") && query.next()) {
+            pageSize = query.value(0).toLongLong();
+        }
+        if (query.exec("PRAGMA page_count") && query.next()) {
+            stats.fileBytes = query.value(0).toLongLong() * pageSize;
+        }
+        if (query.exec("PRAGMA freelist_count") && query.next()) {
+            stats.freeBytes = query.value(0).toLongLong() * pageSize;
+        }
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    QFileInfo wal(path + "-wal");
+    stats.walBytes = wal.exists() ? wal.size() : 0;
+    return stats;
+}
+
+void DiagnosticsPanel::updateDatabase(const DatabaseStats& stats) {
+    if (stats.items < 0) {
+        m_databaseLabel->setText("could not be read");
+        return;
+    }
+    m_databaseItems = stats.items;
+    updateItems();
+    QString text = QString("%1, %2 free").arg(size(stats.fileBytes), size(stats.freeBytes));
+    if (stats.walBytes > 0) {
+        text += QString(", WAL %1").arg(size(stats.walBytes));
+    }
+    m_databaseLabel->setText(text);
+}
@@ -0,0 +1,228 @@
+#include "DiffDialog.h"
+#include "BodyCodec.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QSplitter>
+#include <QScrollBar>
+#include <QDialogButtonBox>
+#include <QFutureWatcher>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtConcurrent/QtConcurrentRun>
+
+struct DiffDialog::Outcome {
+    TextDiff::Result result;
+    QString leftText;
+    QString rightText;
+    QVector<int> leftOffsets;  // Start position of each row in leftText
+    QVector<int> rightOffsets;
+};
+
+namespace {
+    // Lay both sides out row by row, padding with empty lines so rows line up
+    void renderSide(const TextDiff::Result& result, bool left, QString& text, QVector<int>& offsets) {
+        const QStringList& lines = left ? result.leftLines : result.rightLines;
+        qsizetype size = 0;
+        for (const QString& line : lines) {
+            size += line.size() + 1;
+        }
+        text.reserve(size + result.rows.size());
+        offsets.reserve(result.rows.size());
+
+        for (int i = 0; i < result.rows.size(); ++i) {
+            const TextDiff::Row& row = result.rows[i];
+            int line = left ? row.leftLine : row.rightLine;
+            if (i > 0) {
+                text.append(QLatin1Char('\n'));
+            }
+            offsets.append(text.size());
+            if (line >= 0) {
+                text.append(lines[line]);
+            }
+        }
+    }
+
+    void applyFormats(QPlainTextEdit* edit, const TextDiff::Result& result, const QVector<int>& offsets, bool left) {
+        QTextBlockFormat removedBlock, addedBlock, changedBlock, fillerBlock;
+        removedBlock.setBackground(QColor(255, 220, 220));
+        addedBlock.setBackground(QColor(220, 255, 220));
+        changedBlock.setBackground(QColor(255, 245, 200));
+        fillerBlock.setBackground(QColor(235, 235, 235));
+
+        QTextCharFormat wordFormat;
+        wordFormat.setBackground(left ? QColor(255, 170, 170) : QColor(160, 235, 160));
+
+        // Formats go into the document itself; extra selections would be
+        // re-walked on every paint and crawl on large diffs
+        QTextCursor cursor(edit->document());
+        cursor.beginEditBlock();
+        for (int i = 0; i < result.rows.size(); ++i) {
+            const TextDiff::Row& row = result.rows[i];
+            if (row.kind == TextDiff::Row::Equal) continue;
+
+            int line = left ? row.leftLine : row.rightLine;
+            cursor.setPosition(offsets[i]);
+            if (line < 0) {
+                cursor.setBlockFormat(fillerBlock);
+                continue;
+            }
+            if (row.kind == TextDiff::Row::Changed) {
+                cursor.setBlockFormat(changedBlock);
+            } else {
+                cursor.setBlockFormat(left ? removedBlock : addedBlock);
+            }
+
+            for (const TextDiff::Span& span : left ? row.leftSpans : row.rightSpans) {
+                cursor.setPosition(offsets[i] + span.start);
+                cursor.setPosition(offsets[i] + span.start + span.length, QTextCursor::KeepAnchor);
+                cursor.mergeCharFormat(wordFormat);
+            }
+        }
+        cursor.endEditBlock();
+    }
+
+    QPlainTextEdit* createPane(QWidget* parent) {
+        QPlainTextEdit* edit = new QPlainTextEdit(parent);
+        edit->setReadOnly(true);
+        edit->setUndoRedoEnabled(false);
+        edit->setLineWrapMode(QPlainTextEdit::NoWrap);
+        QFont font = edit->font();
+        font.setFamily("Courier New");
+        font.setPointSize(10);
+        edit->setFont(font);
+        return edit;
+    }
+}
+
+DiffDialog::DiffDialog(const Side& left, const Side& right, QWidget* parent)
+    : QDialog(parent)
+    , m_left(left)
+    , m_right(right)
+    , m_cancel(std::make_shared<std::atomic_bool>(false))
+    , m_generation(0)
+{
+    setWindowTitle(QString("Compare: %1 / %2").arg(left.title, right.title));
+    resize(1200, 800);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    m_partCombo = new QComboBox(this);
+    m_partCombo->addItem("Response");
+    m_partCombo->addItem("Request");
+    m_wordCheck = new QCheckBox("Highlight changed words", this);
+    m_wordCheck->setChecked(true);
+    m_statusLabel = new QLabel(this);
+    controls->addWidget(new QLabel("Compare:", this));
+    controls->addWidget(m_partCombo);
+    controls->addWidget(m_wordCheck);
+    controls->addStretch();
+    controls->addWidget(m_statusLabel);
+    layout->addLayout(controls);
+
+    QSplitter* splitter = new QSplitter(Qt::Horizontal, this);
+    QWidget* leftWidget = new QWidget(this);
+    QVBoxLayout* leftLayout = new QVBoxLayout(leftWidget);
+    leftLayout->setContentsMargins(0, 0, 0, 0);
+    leftLayout->addWidget(new QLabel(left.title, this));
+    m_leftEdit = createPane(this);
+    leftLayout->addWidget(m_leftEdit);
+
+    QWidget* rightWidget = new QWidget(this);
+    QVBoxLayout* rightLayout = new QVBoxLayout(rightWidget);
+    rightLayout->setContentsMargins(0, 0, 0, 0);
+    rightLayout->addWidget(new QLabel(right.title, this));
+    m_rightEdit = createPane(this);
+    rightLayout->addWidget(m_rightEdit);
+
+    splitter->addWidget(leftWidget);
+    splitter->addWidget(rightWidget);
+    layout->addWidget(splitter);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    layout->addWidget(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    // Both panes have the same number of rows, so scroll positions map 1:1
+    connect(m_leftEdit->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_rightEdit->verticalScrollBar(), &QScrollBar::setValue);
+    connect(m_rightEdit->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_leftEdit->verticalScrollBar(), &QScrollBar::setValue);
+    connect(m_leftEdit->horizontalScrollBar(), &QScrollBar::valueChanged,
+            m_rightEdit->horizontalScrollBar(), &QScrollBar::setValue);
+    connect(m_rightEdit->horizontalScrollBar(), &QScrollBar::valueChanged,
+            m_leftEdit->horizontalScrollBar(), &QScrollBar::setValue);
+
+    connect(m_partCombo, &QComboBox::currentIndexChanged, this, &DiffDialog::startDiff);
+    connect(m_wordCheck, &QCheckBox::toggled, this, &DiffDialog::startDiff);
+
+    startDiff();
+}
+
+DiffDialog::~DiffDialog() {
+    cancelRunning();
+}
+
+void DiffDialog::cancelRunning() {
+    m_cancel->store(true);
+    m_cancel = std::make_shared<std::atomic_bool>(false);
+}
+
+void DiffDialog::startDiff() {
+    cancelRunning();
+    int generation = ++m_generation;
+
+    bool response = m_partCombo->currentIndex() == 0;
+    QByteArray leftData = response ? m_left.response : m_left.request;
+    QByteArray rightData = response ? m_right.response : m_right.request;
+    TextDiff::Granularity granularity = m_wordCheck->isChecked() ? TextDiff::Granularity::Word
+                                                                 : TextDiff::Granularity::Line;
+    std::shared_ptr<std::atomic_bool> cancel = m_cancel;
+
+    m_statusLabel->setText("Computing differences...");
+    m_partCombo->setEnabled(false);
+    m_wordCheck->setEnabled(false);
+
+    QFutureWatcher<Outcome>* watcher = new QFutureWatcher<Outcome>(this);
+    connect(watcher, &QFutureWatcher<Outcome>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_generation) return;
+
+        Outcome outcome = watcher->result();
+        if (!outcome.result.cancelled) {
+            showResult(outcome);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([leftData, rightData, granularity, cancel]() {
+        Outcome outcome;
+        BodyCodec::Decoded left = BodyCodec::decode(leftData);
+        BodyCodec::Decoded right = BodyCodec::decode(rightData);
+        // Binary bodies are compared as Latin-1 so every byte still shows up somewhere
+        QString leftText = left.binary ? QString::fromLatin1(leftData) : left.text;
+        QString rightText = right.binary ? QString::fromLatin1(rightData) : right.text;
+        outcome.result = TextDiff::compare(leftText, rightText, granularity, cancel.get());
+        if (!outcome.result.cancelled) {
+            renderSide(outcome.result, true, outcome.leftText, outcome.leftOffsets);
+            renderSide(outcome.result, false, outcome.rightText, outcome.rightOffsets);
+        }
+        return outcome;
+    }));
+}
+
+void DiffDialog::showResult(const Outcome& outcome) {
+    const TextDiff::Result& result = outcome.result;
+    m_leftEdit->setPlainText(outcome.leftText);
+    m_rightEdit->setPlainText(outcome.rightText);
+    applyFormats(m_leftEdit, result, outcome.leftOffsets, true);
+    applyFormats(m_rightEdit, result, outcome.rightOffsets, false);
+
+    if (result.changed == 0 && result.added == 0 && result.removed == 0) {
+        m_statusLabel->setText("Identical");
+    } else {
+        m_statusLabel->setText(QString("%1 changed, %2 removed, %3 added lines")
+                                   .arg(result.changed).arg(result.removed).arg(result.added));
+    }
+    m_partCombo->setEnabled(true);
+    m_wordCheck->setEnabled(true);
+}
@@ -0,0 +1,49 @@
+#ifndef DIFFDIALOG_H
+#define DIFFDIALOG_H
+
+#include <QDialog>
+#include <QByteArray>
+#include <QString>
+#include <QPlainTextEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <atomic>
+#include <memory>
+#include "TextDiff.h"
+
+// Side-by-side comparison of two stored items. The diff itself runs on a
+// worker thread; the dialog only lays out the finished result.
+class DiffDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    struct Side {
+        QString title;
+        QByteArray request;
+        QByteArray response;
+    };
+
+    DiffDialog(const Side& left, const Side& right, QWidget* parent = nullptr);
+    ~DiffDialog();
+
+private slots:
+    void startDiff();
+
+private:
+    struct Outcome;
+    void showResult(const Outcome& outcome);
+    void cancelRunning();
+
+    Side m_left;
+    Side m_right;
+    QComboBox* m_partCombo;
+    QCheckBox* m_wordCheck;
+    QLabel* m_statusLabel;
+    QPlainTextEdit* m_leftEdit;
+    QPlainTextEdit* m_rightEdit;
+    std::shared_ptr<std::atomic_bool> m_cancel;
+    int m_generation;
+};
+
+#endif // DIFFDIALOG_H
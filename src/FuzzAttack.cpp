@@ -0,0 +1,186 @@
+#include "FuzzAttack.h"
+#include "HttpMessageIndex.h"
+
+FuzzTemplate FuzzTemplate::parse(const QByteArray& request, QString* error) {
+    FuzzTemplate result;
+    const QByteArrayView marker(Marker);
+    qsizetype from = 0;
+    bool inPosition = false;
+    for (;;) {
+        const qsizetype found = request.indexOf(marker, from);
+        if (found < 0) break;
+        const QByteArray text = request.mid(from, found - from);
+        if (inPosition) {
+            result.m_defaults.append(text);
+        } else {
+            result.m_literals.append(text);
+        }
+        inPosition = !inPosition;
+        from = found + marker.size();
+    }
+    if (inPosition) {
+        if (error) *error = "The last § marker has no closing §.";
+        return FuzzTemplate();
+    }
+    result.m_literals.append(request.mid(from));
+    return result;
+}
+
+QByteArray FuzzTemplate::render(const QList<QByteArray>& values) const {
+    qsizetype size = 0;
+    for (const QByteArray& literal : m_literals) {
+        size += literal.size();
+    }
+    for (const QByteArray& value : values) {
+        size += value.size();
+    }
+    QByteArray request;
+    request.reserve(size);
+    for (int i = 0; i < m_literals.size(); ++i) {
+        request.append(m_literals[i]);
+        if (i < m_defaults.size()) {
+            request.append(i < values.size() ? values[i] : m_defaults[i]);
+        }
+    }
+
+    const HttpMessageIndex index = HttpMessageIndex::parse(request);
+    const int header = index.headerIndex(request, "content-length");
+    if (header >= 0 && index.isHeaderComplete()) {
+        const QByteArray length = QByteArray::number(request.size() - index.bodyOffset());
+        const HttpMessageIndex::Span value = index.headers()[header].value;
+        if (HttpMessageIndex::view(request, value).toByteArray() != length) {
+            request.replace(value.offset, value.length, length);
+        }
+    }
+    return request;
+}
+
+FuzzAttack::FuzzAttack(const FuzzTemplate& request, FuzzMode mode, std::vector<PayloadSet> sets)
+    : m_template(request)
+    , m_mode(mode)
+    , m_sets(std::move(sets))
+    , m_position(0)
+    , m_index(0)
+    , m_started(false)
+    , m_finished(false)
+{
+}
+
+QString FuzzAttack::modeName(FuzzMode mode) {
+    switch (mode) {
+    case FuzzMode::Sniper: return "Sniper";
+    case FuzzMode::BatteringRam: return "Battering ram";
+    case FuzzMode::Pitchfork: return "Pitchfork";
+    case FuzzMode::ClusterBomb: return "Cluster bomb";
+    }
+    return QString();
+}
+
+bool FuzzAttack::validate(QString* error) const {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+    const int positions = m_template.positionCount();
+    if (positions == 0) return fail("Mark at least one payload position with a pair of § signs.");
+    for (const PayloadSet& set : m_sets) {
+        if (!set.isValid()) return fail("A payload set is not valid.");
+    }
+    const bool single = m_mode == FuzzMode::Sniper || m_mode == FuzzMode::BatteringRam;
+    if (single && m_sets.size() != 1) {
+        return fail(QString("%1 takes exactly one payload set.").arg(modeName(m_mode)));
+    }
+    if (!single && int(m_sets.size()) != positions) {
+        return fail(QString("%1 takes one payload set per position: %2 positions, %3 sets.")
+                        .arg(modeName(m_mode)).arg(positions).arg(m_sets.size()));
+    }
+    return true;
+}
+
+qint64 FuzzAttack::total() const {
+    qint64 total = -1;
+    for (const PayloadSet& set : m_sets) {
+        const qint64 count = set.count();
+        if (count < 0) return -1;
+        switch (m_mode) {
+        case FuzzMode::Sniper:
+            total = count * m_template.positionCount();
+            break;
+        case FuzzMode::BatteringRam:
+            total = count;
+            break;
+        case FuzzMode::Pitchfork:
+            total = total < 0 ? count : qMin(total, count);
+            break;
+        case FuzzMode::ClusterBomb:
+            total = total < 0 ? count : total * count;
+            break;
+        }
+    }
+    return qMax<qint64>(total, 0);
+}
+
+bool FuzzAttack::next(FuzzAttempt& attempt) {
+    if (m_finished) return false;
+    if (!advance(attempt)) {
+        m_finished = true;
+        return false;
+    }
+    attempt.index = m_index++;
+    if (m_mode == FuzzMode::Sniper) {
+        QList<QByteArray> values = m_template.defaults();
+        values[attempt.position] = attempt.payloads.first();
+        attempt.request = m_template.render(values);
+    } else if (m_mode == FuzzMode::BatteringRam) {
+        attempt.request = m_template.render(QList<QByteArray>(m_template.positionCount(), attempt.payloads.first()));
+    } else {
+        attempt.request = m_template.render(attempt.payloads);
+    }
+    return true;
+}
+
+bool FuzzAttack::advance(FuzzAttempt& attempt) {
+    attempt.position = -1;
+    attempt.payloads.resize(1);
+    switch (m_mode) {
+    case FuzzMode::Sniper:
+        while (!m_sets[0].next(attempt.payloads[0])) {
+            if (++m_position >= m_template.positionCount()) return false;
+            m_sets[0].reset();
+        }
+        attempt.position = m_position;
+        return true;
+
+    case FuzzMode::BatteringRam:
+        return m_sets[0].next(attempt.payloads[0]);
+
+    case FuzzMode::Pitchfork:
+        attempt.payloads.resize(m_sets.size());
+        for (size_t i = 0; i < m_sets.size(); ++i) {
+            if (!m_sets[i].next(attempt.payloads[i])) return false;
+        }
+        return true;
+
+    case FuzzMode::ClusterBomb:
+        // An odometer: the last set turns fastest, and a set that runs out
+        // starts over while the one before it moves on
+        if (!m_started) {
+            m_started = true;
+            m_current.resize(m_sets.size());
+            for (size_t i = 0; i < m_sets.size(); ++i) {
+                if (!m_sets[i].next(m_current[i])) return false;
+            }
+        } else {
+            int i = int(m_sets.size()) - 1;
+            for (; i >= 0; --i) {
+                if (m_sets[i].next(m_current[i])) break;
+                m_sets[i].reset();
+                m_sets[i].next(m_current[i]);
+            }
+            if (i < 0) return false;
+        }
+        attempt.payloads = m_current;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,76 @@
+#ifndef FUZZATTACK_H
+#define FUZZATTACK_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <vector>
+#include "PayloadSet.h"
+
+// A raw request with payload positions marked the way Burp Intruder does:
+// each position is the text between a pair of § signs, and that text is
+// the position's default value.
+class FuzzTemplate {
+public:
+    static constexpr char Marker[] = "\xc2\xa7"; // § in UTF-8
+
+    FuzzTemplate() = default;
+    static FuzzTemplate parse(const QByteArray& request, QString* error);
+
+    int positionCount() const { return m_defaults.size(); }
+    const QList<QByteArray>& defaults() const { return m_defaults; }
+
+    // The request with values[i] in position i. Content-Length is rewritten
+    // when the payloads changed the size of the body.
+    QByteArray render(const QList<QByteArray>& values) const;
+
+private:
+    QList<QByteArray> m_literals; // One more than positions: the text around them
+    QList<QByteArray> m_defaults;
+};
+
+enum class FuzzMode {
+    Sniper,       // One set; each position in turn gets every payload, the rest keep their defaults
+    BatteringRam, // One set; every position gets the same payload
+    Pitchfork,    // One set per position, walked in step until the shortest runs out
+    ClusterBomb   // One set per position, every combination
+};
+
+// One request of an attack
+struct FuzzAttempt {
+    quint64 index = 0;      // 0-based, in attack order
+    int position = -1;      // Sniper only: the position being fuzzed
+    QList<QByteArray> payloads;
+    QByteArray request;
+};
+
+// Enumerates an attack lazily: each next() pulls from the payload sets and
+// renders one request, so attacks of any size run in constant memory.
+class FuzzAttack {
+public:
+    FuzzAttack(const FuzzTemplate& request, FuzzMode mode, std::vector<PayloadSet> sets);
+
+    // Checks that the number of sets fits the mode and positions
+    bool validate(QString* error) const;
+    // Number of requests, or -1 when a set can't tell its size up front
+    qint64 total() const;
+    bool next(FuzzAttempt& attempt);
+
+    FuzzMode mode() const { return m_mode; }
+
+    static QString modeName(FuzzMode mode);
+
+private:
+    bool advance(FuzzAttempt& attempt);
+
+    FuzzTemplate m_template;
+    FuzzMode m_mode;
+    std::vector<PayloadSet> m_sets;
+    QList<QByteArray> m_current; // Cluster bomb: the value each set is on
+    int m_position;              // Sniper: the position being fuzzed
+    quint64 m_index;
+    bool m_started;
+    bool m_finished;
+};
+
+#endif // FUZZATTACK_H
@@ -0,0 +1,161 @@
+#include "FuzzEngine.h"
+#include "ContentHash.h"
+#include "DatabaseManager.h"
+#include "FuzzResultStore.h"
+#include "HttpMessageIndex.h"
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QTimer>
+
+FuzzEngine::FuzzEngine(FuzzAttack* attack, const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_attack(attack)
+    , m_options(options)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+    qRegisterMetaType<QVector<FuzzResult>>();
+}
+
+FuzzEngine::~FuzzEngine() {
+    cancel();
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void FuzzEngine::start() {
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("fuzzer");
+    m_thread->start();
+}
+
+void FuzzEngine::cancel() {
+    m_cancelled = true;
+}
+
+void FuzzEngine::measure(const QByteArray& response, FuzzResult& result) {
+    const HttpMessageIndex index = HttpMessageIndex::parse(response);
+    result.status = index.status();
+    result.length = response.size();
+    const QByteArrayView body = index.body(response);
+    result.hash = ContentHash::hash(body);
+
+    int words = 0;
+    int lines = body.isEmpty() ? 0 : 1;
+    bool inWord = false;
+    for (const char c : body) {
+        const bool space = c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        if (c == '\n') ++lines;
+        if (!space && !inWord) ++words;
+        inWord = !space;
+    }
+    result.words = words;
+    result.lines = lines;
+}
+
+void FuzzEngine::run() {
+    struct Sent {
+        int position = -1;
+        QByteArray payload;
+    };
+
+    QEventLoop loop;
+    HttpClientPool pool;
+    pool.setMaxConnections(m_options.connections);
+    pool.setMaxConnectionsPerHost(m_options.connections);
+    pool.setTimeout(m_options.timeout);
+    pool.setVerifyPeer(m_options.verifyPeer);
+
+    qint64 total = m_attack->total();
+    const int window = m_options.connections * 2;
+    QHash<quint64, Sent> sent;
+    QVector<FuzzResult> batch;
+    qint64 done = 0;
+    qint64 failed = 0;
+    bool exhausted = false;
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // Saving happens here, off the GUI thread, one chunk per batch
+    const QString connectionName = QString("fuzz-%1").arg(quintptr(QThread::currentThreadId()));
+    QSqlDatabase db;
+    if (m_options.runId >= 0) {
+        db = DatabaseManager::instance().openConnection(connectionName);
+    }
+    qint64 saved = 0;
+
+    auto flush = [&]() {
+        if (!batch.isEmpty()) {
+            if (db.isOpen() && FuzzResultStore::appendChunk(db, m_options.runId, saved, batch)) {
+                saved += batch.size();
+            }
+            emit resultsReady(batch);
+            batch.clear();
+        }
+        if (total < 0) {
+            // Wordlists count their lines in the background
+            total = m_attack->total();
+        }
+        const qint64 ms = elapsed.elapsed();
+        emit progress(done, total, ms > 0 ? done * 1000.0 / ms : 0.0);
+    };
+
+    // Tops the pool up to the window; quits once everything has come back
+    auto fill = [&]() {
+        FuzzAttempt attempt;
+        while (!exhausted && pool.pendingCount() < window) {
+            if (!m_attack->next(attempt)) {
+                exhausted = true;
+                break;
+            }
+            sent.insert(attempt.index, {attempt.position, attempt.payloads.join(", ")});
+            pool.send(attempt.index, m_options.target, attempt.request);
+        }
+        if (exhausted && sent.isEmpty()) loop.quit();
+    };
+
+    connect(&pool, &HttpClientPool::finished, &loop,
+            [&](quint64 id, const QByteArray& response, qint64 time, const QString& error) {
+        const Sent attempt = sent.take(id);
+        FuzzResult result;
+        result.index = id;
+        result.position = attempt.position;
+        result.payload = attempt.payload;
+        result.elapsed = time;
+        result.error = error;
+        if (error.isEmpty()) {
+            measure(response, result);
+        } else {
+            ++failed;
+        }
+        batch.append(result);
+        ++done;
+        if (batch.size() >= BatchSize) flush();
+        fill();
+    });
+
+    QTimer ticker;
+    ticker.setInterval(FlushInterval);
+    connect(&ticker, &QTimer::timeout, &loop, [&]() {
+        if (m_cancelled) {
+            pool.abort();
+            loop.quit();
+            return;
+        }
+        flush();
+    });
+    ticker.start();
+    QTimer::singleShot(0, &loop, fill);
+    loop.exec();
+
+    flush();
+    if (m_options.runId >= 0) {
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+    emit finished(done, failed, m_cancelled);
+}
@@ -0,0 +1,77 @@
+#ifndef FUZZENGINE_H
+#define FUZZENGINE_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "FuzzAttack.h"
+#include "HttpClientPool.h"
+
+// What is kept of one attempt. Responses are measured and dropped on the
+// engine's thread, so a result is a few dozen bytes however large the
+// response was.
+struct FuzzResult {
+    quint64 index = 0;
+    int position = -1;   // Sniper only
+    QByteArray payload;  // The attempt's payloads, comma separated
+    int status = 0;
+    qint64 length = 0;   // Whole response
+    int words = 0;       // Body only
+    int lines = 0;       // Body only
+    qint64 elapsed = 0;  // ns, as reported by HttpClientPool
+    quint64 hash = 0;    // ContentHash of the body
+    QString error;
+};
+
+// Runs a FuzzAttack against one target on its own thread, with its own
+// HttpClientPool and event loop. Requests are rendered only as connections
+// free up, keeping about two per connection queued, so the attack never
+// sits in memory as a whole. Results reach the receiver in batches, and
+// with a run id each batch is saved on the engine's own connection first.
+class FuzzEngine : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        HttpTarget target;
+        int connections = 64;
+        int timeout = 10000; // ms without a byte before a request fails
+        bool verifyPeer = false;
+        int runId = -1;      // Results are also saved to this run (FuzzResultStore::createRun)
+    };
+
+    // Takes ownership of attack, which must have been validated
+    FuzzEngine(FuzzAttack* attack, const Options& options, QObject* parent = nullptr);
+    ~FuzzEngine();
+
+    void start();
+    // Safe to call from any thread
+    void cancel();
+    bool isRunning() const { return m_thread && m_thread->isRunning(); }
+
+    // Fills status, length, words, lines and hash from a raw response
+    static void measure(const QByteArray& response, FuzzResult& result);
+
+    static constexpr int BatchSize = 1000;
+    static constexpr int FlushInterval = 100; // ms
+
+signals:
+    void resultsReady(const QVector<FuzzResult>& results);
+    // total is -1 when the payload sets couldn't tell their size
+    void progress(qint64 done, qint64 total, double requestsPerSecond);
+    void finished(qint64 done, qint64 failed, bool cancelled);
+
+private:
+    void run();
+
+    std::unique_ptr<FuzzAttack> m_attack;
+    Options m_options;
+    QThread* m_thread;
+    std::atomic_bool m_cancelled;
+};
+
+#endif // FUZZENGINE_H
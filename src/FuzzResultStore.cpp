@@ -0,0 +1,347 @@
+#include "FuzzResultStore.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+    quint32 saturate32(qint64 value) {
+        return quint32(qBound<qint64>(0, value, std::numeric_limits<quint32>::max()));
+    }
+
+    qint16 saturate16(qint64 value) {
+        return qint16(qBound<qint64>(std::numeric_limits<qint16>::min(), value, std::numeric_limits<qint16>::max()));
+    }
+
+    // One column of a chunk as raw bytes
+    template <typename T, typename Get>
+    QByteArray columnBlob(const QVector<FuzzResult>& results, Get get) {
+        QByteArray blob(results.size() * qsizetype(sizeof(T)), Qt::Uninitialized);
+        char* out = blob.data();
+        for (const FuzzResult& result : results) {
+            const T value = get(result);
+            memcpy(out, &value, sizeof(T));
+            out += sizeof(T);
+        }
+        return blob;
+    }
+
+    template <typename T>
+    bool appendColumn(QVector<T>& column, const QByteArray& blob, qsizetype count) {
+        if (blob.size() != count * qsizetype(sizeof(T))) return false;
+        const qsizetype at = column.size();
+        column.resize(at + count);
+        memcpy(column.data() + at, blob.constData(), size_t(blob.size()));
+        return true;
+    }
+
+    // Status and word/line counts folded into one key; counts past 2^24 share a bucket
+    quint64 signature(int status, quint32 words, quint32 lines) {
+        const quint64 mask = (1u << 24) - 1;
+        return (quint64(quint16(status)) << 48) | (quint64(qMin<quint64>(words, mask)) << 24) | qMin<quint64>(lines, mask);
+    }
+
+    template <typename T>
+    T median(std::vector<T>& values) {
+        auto middle = values.begin() + values.size() / 2;
+        std::nth_element(values.begin(), middle, values.end());
+        return *middle;
+    }
+}
+
+void FuzzResultStore::append(const QVector<FuzzResult>& results) {
+    const qsizetype reserve = size() + results.size();
+    if (m_payloadIds.capacity() < reserve) {
+        // Geometric growth for every column at once
+        const qsizetype capacity = qMax(reserve, m_payloadIds.capacity() * 2);
+        m_payloadIds.reserve(capacity);
+        m_positions.reserve(capacity);
+        m_statuses.reserve(capacity);
+        m_lengths.reserve(capacity);
+        m_words.reserve(capacity);
+        m_lines.reserve(capacity);
+        m_times.reserve(capacity);
+        m_hashes.reserve(capacity);
+        m_flags.reserve(capacity);
+        m_payloadEnds.reserve(capacity);
+    }
+
+    for (const FuzzResult& result : results) {
+        if (!result.error.isEmpty()) {
+            m_errors.insert(size(), result.error);
+        }
+        m_payloadIds.append(result.index);
+        m_positions.append(saturate16(result.position));
+        m_statuses.append(saturate16(result.status));
+        m_lengths.append(saturate32(result.length));
+        m_words.append(saturate32(result.words));
+        m_lines.append(saturate32(result.lines));
+        m_times.append(saturate32(result.elapsed / 1000));
+        m_hashes.append(result.hash);
+        m_flags.append(0);
+        m_payloadData.append(result.payload);
+        m_payloadEnds.append(m_payloadData.size());
+    }
+}
+
+void FuzzResultStore::clear() {
+    *this = FuzzResultStore();
+}
+
+QByteArrayView FuzzResultStore::payload(qsizetype row) const {
+    const qint64 start = row == 0 ? 0 : m_payloadEnds[row - 1];
+    return QByteArrayView(m_payloadData).sliced(start, m_payloadEnds[row] - start);
+}
+
+qsizetype FuzzResultStore::analyze() {
+    const qsizetype count = size();
+    std::fill(m_flags.begin(), m_flags.end(), quint8(0));
+    if (count < MinAnalyzeRows) {
+        m_summary = QString("A baseline needs at least %1 results.").arg(MinAnalyzeRows);
+        return 0;
+    }
+
+    // Anything shared by no more than 1% of the rows is rare
+    const qsizetype rare = qMax<qsizetype>(1, count / 100);
+    QHash<int, qsizetype> statuses;
+    QHash<quint64, qsizetype> signatures;
+    std::vector<quint32> times;
+    times.reserve(size_t(count));
+    for (qsizetype row = 0; row < count; ++row) {
+        ++statuses[m_statuses[row]];
+        ++signatures[signature(m_statuses[row], m_words[row], m_lines[row])];
+        if (!m_errors.contains(row)) times.push_back(m_times[row]);
+    }
+
+    // Robust spread: the median absolute deviation, which a handful of
+    // very slow responses can't drag up the way a standard deviation would
+    quint32 medianTime = 0;
+    qint64 timeLimit = std::numeric_limits<qint64>::max();
+    if (qint64(times.size()) >= MinAnalyzeRows) {
+        medianTime = median(times);
+        for (quint32& time : times) {
+            time = time > medianTime ? time - medianTime : medianTime - time;
+        }
+        const quint32 deviation = median(times);
+        timeLimit = qint64(medianTime) + qMax<qint64>(6 * qint64(deviation), medianTime);
+    }
+
+    qsizetype flagged = 0;
+    for (qsizetype row = 0; row < count; ++row) {
+        quint8 flags = 0;
+        if (statuses.value(m_statuses[row]) <= rare) {
+            flags |= StatusOutlier;
+        } else if (signatures.value(signature(m_statuses[row], m_words[row], m_lines[row])) <= rare) {
+            flags |= LengthOutlier;
+        }
+        if (m_times[row] > timeLimit && !m_errors.contains(row)) {
+            flags |= TimeOutlier;
+        }
+        m_flags[row] = flags;
+        if (flags) ++flagged;
+    }
+
+    auto baseline = signatures.constBegin();
+    for (auto it = signatures.constBegin(); it != signatures.constEnd(); ++it) {
+        if (it.value() > baseline.value()) baseline = it;
+    }
+    const quint64 mask = (1u << 24) - 1;
+    m_summary = QString("Baseline: status %1, %2 words, %3 lines (%4% of %5); median time %6 ms. %7 outliers.")
+        .arg(int(qint16(baseline.key() >> 48)))
+        .arg((baseline.key() >> 24) & mask)
+        .arg(baseline.key() & mask)
+        .arg(baseline.value() * 100.0 / count, 0, 'f', 1)
+        .arg(count)
+        .arg(medianTime / 1000.0, 0, 'f', 1)
+        .arg(flagged);
+    return flagged;
+}
+
+void FuzzResultStore::sort(QVector<int>& rows, Key key, Qt::SortOrder order) const {
+    const bool ascending = order == Qt::AscendingOrder;
+    if (key == Key::Payload) {
+        std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) {
+            const int compare = payload(a).compare(payload(b));
+            return ascending ? compare < 0 : compare > 0;
+        });
+        return;
+    }
+    if (key == Key::Error) {
+        std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) {
+            const int compare = error(a).compare(error(b));
+            return ascending ? compare < 0 : compare > 0;
+        });
+        return;
+    }
+
+    // Numeric keys are copied out next to the row, so the sort itself runs
+    // over one contiguous array
+    std::vector<std::pair<quint64, int>> keyed;
+    keyed.reserve(size_t(rows.size()));
+    for (int row : rows) {
+        quint64 value = 0;
+        switch (key) {
+        case Key::PayloadId: value = m_payloadIds[row]; break;
+        case Key::Position: value = quint64(m_positions[row] + 1); break;
+        case Key::Status: value = quint64(m_statuses[row] + 1); break;
+        case Key::Length: value = m_lengths[row]; break;
+        case Key::Words: value = m_words[row]; break;
+        case Key::Lines: value = m_lines[row]; break;
+        case Key::Time: value = m_times[row]; break;
+        case Key::Hash: value = m_hashes[row]; break;
+        case Key::Flags: value = m_flags[row]; break;
+        case Key::Payload:
+        case Key::Error: break;
+        }
+        keyed.emplace_back(value, row);
+    }
+    if (ascending) {
+        std::sort(keyed.begin(), keyed.end());
+    } else {
+        std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+    }
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        rows[qsizetype(i)] = keyed[i].second;
+    }
+}
+
+int FuzzResultStore::createRun(QSqlDatabase& db, int itemId, const QString& mode, const QString& target,
+                               const QByteArray& request) {
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO fuzz_runs (item_id, created, mode, target, request) "
+                  "VALUES (:item_id, :created, :mode, :target, :request)");
+    query.bindValue(":item_id", itemId);
+    query.bindValue(":created", QDateTime::currentSecsSinceEpoch());
+    query.bindValue(":mode", mode);
+    query.bindValue(":target", target);
+    query.bindValue(":request", request);
+    if (!query.exec()) {
+        qDebug() << "Error creating fuzz run:" << query.lastError().text();
+        return -1;
+    }
+    return query.lastInsertId().toInt();
+}
+
+bool FuzzResultStore::appendChunk(QSqlDatabase& db, int runId, qint64 firstRow, const QVector<FuzzResult>& results) {
+    if (results.isEmpty()) return true;
+
+    QByteArray payloads;
+    QByteArray errors;
+    QDataStream errorStream(&errors, QIODevice::WriteOnly);
+    quint32 end = 0;
+    for (int i = 0; i < results.size(); ++i) {
+        payloads.append(results[i].payload);
+        if (!results[i].error.isEmpty()) {
+            errorStream << qint32(i) << results[i].error;
+        }
+    }
+    const QByteArray payloadEnds = columnBlob<quint32>(results, [&end](const FuzzResult& result) {
+        end += quint32(result.payload.size());
+        return end;
+    });
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO fuzz_chunks (run_id, first_row, row_count, payload_ids, positions, statuses, lengths, "
+                  "words, lines, times, hashes, payloads, payload_ends, errors) "
+                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(runId);
+    query.addBindValue(firstRow);
+    query.addBindValue(int(results.size()));
+    query.addBindValue(columnBlob<quint64>(results, [](const FuzzResult& r) { return r.index; }));
+    query.addBindValue(columnBlob<qint16>(results, [](const FuzzResult& r) { return saturate16(r.position); }));
+    query.addBindValue(columnBlob<qint16>(results, [](const FuzzResult& r) { return saturate16(r.status); }));
+    query.addBindValue(columnBlob<quint32>(results, [](const FuzzResult& r) { return saturate32(r.length); }));
+    query.addBindValue(columnBlob<quint32>(results, [](const FuzzResult& r) { return saturate32(r.words); }));
+    query.addBindValue(columnBlob<quint32>(results, [](const FuzzResult& r) { return saturate32(r.lines); }));
+    query.addBindValue(columnBlob<quint32>(results, [](const FuzzResult& r) { return saturate32(r.elapsed / 1000); }));
+    query.addBindValue(columnBlob<quint64>(results, [](const FuzzResult& r) { return r.hash; }));
+    query.addBindValue(payloads);
+    query.addBindValue(payloadEnds);
+    query.addBindValue(errors);
+    if (!query.exec()) {
+        qDebug() << "Error saving fuzz results:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QList<FuzzResultStore::Run> FuzzResultStore::runs(QSqlDatabase& db, int itemId) {
+    QList<Run> runs;
+    QSqlQuery query(db);
+    query.prepare("SELECT r.id, r.created, r.mode, r.target, COALESCE(SUM(c.row_count), 0) FROM fuzz_runs r "
+                  "LEFT JOIN fuzz_chunks c ON c.run_id = r.id WHERE r.item_id = :item_id "
+                  "GROUP BY r.id ORDER BY r.id DESC");
+    query.bindValue(":item_id", itemId);
+    if (!query.exec()) {
+        qDebug() << "Error listing fuzz runs:" << query.lastError().text();
+        return runs;
+    }
+    while (query.next()) {
+        Run run;
+        run.id = query.value(0).toInt();
+        run.created = QDateTime::fromSecsSinceEpoch(query.value(1).toLongLong());
+        run.mode = query.value(2).toString();
+        run.target = query.value(3).toString();
+        run.rows = query.value(4).toLongLong();
+        runs.append(run);
+    }
+    return runs;
+}
+
+bool FuzzResultStore::load(QSqlDatabase& db, int runId, QString* error) {
+    clear();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT row_count, payload_ids, positions, statuses, lengths, words, lines, times, hashes, "
+                  "payloads, payload_ends, errors FROM fuzz_chunks WHERE run_id = :run_id ORDER BY first_row");
+    query.bindValue(":run_id", runId);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        const qsizetype count = query.value(0).toLongLong();
+        const qsizetype firstRow = size();
+        const qint64 payloadBase = m_payloadData.size();
+        QVector<quint32> ends;
+        bool valid = appendColumn(m_payloadIds, query.value(1).toByteArray(), count)
+            && appendColumn(m_positions, query.value(2).toByteArray(), count)
+            && appendColumn(m_statuses, query.value(3).toByteArray(), count)
+            && appendColumn(m_lengths, query.value(4).toByteArray(), count)
+            && appendColumn(m_words, query.value(5).toByteArray(), count)
+            && appendColumn(m_lines, query.value(6).toByteArray(), count)
+            && appendColumn(m_times, query.value(7).toByteArray(), count)
+            && appendColumn(m_hashes, query.value(8).toByteArray(), count)
+            && appendColumn(ends, query.value(10).toByteArray(), count);
+        const QByteArray payloads = query.value(9).toByteArray();
+        valid = valid && (count == 0 || ends.last() == quint32(payloads.size()));
+        if (!valid) {
+            clear();
+            if (error) *error = QString("Fuzz run %1 has a damaged chunk at row %2.").arg(runId).arg(firstRow);
+            return false;
+        }
+
+        m_payloadData.append(payloads);
+        for (quint32 end : ends) {
+            m_payloadEnds.append(payloadBase + end);
+        }
+        m_flags.resize(size());
+
+        QDataStream errors(query.value(11).toByteArray());
+        while (!errors.atEnd()) {
+            qint32 row = 0;
+            QString message;
+            errors >> row >> message;
+            if (errors.status() != QDataStream::Ok) break;
+            m_errors.insert(firstRow + row, message);
+        }
+    }
+    return true;
+}
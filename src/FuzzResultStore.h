@@ -0,0 +1,92 @@
+#ifndef FUZZRESULTSTORE_H
+#define FUZZRESULTSTORE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include "FuzzEngine.h"
+
+// Results of one fuzz run, one vector per column. A row costs about 45
+// bytes plus its payload text, so tens of millions of rows fit in memory,
+// and sorting or scanning a column walks one contiguous array. Payload
+// texts share one buffer; errors are rare and kept apart.
+//
+// In the database a run is a fuzz_runs row plus fuzz_chunks rows, each
+// chunk holding a batch of results as one blob per column (native byte
+// order), so appending a batch is a single insert.
+class FuzzResultStore {
+public:
+    enum Flag : quint8 {
+        StatusOutlier = 1, // A status few other rows have
+        LengthOutlier = 2, // A rare size for its status, by word and line count
+        TimeOutlier = 4    // Far slower than the median response
+    };
+
+    enum class Key { PayloadId, Position, Payload, Status, Length, Words, Lines, Time, Hash, Flags, Error };
+
+    struct Run {
+        int id = -1;
+        QDateTime created;
+        QString mode;
+        QString target;
+        qint64 rows = 0;
+    };
+
+    qsizetype size() const { return m_payloadIds.size(); }
+    void append(const QVector<FuzzResult>& results);
+    void clear();
+
+    quint64 payloadId(qsizetype row) const { return m_payloadIds[row]; }
+    int position(qsizetype row) const { return m_positions[row]; }
+    QByteArrayView payload(qsizetype row) const;
+    int status(qsizetype row) const { return m_statuses[row]; }
+    qint64 length(qsizetype row) const { return m_lengths[row]; }
+    int words(qsizetype row) const { return int(m_words[row]); }
+    int lines(qsizetype row) const { return int(m_lines[row]); }
+    qint64 time(qsizetype row) const { return m_times[row]; } // Microseconds
+    quint64 hash(qsizetype row) const { return m_hashes[row]; }
+    quint8 flags(qsizetype row) const { return m_flags[row]; }
+    QString error(qsizetype row) const { return m_errors.value(row); }
+
+    // Takes the most common status and word/line signature as the baseline
+    // and flags rows that stray from it, plus rows much slower than the
+    // median. Returns the number of flagged rows; summary() describes the baseline.
+    qsizetype analyze();
+    QString summary() const { return m_summary; }
+
+    // rows ordered by key; ties keep arrival order
+    void sort(QVector<int>& rows, Key key, Qt::SortOrder order) const;
+
+    // Starts a run for itemId and returns its id, or -1
+    static int createRun(QSqlDatabase& db, int itemId, const QString& mode, const QString& target,
+                         const QByteArray& request);
+    // Saves results as one chunk of the run; firstRow is the first result's row number
+    static bool appendChunk(QSqlDatabase& db, int runId, qint64 firstRow, const QVector<FuzzResult>& results);
+    static QList<Run> runs(QSqlDatabase& db, int itemId);
+    // Replaces the contents with a saved run
+    bool load(QSqlDatabase& db, int runId, QString* error);
+
+    static constexpr qint64 MinAnalyzeRows = 20;
+
+private:
+    QVector<quint64> m_payloadIds;
+    QVector<qint16> m_positions;
+    QVector<qint16> m_statuses;
+    QVector<quint32> m_lengths;
+    QVector<quint32> m_words;
+    QVector<quint32> m_lines;
+    QVector<quint32> m_times;
+    QVector<quint64> m_hashes;
+    QVector<quint8> m_flags;
+    QVector<qint64> m_payloadEnds; // End offset of each row's payload in m_payloadData
+    QByteArray m_payloadData;
+    QHash<qsizetype, QString> m_errors;
+    QString m_summary;
+};
+
+#endif // FUZZRESULTSTORE_H
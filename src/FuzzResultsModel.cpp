@@ -0,0 +1,162 @@
+#include "FuzzResultsModel.h"
+#include <QColor>
+
+namespace {
+    FuzzResultStore::Key keyFor(int column) {
+        switch (column) {
+        case FuzzResultsModel::Position: return FuzzResultStore::Key::Position;
+        case FuzzResultsModel::Payload: return FuzzResultStore::Key::Payload;
+        case FuzzResultsModel::Status: return FuzzResultStore::Key::Status;
+        case FuzzResultsModel::Length: return FuzzResultStore::Key::Length;
+        case FuzzResultsModel::Words: return FuzzResultStore::Key::Words;
+        case FuzzResultsModel::Lines: return FuzzResultStore::Key::Lines;
+        case FuzzResultsModel::Time: return FuzzResultStore::Key::Time;
+        case FuzzResultsModel::Flags: return FuzzResultStore::Key::Flags;
+        case FuzzResultsModel::Error: return FuzzResultStore::Key::Error;
+        }
+        return FuzzResultStore::Key::PayloadId;
+    }
+
+    QString flagText(quint8 flags) {
+        QStringList parts;
+        if (flags & FuzzResultStore::StatusOutlier) parts << "status";
+        if (flags & FuzzResultStore::LengthOutlier) parts << "length";
+        if (flags & FuzzResultStore::TimeOutlier) parts << "time";
+        return parts.join(", ");
+    }
+}
+
+FuzzResultsModel::FuzzResultsModel(QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_ordered(false)
+    , m_outliersOnly(false)
+    , m_sortColumn(-1)
+    , m_sortOrder(Qt::AscendingOrder)
+{
+}
+
+int FuzzResultsModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return int(m_ordered ? m_order.size() : m_store.size());
+}
+
+int FuzzResultsModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant FuzzResultsModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+    const int row = storeRow(index.row());
+    const bool failed = !m_store.error(row).isEmpty();
+
+    if (role == Qt::BackgroundRole) {
+        return m_store.flags(row) ? QVariant(QColor(255, 235, 200)) : QVariant();
+    }
+    if (role == Qt::TextAlignmentRole) {
+        if (index.column() == Payload || index.column() == Flags || index.column() == Error) return QVariant();
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) return QVariant();
+
+    switch (index.column()) {
+    case Index: return m_store.payloadId(row);
+    case Position: return m_store.position(row) < 0 ? QVariant() : QVariant(m_store.position(row) + 1);
+    case Payload: return QString::fromUtf8(m_store.payload(row));
+    case Status: return m_store.status(row) == 0 ? QVariant() : QVariant(m_store.status(row));
+    case Length: return failed ? QVariant() : QVariant(m_store.length(row));
+    case Words: return failed ? QVariant() : QVariant(m_store.words(row));
+    case Lines: return failed ? QVariant() : QVariant(m_store.lines(row));
+    case Time: return QString::number(m_store.time(row) / 1000.0, 'f', 1);
+    case Flags: return flagText(m_store.flags(row));
+    case Error: return m_store.error(row);
+    }
+    return QVariant();
+}
+
+QVariant FuzzResultsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+    switch (section) {
+    case Index: return "#";
+    case Position: return "Position";
+    case Payload: return "Payload";
+    case Status: return "Status";
+    case Length: return "Length";
+    case Words: return "Words";
+    case Lines: return "Lines";
+    case Time: return "Time (ms)";
+    case Flags: return "Outlier";
+    case Error: return "Error";
+    }
+    return QVariant();
+}
+
+void FuzzResultsModel::sort(int column, Qt::SortOrder order) {
+    m_sortColumn = column;
+    m_sortOrder = order;
+    beginResetModel();
+    rebuildOrder();
+    endResetModel();
+}
+
+void FuzzResultsModel::rebuildOrder() {
+    m_ordered = m_outliersOnly || m_sortColumn >= 0;
+    m_order.clear();
+    if (!m_ordered) return;
+    m_order.reserve(m_store.size());
+    for (int row = 0; row < m_store.size(); ++row) {
+        if (!m_outliersOnly || m_store.flags(row)) m_order.append(row);
+    }
+    if (m_sortColumn >= 0) {
+        m_store.sort(m_order, keyFor(m_sortColumn), m_sortOrder);
+    }
+}
+
+void FuzzResultsModel::append(const QVector<FuzzResult>& results) {
+    if (results.isEmpty()) return;
+    const int first = int(m_store.size());
+    if (m_outliersOnly) {
+        // New rows haven't been analyzed, so none of them is shown yet
+        m_store.append(results);
+        return;
+    }
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + int(results.size()) - 1);
+    m_store.append(results);
+    if (m_ordered) {
+        for (int row = first; row < m_store.size(); ++row) {
+            m_order.append(row);
+        }
+    }
+    endInsertRows();
+}
+
+void FuzzResultsModel::clear() {
+    beginResetModel();
+    m_store.clear();
+    rebuildOrder();
+    endResetModel();
+}
+
+bool FuzzResultsModel::loadRun(QSqlDatabase& db, int runId, QString* error) {
+    beginResetModel();
+    const bool loaded = m_store.load(db, runId, error);
+    if (loaded) m_store.analyze();
+    rebuildOrder();
+    endResetModel();
+    return loaded;
+}
+
+qsizetype FuzzResultsModel::analyze() {
+    beginResetModel();
+    const qsizetype outliers = m_store.analyze();
+    rebuildOrder();
+    endResetModel();
+    return outliers;
+}
+
+void FuzzResultsModel::setOutliersOnly(bool outliersOnly) {
+    if (m_outliersOnly == outliersOnly) return;
+    beginResetModel();
+    m_outliersOnly = outliersOnly;
+    rebuildOrder();
+    endResetModel();
+}
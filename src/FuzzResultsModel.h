@@ -0,0 +1,50 @@
+#ifndef FUZZRESULTSMODEL_H
+#define FUZZRESULTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include "FuzzResultStore.h"
+
+// Table over a FuzzResultStore. The view only asks for visible rows, and
+// sorting or filtering reorders a vector of row numbers rather than the
+// results, so both stay fast at millions of rows. Rows arriving while the
+// table is sorted are added at the bottom until the next sort.
+class FuzzResultsModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { Index, Position, Payload, Status, Length, Words, Lines, Time, Flags, Error, ColumnCount };
+
+    explicit FuzzResultsModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    // column -1 restores arrival order
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    void append(const QVector<FuzzResult>& results);
+    void clear();
+    bool loadRun(QSqlDatabase& db, int runId, QString* error);
+    // Reruns the baseline clustering; returns the number of outliers
+    qsizetype analyze();
+    // Only rows flagged by the last analyze()
+    void setOutliersOnly(bool outliersOnly);
+
+    const FuzzResultStore& store() const { return m_store; }
+    // Row in the store for a row of the table
+    int storeRow(int row) const { return m_ordered ? m_order[row] : row; }
+
+private:
+    void rebuildOrder();
+
+    FuzzResultStore m_store;
+    QVector<int> m_order; // Store rows in display order, when m_ordered
+    bool m_ordered;
+    bool m_outliersOnly;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+};
+
+#endif // FUZZRESULTSMODEL_H
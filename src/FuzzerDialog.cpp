@@ -0,0 +1,304 @@
+#include "FuzzerDialog.h"
+#include "DatabaseManager.h"
+#include "ReplayEngine.h"
+#include <QFontDatabase>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLocale>
+#include <QMessageBox>
+#include <QSplitter>
+#include <QStringEncoder>
+#include <QVBoxLayout>
+
+namespace {
+    // Encodes text in encoding, leaving the § markers as the UTF-8 bytes FuzzTemplate looks for
+    QByteArray encodeAroundMarkers(const QString& text, const QByteArray& encoding) {
+        QStringEncoder encoder(encoding.constData(), QStringEncoder::Flag::Stateless);
+        if (!encoder.isValid()) {
+            encoder = QStringEncoder(QStringConverter::Utf8, QStringEncoder::Flag::Stateless);
+        }
+        const QStringList parts = text.split(QString::fromUtf8(FuzzTemplate::Marker));
+        QByteArray out;
+        for (int i = 0; i < parts.size(); ++i) {
+            if (i > 0) out.append(FuzzTemplate::Marker);
+            out.append(encoder.encode(parts[i]));
+        }
+        return out;
+    }
+}
+
+FuzzerDialog::FuzzerDialog(const OrganizerItem* item, QWidget* parent)
+    : QDialog(parent)
+    , m_engine(nullptr)
+    , m_itemId(item->dbId())
+{
+    setWindowTitle("Fuzz " + item->name());
+    resize(1000, 750);
+
+    m_templateEdit = new QPlainTextEdit(this);
+    m_templateEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_templateEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_templateBody = BodyCodec::decode(item->request());
+    if (m_templateBody.binary) {
+        // Latin-1 maps every byte to one character, so the body goes out as it was
+        m_templateBody.text = QString::fromLatin1(item->request());
+        m_templateBody.encoding = "ISO-8859-1";
+    }
+    m_templateEdit->setPlainText(m_templateBody.text);
+
+    QPushButton* addButton = new QPushButton("Add §", this);
+    QPushButton* clearButton = new QPushButton("Clear §", this);
+    connect(addButton, &QPushButton::clicked, this, &FuzzerDialog::addMarkers);
+    connect(clearButton, &QPushButton::clicked, this, &FuzzerDialog::clearMarkers);
+
+    m_payloadsEdit = new QPlainTextEdit(this);
+    m_payloadsEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_payloadsEdit->setPlaceholderText("One payload set per line, in position order:\n"
+                                       "file:/path/to/wordlist.txt\n"
+                                       "range:1-1000 | prefix:id= | url\n"
+                                       "list:admin,guest,root | md5\n"
+                                       "Transforms: url, base64, hex, prefix:, suffix:, upper, lower, md5, sha1, sha256");
+    m_payloadsEdit->setMaximumHeight(100);
+
+    m_modeCombo = new QComboBox(this);
+    for (FuzzMode mode : {FuzzMode::Sniper, FuzzMode::BatteringRam, FuzzMode::Pitchfork, FuzzMode::ClusterBomb}) {
+        m_modeCombo->addItem(FuzzAttack::modeName(mode), int(mode));
+    }
+
+    const HttpTarget target = ReplayEngine::targetFor(item, true);
+    m_schemeCombo = new QComboBox(this);
+    m_schemeCombo->addItems({"https", "http"});
+    m_schemeCombo->setCurrentIndex(target.tls ? 0 : 1);
+    m_hostEdit = new QLineEdit(QString("%1:%2").arg(target.host).arg(target.port), this);
+
+    m_connectionsSpin = new QSpinBox(this);
+    m_connectionsSpin->setRange(1, 1024);
+    m_connectionsSpin->setValue(FuzzEngine::Options().connections);
+    m_verifyCheck = new QCheckBox("Verify TLS certificates", this);
+
+    QHBoxLayout* targetLayout = new QHBoxLayout();
+    targetLayout->addWidget(m_schemeCombo);
+    targetLayout->addWidget(m_hostEdit, 1);
+    targetLayout->addWidget(new QLabel("Connections:", this));
+    targetLayout->addWidget(m_connectionsSpin);
+    targetLayout->addWidget(m_verifyCheck);
+
+    QFormLayout* form = new QFormLayout();
+    form->addRow("Target:", targetLayout);
+    form->addRow("Attack:", m_modeCombo);
+    form->addRow("Payload sets:", m_payloadsEdit);
+
+    m_startButton = new QPushButton("Start Attack", this);
+    m_stopButton = new QPushButton("Stop", this);
+    m_statusLabel = new QLabel(this);
+    connect(m_startButton, &QPushButton::clicked, this, &FuzzerDialog::start);
+    connect(m_stopButton, &QPushButton::clicked, this, &FuzzerDialog::stop);
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    buttons->addWidget(addButton);
+    buttons->addWidget(clearButton);
+    buttons->addStretch();
+    buttons->addWidget(m_statusLabel);
+    buttons->addWidget(m_startButton);
+    buttons->addWidget(m_stopButton);
+
+    QWidget* top = new QWidget(this);
+    QVBoxLayout* topLayout = new QVBoxLayout(top);
+    topLayout->setContentsMargins(0, 0, 0, 0);
+    topLayout->addWidget(m_templateEdit);
+    topLayout->addLayout(form);
+    topLayout->addLayout(buttons);
+
+    m_results = new FuzzResultsModel(this);
+    m_resultsView = new QTableView(this);
+    m_resultsView->setModel(m_results);
+    // No indicator means arrival order; sorting is done by the model
+    m_resultsView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    m_resultsView->setSortingEnabled(true);
+    m_resultsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_resultsView->verticalHeader()->hide();
+    // Fixed row heights and no contents-based sizing keep layout cost flat
+    // as rows stream in
+    m_resultsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_resultsView->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 4);
+    m_resultsView->horizontalHeader()->setSectionResizeMode(FuzzResultsModel::Payload, QHeaderView::Stretch);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_outliersCheck = new QCheckBox("Outliers only", this);
+    m_analyzeButton = new QPushButton("Analyze", this);
+    m_runsCombo = new QComboBox(this);
+    m_loadButton = new QPushButton("Load Run", this);
+    connect(m_outliersCheck, &QCheckBox::toggled, m_results, &FuzzResultsModel::setOutliersOnly);
+    connect(m_analyzeButton, &QPushButton::clicked, this, &FuzzerDialog::analyze);
+    connect(m_loadButton, &QPushButton::clicked, this, &FuzzerDialog::loadRun);
+
+    QHBoxLayout* resultsBar = new QHBoxLayout();
+    resultsBar->addWidget(m_summaryLabel, 1);
+    resultsBar->addWidget(m_outliersCheck);
+    resultsBar->addWidget(m_analyzeButton);
+    resultsBar->addWidget(m_runsCombo);
+    resultsBar->addWidget(m_loadButton);
+
+    QWidget* bottom = new QWidget(this);
+    QVBoxLayout* bottomLayout = new QVBoxLayout(bottom);
+    bottomLayout->setContentsMargins(0, 0, 0, 0);
+    bottomLayout->addLayout(resultsBar);
+    bottomLayout->addWidget(m_resultsView);
+
+    QSplitter* splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(top);
+    splitter->addWidget(bottom);
+    splitter->setStretchFactor(1, 1);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(splitter);
+    refreshRuns();
+    setRunning(false);
+}
+
+FuzzerDialog::~FuzzerDialog() {
+    delete m_engine;
+}
+
+void FuzzerDialog::addMarkers() {
+    QTextCursor cursor = m_templateEdit->textCursor();
+    const QString marker = QString::fromUtf8(FuzzTemplate::Marker);
+    cursor.insertText(marker + cursor.selectedText() + marker);
+}
+
+void FuzzerDialog::clearMarkers() {
+    QString text = m_templateEdit->toPlainText();
+    text.remove(QString::fromUtf8(FuzzTemplate::Marker));
+    m_templateEdit->setPlainText(text);
+}
+
+void FuzzerDialog::start() {
+    QString error;
+    // The editor shows LF line ends; the header block goes out with CRLF, the
+    // body with the line breaks and charset it was stored with
+    const QString text = m_templateEdit->toPlainText();
+    const qsizetype split = BodyCodec::headerEnd(text);
+    QString head = split < 0 ? text : text.first(split);
+    QString body = split < 0 ? QString() : text.sliced(split);
+    head.replace("\r\n", "\n");
+    head.replace("\n", "\r\n");
+    if (m_templateBody.bodyCrlf && !body.contains('\r')) {
+        body.replace("\n", "\r\n");
+    }
+    const QByteArray request = encodeAroundMarkers(head, "ISO-8859-1") + encodeAroundMarkers(body, m_templateBody.encoding);
+    const FuzzTemplate parsed = FuzzTemplate::parse(request, &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "Fuzzer", error);
+        return;
+    }
+
+    std::vector<PayloadSet> sets;
+    for (const QString& line : m_payloadsEdit->toPlainText().split('\n', Qt::SkipEmptyParts)) {
+        if (line.trimmed().isEmpty()) continue;
+        PayloadSet set = PayloadSet::parse(line, &error);
+        if (!set.isValid()) {
+            QMessageBox::warning(this, "Fuzzer", error);
+            return;
+        }
+        sets.push_back(std::move(set));
+    }
+
+    auto attack = std::make_unique<FuzzAttack>(parsed, FuzzMode(m_modeCombo->currentData().toInt()), std::move(sets));
+    if (!attack->validate(&error)) {
+        QMessageBox::warning(this, "Fuzzer", error);
+        return;
+    }
+
+    FuzzEngine::Options options;
+    const QString authority = m_hostEdit->text().trimmed();
+    const int colon = authority.lastIndexOf(':');
+    options.target.tls = m_schemeCombo->currentIndex() == 0;
+    options.target.host = colon > 0 ? authority.left(colon) : authority;
+    options.target.port = colon > 0 ? quint16(authority.mid(colon + 1).toUInt()) : (options.target.tls ? 443 : 80);
+    if (options.target.host.isEmpty() || options.target.port == 0) {
+        QMessageBox::warning(this, "Fuzzer", "Enter the target as host:port.");
+        return;
+    }
+    options.connections = m_connectionsSpin->value();
+    options.verifyPeer = m_verifyCheck->isChecked();
+
+    if (m_itemId >= 0) {
+        options.runId = FuzzResultStore::createRun(DatabaseManager::instance().database(), m_itemId,
+                                                   m_modeCombo->currentText(), authority, request);
+    }
+
+    delete m_engine;
+    m_results->clear();
+    m_summaryLabel->clear();
+    m_engine = new FuzzEngine(attack.release(), options);
+    connect(m_engine, &FuzzEngine::resultsReady, m_results, &FuzzResultsModel::append);
+    connect(m_engine, &FuzzEngine::progress, this, &FuzzerDialog::onProgress);
+    connect(m_engine, &FuzzEngine::finished, this, &FuzzerDialog::onFinished);
+    setRunning(true);
+    m_statusLabel->setText("Starting...");
+    m_engine->start();
+}
+
+void FuzzerDialog::stop() {
+    if (m_engine) {
+        m_engine->cancel();
+    }
+}
+
+void FuzzerDialog::onProgress(qint64 done, qint64 total, double requestsPerSecond) {
+    const QString of = total < 0 ? QString() : QString(" of %1").arg(total);
+    m_statusLabel->setText(QString("%1%2 requests, %3/s").arg(done).arg(of).arg(qint64(requestsPerSecond)));
+}
+
+void FuzzerDialog::onFinished(qint64 done, qint64 failed, bool cancelled) {
+    setRunning(false);
+    QString text = QString("%1 %2 requests").arg(cancelled ? "Stopped after" : "Finished").arg(done);
+    if (failed > 0) {
+        text += QString(", %1 failed").arg(failed);
+    }
+    m_statusLabel->setText(text);
+    analyze();
+    refreshRuns();
+}
+
+void FuzzerDialog::analyze() {
+    m_results->analyze();
+    m_summaryLabel->setText(m_results->store().summary());
+}
+
+void FuzzerDialog::refreshRuns() {
+    m_runsCombo->clear();
+    if (m_itemId >= 0) {
+        const QList<FuzzResultStore::Run> runs = FuzzResultStore::runs(DatabaseManager::instance().database(), m_itemId);
+        for (const FuzzResultStore::Run& run : runs) {
+            m_runsCombo->addItem(QString("%1, %2 on %3, %4 results")
+                                     .arg(QLocale().toString(run.created, QLocale::ShortFormat), run.mode, run.target)
+                                     .arg(run.rows),
+                                 run.id);
+        }
+    }
+    m_runsCombo->setEnabled(m_runsCombo->count() > 0);
+    m_loadButton->setEnabled(m_runsCombo->count() > 0 && m_startButton->isEnabled());
+}
+
+void FuzzerDialog::loadRun() {
+    if (m_runsCombo->currentIndex() < 0) return;
+    QString error;
+    if (!m_results->loadRun(DatabaseManager::instance().database(), m_runsCombo->currentData().toInt(), &error)) {
+        QMessageBox::warning(this, "Fuzzer", error);
+        return;
+    }
+    m_statusLabel->setText(QString("Loaded %1 results").arg(m_results->store().size()));
+    m_summaryLabel->setText(m_results->store().summary());
+}
+
+void FuzzerDialog::setRunning(bool running) {
+    m_startButton->setEnabled(!running);
+    m_stopButton->setEnabled(running);
+    m_templateEdit->setReadOnly(running);
+    m_payloadsEdit->setReadOnly(running);
+    m_analyzeButton->setEnabled(!running);
+    m_loadButton->setEnabled(!running && m_runsCombo->count() > 0);
+}
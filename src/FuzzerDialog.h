@@ -0,0 +1,65 @@
+#ifndef FUZZERDIALOG_H
+#define FUZZERDIALOG_H
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableView>
+#include "BodyCodec.h"
+#include "FuzzEngine.h"
+#include "FuzzResultsModel.h"
+#include "OrganizerItem.h"
+
+// Intruder-style attack on one stored request. The request is copied into
+// an editable template where payload positions are marked with § pairs;
+// the attack runs on a FuzzEngine and results stream into a table. Each
+// run of a saved request is kept in the project and can be reloaded.
+class FuzzerDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit FuzzerDialog(const OrganizerItem* item, QWidget* parent = nullptr);
+    ~FuzzerDialog();
+
+private slots:
+    void addMarkers();
+    void clearMarkers();
+    void start();
+    void stop();
+    void onProgress(qint64 done, qint64 total, double requestsPerSecond);
+    void onFinished(qint64 done, qint64 failed, bool cancelled);
+    void analyze();
+    void loadRun();
+
+private:
+    void setRunning(bool running);
+    void refreshRuns();
+
+    QPlainTextEdit* m_templateEdit;
+    BodyCodec::Decoded m_templateBody; // How the template was decoded, so its body encodes back to the same bytes
+    QPlainTextEdit* m_payloadsEdit;
+    QComboBox* m_modeCombo;
+    QComboBox* m_schemeCombo;
+    QLineEdit* m_hostEdit;
+    QSpinBox* m_connectionsSpin;
+    QCheckBox* m_verifyCheck;
+    QPushButton* m_startButton;
+    QPushButton* m_stopButton;
+    QLabel* m_statusLabel;
+    QTableView* m_resultsView;
+    QLabel* m_summaryLabel;
+    QCheckBox* m_outliersCheck;
+    QPushButton* m_analyzeButton;
+    QComboBox* m_runsCombo;
+    QPushButton* m_loadButton;
+    FuzzResultsModel* m_results;
+    FuzzEngine* m_engine;
+    int m_itemId;
+};
+
+#endif // FUZZERDIALOG_H
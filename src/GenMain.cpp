@@ -0,0 +1,106 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include "DatabaseManager.h"
+#include "ProjectGenerator.h"
+
+// ro-gen: fills a project with synthetic traffic for scale and performance
+// testing, optionally writing the same requests as Burp XML, HAR and pcap
+// so the importers can be measured against a known result.
+namespace {
+    QTextStream& err() {
+        static QTextStream stream(stderr);
+        return stream;
+    }
+
+    int fail(const QString& message) {
+        err() << "ro-gen: " << message << Qt::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("RequestOrganizer");
+
+    const GeneratorOptions defaults;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate a synthetic Request Organizer project. The same seed and "
+                                     "options always give the same project.");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "Project database (default: the GUI's project).", "file");
+    QCommandLineOption parentOption("parent", "Folder id to generate into (default: top level).", "id");
+    QCommandLineOption seedOption("seed", "Random seed.", "n", QString::number(defaults.seed));
+    QCommandLineOption itemsOption("items", "Number of requests.", "n", QString::number(defaults.items));
+    QCommandLineOption fanOutOption("fan-out", "Subfolders per folder.", "n", QString::number(defaults.fanOut));
+    QCommandLineOption depthOption("depth", "Folder levels below the top folder.", "n", QString::number(defaults.depth));
+    QCommandLineOption hostsOption("hosts", "Distinct hosts.", "n", QString::number(defaults.hosts));
+    QCommandLineOption minBodyOption("min-body", "Smallest response body in bytes.", "bytes",
+                                     QString::number(defaults.minBody));
+    QCommandLineOption maxBodyOption("max-body", "Largest response body in bytes.", "bytes",
+                                     QString::number(defaults.maxBody));
+    QCommandLineOption skewOption("body-skew", "Body size skew; higher means more small bodies.", "x",
+                                  QString::number(defaults.bodySkew));
+    QCommandLineOption screenshotsOption("screenshots", "Fraction of requests with a screenshot.", "ratio",
+                                         QString::number(defaults.screenshotRatio));
+    QCommandLineOption binaryOption("binary", "Fraction of 200 responses with a binary body.", "ratio",
+                                    QString::number(defaults.binaryRatio));
+    QCommandLineOption burpOption("burp", "Also write the requests as Burp XML.", "file");
+    QCommandLineOption harOption("har", "Also write the requests as HAR.", "file");
+    QCommandLineOption pcapOption("pcap", "Also write the requests as a pcap capture.", "file");
+    parser.addOptions({dbOption, parentOption, seedOption, itemsOption, fanOutOption, depthOption, hostsOption,
+                       minBodyOption, maxBodyOption, skewOption, screenshotsOption, binaryOption,
+                       burpOption, harOption, pcapOption});
+    parser.process(app);
+
+    bool ok = true;
+    auto number = [&parser, &ok](const QCommandLineOption& option) {
+        bool valid = false;
+        const double value = parser.value(option).toDouble(&valid);
+        if (!valid || value < 0) {
+            err() << "ro-gen: --" << option.names().first() << " takes a non-negative number" << Qt::endl;
+            ok = false;
+        }
+        return value;
+    };
+    GeneratorOptions options;
+    options.seed = quint32(number(seedOption));
+    options.items = qint64(number(itemsOption));
+    options.fanOut = int(number(fanOutOption));
+    options.depth = int(number(depthOption));
+    options.hosts = int(number(hostsOption));
+    options.minBody = int(number(minBodyOption));
+    options.maxBody = int(number(maxBodyOption));
+    options.bodySkew = number(skewOption);
+    options.screenshotRatio = number(screenshotsOption);
+    options.binaryRatio = number(binaryOption);
+    options.burpFile = parser.value(burpOption);
+    options.harFile = parser.value(harOption);
+    options.pcapFile = parser.value(pcapOption);
+    if (!ok) return 2;
+    const int parentId = parser.isSet(parentOption) ? parser.value(parentOption).toInt(&ok) : -1;
+    if (!ok) return fail("--parent takes a folder id");
+
+    DatabaseManager& db = DatabaseManager::instance();
+    if (parser.isSet(dbOption)) {
+        db.setDatabasePath(parser.value(dbOption));
+    }
+    if (!db.initialize()) {
+        return fail("Could not open " + db.databasePath());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    ProjectGenerator generator(options);
+    bool generated = generator.generate(db.database(), parentId, &error, [](qint64 done, qint64 total) {
+        err() << "\r" << done << "/" << total << Qt::flush;
+    });
+    err() << Qt::endl;
+    if (!generated) return fail(error);
+
+    QTextStream(stdout) << "Generated " << options.items << " requests in "
+                        << QString::number(timer.elapsed() / 1000.0, 'f', 1) << " s" << Qt::endl;
+    return 0;
+}
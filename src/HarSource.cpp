@@ -0,0 +1,288 @@
+#include "HarSource.h"
+
+HarSource::HarSource(const QString& fileName)
+    : m_file(fileName)
+    , m_json(&m_file)
+    , m_inEntries(false)
+{
+}
+
+bool HarSource::open() {
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = "Could not open file: " + m_file.fileName();
+        return false;
+    }
+    // A HAR without entries simply imports nothing
+    findEntries();
+    return m_error.isEmpty() && !m_json.hasError();
+}
+
+bool HarSource::findEntries() {
+    if (m_json.readNext() != JsonStreamReader::StartObject) {
+        m_error = "Not a HAR file: " + m_file.fileName();
+        return false;
+    }
+    // Walk down to log.entries, skipping everything else on the way
+    while (m_json.readNext() == JsonStreamReader::Name) {
+        if (m_json.rawText() != "log") {
+            if (!m_json.skipValue()) return false;
+            continue;
+        }
+        if (m_json.readNext() != JsonStreamReader::StartObject) {
+            m_error = "Not a HAR file: " + m_file.fileName();
+            return false;
+        }
+        while (m_json.readNext() == JsonStreamReader::Name) {
+            if (m_json.rawText() == "entries") {
+                m_inEntries = m_json.readNext() == JsonStreamReader::StartArray;
+                return m_inEntries;
+            }
+            if (!m_json.skipValue()) return false;
+        }
+        return false;
+    }
+    return false;
+}
+
+bool HarSource::next(ImportRecord& record) {
+    while (m_inEntries) {
+        JsonStreamReader::Token token = m_json.readNext();
+        if (token == JsonStreamReader::StartObject) {
+            readEntry(record);
+            return !m_json.hasError();
+        }
+        if (token == JsonStreamReader::EndArray || token == JsonStreamReader::Invalid ||
+            token == JsonStreamReader::EndDocument) {
+            m_inEntries = false;
+            break;
+        }
+        m_json.skipValue(); // Not an entry object
+    }
+    return false;
+}
+
+qint64 HarSource::bytesRead() const {
+    return m_json.bytesRead();
+}
+
+qint64 HarSource::totalBytes() const {
+    return m_file.size();
+}
+
+QString HarSource::errorString() const {
+    if (!m_error.isEmpty()) return m_error;
+    if (m_json.hasError()) return "JSON parsing error: " + m_json.errorString();
+    return QString();
+}
+
+void HarSource::readEntry(ImportRecord& record) {
+    while (m_json.readNext() == JsonStreamReader::Name) {
+        const QByteArray& name = m_json.rawText();
+        if (name == "startedDateTime") {
+            record.time = m_json.readString(); // ISO 8601, parsed by the pipeline's workers
+        } else if (name == "time") {
+            record.responseTime = qRound64(m_json.readNumber());
+        } else if (name == "request") {
+            readRequest(record);
+        } else if (name == "response") {
+            readResponse(record);
+        } else if (name == "comment") {
+            record.comment = m_json.readString();
+        } else {
+            m_json.skipValue();
+        }
+    }
+}
+
+void HarSource::readRequest(ImportRecord& record) {
+    if (m_json.readNext() != JsonStreamReader::StartObject) {
+        m_json.skipValue();
+        return;
+    }
+
+    QByteArray method, url, version, body;
+    Headers headers;
+    while (m_json.readNext() == JsonStreamReader::Name) {
+        const QByteArray& name = m_json.rawText();
+        if (name == "method") {
+            method = m_json.readRawString();
+        } else if (name == "url") {
+            url = m_json.readRawString();
+        } else if (name == "httpVersion") {
+            version = m_json.readRawString();
+        } else if (name == "headers") {
+            headers = readHeaders();
+        } else if (name == "postData") {
+            if (m_json.readNext() != JsonStreamReader::StartObject) {
+                m_json.skipValue();
+                continue;
+            }
+            bool base64 = false;
+            while (m_json.readNext() == JsonStreamReader::Name) {
+                if (m_json.rawText() == "text") {
+                    body = m_json.readRawString();
+                } else if (m_json.rawText() == "encoding") {
+                    base64 = m_json.readRawString() == "base64";
+                } else {
+                    m_json.skipValue();
+                }
+            }
+            if (base64) {
+                body = QByteArray::fromBase64(body);
+            }
+        } else {
+            m_json.skipValue();
+        }
+    }
+
+    // Origin-form target: everything after the authority
+    QByteArray target = "/";
+    qsizetype scheme = url.indexOf("://");
+    qsizetype pathStart = url.indexOf('/', scheme < 0 ? 0 : scheme + 3);
+    qsizetype queryStart = url.indexOf('?', scheme < 0 ? 0 : scheme + 3);
+    if (pathStart < 0 || (queryStart >= 0 && queryStart < pathStart)) pathStart = queryStart;
+    if (pathStart >= 0) {
+        target = url.mid(pathStart);
+        if (target.startsWith('?')) target.prepend('/');
+        qsizetype fragment = target.indexOf('#');
+        if (fragment >= 0) target.truncate(fragment);
+    }
+
+    // HTTP/2 captures carry the authority as a pseudo-header instead of Host
+    bool hasHost = false;
+    for (const auto& header : headers) {
+        if (qstricmp(header.first.constData(), "host") == 0) hasHost = true;
+    }
+    if (!hasHost && scheme >= 0) {
+        qsizetype authorityEnd = pathStart >= 0 ? pathStart : url.size();
+        headers.prepend({"Host", url.mid(scheme + 3, authorityEnd - scheme - 3)});
+    }
+
+    QByteArray message;
+    message.reserve(method.size() + target.size() + body.size() + 512);
+    message.append(method).append(' ').append(target).append(' ').append(startLineVersion(version)).append("\r\n");
+    appendHeaders(message, headers, body.size());
+    message.append(body);
+
+    record.method = QString::fromLatin1(method);
+    record.url = QString::fromUtf8(url);
+    record.request = message;
+}
+
+void HarSource::readResponse(ImportRecord& record) {
+    if (m_json.readNext() != JsonStreamReader::StartObject) {
+        m_json.skipValue();
+        return;
+    }
+
+    QByteArray statusText, version, body;
+    Headers headers;
+    int status = 0;
+    qint64 contentSize = -1;
+    while (m_json.readNext() == JsonStreamReader::Name) {
+        const QByteArray& name = m_json.rawText();
+        if (name == "status") {
+            status = int(m_json.readNumber());
+        } else if (name == "statusText") {
+            statusText = m_json.readRawString();
+        } else if (name == "httpVersion") {
+            version = m_json.readRawString();
+        } else if (name == "headers") {
+            headers = readHeaders();
+        } else if (name == "content") {
+            if (m_json.readNext() != JsonStreamReader::StartObject) {
+                m_json.skipValue();
+                continue;
+            }
+            bool base64 = false;
+            while (m_json.readNext() == JsonStreamReader::Name) {
+                const QByteArray& field = m_json.rawText();
+                if (field == "text") {
+                    body = m_json.readRawString();
+                } else if (field == "encoding") {
+                    base64 = m_json.readRawString() == "base64";
+                } else if (field == "size") {
+                    contentSize = qint64(m_json.readNumber());
+                } else {
+                    m_json.skipValue();
+                }
+            }
+            if (base64) {
+                body = QByteArray::fromBase64(body);
+            }
+        } else {
+            m_json.skipValue();
+        }
+    }
+
+    QByteArray message;
+    message.reserve(body.size() + 512);
+    message.append(startLineVersion(version)).append(' ').append(QByteArray::number(status));
+    if (!statusText.isEmpty()) message.append(' ').append(statusText);
+    message.append("\r\n");
+    appendHeaders(message, headers, body.size());
+    message.append(body);
+
+    record.status = status;
+    record.responseLength = contentSize > 0 ? contentSize : body.size();
+    record.response = message;
+}
+
+HarSource::Headers HarSource::readHeaders() {
+    Headers headers;
+    if (m_json.readNext() != JsonStreamReader::StartArray) {
+        m_json.skipValue();
+        return headers;
+    }
+    forever {
+        JsonStreamReader::Token token = m_json.readNext();
+        if (token == JsonStreamReader::EndArray || token == JsonStreamReader::Invalid ||
+            token == JsonStreamReader::EndDocument) {
+            break;
+        }
+        if (token != JsonStreamReader::StartObject) {
+            m_json.skipValue();
+            continue;
+        }
+        QByteArray name, value;
+        while (m_json.readNext() == JsonStreamReader::Name) {
+            const QByteArray& field = m_json.rawText();
+            if (field == "name") {
+                name = m_json.readRawString();
+            } else if (field == "value") {
+                value = m_json.readRawString();
+            } else {
+                m_json.skipValue();
+            }
+        }
+        if (!name.isEmpty()) headers.append({name, value});
+    }
+    return headers;
+}
+
+QByteArray HarSource::startLineVersion(const QByteArray& httpVersion) {
+    // Browsers report "h2" / "h3" for newer protocols
+    QByteArray version = httpVersion.toUpper();
+    if (version.startsWith("HTTP/")) return version;
+    if (version == "H2") return "HTTP/2";
+    if (version == "H3") return "HTTP/3";
+    return "HTTP/1.1";
+}
+
+void HarSource::appendHeaders(QByteArray& message, const Headers& headers, qsizetype bodySize) {
+    // HAR bodies are stored decoded, so the framing headers are rewritten to match
+    for (const auto& header : headers) {
+        const QByteArray& name = header.first;
+        if (name.startsWith(':')) continue; // HTTP/2 pseudo-headers
+        if (qstricmp(name.constData(), "content-length") == 0 ||
+            qstricmp(name.constData(), "content-encoding") == 0 ||
+            qstricmp(name.constData(), "transfer-encoding") == 0) {
+            continue;
+        }
+        message.append(name).append(": ").append(header.second).append("\r\n");
+    }
+    if (bodySize > 0) {
+        message.append("Content-Length: ").append(QByteArray::number(bodySize)).append("\r\n");
+    }
+    message.append("\r\n");
+}
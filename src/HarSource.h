@@ -0,0 +1,40 @@
+#ifndef HARSOURCE_H
+#define HARSOURCE_H
+
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include "ImportSource.h"
+#include "JsonStreamReader.h"
+
+// Reads the log.entries of a HAR 1.2 file one entry at a time with a
+// streaming JSON reader, so multi-gigabyte captures never have to fit in a
+// QJsonDocument. Each entry is rebuilt into raw HTTP/1.x messages.
+class HarSource : public ImportSource {
+public:
+    explicit HarSource(const QString& fileName);
+
+    bool open() override;
+    bool next(ImportRecord& record) override;
+    qint64 bytesRead() const override;
+    qint64 totalBytes() const override;
+    QString errorString() const override;
+
+private:
+    typedef QList<QPair<QByteArray, QByteArray>> Headers;
+
+    bool findEntries();
+    void readEntry(ImportRecord& record);
+    void readRequest(ImportRecord& record);
+    void readResponse(ImportRecord& record);
+    Headers readHeaders();
+    static QByteArray startLineVersion(const QByteArray& httpVersion);
+    static void appendHeaders(QByteArray& message, const Headers& headers, qsizetype bodySize);
+
+    QFile m_file;
+    JsonStreamReader m_json;
+    bool m_inEntries;
+    QString m_error;
+};
+
+#endif // HARSOURCE_H
@@ -0,0 +1,269 @@
+#include "HarWriter.h"
+#include "BodyCodec.h"
+#include "HttpDecoder.h"
+#include "RequestOrigin.h"
+#include <QDateTime>
+#include <QFile>
+#include <QStringDecoder>
+
+namespace {
+    const char HexDigits[] = "0123456789abcdef";
+
+    bool isUtf8Text(QByteArrayView body) {
+        if (BodyCodec::looksBinary(body)) return false;
+        QStringDecoder decoder(QStringConverter::Utf8, QStringDecoder::Flag::Stateless);
+        QString text = decoder.decode(body);
+        return !decoder.hasError();
+    }
+
+    void collectEntries(const OrganizerItem* item, QList<HarEntry>& entries) {
+        if (item->type() == ItemType::Request) {
+            entries.append(HarWriter::entryFor(item));
+        }
+        for (const OrganizerItem* child : item->children()) {
+            collectEntries(child, entries);
+        }
+    }
+}
+
+HarWriter::HarWriter(QIODevice* device)
+    : m_device(device)
+    , m_firstEntry(true)
+    , m_error(false)
+{
+}
+
+HarEntry HarWriter::entryFor(const OrganizerItem* item) {
+    HarEntry entry;
+    entry.host = item->host();
+    entry.url = item->url();
+    entry.query = item->query();
+    entry.scheme = item->scheme();
+    entry.port = item->port();
+    entry.method = item->method();
+    entry.annotation = item->annotation();
+    entry.timestamp = item->timestamp();
+    entry.responseTime = item->responseTime();
+    entry.status = item->status();
+    entry.request = item->request();
+    entry.response = item->response();
+    return entry;
+}
+
+QList<HarEntry> HarWriter::snapshot(const OrganizerItem* root) {
+    QList<HarEntry> entries;
+    collectEntries(root, entries);
+    return entries;
+}
+
+bool HarWriter::exportEntries(const QList<HarEntry>& entries, const QString& fileName, QString* error,
+                              const std::atomic_bool* cancel) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = "Could not open file: " + fileName;
+        return false;
+    }
+
+    HarWriter writer(&file);
+    writer.writeStart();
+    for (const HarEntry& entry : entries) {
+        if (writer.hasError()) break;
+        if (cancel && cancel->load()) {
+            file.remove();
+            return false;
+        }
+        writer.writeEntry(entry);
+    }
+    writer.writeEnd();
+    if (writer.hasError()) {
+        if (error) *error = "Error writing file: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void HarWriter::write(QByteArrayView data) {
+    if (m_error) return;
+    if (m_device->write(data.data(), data.size()) != data.size()) {
+        m_error = true;
+    }
+}
+
+void HarWriter::writeString(QByteArrayView utf8) {
+    // Escape runs are rare, so plain spans go out in one write
+    write("\"");
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < utf8.size(); ++i) {
+        uchar c = uchar(utf8[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        write(utf8.sliced(start, i - start));
+        start = i + 1;
+        switch (c) {
+        case '"': write("\\\""); break;
+        case '\\': write("\\\\"); break;
+        case '\n': write("\\n"); break;
+        case '\r': write("\\r"); break;
+        case '\t': write("\\t"); break;
+        default: {
+            const char escape[] = {'\\', 'u', '0', '0', HexDigits[c >> 4], HexDigits[c & 0xF]};
+            write(QByteArrayView(escape, 6));
+            break;
+        }
+        }
+    }
+    write(utf8.sliced(start));
+    write("\"");
+}
+
+void HarWriter::writeLatin1String(QByteArrayView latin1) {
+    // Header bytes are Latin-1; only bytes above 0x7F need converting
+    for (char c : latin1) {
+        if (uchar(c) >= 0x80) {
+            writeString(QString::fromLatin1(latin1).toUtf8());
+            return;
+        }
+    }
+    writeString(latin1);
+}
+
+void HarWriter::writeStart() {
+    write("{\"log\":{\"version\":\"1.2\",\"creator\":{\"name\":\"Request Organizer\",\"version\":\"1.0\"},\"entries\":[");
+}
+
+void HarWriter::writeEnd() {
+    write("]}}\n");
+}
+
+void HarWriter::writeHeaders(const QByteArray& message, const HttpMessageIndex& index) {
+    write("\"headers\":[");
+    bool first = true;
+    for (const HttpMessageIndex::Header& header : index.headers()) {
+        if (!first) write(",");
+        first = false;
+        write("{\"name\":");
+        writeLatin1String(HttpMessageIndex::view(message, header.name));
+        write(",\"value\":");
+        writeLatin1String(HttpMessageIndex::view(message, header.value));
+        write("}");
+    }
+    write("]");
+}
+
+void HarWriter::writeBody(QByteArrayView body, const QByteArray& contentType, bool request) {
+    // Bodies that aren't valid UTF-8 text go out as base64 so nothing is lost
+    bool text = isUtf8Text(body);
+    if (request) {
+        write(",\"postData\":{\"mimeType\":");
+        writeLatin1String(contentType);
+        write(",\"text\":");
+        if (text) {
+            writeString(body);
+        } else {
+            // Not in the HAR spec for postData, but mirrors content.encoding
+            writeString(body.toByteArray().toBase64());
+            write(",\"encoding\":\"base64\"");
+        }
+        write("}");
+        return;
+    }
+
+    write(",\"content\":{\"size\":");
+    write(QByteArray::number(body.size()));
+    write(",\"mimeType\":");
+    writeLatin1String(contentType);
+    write(",\"text\":");
+    if (text) {
+        writeString(body);
+    } else {
+        writeString(body.toByteArray().toBase64());
+        write(",\"encoding\":\"base64\"");
+    }
+    write("}");
+}
+
+void HarWriter::writeEntry(const HarEntry& entry) {
+    // Decoded copies, dropped after the entry: HAR bodies are stored without transfer or content coding
+    const QByteArray request = HttpDecoder::decode(entry.request);
+    const QByteArray response = HttpDecoder::decode(entry.response);
+    HttpMessageIndex requestIndex = HttpMessageIndex::parse(request);
+    HttpMessageIndex responseIndex = HttpMessageIndex::parse(response);
+    const bool parsedRequest = requestIndex.isValid() && requestIndex.isRequest();
+
+    QByteArray method = parsedRequest ? requestIndex.method(request).toByteArray() : entry.method.toLatin1();
+    QByteArray target = parsedRequest ? requestIndex.target(request).toByteArray() : QByteArray();
+    if (target.isEmpty()) {
+        target = entry.url.toUtf8();
+        if (!entry.query.isEmpty()) target += "?" + entry.query.toUtf8();
+    }
+    const QByteArray url = RequestOrigin::resolve(entry.scheme, entry.port, entry.host,
+                                                  QString::fromLatin1(requestIndex.header(request, "host")))
+                               .url(QString::fromUtf8(target)).toUtf8();
+
+    if (!m_firstEntry) write(",");
+    m_firstEntry = false;
+
+    write("\n{\"startedDateTime\":");
+    writeString(QDateTime::fromSecsSinceEpoch(entry.timestamp, Qt::UTC).toString(Qt::ISODateWithMs).toUtf8());
+    write(",\"time\":");
+    write(QByteArray::number(entry.responseTime));
+
+    write(",\"request\":{\"method\":");
+    writeLatin1String(method);
+    write(",\"url\":");
+    writeString(url);
+    write(",\"httpVersion\":");
+    writeLatin1String(parsedRequest ? requestIndex.version(request) : QByteArrayView("HTTP/1.1"));
+    write(",\"cookies\":[],");
+    writeHeaders(request, requestIndex);
+
+    write(",\"queryString\":[");
+    qsizetype queryStart = target.indexOf('?');
+    if (queryStart >= 0) {
+        bool first = true;
+        for (const QByteArray& pair : target.mid(queryStart + 1).split('&')) {
+            if (pair.isEmpty()) continue;
+            qsizetype equals = pair.indexOf('=');
+            if (!first) write(",");
+            first = false;
+            write("{\"name\":");
+            writeString(QByteArray::fromPercentEncoding(equals < 0 ? pair : pair.left(equals)));
+            write(",\"value\":");
+            writeString(QByteArray::fromPercentEncoding(equals < 0 ? QByteArray() : pair.mid(equals + 1)));
+            write("}");
+        }
+    }
+    write("]");
+    QByteArrayView requestBody = requestIndex.body(request);
+    if (!requestBody.isEmpty()) {
+        writeBody(requestBody, requestIndex.header(request, "content-type").toByteArray(), true);
+    }
+    write(",\"headersSize\":-1,\"bodySize\":");
+    write(QByteArray::number(requestBody.size()));
+    write("}");
+
+    QByteArrayView responseBody = responseIndex.body(response);
+    write(",\"response\":{\"status\":");
+    write(QByteArray::number(responseIndex.isResponse() ? responseIndex.status() : entry.status));
+    write(",\"statusText\":");
+    writeLatin1String(responseIndex.reason(response));
+    write(",\"httpVersion\":");
+    writeLatin1String(responseIndex.isResponse() ? responseIndex.version(response) : QByteArrayView("HTTP/1.1"));
+    write(",\"cookies\":[],");
+    writeHeaders(response, responseIndex);
+    writeBody(responseBody, responseIndex.header(response, "content-type").toByteArray(), false);
+    write(",\"redirectURL\":");
+    writeLatin1String(responseIndex.header(response, "location"));
+    write(",\"headersSize\":-1,\"bodySize\":");
+    write(QByteArray::number(responseBody.size()));
+    write("}");
+
+    write(",\"cache\":{},\"timings\":{\"send\":0,\"wait\":");
+    write(QByteArray::number(entry.responseTime));
+    write(",\"receive\":0}");
+    if (!entry.annotation.isEmpty()) {
+        write(",\"comment\":");
+        writeString(entry.annotation.toUtf8());
+    }
+    write("}");
+}
@@ -0,0 +1,66 @@
+#ifndef HARWRITER_H
+#define HARWRITER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <atomic>
+#include "HttpMessageIndex.h"
+#include "OrganizerItem.h"
+
+// One request as taken on the GUI thread: the raw messages share their data
+// with the item and are decoded only while the entry is written.
+struct HarEntry {
+    QString host;
+    QString url;
+    QString query;
+    QString scheme;
+    int port = 0;
+    QString method;
+    QString annotation;
+    qint64 timestamp = 0;
+    qint64 responseTime = 0;
+    int status = 0;
+    QByteArray request;
+    QByteArray response;
+};
+
+// Writes a HAR 1.2 log entry by entry straight to a device, so exporting a
+// large subtree never builds the whole document in memory.
+class HarWriter {
+public:
+    explicit HarWriter(QIODevice* device);
+
+    void writeStart();
+    void writeEntry(const HarEntry& entry);
+    void writeEntry(const OrganizerItem* item) { writeEntry(entryFor(item)); }
+    void writeEnd();
+    bool hasError() const { return m_error; }
+
+    static HarEntry entryFor(const OrganizerItem* item);
+    // Every request in the subtree under root, depth first.
+    // Must run on the thread that owns the items.
+    static QList<HarEntry> snapshot(const OrganizerItem* root);
+
+    // Decodes and writes the entries to fileName; safe to run on a worker
+    static bool exportEntries(const QList<HarEntry>& entries, const QString& fileName, QString* error = nullptr,
+                              const std::atomic_bool* cancel = nullptr);
+    static bool exportItems(const OrganizerItem* root, const QString& fileName, QString* error = nullptr) {
+        return exportEntries(snapshot(root), fileName, error);
+    }
+
+private:
+    void write(QByteArrayView data);
+    void writeString(QByteArrayView utf8);
+    void writeLatin1String(QByteArrayView latin1);
+    void writeHeaders(const QByteArray& message, const HttpMessageIndex& index);
+    void writeBody(QByteArrayView body, const QByteArray& contentType, bool request);
+
+    QIODevice* m_device;
+    bool m_firstEntry;
+    bool m_error;
+};
+
+#endif // HARWRITER_H
@@ -0,0 +1,95 @@
+#include "HexView.h"
+#include <QPainter>
+#include <QScrollBar>
+#include <QFontDatabase>
+
+HexView::HexView(QWidget* parent)
+    : QAbstractScrollArea(parent)
+{
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    font.setPointSize(10);
+    setFont(font);
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+}
+
+void HexView::setData(const QByteArray& data) {
+    m_data = data;
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+}
+
+int HexView::rowCount() const {
+    return static_cast<int>((m_data.size() + BytesPerRow - 1) / BytesPerRow);
+}
+
+int HexView::visibleRowCount() const {
+    return qMax(1, viewport()->height() / fontMetrics().height());
+}
+
+int HexView::lineWidth() const {
+    // "00000000  " + 16 * "00 " + 1 extra gap + " " + 16 ASCII characters
+    return fontMetrics().horizontalAdvance(QLatin1Char('0')) * (10 + BytesPerRow * 3 + 2 + BytesPerRow);
+}
+
+void HexView::updateScrollBars() {
+    verticalScrollBar()->setRange(0, qMax(0, rowCount() - visibleRowCount()));
+    verticalScrollBar()->setPageStep(visibleRowCount());
+    horizontalScrollBar()->setRange(0, qMax(0, lineWidth() - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+}
+
+void HexView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void HexView::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+    QPainter painter(viewport());
+    painter.setFont(font());
+
+    static const char hexDigits[] = "0123456789abcdef";
+    const int lineHeight = fontMetrics().height();
+    const int ascent = fontMetrics().ascent();
+    const int x = -horizontalScrollBar()->value() + 4;
+    const int firstRow = verticalScrollBar()->value();
+    const int lastRow = qMin(rowCount(), firstRow + visibleRowCount() + 1);
+    const QColor offsetColor = palette().color(QPalette::PlaceholderText);
+    const QColor textColor = palette().color(QPalette::Text);
+    const int offsetWidth = fontMetrics().horizontalAdvance(QLatin1Char('0')) * 10;
+
+    QString line;
+    line.reserve(BytesPerRow * 4 + 4);
+    for (int row = firstRow; row < lastRow; ++row) {
+        const qsizetype start = static_cast<qsizetype>(row) * BytesPerRow;
+        const qsizetype count = qMin<qsizetype>(BytesPerRow, m_data.size() - start);
+        const int y = (row - firstRow) * lineHeight + ascent;
+
+        painter.setPen(offsetColor);
+        painter.drawText(x, y, QString("%1").arg(start, 8, 16, QLatin1Char('0')));
+
+        line.clear();
+        for (int i = 0; i < BytesPerRow; ++i) {
+            if (i == BytesPerRow / 2) line.append(QLatin1Char(' '));
+            if (i < count) {
+                uchar byte = static_cast<uchar>(m_data.at(start + i));
+                line.append(QLatin1Char(hexDigits[byte >> 4]));
+                line.append(QLatin1Char(hexDigits[byte & 0xf]));
+                line.append(QLatin1Char(' '));
+            } else {
+                line.append(QLatin1String("   "));
+            }
+        }
+        line.append(QLatin1Char(' '));
+        for (int i = 0; i < count; ++i) {
+            char c = m_data.at(start + i);
+            line.append(c >= 0x20 && c < 0x7f ? QLatin1Char(c) : QLatin1Char('.'));
+        }
+
+        painter.setPen(textColor);
+        painter.drawText(x + offsetWidth, y, line);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef HEXVIEW_H
+#define HEXVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+
+// Read-only offset/hex/ASCII view. Only the rows inside the viewport are
+// formatted on each paint, so multi-megabyte bodies cost nothing up front.
+class HexView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    explicit HexView(QWidget* parent = nullptr);
+
+    void setData(const QByteArray& data);
+    const QByteArray& data() const { return m_data; }
+    void clear() { setData(QByteArray()); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    static constexpr int BytesPerRow = 16;
+
+    void updateScrollBars();
+    int rowCount() const;
+    int visibleRowCount() const;
+    int lineWidth() const;
+
+    QByteArray m_data;
+};
+
+#endif // HEXVIEW_H
@@ -0,0 +1,296 @@
+#include "HttpClientPool.h"
+#include "HttpMessageIndex.h"
+#include "OutboundScheduler.h"
+#include <QSslSocket>
+#include <QTimer>
+#include <limits>
+
+namespace {
+    // Whether the connection stays usable after this exchange
+    bool keepsAlive(const QByteArray& request, const QByteArray& response, const HttpMessageIndex& index) {
+        if (index.status() == 101) return false;
+        if (index.header(response, "connection").toByteArray().toLower().contains("close")) return false;
+        if (index.version(response) == "HTTP/1.0" &&
+            !index.header(response, "connection").toByteArray().toLower().contains("keep-alive")) {
+            return false;
+        }
+        HttpMessageIndex requestIndex = HttpMessageIndex::parse(request);
+        return !requestIndex.header(request, "connection").toByteArray().toLower().contains("close");
+    }
+}
+
+HttpClientPool::HttpClientPool(QObject* parent)
+    : QObject(parent)
+    , m_wake(new QTimer(this))
+    , m_job(OutboundScheduler::instance().registerJob())
+    , m_pending(0)
+    , m_maxConnections(32)
+    , m_maxPerHost(6)
+    , m_timeout(30000)
+    , m_verifyPeer(false)
+{
+    m_wake->setSingleShot(true);
+    m_wake->setTimerType(Qt::PreciseTimer);
+    connect(m_wake, &QTimer::timeout, this, &HttpClientPool::schedule);
+}
+
+HttpClientPool::~HttpClientPool() {
+    abort();
+    OutboundScheduler::instance().unregisterJob(m_job);
+}
+
+void HttpClientPool::send(quint64 id, const HttpTarget& target, const QByteArray& request) {
+    ++m_pending;
+    if (target.tls && !QSslSocket::supportsSsl()) {
+        // Reported from the event loop like every other result
+        QTimer::singleShot(0, this, [this, id]() {
+            --m_pending;
+            emit finished(id, QByteArray(), 0, "TLS is not available (no OpenSSL backend)");
+        });
+        return;
+    }
+
+    Job job;
+    job.id = id;
+    job.target = target;
+    job.request = request;
+    job.head = request.startsWith("HEAD ");
+    m_hosts[target].queue.enqueue(job);
+    if (!m_order.contains(target)) {
+        m_order.append(target);
+    }
+    schedule();
+}
+
+void HttpClientPool::abort() {
+    const QList<Connection*> connections = m_connections;
+    for (Connection* connection : connections) {
+        drop(connection);
+    }
+    m_hosts.clear();
+    m_order.clear();
+    m_pending = 0;
+    m_wake->stop();
+}
+
+void HttpClientPool::schedule() {
+    // Each pass gives every waiting host at most one connection
+    bool started = true;
+    while (started && !m_order.isEmpty()) {
+        started = false;
+        for (int i = 0; i < m_order.size();) {
+            const HttpTarget target = m_order[i];
+            Host& host = m_hosts[target];
+            if (host.queue.isEmpty()) {
+                m_order.removeAt(i);
+                continue;
+            }
+            // A token is only asked for when a connection is there to use it
+            Connection* connection = nullptr;
+            const bool room = !host.idle.isEmpty() ||
+                              (host.open < m_maxPerHost &&
+                               (m_connections.size() < m_maxConnections || hasIdleConnection()));
+            if (room && admit(target)) {
+                if (!host.idle.isEmpty()) {
+                    connection = host.idle.takeLast();
+                } else {
+                    if (m_connections.size() >= m_maxConnections) closeIdleConnection();
+                    connection = openConnection(target);
+                }
+            }
+            if (connection) {
+                start(connection, m_hosts[target].queue.dequeue());
+                started = true;
+            }
+            ++i;
+        }
+    }
+}
+
+HttpClientPool::Connection* HttpClientPool::openConnection(const HttpTarget& target) {
+    Connection* connection = new Connection;
+    connection->target = target;
+    connection->socket = new QSslSocket(this);
+    connection->timeout = new QTimer(connection->socket);
+    connection->timeout->setSingleShot(true);
+    connection->timeout->setInterval(m_timeout);
+
+    QSslSocket* socket = connection->socket;
+    connect(connection->timeout, &QTimer::timeout, this, [this, connection]() {
+        onClosed(connection, "Timed out");
+    });
+    connect(socket, &QSslSocket::connected, this, [connection]() {
+        connection->connectedAt = connection->elapsed.nsecsElapsed();
+    });
+    connect(socket, &QSslSocket::encrypted, this, [connection]() {
+        connection->encryptedAt = connection->elapsed.nsecsElapsed();
+    });
+    connect(socket, &QSslSocket::readyRead, this, [this, connection]() { onReadyRead(connection); });
+    connect(socket, &QSslSocket::disconnected, this, [this, connection]() { onClosed(connection, QString()); });
+    connect(socket, &QSslSocket::errorOccurred, this, [this, connection](QAbstractSocket::SocketError error) {
+        // A plain close is handled by disconnected, which may still end a close-delimited body
+        if (error != QAbstractSocket::RemoteHostClosedError) {
+            onClosed(connection, connection->socket->errorString());
+        }
+    });
+
+    // Writes made before the connection is up are buffered until it is
+    if (target.tls) {
+        socket->setPeerVerifyMode(m_verifyPeer ? QSslSocket::VerifyPeer : QSslSocket::VerifyNone);
+        socket->connectToHostEncrypted(target.host, target.port);
+    } else {
+        socket->connectToHost(target.host, target.port);
+    }
+    m_hosts[target].open++;
+    m_connections.append(connection);
+    return connection;
+}
+
+bool HttpClientPool::admit(const HttpTarget& target) {
+    const qint64 wait = OutboundScheduler::instance().acquire(m_job, target.host);
+    if (wait == 0) return true;
+    const int milliseconds = int(qMin<qint64>((wait + 999999) / 1000000, std::numeric_limits<int>::max()));
+    if (!m_wake->isActive() || m_wake->remainingTime() > milliseconds) {
+        m_wake->start(milliseconds);
+    }
+    return false;
+}
+
+bool HttpClientPool::hasIdleConnection() const {
+    for (const Host& host : m_hosts) {
+        if (!host.idle.isEmpty()) return true;
+    }
+    return false;
+}
+
+bool HttpClientPool::closeIdleConnection() {
+    for (auto it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+        if (!it->idle.isEmpty()) {
+            drop(it->idle.takeFirst());
+            return true;
+        }
+    }
+    return false;
+}
+
+void HttpClientPool::start(Connection* connection, const Job& job) {
+    connection->job = job;
+    connection->busy = true;
+    connection->buffer.clear();
+    connection->elapsed.start();
+    connection->connectedAt = -1;
+    connection->encryptedAt = -1;
+    connection->firstByteAt = -1;
+    connection->timeout->start();
+    connection->socket->write(job.request);
+}
+
+void HttpClientPool::onReadyRead(Connection* connection) {
+    connection->buffer.append(connection->socket->readAll());
+    if (!connection->busy) {
+        // Nothing was asked; whatever an idle connection sends is meaningless
+        connection->buffer.clear();
+        return;
+    }
+    connection->timeout->start();
+    if (connection->firstByteAt < 0) {
+        connection->firstByteAt = connection->elapsed.nsecsElapsed();
+    }
+
+    forever {
+        const qint64 length = HttpMessageIndex::messageLength(connection->buffer, false, connection->job.head, false);
+        if (length < 0) {
+            complete(connection, QByteArray(), "Response is not HTTP/1.x", false);
+            return;
+        }
+        if (length == 0) return;
+
+        QByteArray response = connection->buffer.left(length);
+        connection->buffer.remove(0, length);
+        HttpMessageIndex index = HttpMessageIndex::parse(response);
+        if (index.status() / 100 == 1 && index.status() != 101) {
+            continue; // 100 Continue and other interim responses precede the real one
+        }
+        if (index.status() == 429 || index.status() == 503) {
+            OutboundScheduler::instance().reportOverload(connection->target.host, index.header(response, "retry-after"));
+        }
+        complete(connection, response, QString(), keepsAlive(connection->job.request, response, index));
+        return;
+    }
+}
+
+void HttpClientPool::onClosed(Connection* connection, const QString& error) {
+    if (!connection->busy) {
+        // The server closed a pooled connection
+        m_hosts[connection->target].idle.removeOne(connection);
+        drop(connection);
+        schedule();
+        return;
+    }
+
+    if (error.isEmpty() && !connection->buffer.isEmpty()) {
+        // A response without framing ends with the connection
+        const qint64 length = HttpMessageIndex::messageLength(connection->buffer, false, connection->job.head, true);
+        if (length > 0) {
+            complete(connection, connection->buffer.left(length), QString(), false);
+            return;
+        }
+    }
+
+    if (connection->reused && connection->buffer.isEmpty() && !connection->job.retried) {
+        // Keep-alive race: the server gave up on the connection as we reused it
+        Job job = connection->job;
+        job.retried = true;
+        drop(connection);
+        m_hosts[job.target].queue.prepend(job);
+        if (!m_order.contains(job.target)) {
+            m_order.append(job.target);
+        }
+        schedule();
+        return;
+    }
+
+    complete(connection, QByteArray(), error.isEmpty() ? QString("Connection closed before a complete response") : error,
+             false);
+}
+
+void HttpClientPool::complete(Connection* connection, const QByteArray& response, const QString& error, bool keepAlive) {
+    const Job job = connection->job;
+    const qint64 elapsed = connection->elapsed.nsecsElapsed();
+    Timing timing;
+    const qint64 connected = qMax<qint64>(connection->connectedAt, 0);
+    const qint64 handshaken = qMax(connected, connection->encryptedAt);
+    const qint64 firstByte = connection->firstByteAt < 0 ? elapsed : connection->firstByteAt;
+    timing.connect = connected;
+    timing.tls = handshaken - connected;
+    timing.firstByte = qMax<qint64>(firstByte - handshaken, 0);
+    timing.transfer = elapsed - firstByte;
+    connection->job = Job();
+    connection->busy = false;
+    connection->reused = true;
+    connection->timeout->stop();
+    if (keepAlive && connection->socket->state() == QAbstractSocket::ConnectedState) {
+        m_hosts[connection->target].idle.append(connection);
+    } else {
+        drop(connection);
+    }
+
+    --m_pending;
+    emit timing(job.id, timing);
+    emit finished(job.id, response, elapsed, error);
+    schedule();
+}
+
+void HttpClientPool::drop(Connection* connection) {
+    connection->socket->disconnect(this);
+    connection->timeout->disconnect(this);
+    connection->socket->abort();
+    connection->socket->deleteLater();
+    m_connections.removeOne(connection);
+    auto host = m_hosts.find(connection->target);
+    if (host != m_hosts.end()) {
+        host->open--;
+        host->idle.removeOne(connection);
+    }
+    delete connection;
+}
@@ -0,0 +1,128 @@
+#ifndef HTTPCLIENTPOOL_H
+#define HTTPCLIENTPOOL_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+
+class QSslSocket;
+class QTimer;
+
+struct HttpTarget {
+    QString host;
+    quint16 port = 443;
+    bool tls = true;
+
+    bool operator==(const HttpTarget& other) const {
+        return port == other.port && tls == other.tls && host == other.host;
+    }
+};
+
+inline size_t qHash(const HttpTarget& target, size_t seed = 0) {
+    return qHashMulti(seed, target.host, target.port, target.tls);
+}
+
+// Sends raw HTTP/1.1 requests exactly as stored and reads back the raw
+// responses, over keep-alive connections pooled per target. One request is
+// in flight per connection (no pipelining). Requests beyond the global or
+// per-host connection limit wait in a per-host queue, and hosts take turns
+// so one busy host can't starve the rest. Each pool is also a job of the
+// OutboundScheduler, which has the last word on when a request may leave;
+// held back requests stay queued until it says to ask again. Everything
+// runs on the owning thread's event loop.
+class HttpClientPool : public QObject {
+    Q_OBJECT
+
+public:
+    // Where a request's time went, in nanoseconds. connect and tls are zero
+    // on a pooled connection; transfer runs from the first response byte to
+    // the last.
+    struct Timing {
+        qint64 connect = 0;
+        qint64 tls = 0;
+        qint64 firstByte = 0; // From the request being written, or the handshake ending
+        qint64 transfer = 0;
+    };
+
+    explicit HttpClientPool(QObject* parent = nullptr);
+    ~HttpClientPool();
+
+    void setMaxConnections(int count) { m_maxConnections = qMax(1, count); }
+    void setMaxConnectionsPerHost(int count) { m_maxPerHost = qMax(1, count); }
+    // No bytes for this long fails the request
+    void setTimeout(int milliseconds) { m_timeout = milliseconds; }
+    // Off by default: replayed traffic usually goes to test hosts with self-signed certificates
+    void setVerifyPeer(bool verify) { m_verifyPeer = verify; }
+
+    // id comes back with the response in finished()
+    void send(quint64 id, const HttpTarget& target, const QByteArray& request);
+    // Drops queued requests and closes every connection; nothing more is reported
+    void abort();
+    int pendingCount() const { return m_pending; }
+
+signals:
+    // error is empty on success; elapsed runs from handing the request to a
+    // connection to the last response byte, in nanoseconds, so it includes
+    // connecting and the TLS handshake when no pooled connection was free
+    void finished(quint64 id, const QByteArray& response, qint64 elapsed, const QString& error);
+    // Emitted just before finished() for the same request
+    void timing(quint64 id, const HttpClientPool::Timing& timing);
+
+private:
+    struct Job {
+        quint64 id = 0;
+        HttpTarget target;
+        QByteArray request;
+        bool head = false;
+        bool retried = false;
+    };
+
+    struct Connection {
+        QSslSocket* socket = nullptr;
+        HttpTarget target;
+        Job job;
+        bool busy = false;
+        bool reused = false; // Has served a request before; a close before any reply means retry
+        QByteArray buffer;
+        QElapsedTimer elapsed;
+        qint64 connectedAt = -1; // ns into elapsed; -1 until it happens
+        qint64 encryptedAt = -1;
+        qint64 firstByteAt = -1;
+        QTimer* timeout = nullptr; // Owned by the socket
+    };
+
+    struct Host {
+        QQueue<Job> queue;
+        QList<Connection*> idle;
+        int open = 0;
+    };
+
+    void schedule();
+    // Whether the scheduler lets a request to target go now; arms m_wake if not
+    bool admit(const HttpTarget& target);
+    Connection* openConnection(const HttpTarget& target);
+    bool hasIdleConnection() const;
+    bool closeIdleConnection();
+    void start(Connection* connection, const Job& job);
+    void onReadyRead(Connection* connection);
+    void onClosed(Connection* connection, const QString& error);
+    void complete(Connection* connection, const QByteArray& response, const QString& error, bool keepAlive);
+    void drop(Connection* connection);
+
+    QHash<HttpTarget, Host> m_hosts;
+    QList<HttpTarget> m_order; // Round-robin order of hosts with queued requests
+    QList<Connection*> m_connections;
+    QTimer* m_wake; // Retries hosts the scheduler held back
+    int m_job;
+    int m_pending;
+    int m_maxConnections;
+    int m_maxPerHost;
+    int m_timeout;
+    bool m_verifyPeer;
+};
+
+#endif // HTTPCLIENTPOOL_H
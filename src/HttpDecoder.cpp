@@ -0,0 +1,181 @@
+#include "HttpDecoder.h"
+#include <QList>
+#include <zlib.h>
+
+namespace HttpDecoder {
+
+namespace {
+    QList<QByteArray> codings(QByteArrayView value) {
+        QList<QByteArray> result;
+        for (const QByteArray& token : value.toByteArray().split(',')) {
+            QByteArray coding = token.trimmed().toLower();
+            if (!coding.isEmpty()) {
+                result.append(coding);
+            }
+        }
+        return result;
+    }
+}
+
+QByteArray dechunk(QByteArrayView body, bool* ok) {
+    QByteArray result;
+    result.reserve(body.size());
+    qsizetype pos = 0;
+    bool complete = false;
+
+    while (pos < body.size()) {
+        qsizetype lineEnd = body.indexOf('\n', pos);
+        if (lineEnd < 0) break;
+
+        // Chunk size, optionally followed by ";extension"
+        QByteArrayView sizeLine = body.sliced(pos, lineEnd - pos);
+        qsizetype extension = sizeLine.indexOf(';');
+        if (extension >= 0) sizeLine = sizeLine.first(extension);
+        bool validSize = false;
+        qlonglong size = sizeLine.trimmed().toLongLong(&validSize, 16);
+        if (!validSize || size < 0) break;
+
+        pos = lineEnd + 1;
+        if (size == 0) {
+            complete = true; // Trailers, if any, are dropped
+            break;
+        }
+        if (size > body.size() - pos || result.size() + size > MaxDecodedSize) {
+            // Truncated capture: keep what we have
+            result.append(body.sliced(pos));
+            break;
+        }
+        result.append(body.sliced(pos, size));
+        pos += size;
+        if (pos < body.size() && body[pos] == '\r') ++pos;
+        if (pos < body.size() && body[pos] == '\n') ++pos;
+    }
+
+    if (ok) *ok = complete;
+    return result;
+}
+
+QByteArray inflate(QByteArrayView body, bool* ok) {
+    // 15 + 32 auto-detects zlib and gzip headers; some servers send raw deflate instead
+    for (int windowBits : {15 + 32, -15}) {
+        z_stream stream = {};
+        if (inflateInit2(&stream, windowBits) != Z_OK) break;
+
+        QByteArray result;
+        result.resize(qMin<qsizetype>(qMax<qsizetype>(body.size() * 4, 4096), MaxDecodedSize));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+        stream.avail_in = static_cast<uInt>(body.size());
+
+        int status = Z_OK;
+        qsizetype written = 0;
+        while (status == Z_OK || status == Z_BUF_ERROR) {
+            if (written == result.size()) {
+                if (result.size() >= MaxDecodedSize) break;
+                result.resize(qMin(result.size() * 2, MaxDecodedSize));
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(result.data() + written);
+            stream.avail_out = static_cast<uInt>(result.size() - written);
+            status = ::inflate(&stream, Z_NO_FLUSH);
+            written = result.size() - stream.avail_out;
+
+            if (status == Z_STREAM_END && stream.avail_in > 0) {
+                // Concatenated gzip members
+                inflateReset(&stream);
+                status = Z_OK;
+            } else if (status == Z_BUF_ERROR && stream.avail_in == 0) {
+                break; // Truncated input; keep what was inflated
+            }
+        }
+        inflateEnd(&stream);
+
+        if (written > 0 || status == Z_STREAM_END) {
+            result.truncate(written);
+            if (ok) *ok = status == Z_STREAM_END;
+            return result;
+        }
+    }
+
+    if (ok) *ok = false;
+    return QByteArray();
+}
+
+QByteArray decode(const QByteArray& raw, QStringList* applied) {
+    return decode(raw, HttpMessageIndex::parse(raw), applied);
+}
+
+QByteArray decode(const QByteArray& raw, const HttpMessageIndex& index, QStringList* applied) {
+    if (!index.isHeaderComplete()) return raw;
+
+    QByteArrayView data(raw);
+    QList<QByteArray> transferCodings;
+    QList<QByteArray> contentCodings;
+    for (const HttpMessageIndex::Header& header : index.headers()) {
+        QByteArrayView name = HttpMessageIndex::view(data, header.name);
+        if (HttpMessageIndex::nameEquals(name, "transfer-encoding")) {
+            transferCodings += codings(HttpMessageIndex::view(data, header.value));
+        } else if (HttpMessageIndex::nameEquals(name, "content-encoding")) {
+            contentCodings += codings(HttpMessageIndex::view(data, header.value));
+        }
+    }
+
+    if (transferCodings.isEmpty() && contentCodings.isEmpty()) return raw;
+
+    QStringList steps;
+    QByteArray decodedBody = index.body(data).toByteArray();
+    bool transferDecoded = false;
+    if (transferCodings.contains("chunked")) {
+        decodedBody = dechunk(decodedBody);
+        transferDecoded = true;
+        steps << "chunked";
+    }
+
+    // Content codings are listed in the order they were applied
+    while (!contentCodings.isEmpty()) {
+        const QByteArray& coding = contentCodings.last();
+        if (coding == "identity") {
+            contentCodings.removeLast();
+            continue;
+        }
+        if (coding != "gzip" && coding != "x-gzip" && coding != "deflate") {
+            break; // br, zstd, ...: leave the remaining codings in place
+        }
+        bool ok = false;
+        QByteArray inflated = inflate(decodedBody, &ok);
+        if (inflated.isEmpty() && !decodedBody.isEmpty()) {
+            break;
+        }
+        decodedBody = inflated;
+        steps << QString::fromLatin1(coding);
+        contentCodings.removeLast();
+    }
+
+    if (steps.isEmpty()) return raw;
+
+    // Rebuild the head so the framing headers describe the decoded body
+    const QByteArrayView eol = index.lineEnding();
+    QByteArray result;
+    result.reserve(index.bodyOffset() + decodedBody.size() + 32);
+    result.append(index.startLine(data)).append(eol);
+    for (const HttpMessageIndex::Header& header : index.headers()) {
+        QByteArrayView name = HttpMessageIndex::view(data, header.name);
+        if (HttpMessageIndex::nameEquals(name, "content-length")) continue;
+        if (transferDecoded && HttpMessageIndex::nameEquals(name, "transfer-encoding")) continue;
+        if (HttpMessageIndex::nameEquals(name, "content-encoding")) {
+            // Re-emit only the codings we could not remove, once
+            if (!contentCodings.isEmpty()) {
+                result.append("Content-Encoding: ").append(contentCodings.join(", ")).append(eol);
+                contentCodings.clear();
+            }
+            continue;
+        }
+        result.append(HttpMessageIndex::view(data, header.line)).append(eol);
+    }
+    result.append("Content-Length: ").append(QByteArray::number(decodedBody.size())).append(eol);
+    result.append(eol);
+    result.append(decodedBody);
+
+    if (applied) *applied = steps;
+    return result;
+}
+
+} // namespace HttpDecoder
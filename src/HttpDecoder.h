@@ -0,0 +1,28 @@
+#ifndef HTTPDECODER_H
+#define HTTPDECODER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QStringList>
+#include "HttpMessageIndex.h"
+
+// Produces a readable copy of a raw HTTP/1.x message: chunked transfer
+// coding is removed, gzip/deflate content coding is inflated, and the
+// framing headers are rewritten to match. The input is never modified.
+namespace HttpDecoder {
+
+// Decoding stops here so a hostile response can't exhaust memory
+constexpr qsizetype MaxDecodedSize = 256 * 1024 * 1024;
+
+// Returns raw itself (sharing its data) when there is nothing to decode.
+// applied receives the codings that were removed, e.g. {"chunked", "gzip"}.
+QByteArray decode(const QByteArray& raw, QStringList* applied = nullptr);
+// Same, reusing an index already built over raw
+QByteArray decode(const QByteArray& raw, const HttpMessageIndex& index, QStringList* applied = nullptr);
+
+QByteArray dechunk(QByteArrayView body, bool* ok = nullptr);
+QByteArray inflate(QByteArrayView body, bool* ok = nullptr);
+
+} // namespace HttpDecoder
+
+#endif // HTTPDECODER_H
@@ -0,0 +1,241 @@
+#include "HttpMessageIndex.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    inline char lower(char c) {
+        return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+    }
+
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    HttpMessageIndex::Span trimmedSpan(QByteArrayView data, qsizetype start, qsizetype end) {
+        while (start < end && isSpace(data[start])) ++start;
+        while (end > start && isSpace(data[end - 1])) --end;
+        return {quint32(start), quint32(end - start)};
+    }
+
+    bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    // Methods are tokens; this keeps pasted bodies from parsing as requests
+    bool isMethod(QByteArrayView method) {
+        if (method.isEmpty()) return false;
+        for (char c : method) {
+            if (!((c >= 'A' && c <= 'Z') || c == '-' || c == '_')) return false;
+        }
+        return true;
+    }
+
+    qint64 chunkedLength(QByteArrayView data, qsizetype pos) {
+        forever {
+            qsizetype lineEnd = data.indexOf('\n', pos);
+            if (lineEnd < 0) return 0;
+            QByteArray sizeText = data.sliced(pos, lineEnd - pos).toByteArray();
+            qsizetype extension = sizeText.indexOf(';');
+            if (extension >= 0) sizeText.truncate(extension);
+            bool ok = false;
+            qint64 size = sizeText.trimmed().toLongLong(&ok, 16);
+            if (!ok || size < 0) return -1;
+            pos = lineEnd + 1;
+
+            if (size == 0) {
+                // Optional trailers, then an empty line
+                forever {
+                    lineEnd = data.indexOf('\n', pos);
+                    if (lineEnd < 0) return 0;
+                    bool empty = lineEnd == pos || (lineEnd == pos + 1 && data[pos] == '\r');
+                    pos = lineEnd + 1;
+                    if (empty) return pos;
+                }
+            }
+
+            if (size > data.size() - pos) return 0;
+            pos += size;
+            if (pos >= data.size()) return 0;
+            if (data[pos] == '\r' && ++pos >= data.size()) return 0;
+            if (data[pos] != '\n') return -1;
+            ++pos;
+        }
+    }
+}
+
+bool HttpMessageIndex::nameEquals(QByteArrayView a, QByteArrayView b) {
+    if (a.size() != b.size()) return false;
+    for (qsizetype i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+quint32 HttpMessageIndex::hashName(QByteArrayView name) {
+    // FNV-1a over ASCII-lowercased bytes
+    quint32 hash = 2166136261u;
+    for (char c : name) {
+        hash ^= quint8(lower(c));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+HttpMessageIndex HttpMessageIndex::parse(QByteArrayView data) {
+    HttpMessageIndex index;
+    const qsizetype size = qMin<qsizetype>(data.size(), std::numeric_limits<qint32>::max());
+    qsizetype pos = 0;
+
+    // Tolerate stray blank lines before the start line
+    while (pos < size && (data[pos] == '\r' || data[pos] == '\n')) ++pos;
+    if (pos >= size) return index;
+
+    qsizetype lineEnd = data.indexOf('\n', pos);
+    if (lineEnd < 0) lineEnd = size;
+    index.m_crlf = lineEnd > pos && data[lineEnd - 1] == '\r';
+    qsizetype contentEnd = index.m_crlf ? lineEnd - 1 : lineEnd;
+    index.m_startLine = {quint32(pos), quint32(contentEnd - pos)};
+
+    // Start line: "HTTP/1.1 200 OK" or "GET /path HTTP/1.1"
+    qsizetype first = data.indexOf(' ', pos);
+    if (first < 0 || first > contentEnd) first = contentEnd;
+    if (data.sliced(pos, first - pos).startsWith("HTTP/")) {
+        index.m_request = false;
+        index.m_version = {quint32(pos), quint32(first - pos)};
+        qsizetype codeStart = first + 1;
+        if (codeStart + 3 <= contentEnd && isDigit(data[codeStart]) && isDigit(data[codeStart + 1]) &&
+            isDigit(data[codeStart + 2])) {
+            index.m_status = (data[codeStart] - '0') * 100 + (data[codeStart + 1] - '0') * 10 + (data[codeStart + 2] - '0');
+            index.m_reason = trimmedSpan(data, codeStart + 3, contentEnd);
+            index.m_valid = true;
+        }
+    } else {
+        index.m_request = true;
+        index.m_method = {quint32(pos), quint32(first - pos)};
+        qsizetype targetStart = first + 1;
+        qsizetype second = targetStart < contentEnd ? data.indexOf(' ', targetStart) : -1;
+        if (second < 0 || second > contentEnd) second = contentEnd;
+        if (targetStart < second) {
+            index.m_target = {quint32(targetStart), quint32(second - targetStart)};
+            index.m_version = trimmedSpan(data, qMin(second + 1, contentEnd), contentEnd);
+            index.m_valid = isMethod(view(data, index.m_method));
+        }
+    }
+
+    // Header block up to the first empty line
+    pos = lineEnd + 1;
+    while (pos <= size) {
+        if (pos == size) {
+            break; // Message ends without the blank line
+        }
+        lineEnd = data.indexOf('\n', pos);
+        if (lineEnd < 0) lineEnd = size;
+        contentEnd = (lineEnd > pos && data[lineEnd - 1] == '\r') ? lineEnd - 1 : lineEnd;
+
+        if (contentEnd == pos) {
+            index.m_bodyOffset = qMin(lineEnd + 1, size);
+            break;
+        }
+
+        if (isSpace(data[pos]) && !index.m_headers.isEmpty()) {
+            // Obsolete line folding continues the previous value
+            Header& previous = index.m_headers.last();
+            qsizetype valueEnd = contentEnd;
+            while (valueEnd > pos && isSpace(data[valueEnd - 1])) --valueEnd;
+            previous.value.length = quint32(valueEnd - previous.value.offset);
+            previous.line.length = quint32(contentEnd - previous.line.offset);
+        } else if (index.m_headers.size() < std::numeric_limits<qint16>::max()) {
+            qsizetype colon = data.indexOf(':', pos);
+            if (colon > pos && colon < contentEnd) {
+                Header header;
+                header.name = trimmedSpan(data, pos, colon);
+                header.value = trimmedSpan(data, colon + 1, contentEnd);
+                header.line = {quint32(pos), quint32(contentEnd - pos)};
+                index.m_headers.append(header);
+            }
+        }
+        pos = lineEnd + 1;
+    }
+
+    index.buildTable(data);
+    return index;
+}
+
+void HttpMessageIndex::buildTable(QByteArrayView data) {
+    int capacity = 8;
+    while (capacity < m_headers.size() * 2) capacity <<= 1;
+    m_table.resize(capacity);
+    std::fill(m_table.begin(), m_table.end(), qint16(0));
+
+    const quint32 mask = quint32(capacity - 1);
+    for (int i = 0; i < m_headers.size(); ++i) {
+        QByteArrayView name = view(data, m_headers[i].name);
+        quint32 slot = hashName(name) & mask;
+        while (m_table[slot] != 0) {
+            // Keep only the first occurrence of repeated headers
+            if (nameEquals(view(data, m_headers[m_table[slot] - 1].name), name)) break;
+            slot = (slot + 1) & mask;
+        }
+        if (m_table[slot] == 0) {
+            m_table[slot] = qint16(i + 1);
+        }
+    }
+}
+
+int HttpMessageIndex::headerIndex(QByteArrayView data, QByteArrayView name) const {
+    if (m_table.isEmpty()) return -1;
+    const quint32 mask = quint32(m_table.size() - 1);
+    quint32 slot = hashName(name) & mask;
+    while (m_table[slot] != 0) {
+        int index = m_table[slot] - 1;
+        if (nameEquals(view(data, m_headers[index].name), name)) return index;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+QByteArrayView HttpMessageIndex::header(QByteArrayView data, QByteArrayView name) const {
+    int index = headerIndex(data, name);
+    return index >= 0 ? view(data, m_headers[index].value) : QByteArrayView();
+}
+
+QByteArrayView HttpMessageIndex::body(QByteArrayView data) const {
+    if (m_bodyOffset < 0 || m_bodyOffset > data.size()) return QByteArrayView();
+    return data.sliced(m_bodyOffset);
+}
+
+qint64 HttpMessageIndex::messageLength(QByteArrayView data, bool request, bool headRequest, bool closed) {
+    if (data.isEmpty()) return 0;
+    // Cheap rejection of TLS and other protocols before any parsing
+    if (request) {
+        if (data[0] < 'A' || data[0] > 'Z') return -1;
+    } else if (!QByteArrayView("HTTP/").startsWith(data.first(qMin<qsizetype>(data.size(), 5)))) {
+        return -1;
+    }
+
+    QByteArrayView headerView = data.first(qMin(data.size(), MaxHeaderBytes));
+    HttpMessageIndex index = HttpMessageIndex::parse(headerView);
+    if (!index.isHeaderComplete()) return data.size() >= MaxHeaderBytes ? -1 : 0;
+    if (!index.isValid() || index.isRequest() != request) return -1;
+
+    const qint64 bodyStart = index.bodyOffset();
+    if (!request) {
+        int status = index.status();
+        if (headRequest || status / 100 == 1 || status == 204 || status == 304) return bodyStart;
+    }
+
+    QByteArrayView transferEncoding = index.header(headerView, "transfer-encoding");
+    if (!transferEncoding.isEmpty() && transferEncoding.toByteArray().toLower().contains("chunked")) {
+        return chunkedLength(data, bodyStart);
+    }
+    QByteArrayView contentLength = index.header(headerView, "content-length");
+    if (!contentLength.isEmpty()) {
+        bool ok = false;
+        qint64 length = contentLength.toByteArray().trimmed().toLongLong(&ok);
+        if (!ok || length < 0) return -1;
+        return data.size() - bodyStart >= length ? bodyStart + length : 0;
+    }
+    if (request) return bodyStart;
+    // No framing: the response runs until the server closes
+    return closed ? data.size() : 0;
+}
@@ -0,0 +1,80 @@
+#ifndef HTTPMESSAGEINDEX_H
+#define HTTPMESSAGEINDEX_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+#include <QVarLengthArray>
+
+// Compact index over a raw HTTP/1.x message. Every field is an offset/length
+// pair into the bytes it was built from, so parsing copies nothing and any
+// header can be looked up by name in O(1) through a small case-insensitive
+// hash table. Keep the QByteArray alive alongside the index.
+class HttpMessageIndex {
+public:
+    struct Span {
+        quint32 offset = 0;
+        quint32 length = 0;
+        bool isEmpty() const { return length == 0; }
+    };
+
+    struct Header {
+        Span name;
+        Span value;
+        Span line; // Whole header line without its terminator
+    };
+
+    static HttpMessageIndex parse(QByteArrayView data);
+
+    bool isValid() const { return m_valid; }
+    bool isRequest() const { return m_request; }
+    bool isResponse() const { return m_valid && !m_request; }
+    // False when the blank line ending the header block was never seen
+    bool isHeaderComplete() const { return m_bodyOffset >= 0; }
+
+    QByteArrayView method(QByteArrayView data) const { return view(data, m_method); }
+    QByteArrayView target(QByteArrayView data) const { return view(data, m_target); }
+    QByteArrayView version(QByteArrayView data) const { return view(data, m_version); }
+    QByteArrayView reason(QByteArrayView data) const { return view(data, m_reason); }
+    QByteArrayView startLine(QByteArrayView data) const { return view(data, m_startLine); }
+    int status() const { return m_status; }
+
+    const QVector<Header>& headers() const { return m_headers; }
+    // First header with this name (case-insensitive), or -1
+    int headerIndex(QByteArrayView data, QByteArrayView name) const;
+    QByteArrayView header(QByteArrayView data, QByteArrayView name) const;
+    bool hasHeader(QByteArrayView data, QByteArrayView name) const { return headerIndex(data, name) >= 0; }
+
+    qsizetype bodyOffset() const { return m_bodyOffset; }
+    QByteArrayView body(QByteArrayView data) const;
+    // Line terminator used by the header block
+    QByteArrayView lineEnding() const { return m_crlf ? QByteArrayView("\r\n") : QByteArrayView("\n"); }
+
+    // Length of the complete message at the start of a byte stream: 0 while
+    // more bytes are needed, -1 when the stream isn't HTTP/1.x. headRequest
+    // says the response answers a HEAD; closed that no more bytes will come.
+    static qint64 messageLength(QByteArrayView data, bool request, bool headRequest, bool closed);
+    static constexpr qsizetype MaxHeaderBytes = 64 * 1024;
+
+    static QByteArrayView view(QByteArrayView data, Span span) { return data.sliced(span.offset, span.length); }
+    static bool nameEquals(QByteArrayView a, QByteArrayView b);
+
+private:
+    static quint32 hashName(QByteArrayView name);
+    void buildTable(QByteArrayView data);
+
+    bool m_valid = false;
+    bool m_request = false;
+    bool m_crlf = true;
+    int m_status = 0;
+    Span m_startLine;
+    Span m_method;
+    Span m_target;
+    Span m_version;
+    Span m_reason;
+    QVector<Header> m_headers;
+    QVarLengthArray<qint16, 64> m_table; // Open addressing: header index + 1, 0 = empty
+    qsizetype m_bodyOffset = -1;
+};
+
+#endif // HTTPMESSAGEINDEX_H
@@ -10,56 +10,82 @@ HttpSyntaxHighlighter::HttpSyntaxHighlighter(QTextDocument* parent)
     HighlightingRule rule;
     rule.pattern = QRegularExpression("\\b(GET|POST|PUT|DELETE|PATCH|HEAD|OPTIONS)\\b", QRegularExpression::CaseInsensitiveOption);
     rule.format = methodFormat;
-    highlightingRules.append(rule);
+    startLineRules.append(rule);
 
-    // HTTP Headers format
+    // HTTP Headers format (names are found by the colon, no pattern needed)
     headerFormat.setForeground(QColor(50, 150, 200));
-    rule.pattern = QRegularExpression("^([A-Za-z-]+):\\s*");
-    rule.format = headerFormat;
-    highlightingRules.append(rule);
 
     // URL format
     urlFormat.setForeground(QColor(100, 150, 200));
     urlFormat.setUnderlineStyle(QTextCharFormat::SingleUnderline);
     rule.pattern = QRegularExpression("(https?://[^\\s]+|/[^\\s]*)");
     rule.format = urlFormat;
-    highlightingRules.append(rule);
+    startLineRules.append(rule);
 
     // HTTP Status codes
     statusFormat.setForeground(QColor(200, 100, 50));
     statusFormat.setFontWeight(QFont::Bold);
     rule.pattern = QRegularExpression("\\b(HTTP/[0-9.]+\\s+[0-9]{3})\\b");
     rule.format = statusFormat;
-    highlightingRules.append(rule);
+    startLineRules.append(rule);
 
     // JSON keys
     jsonKeyFormat.setForeground(QColor(150, 100, 200));
     rule.pattern = QRegularExpression("\"([^\"]+)\"\\s*:");
     rule.format = jsonKeyFormat;
-    highlightingRules.append(rule);
+    bodyRules.append(rule);
 
     // JSON strings
     jsonStringFormat.setForeground(QColor(50, 200, 100));
     rule.pattern = QRegularExpression(":\\s*\"([^\"]*)\"");
     rule.format = jsonStringFormat;
-    highlightingRules.append(rule);
+    bodyRules.append(rule);
 
     // JSON numbers
     jsonNumberFormat.setForeground(QColor(200, 150, 50));
     rule.pattern = QRegularExpression(":\\s*(-?\\d+\\.?\\d*)");
     rule.format = jsonNumberFormat;
-    highlightingRules.append(rule);
+    bodyRules.append(rule);
 
     // Comments
     commentFormat.setForeground(QColor(100, 100, 100));
     commentFormat.setFontItalic(true);
     rule.pattern = QRegularExpression("//.*$");
     rule.format = commentFormat;
-    highlightingRules.append(rule);
+    bodyRules.append(rule);
 }
 
 void HttpSyntaxHighlighter::highlightBlock(const QString& text) {
-    for (const HighlightingRule& rule : highlightingRules) {
+    int state = previousBlockState();
+    if (state < 0) state = StartLine;
+
+    switch (state) {
+    case StartLine:
+        // Stray blank lines before the start line keep us here
+        if (!text.isEmpty() && text != QLatin1String("\r")) {
+            applyRules(startLineRules, text);
+            state = Headers;
+        }
+        break;
+    case Headers:
+        if (text.isEmpty() || text == QLatin1String("\r")) {
+            state = Body;
+        } else if (text.at(0) != QLatin1Char(' ') && text.at(0) != QLatin1Char('\t')) {
+            qsizetype colon = text.indexOf(QLatin1Char(':'));
+            if (colon > 0) {
+                setFormat(0, colon + 1, headerFormat);
+            }
+        }
+        break;
+    default:
+        applyRules(bodyRules, text);
+        break;
+    }
+    setCurrentBlockState(state);
+}
+
+void HttpSyntaxHighlighter::applyRules(const QVector<HighlightingRule>& rules, const QString& text) {
+    for (const HighlightingRule& rule : rules) {
         QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
         while (matchIterator.hasNext()) {
             QRegularExpressionMatch match = matchIterator.next();
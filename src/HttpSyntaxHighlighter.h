@@ -19,7 +19,13 @@ private:
         QRegularExpression pattern;
         QTextCharFormat format;
     };
-    QVector<HighlightingRule> highlightingRules;
+    // Block states: which part of the message a line belongs to
+    enum State { StartLine = 0, Headers = 1, Body = 2 };
+
+    void applyRules(const QVector<HighlightingRule>& rules, const QString& text);
+
+    QVector<HighlightingRule> startLineRules;
+    QVector<HighlightingRule> bodyRules;
 
     QTextCharFormat methodFormat;
     QTextCharFormat headerFormat;
@@ -0,0 +1,413 @@
+#include "ImportPipeline.h"
+#include "DatabaseManager.h"
+#include "HttpMessageIndex.h"
+#include "PerfCounters.h"
+#include "RequestOrigin.h"
+#include "Trace.h"
+#include <QDateTime>
+#include <QHash>
+#include <QFuture>
+#include <QMutexLocker>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+    int twoDigits(QStringView text, int pos) {
+        QChar high = text[pos], low = text[pos + 1];
+        if (!high.isDigit() || !low.isDigit()) return -1;
+        return (high.unicode() - '0') * 10 + (low.unicode() - '0');
+    }
+}
+
+ImportPipeline::ImportPipeline(ImportSource* source, int parentDbId, QObject* parent)
+    : QObject(parent)
+    , m_source(source)
+    , m_parentDbId(parentDbId)
+    , m_duplicates(Duplicates::ImportAll)
+    , m_parser(nullptr)
+    , m_writer(nullptr)
+    , m_freeSlots(MaxBatchesInFlight)
+    , m_cancelled(false)
+    , m_errors(0)
+{
+    qRegisterMetaType<QList<OrganizerItem*>>();
+    qRegisterMetaType<QList<QPair<int, OrganizerItem*>>>();
+    // The parser and writer threads take a core each
+    m_workers.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 2));
+}
+
+ImportPipeline::~ImportPipeline() {
+    cancel();
+    if (m_parser) {
+        m_parser->wait();
+        delete m_parser;
+    }
+    if (m_writer) {
+        m_writer->wait();
+        delete m_writer;
+    }
+}
+
+void ImportPipeline::start() {
+    m_elapsed.start();
+    m_parser = QThread::create([this]() { parse(); });
+    m_writer = QThread::create([this]() { write(); });
+    m_parser->setObjectName("import parser");
+    m_writer->setObjectName("import writer");
+    m_writer->start();
+    m_parser->start();
+}
+
+void ImportPipeline::cancel() {
+    m_cancelled = true;
+}
+
+void ImportPipeline::batchConsumed() {
+    m_freeSlots.release();
+}
+
+void ImportPipeline::parse() {
+    if (!m_source->open()) {
+        m_error = m_source->errorString();
+        enqueue({QList<OrganizerItem*>(), true});
+        return;
+    }
+
+    const qint64 total = m_source->totalBytes();
+    const qint64 progressStep = qMax<qint64>(total / 1000, 1);
+    qint64 lastProgress = 0;
+    emit progress(0, total);
+
+    // Results are collected in submission order, so items keep the file's order
+    // however the workers finish; the window bounds the records held in memory
+    const int window = m_workers.maxThreadCount() * 16;
+    QQueue<QFuture<OrganizerItem*>> pending;
+    QList<OrganizerItem*> batch;
+    qint64 batchBytes = 0;
+    int errors = 0;
+    bool accepting = true;
+
+    auto collect = [&](OrganizerItem* item) {
+        if (!item) {
+            errors++;
+            return;
+        }
+        if (!accepting) {
+            delete item;
+            return;
+        }
+        batch.append(item);
+        batchBytes += item->request().size() + item->response().size();
+        if (batch.size() >= BatchSize || batchBytes >= BatchBytes) {
+            accepting = pushBatch(batch);
+            batchBytes = 0;
+        }
+    };
+
+    ImportRecord record;
+    while (accepting && !m_cancelled && m_source->next(record)) {
+        pending.enqueue(QtConcurrent::run(&m_workers, &ImportPipeline::createItem, std::move(record)));
+        record = ImportRecord();
+        while (pending.size() >= window) {
+            collect(pending.dequeue().result());
+        }
+
+        qint64 position = m_source->bytesRead();
+        if (position - lastProgress >= progressStep) {
+            lastProgress = position;
+            emit progress(position, total);
+        }
+    }
+    while (!pending.isEmpty()) {
+        collect(pending.dequeue().result());
+    }
+
+    if (accepting && !m_cancelled && !batch.isEmpty()) {
+        pushBatch(batch);
+    }
+    // Anything left was parsed after cancelling and never handed over
+    qDeleteAll(batch);
+
+    m_errors = errors;
+    if (!m_cancelled) {
+        m_error = m_source->errorString();
+    }
+    emit progress(total, total);
+    enqueue({QList<OrganizerItem*>(), true});
+}
+
+bool ImportPipeline::pushBatch(QList<OrganizerItem*>& batch) {
+    // Wait for the receiver to catch up, checking for cancellation meanwhile
+    while (!m_freeSlots.tryAcquire(1, 100)) {
+        if (m_cancelled) return false;
+    }
+    if (m_cancelled) {
+        m_freeSlots.release();
+        return false;
+    }
+    PerfCounters::pendingWrites += batch.size();
+    enqueue({batch, false});
+    batch.clear();
+    return true;
+}
+
+void ImportPipeline::enqueue(const Batch& batch) {
+    QMutexLocker locker(&m_queueMutex);
+    m_queue.enqueue(batch);
+    m_queueNotEmpty.wakeOne();
+}
+
+void ImportPipeline::write() {
+    const QString connectionName = QString("import-%1").arg(quintptr(this));
+    int imported = 0;
+    int duplicates = 0;
+    {
+        QSqlDatabase db = DatabaseManager::instance().openConnection(connectionName);
+        forever {
+            Batch batch;
+            {
+                QMutexLocker locker(&m_queueMutex);
+                while (m_queue.isEmpty()) {
+                    m_queueNotEmpty.wait(&m_queueMutex);
+                }
+                batch = m_queue.dequeue();
+            }
+            if (batch.last) break;
+            RO_TRACE("ImportPipeline::writeBatch");
+            const int queued = batch.items.size();
+
+            if (m_duplicates != Duplicates::ImportAll) {
+                QList<QPair<int, OrganizerItem*>> replacements;
+                duplicates += filterDuplicates(db, batch.items, replacements);
+                if (!replacements.isEmpty()) {
+                    if (DatabaseManager::instance().replaceItems(db, replacements)) {
+                        emit itemsReplaced(replacements);
+                    } else {
+                        for (const auto& replacement : replacements) {
+                            delete replacement.second;
+                        }
+                    }
+                }
+            }
+
+            // Items that fail to save keep dbId -1; the model saves those itself
+            DatabaseManager::instance().insertItems(db, batch.items, m_parentDbId);
+            PerfCounters::pendingWrites -= queued;
+            imported += batch.items.size();
+            emit batchReady(batch.items);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    PerfCounters::import.record(m_elapsed.nsecsElapsed());
+    PerfCounters::lastImportItems = imported;
+    // m_errors and m_error were set before the last batch was queued
+    emit finished(imported, duplicates, m_errors, m_cancelled, m_error);
+}
+
+int ImportPipeline::filterDuplicates(QSqlDatabase& db, QList<OrganizerItem*>& items,
+                                     QList<QPair<int, OrganizerItem*>>& replacements) {
+    // Hashes were computed by the workers; the lookup is one indexed query per batch
+    QList<quint64> hashes;
+    hashes.reserve(items.size());
+    for (const OrganizerItem* item : items) {
+        hashes.append(item->requestHash());
+    }
+    const QMultiHash<quint64, DatabaseManager::StoredHash> stored =
+        DatabaseManager::instance().findRequestHashes(db, hashes);
+    const bool matchResponse = m_duplicates == Duplicates::SkipExchange;
+
+    QList<OrganizerItem*> kept;
+    kept.reserve(items.size());
+    QHash<quint64, int> keptByHash; // Repeats within the batch aren't saved yet
+    int duplicates = 0;
+    for (OrganizerItem* item : std::as_const(items)) {
+        const quint64 hash = item->requestHash();
+        int existingId = -1;
+        for (auto it = stored.constFind(hash); it != stored.cend() && it.key() == hash; ++it) {
+            if (!matchResponse || it->responseHash == item->responseHash()) {
+                existingId = it->id;
+                break;
+            }
+        }
+
+        if (existingId >= 0) {
+            ++duplicates;
+            if (m_duplicates == Duplicates::Replace) {
+                replacements.append({existingId, item});
+            } else {
+                delete item;
+            }
+            continue;
+        }
+
+        const int keptIndex = keptByHash.value(hash, -1);
+        if (keptIndex >= 0 && (!matchResponse || kept[keptIndex]->responseHash() == item->responseHash())) {
+            ++duplicates;
+            if (m_duplicates == Duplicates::Replace) {
+                // The later exchange wins, in the earlier one's place
+                delete kept[keptIndex];
+                kept[keptIndex] = item;
+            } else {
+                delete item;
+            }
+            continue;
+        }
+
+        keptByHash.insert(hash, kept.size());
+        kept.append(item);
+    }
+    items = kept;
+    return duplicates;
+}
+
+OrganizerItem* ImportPipeline::createItem(const ImportRecord& record) {
+    RO_TRACE("ImportPipeline::createItem");
+    QByteArray requestData = record.requestBase64 ? QByteArray::fromBase64(record.request) : record.request;
+    QByteArray responseData = record.responseBase64 ? QByteArray::fromBase64(record.response) : record.response;
+    QString methodStr = record.method;
+    QString urlStr = record.url;
+    QString hostStr = record.host;
+    int status = record.status;
+    qint64 responseLength = record.responseLength;
+    bool guessedScheme = false;
+
+    // Fill in whatever the export left out from the messages themselves
+    if (methodStr.isEmpty() || urlStr.isEmpty() || hostStr.isEmpty()) {
+        HttpMessageIndex request = HttpMessageIndex::parse(requestData);
+        if (request.isValid() && request.isRequest()) {
+            if (methodStr.isEmpty()) {
+                methodStr = QString::fromLatin1(request.method(requestData));
+            }
+            if (hostStr.isEmpty()) {
+                hostStr = QString::fromLatin1(request.header(requestData, "host"));
+            }
+            if (urlStr.isEmpty()) {
+                QString target = QString::fromLatin1(request.target(requestData));
+                urlStr = target.startsWith('/') ? "http://" + hostStr + target : target;
+                guessedScheme = target.startsWith('/');
+            }
+        }
+    }
+    if (status == 0 || responseLength == 0) {
+        HttpMessageIndex response = HttpMessageIndex::parse(responseData);
+        if (status == 0 && response.isResponse()) {
+            status = response.status();
+        }
+        if (responseLength == 0) {
+            responseLength = responseData.size();
+        }
+    }
+
+    if (methodStr.isEmpty() || urlStr.isEmpty()) {
+        return nullptr;
+    }
+
+    // Generate name from URL and method
+    QUrl url(urlStr);
+    QString path = url.path();
+    if (path.isEmpty()) {
+        path = "/";
+    }
+    QString name = record.name;
+    if (name.isEmpty()) {
+        name = methodStr + " " + path;
+        if (name.length() > 50) {
+            name = name.left(47) + "...";
+        }
+    }
+    if (hostStr.isEmpty()) {
+        hostStr = url.host();
+    }
+    // Kept so exports don't have to guess the scheme from the Host header
+    QString scheme = record.scheme.isEmpty() && !guessedScheme ? url.scheme().toLower() : record.scheme;
+    if (!RequestOrigin::isKnownScheme(scheme)) scheme.clear();
+    int port = record.port;
+    if (port <= 0 || port > 65535) port = scheme.isEmpty() ? 0 : url.port(RequestOrigin::defaultPort(scheme));
+
+    OrganizerItem* item = new OrganizerItem(ItemType::Request, name);
+    item->setHost(hostStr);
+    item->setUrl(record.path.isEmpty() ? path : record.path);  // URL field contains only the path
+    item->setScheme(scheme);
+    item->setPort(port);
+    item->setMethod(methodStr);
+    item->setQuery(url.query());
+    item->setStatus(status);
+    item->setLength(responseLength);
+    item->setResponseTime(record.responseTime);
+    item->setAnnotation(record.comment);
+    item->setRequest(requestData);
+    item->setResponse(responseData);
+    item->setTimestamp(record.timestamp ? record.timestamp : parseTimestamp(record.time));
+    // Hashed here, in parallel, so the writer only has to look them up
+    item->requestHash();
+    item->responseHash();
+    return item;
+}
+
+qint64 ImportPipeline::parseTimestamp(const QString& time) {
+    if (time.isEmpty()) {
+        return QDateTime::currentDateTime().toSecsSinceEpoch();
+    }
+
+    // Burp writes "Tue Mar 05 14:22:11 CST 2024". Parse that by hand; trying
+    // QDateTime::fromString formats in turn dominated import time. The zone
+    // name is ignored and the time read as local, as before.
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const QList<QStringView> parts = QStringView(time).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    if ((parts.size() == 5 || parts.size() == 6) && parts[1].size() == 3 && parts[3].size() == 8) {
+        int month = 0;
+        for (int i = 0; i < 12 && month == 0; ++i) {
+            if (parts[1] == QLatin1String(months + i * 3, 3)) month = i + 1;
+        }
+        bool dayOk = false, yearOk = false;
+        int day = parts[2].toInt(&dayOk);
+        int year = parts.last().toInt(&yearOk);
+        int hour = twoDigits(parts[3], 0);
+        int minute = twoDigits(parts[3], 3);
+        int second = twoDigits(parts[3], 6);
+        QDateTime dateTime(QDate(year, month, dayOk ? day : 0), QTime(hour, minute, second));
+        if (month && yearOk && dateTime.isValid()) {
+            return dateTime.toSecsSinceEpoch();
+        }
+    }
+
+    // Try ISO format if the Burp format didn't match
+    QDateTime dateTime = QDateTime::fromString(time, Qt::ISODate);
+    // If parsing fails, use current time
+    return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : QDateTime::currentDateTime().toSecsSinceEpoch();
+}
+
+QByteArray ImportPipeline::buildRequest(const QByteArray& method, const QByteArray& url,
+                                        const QList<QPair<QByteArray, QByteArray>>& headers, const QByteArray& body) {
+    qsizetype scheme = url.indexOf("://");
+    qsizetype authorityStart = scheme < 0 ? 0 : scheme + 3;
+    qsizetype authorityEnd = authorityStart;
+    while (authorityEnd < url.size() && url[authorityEnd] != '/' && url[authorityEnd] != '?' && url[authorityEnd] != '#') {
+        ++authorityEnd;
+    }
+    QByteArray target = url.mid(authorityEnd);
+    qsizetype fragment = target.indexOf('#');
+    if (fragment >= 0) target.truncate(fragment);
+    if (target.isEmpty() || target.startsWith('?')) target.prepend('/');
+
+    QByteArray message;
+    message.reserve(target.size() + body.size() + 256);
+    message.append(method).append(' ').append(target).append(" HTTP/1.1\r\n");
+    bool hasHost = false;
+    for (const auto& header : headers) {
+        if (qstricmp(header.first.constData(), "host") == 0) hasHost = true;
+    }
+    if (!hasHost) message.append("Host: ").append(url.mid(authorityStart, authorityEnd - authorityStart)).append("\r\n");
+    for (const auto& header : headers) {
+        if (qstricmp(header.first.constData(), "content-length") == 0) continue;
+        message.append(header.first).append(": ").append(header.second).append("\r\n");
+    }
+    if (!body.isEmpty()) {
+        message.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    }
+    message.append("\r\n");
+    message.append(body);
+    return message;
+}
@@ -0,0 +1,97 @@
+#ifndef IMPORTPIPELINE_H
+#define IMPORTPIPELINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QQueue>
+#include <QSqlDatabase>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include "ImportSource.h"
+#include "OrganizerItem.h"
+
+// Imports an ImportSource in three stages: one parser thread reads records,
+// a pool of workers decodes them into items, and a single writer thread
+// saves them, in file order, on its own database connection. Saved items
+// reach the receiver in batches; at most MaxBatchesInFlight of them can be
+// waiting, so memory stays bounded no matter how large the export is.
+class ImportPipeline : public QObject {
+    Q_OBJECT
+
+public:
+    // Takes ownership of source; items are saved under parentDbId (-1 for the root)
+    ImportPipeline(ImportSource* source, int parentDbId, QObject* parent = nullptr);
+    ~ImportPipeline();
+
+    // What to do with records whose raw request is already in the project
+    enum class Duplicates {
+        ImportAll,      // Import everything as new items
+        SkipRequest,    // Skip when the request matches a saved one
+        SkipExchange,   // Skip only when the response matches too
+        Replace         // Overwrite the saved exchange in place
+    };
+
+    static const int BatchSize = 250;
+    static const qint64 BatchBytes = 32 * 1024 * 1024;
+    static const int MaxBatchesInFlight = 2;
+
+    // Call before start()
+    void setDuplicates(Duplicates duplicates) { m_duplicates = duplicates; }
+    void start();
+    // Both are safe to call from any thread
+    void cancel();
+    void batchConsumed();
+
+    // Worker stage: decodes bodies and fills every field; null if unusable
+    static OrganizerItem* createItem(const ImportRecord& record);
+    static qint64 parseTimestamp(const QString& time);
+    // Synthesizes an HTTP/1.1 request for url with an origin-form target,
+    // adding Host when missing and Content-Length for a body
+    static QByteArray buildRequest(const QByteArray& method, const QByteArray& url,
+                                   const QList<QPair<QByteArray, QByteArray>>& headers, const QByteArray& body);
+
+signals:
+    // Items are already saved; the receiver takes ownership and must call batchConsumed()
+    void batchReady(const QList<OrganizerItem*>& items);
+    // Saved ids whose exchange was overwritten, each with the imported item
+    // holding the new data; the receiver takes ownership of the items
+    void itemsReplaced(const QList<QPair<int, OrganizerItem*>>& replacements);
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void finished(int imported, int duplicates, int errors, bool cancelled, const QString& error);
+
+private:
+    struct Batch {
+        QList<OrganizerItem*> items;
+        bool last = false;
+    };
+
+    void parse();
+    void write();
+    bool pushBatch(QList<OrganizerItem*>& batch);
+    void enqueue(const Batch& batch);
+    int filterDuplicates(QSqlDatabase& db, QList<OrganizerItem*>& items, QList<QPair<int, OrganizerItem*>>& replacements);
+
+    std::unique_ptr<ImportSource> m_source;
+    int m_parentDbId;
+    Duplicates m_duplicates;
+    QThreadPool m_workers;
+    QThread* m_parser;
+    QThread* m_writer;
+    QMutex m_queueMutex;
+    QWaitCondition m_queueNotEmpty;
+    QQueue<Batch> m_queue;
+    QSemaphore m_freeSlots;
+    std::atomic_bool m_cancelled;
+    int m_errors;   // Set by the parser before it queues the last batch
+    QElapsedTimer m_elapsed;
+    QString m_error;
+};
+
+#endif // IMPORTPIPELINE_H
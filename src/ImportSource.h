@@ -0,0 +1,45 @@
+#ifndef IMPORTSOURCE_H
+#define IMPORTSOURCE_H
+
+#include <QByteArray>
+#include <QString>
+
+// One captured request as read from an export file. Sources fill in what
+// the format provides and leave the costly work (base64 decoding, timestamp
+// and URL parsing) to the import pipeline's worker threads.
+struct ImportRecord {
+    QString name;            // Generated from method and path when empty
+    QString url;
+    QString host;
+    QString method;
+    QString path;
+    QString scheme;          // "http" or "https" when the format records it apart from the URL
+    int port = 0;
+    QString comment;
+    QString time;            // Parsed when timestamp is 0
+    qint64 timestamp = 0;    // Seconds since epoch
+    int status = 0;
+    qint64 responseLength = 0;
+    qint64 responseTime = 0; // Milliseconds
+    QByteArray request;
+    QByteArray response;
+    bool requestBase64 = false;
+    bool responseBase64 = false;
+};
+
+// Sequential reader over an export. All calls happen on the import
+// pipeline's parser thread.
+class ImportSource {
+public:
+    virtual ~ImportSource() {}
+
+    virtual bool open() = 0;
+    // Fills record with the next entry; false at the end or on error
+    virtual bool next(ImportRecord& record) = 0;
+    virtual qint64 bytesRead() const = 0;
+    virtual qint64 totalBytes() const = 0;
+    // Empty unless open() or next() failed
+    virtual QString errorString() const = 0;
+};
+
+#endif // IMPORTSOURCE_H
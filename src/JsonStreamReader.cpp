@@ -0,0 +1,226 @@
+#include "JsonStreamReader.h"
+#include "TextEscapes.h"
+#include <cstring>
+
+namespace {
+    const qint64 ChunkSize = 256 * 1024;
+
+    inline bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+}
+
+JsonStreamReader::JsonStreamReader(QIODevice* device)
+    : m_device(device)
+    , m_pos(0)
+    , m_consumed(0)
+    , m_token(NoToken)
+    , m_depth(0)
+    , m_bool(false)
+    , m_skipping(false)
+{
+}
+
+bool JsonStreamReader::ensure(qsizetype count) {
+    if (m_buffer.size() - m_pos >= count) return true;
+
+    // Drop what has been parsed so the buffer never grows past one chunk plus a token's tail
+    m_consumed += m_pos;
+    m_buffer.remove(0, m_pos);
+    m_pos = 0;
+    while (m_buffer.size() < count) {
+        QByteArray chunk = m_device->read(ChunkSize);
+        if (chunk.isEmpty()) return false;
+        m_buffer.append(chunk);
+    }
+    return true;
+}
+
+JsonStreamReader::Token JsonStreamReader::fail(const QString& error) {
+    if (m_error.isEmpty()) {
+        m_error = QString("%1 at byte %2").arg(error).arg(bytesRead());
+    }
+    m_token = Invalid;
+    return m_token;
+}
+
+JsonStreamReader::Token JsonStreamReader::readNext() {
+    if (m_token == Invalid || m_token == EndDocument) return m_token;
+    if (!m_skipping) m_text.clear();
+
+    // Commas and colons only separate tokens; the token types carry the structure
+    forever {
+        if (!ensure(1)) {
+            if (m_depth > 0) return fail("Unexpected end of JSON");
+            m_token = EndDocument;
+            return m_token;
+        }
+        char c = m_buffer[m_pos];
+        if (isWhitespace(c) || c == ',' || c == ':') {
+            ++m_pos;
+            continue;
+        }
+        break;
+    }
+
+    char c = m_buffer[m_pos];
+    switch (c) {
+    case '{':
+    case '[':
+        ++m_pos;
+        ++m_depth;
+        m_token = c == '{' ? StartObject : StartArray;
+        return m_token;
+    case '}':
+    case ']':
+        ++m_pos;
+        if (--m_depth < 0) return fail("Unbalanced JSON");
+        m_token = c == '}' ? EndObject : EndArray;
+        return m_token;
+    case '"': {
+        ++m_pos;
+        if (!parseString(!m_skipping)) return fail("Unterminated JSON string");
+        // A string followed by a colon is a member name
+        m_token = String;
+        while (ensure(1) && isWhitespace(m_buffer[m_pos])) ++m_pos;
+        if (ensure(1) && m_buffer[m_pos] == ':') {
+            ++m_pos;
+            m_token = Name;
+        }
+        return m_token;
+    }
+    case 't':
+        return parseLiteral("true", Bool, true) ? m_token : fail("Invalid JSON literal");
+    case 'f':
+        return parseLiteral("false", Bool, false) ? m_token : fail("Invalid JSON literal");
+    case 'n':
+        return parseLiteral("null", Null, false) ? m_token : fail("Invalid JSON literal");
+    default:
+        break;
+    }
+
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        forever {
+            if (!ensure(1)) break;
+            char d = m_buffer[m_pos];
+            if (!((d >= '0' && d <= '9') || d == '-' || d == '+' || d == '.' || d == 'e' || d == 'E')) break;
+            if (!m_skipping) m_text.append(d);
+            ++m_pos;
+        }
+        m_token = Number;
+        return m_token;
+    }
+
+    return fail(QString("Unexpected character '%1'").arg(QChar::fromLatin1(c)));
+}
+
+bool JsonStreamReader::parseLiteral(const char* literal, Token token, bool value) {
+    qsizetype length = qsizetype(strlen(literal));
+    if (!ensure(length) || memcmp(m_buffer.constData() + m_pos, literal, length) != 0) return false;
+    m_pos += length;
+    m_token = token;
+    m_bool = value;
+    return true;
+}
+
+bool JsonStreamReader::parseString(bool keep) {
+    forever {
+        if (!ensure(1)) return false;
+
+        // Copy the plain run up to the next quote or escape in one go
+        const char* data = m_buffer.constData();
+        qsizetype end = m_pos;
+        const qsizetype size = m_buffer.size();
+        while (end < size && data[end] != '"' && data[end] != '\\') ++end;
+        if (keep) m_text.append(data + m_pos, end - m_pos);
+        m_pos = end;
+        if (end == size) continue;
+
+        if (data[end] == '"') {
+            ++m_pos;
+            return true;
+        }
+
+        // Escape sequence
+        if (!ensure(2)) return false;
+        char escape = m_buffer[m_pos + 1];
+        m_pos += 2;
+        switch (escape) {
+        case 'b': if (keep) m_text.append('\b'); break;
+        case 'f': if (keep) m_text.append('\f'); break;
+        case 'n': if (keep) m_text.append('\n'); break;
+        case 'r': if (keep) m_text.append('\r'); break;
+        case 't': if (keep) m_text.append('\t'); break;
+        case 'u': {
+            if (!ensure(4)) return false;
+            uint codePoint = 0;
+            for (int i = 0; i < 4; ++i) {
+                int digit = TextEscapes::hexValue(m_buffer[m_pos + i]);
+                if (digit < 0) return false;
+                codePoint = (codePoint << 4) | uint(digit);
+            }
+            m_pos += 4;
+            // Surrogate pair: a second \uXXXX must follow
+            if (codePoint >= 0xD800 && codePoint < 0xDC00 && ensure(6) &&
+                m_buffer[m_pos] == '\\' && m_buffer[m_pos + 1] == 'u') {
+                uint low = 0;
+                bool valid = true;
+                for (int i = 0; i < 4; ++i) {
+                    int digit = TextEscapes::hexValue(m_buffer[m_pos + 2 + i]);
+                    if (digit < 0) valid = false;
+                    low = (low << 4) | uint(qMax(digit, 0));
+                }
+                if (valid && low >= 0xDC00 && low < 0xE000) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    m_pos += 6;
+                }
+            }
+            if (codePoint >= 0xD800 && codePoint < 0xE000) codePoint = 0xFFFD; // Lone surrogate
+            if (keep) TextEscapes::appendUtf8(m_text, codePoint);
+            break;
+        }
+        default:
+            // \" \\ \/ and anything unknown stand for themselves
+            if (keep) m_text.append(escape);
+            break;
+        }
+    }
+}
+
+bool JsonStreamReader::skipValue() {
+    Token token = m_token;
+    // After a Name, the value is the next token
+    if (token == Name || token == NoToken) {
+        m_skipping = true;
+        token = readNext();
+        m_skipping = false;
+    }
+    if (token == StartObject || token == StartArray) {
+        int depth = m_depth - 1;
+        m_skipping = true;
+        while (m_depth > depth && readNext() != Invalid) {
+            if (m_token == EndDocument) break;
+        }
+        m_skipping = false;
+    }
+    m_text.clear();
+    return m_token != Invalid;
+}
+
+QByteArray JsonStreamReader::readRawString() {
+    Token token = readNext();
+    if (token == String || token == Number) return m_text;
+    if (token == StartObject || token == StartArray) skipValue();
+    return QByteArray();
+}
+
+QString JsonStreamReader::readString() {
+    return QString::fromUtf8(readRawString());
+}
+
+double JsonStreamReader::readNumber() {
+    Token token = readNext();
+    if (token == Number || token == String) return m_text.toDouble();
+    if (token == StartObject || token == StartArray) skipValue();
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+// Pull parser for JSON read incrementally from a device, in the spirit of
+// QXmlStreamReader: only the current token is held in memory, so documents
+// far larger than RAM can be walked. Separators are not validated; the
+// reader assumes well-formed input and only reports structural errors.
+class JsonStreamReader {
+public:
+    enum Token {
+        NoToken,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        Name,
+        String,
+        Number,
+        Bool,
+        Null,
+        EndDocument,
+        Invalid
+    };
+
+    explicit JsonStreamReader(QIODevice* device);
+
+    Token readNext();
+    Token tokenType() const { return m_token; }
+    int depth() const { return m_depth; }
+
+    // UTF-8 text of the current Name or String, or the literal of a Number
+    const QByteArray& rawText() const { return m_text; }
+    QString text() const { return QString::fromUtf8(m_text); }
+    double number() const { return m_text.toDouble(); }
+    bool boolValue() const { return m_bool; }
+
+    // Skips the value that follows the current Name (or starts at the current token)
+    bool skipValue();
+    // Reads the next value as a string; numbers give their literal, anything else is skipped
+    QString readString();
+    QByteArray readRawString();
+    double readNumber();
+
+    bool hasError() const { return m_token == Invalid; }
+    QString errorString() const { return m_error; }
+    qint64 bytesRead() const { return m_consumed + m_pos; }
+
+private:
+    bool ensure(qsizetype count);
+    bool parseString(bool keep);
+    bool parseLiteral(const char* literal, Token token, bool value);
+    Token fail(const QString& error);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    qsizetype m_pos;
+    qint64 m_consumed; // Bytes dropped from the front of m_buffer
+    Token m_token;
+    int m_depth;
+    QByteArray m_text;
+    bool m_bool;
+    bool m_skipping;
+    QString m_error;
+};
+
+#endif // JSONSTREAMREADER_H
@@ -0,0 +1,91 @@
+#include "LatencyHistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram(qint64 highest, int significantDigits)
+    : m_total(0)
+    , m_sum(0)
+    , m_min(0)
+    , m_max(0)
+{
+    // Sub-buckets enough to tell 2 * 10^digits values apart within a bucket
+    const int digits = qBound(1, significantDigits, 5);
+    const double resolution = 2.0 * std::pow(10.0, digits);
+    const int subBucketCountMagnitude = int(std::ceil(std::log2(resolution)));
+    m_subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+    const qint64 subBucketCount = qint64(1) << subBucketCountMagnitude;
+    m_subBucketHalfCount = subBucketCount / 2;
+    m_subBucketMask = subBucketCount - 1;
+    m_highest = qMax<qint64>(highest, 2);
+
+    // Each bucket covers twice the range of the one before
+    int buckets = 1;
+    qint64 smallestUntrackable = subBucketCount;
+    while (smallestUntrackable <= m_highest && smallestUntrackable < (qint64(1) << 62)) {
+        smallestUntrackable <<= 1;
+        ++buckets;
+    }
+    m_counts.resize((buckets + 1) * m_subBucketHalfCount);
+}
+
+int LatencyHistogram::countsIndex(qint64 value) const {
+    const int bucketIndex = 63 - m_subBucketHalfCountMagnitude - int(qCountLeadingZeroBits(quint64(value | m_subBucketMask)));
+    const qint64 subBucketIndex = value >> bucketIndex;
+    return int(((qint64(bucketIndex) + 1) << m_subBucketHalfCountMagnitude) + (subBucketIndex - m_subBucketHalfCount));
+}
+
+qint64 LatencyHistogram::valueAt(int index) const {
+    int bucketIndex = (index >> m_subBucketHalfCountMagnitude) - 1;
+    qint64 subBucketIndex = (index & (m_subBucketHalfCount - 1)) + m_subBucketHalfCount;
+    if (bucketIndex < 0) {
+        subBucketIndex -= m_subBucketHalfCount;
+        bucketIndex = 0;
+    }
+    return (subBucketIndex << bucketIndex) + (qint64(1) << bucketIndex) - 1;
+}
+
+void LatencyHistogram::record(qint64 value) {
+    value = qBound<qint64>(0, value, m_highest);
+    ++m_counts[countsIndex(value)];
+    if (m_total == 0 || value < m_min) m_min = value;
+    if (value > m_max) m_max = value;
+    ++m_total;
+    m_sum += value;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    if (other.m_counts.size() != m_counts.size() || other.m_total == 0) return;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_min = m_total == 0 ? other.m_min : qMin(m_min, other.m_min);
+    m_max = qMax(m_max, other.m_max);
+    m_total += other.m_total;
+    m_sum += other.m_sum;
+}
+
+void LatencyHistogram::clear() {
+    m_counts.fill(0);
+    m_total = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (m_total == 0) return 0;
+    const qint64 target = qMax<qint64>(1, qint64(std::ceil(qBound(0.0, percentile, 100.0) / 100.0 * m_total)));
+    qint64 seen = 0;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        seen += m_counts[i];
+        if (seen >= target) return qMin(valueAt(i), m_max);
+    }
+    return m_max;
+}
+
+QString LatencyHistogram::percentiles() const {
+    auto ms = [](qint64 microseconds) { return QString::number(microseconds / 1000.0, 'f', 1); };
+    return QString("p50 %1  p90 %2  p99 %3  p99.9 %4  max %5 ms")
+        .arg(ms(valueAtPercentile(50)), ms(valueAtPercentile(90)), ms(valueAtPercentile(99)),
+             ms(valueAtPercentile(99.9)), ms(max()));
+}
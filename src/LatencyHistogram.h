@@ -0,0 +1,46 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <QVector>
+
+// HdrHistogram's bucket layout: values from 1 to highest are counted in
+// buckets whose width grows with the value, so every recorded value is
+// reproduced to the given number of significant decimal digits. Recording
+// is a couple of shifts and an increment; memory depends only on the range
+// and precision, never on how many values are recorded.
+class LatencyHistogram {
+public:
+    // highest is the largest value kept exactly; larger ones count as highest
+    explicit LatencyHistogram(qint64 highest = 3600LL * 1000 * 1000, int significantDigits = 3);
+
+    void record(qint64 value);
+    void add(const LatencyHistogram& other); // Same range and precision only
+    void clear();
+
+    qint64 count() const { return m_total; }
+    qint64 min() const { return m_total ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const { return m_total ? double(m_sum) / m_total : 0.0; }
+    // Smallest value at or above which lies no more than (100 - percentile)% of the values
+    qint64 valueAtPercentile(double percentile) const;
+
+    // "p50 1.2 ms  p90 ...", reading the values as microseconds
+    QString percentiles() const;
+
+private:
+    int countsIndex(qint64 value) const;
+    qint64 valueAt(int index) const; // Highest value counted at index
+
+    int m_subBucketHalfCountMagnitude;
+    qint64 m_subBucketHalfCount;
+    qint64 m_subBucketMask;
+    qint64 m_highest;
+    QVector<qint64> m_counts;
+    qint64 m_total;
+    qint64 m_sum;
+    qint64 m_min;
+    qint64 m_max;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,184 @@
+#include "LoadTestDialog.h"
+#include "OrganizerModel.h"
+#include "ReplayEngine.h"
+#include <QFontDatabase>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+LoadTestDialog::LoadTestDialog(const QList<const OrganizerItem*>& items, OrganizerModel* model, QWidget* parent)
+    : QDialog(parent)
+    , m_model(model)
+    , m_engine(nullptr)
+{
+    for (const OrganizerItem* item : items) {
+        if (item->request().isEmpty()) continue;
+        LoadTestRequest request;
+        request.dbId = item->dbId();
+        request.name = item->name();
+        request.target = ReplayEngine::targetFor(item, true);
+        request.request = item->request();
+        m_requests.append(request);
+        m_plainTargets.append(ReplayEngine::targetFor(item, false));
+    }
+
+    setWindowTitle(m_requests.size() == 1 ? "Load Test " + m_requests.first().name : "Load Test");
+    resize(760, 560);
+
+    m_schemeCombo = new QComboBox(this);
+    m_schemeCombo->addItems({"HTTPS", "HTTP"});
+    m_modeCombo = new QComboBox(this);
+    m_modeCombo->addItem("Fixed rate", int(LoadTestEngine::Mode::Rate));
+    m_modeCombo->addItem("Fixed concurrency", int(LoadTestEngine::Mode::Concurrency));
+    m_valueSpin = new QSpinBox(this);
+    m_valueSpin->setRange(1, 100000);
+    m_durationSpin = new QSpinBox(this);
+    m_durationSpin->setRange(1, 24 * 3600);
+    m_durationSpin->setSuffix(" s");
+    m_durationSpin->setValue(LoadTestEngine::Options().duration);
+    m_connectionsSpin = new QSpinBox(this);
+    m_connectionsSpin->setRange(1, 1024);
+    m_connectionsSpin->setValue(LoadTestEngine::Options().connections);
+    m_verifyCheck = new QCheckBox("Verify TLS certificates", this);
+    connect(m_modeCombo, &QComboBox::currentIndexChanged, this, &LoadTestDialog::onModeChanged);
+
+    QHBoxLayout* loadLayout = new QHBoxLayout();
+    loadLayout->addWidget(m_modeCombo);
+    loadLayout->addWidget(m_valueSpin);
+    loadLayout->addWidget(new QLabel("for", this));
+    loadLayout->addWidget(m_durationSpin);
+    loadLayout->addStretch();
+
+    QFormLayout* form = new QFormLayout();
+    form->addRow(QString("%1 requests, round-robin:").arg(m_requests.size()), loadLayout);
+    form->addRow("Scheme when the Host has no port:", m_schemeCombo);
+    form->addRow("Connections:", m_connectionsSpin);
+    form->addRow(m_verifyCheck);
+
+    m_startButton = new QPushButton("Start", this);
+    m_stopButton = new QPushButton("Stop", this);
+    m_attachButton = new QPushButton("Attach to Items", this);
+    m_attachButton->setToolTip("Add the summary to each request's annotation and its median to Response Time");
+    m_statusLabel = new QLabel(this);
+    connect(m_startButton, &QPushButton::clicked, this, &LoadTestDialog::start);
+    connect(m_stopButton, &QPushButton::clicked, this, &LoadTestDialog::stop);
+    connect(m_attachButton, &QPushButton::clicked, this, &LoadTestDialog::attach);
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    buttons->addWidget(m_statusLabel, 1);
+    buttons->addWidget(m_startButton);
+    buttons->addWidget(m_stopButton);
+    buttons->addWidget(m_attachButton);
+
+    m_reportEdit = new QPlainTextEdit(this);
+    m_reportEdit->setReadOnly(true);
+    m_reportEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_reportEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+    layout->addWidget(m_reportEdit, 1);
+
+    onModeChanged(0);
+    setRunning(false);
+}
+
+LoadTestDialog::~LoadTestDialog() {
+    delete m_engine;
+}
+
+void LoadTestDialog::onModeChanged(int index) {
+    const bool rate = LoadTestEngine::Mode(m_modeCombo->itemData(index).toInt()) == LoadTestEngine::Mode::Rate;
+    const LoadTestEngine::Options defaults;
+    m_valueSpin->setSuffix(rate ? " req/s" : " in flight");
+    m_valueSpin->setValue(rate ? defaults.rate : defaults.concurrency);
+    // Concurrency mode opens exactly as many connections as it keeps requests in flight
+    m_connectionsSpin->setEnabled(rate);
+}
+
+void LoadTestDialog::start() {
+    if (m_requests.isEmpty()) {
+        QMessageBox::information(this, "Load Test", "None of the selected requests has a saved raw request.");
+        return;
+    }
+
+    LoadTestEngine::Options options;
+    options.mode = LoadTestEngine::Mode(m_modeCombo->currentData().toInt());
+    options.rate = m_valueSpin->value();
+    options.concurrency = m_valueSpin->value();
+    options.duration = m_durationSpin->value();
+    options.connections = m_connectionsSpin->value();
+    options.verifyPeer = m_verifyCheck->isChecked();
+
+    QVector<LoadTestRequest> requests = m_requests;
+    if (m_schemeCombo->currentIndex() == 1) {
+        for (int i = 0; i < requests.size(); ++i) {
+            requests[i].target = m_plainTargets[i];
+        }
+    }
+
+    delete m_engine;
+    m_reportEdit->clear();
+    m_engine = new LoadTestEngine(requests, options);
+    connect(m_engine, &LoadTestEngine::progress, this, &LoadTestDialog::onProgress);
+    connect(m_engine, &LoadTestEngine::finished, this, &LoadTestDialog::onFinished);
+    setRunning(true);
+    m_statusLabel->setText("Starting...");
+    m_engine->start();
+}
+
+void LoadTestDialog::stop() {
+    if (m_engine) {
+        m_engine->cancel();
+    }
+}
+
+void LoadTestDialog::onProgress(qint64 completed, int inFlight, double requestsPerSecond, qint64 latency99) {
+    m_statusLabel->setText(QString("%1 responses, %2 in flight, %3/s, p99 %4 ms")
+                               .arg(completed).arg(inFlight).arg(qint64(requestsPerSecond))
+                               .arg(latency99 / 1000.0, 0, 'f', 1));
+}
+
+void LoadTestDialog::onFinished(const LoadTestReport& report) {
+    m_report = report;
+    setRunning(false);
+    m_statusLabel->setText(QString("%1 after %2 responses").arg(report.cancelled ? "Stopped" : "Finished")
+                               .arg(report.completed()));
+    m_reportEdit->setPlainText(report.text());
+    m_attachButton->setEnabled(report.completed() > 0);
+}
+
+void LoadTestDialog::attach() {
+    int attached = 0;
+    for (int i = 0; i < m_report.items.size(); ++i) {
+        const LoadTestReport::Item& item = m_report.items.at(i);
+        const QModelIndex index = m_model->indexForDbId(item.dbId);
+        if (!index.isValid() || item.latency.count() == 0) continue;
+
+        // The newest result replaces an earlier one; other notes stay
+        QStringList lines = m_model->getItem(index)->annotation().split('\n', Qt::SkipEmptyParts);
+        lines.removeIf([](const QString& line) { return line.startsWith("Load test "); });
+        lines.append(m_report.summary(i));
+        m_model->setData(index.siblingAtColumn(1), lines.join('\n'), Qt::EditRole);
+        const qint64 median = qMax<qint64>(1, qRound64(item.latency.valueAtPercentile(50) / 1000.0));
+        m_model->setData(index.siblingAtColumn(8), QString::number(median), Qt::EditRole);
+        ++attached;
+    }
+    m_statusLabel->setText(QString("Attached to %1 items").arg(attached));
+    m_attachButton->setEnabled(false);
+}
+
+void LoadTestDialog::setRunning(bool running) {
+    m_startButton->setEnabled(!running);
+    m_stopButton->setEnabled(running);
+    m_attachButton->setEnabled(false);
+    m_modeCombo->setEnabled(!running);
+    m_valueSpin->setEnabled(!running);
+    m_durationSpin->setEnabled(!running);
+    m_schemeCombo->setEnabled(!running);
+    m_verifyCheck->setEnabled(!running);
+    m_connectionsSpin->setEnabled(!running &&
+                                  LoadTestEngine::Mode(m_modeCombo->currentData().toInt()) == LoadTestEngine::Mode::Rate);
+}
@@ -0,0 +1,56 @@
+#ifndef LOADTESTDIALOG_H
+#define LOADTESTDIALOG_H
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialog>
+#include <QLabel>
+#include <QList>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include "LoadTestEngine.h"
+#include "OrganizerItem.h"
+
+class OrganizerModel;
+
+// Load test of one or more stored requests, sent round-robin. The requests
+// are copied when the dialog opens; attaching the report finds the items
+// again by id, so ones deleted meanwhile are skipped.
+class LoadTestDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    LoadTestDialog(const QList<const OrganizerItem*>& items, OrganizerModel* model, QWidget* parent = nullptr);
+    ~LoadTestDialog();
+
+private slots:
+    void start();
+    void stop();
+    void onModeChanged(int index);
+    void onProgress(qint64 completed, int inFlight, double requestsPerSecond, qint64 latency99);
+    void onFinished(const LoadTestReport& report);
+    void attach();
+
+private:
+    void setRunning(bool running);
+
+    OrganizerModel* m_model;
+    QComboBox* m_schemeCombo;
+    QComboBox* m_modeCombo;
+    QSpinBox* m_valueSpin;
+    QSpinBox* m_durationSpin;
+    QSpinBox* m_connectionsSpin;
+    QCheckBox* m_verifyCheck;
+    QPushButton* m_startButton;
+    QPushButton* m_stopButton;
+    QPushButton* m_attachButton;
+    QLabel* m_statusLabel;
+    QPlainTextEdit* m_reportEdit;
+    QVector<LoadTestRequest> m_requests; // Targets for an HTTPS default
+    QVector<HttpTarget> m_plainTargets;  // The same for an HTTP default
+    LoadTestReport m_report;
+    LoadTestEngine* m_engine;
+};
+
+#endif // LOADTESTDIALOG_H
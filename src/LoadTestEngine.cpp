@@ -0,0 +1,249 @@
+#include "LoadTestEngine.h"
+#include "HttpMessageIndex.h"
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+
+namespace {
+    QString phaseLine(const QString& label, const LatencyHistogram& histogram) {
+        return QString("%1 %2").arg(label, -12).arg(histogram.count() ? histogram.percentiles() : QString("-"));
+    }
+}
+
+QString LoadTestReport::text() const {
+    qint64 failed = 0;
+    qint64 httpErrors = 0;
+    for (const Item& item : items) {
+        failed += item.failed;
+        httpErrors += item.httpErrors;
+    }
+
+    QStringList lines;
+    lines << QString("Load test %1, %2%3")
+                 .arg(started.toString("yyyy-MM-dd hh:mm:ss"), mode, cancelled ? QString(" (stopped)") : QString());
+    lines << QString("%1 responses (%2 status 400+), %3 failed, %4 missed in %5 s: %6 req/s")
+                 .arg(completed()).arg(httpErrors).arg(failed).arg(missed)
+                 .arg(elapsed / 1000.0, 0, 'f', 1).arg(throughput(), 0, 'f', 1);
+    lines << QString();
+    lines << phaseLine("Latency", latency);
+    lines << phaseLine("Connect", connect) + QString("  (%1 new connections)").arg(connect.count());
+    lines << phaseLine("TLS", tls);
+    lines << phaseLine("First byte", firstByte);
+    lines << phaseLine("Transfer", transfer);
+    if (items.size() > 1) {
+        lines << QString();
+        for (const Item& item : items) {
+            lines << QString("%1: %2 ok, %3 status 400+, %4 failed, %5")
+                         .arg(item.name).arg(item.ok).arg(item.httpErrors).arg(item.failed)
+                         .arg(item.latency.count() ? item.latency.percentiles() : QString("-"));
+        }
+    }
+    if (!lastError.isEmpty()) {
+        lines << QString() << QString("Last error: %1").arg(lastError);
+    }
+    return lines.join('\n');
+}
+
+QString LoadTestReport::summary(int item) const {
+    const Item& entry = items.at(item);
+    const qint64 responses = entry.ok + entry.httpErrors;
+    QString line = QString("Load test %1, %2: %3 req, %4 req/s, %5")
+                       .arg(started.toString("yyyy-MM-dd hh:mm"), mode)
+                       .arg(responses)
+                       .arg(elapsed > 0 ? responses * 1000.0 / elapsed : 0.0, 0, 'f', 1)
+                       .arg(entry.latency.percentiles());
+    if (entry.httpErrors) line += QString(", %1 status 400+").arg(entry.httpErrors);
+    if (entry.failed) line += QString(", %1 failed").arg(entry.failed);
+    return line;
+}
+
+LoadTestEngine::LoadTestEngine(const QVector<LoadTestRequest>& requests, const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_requests(requests)
+    , m_options(options)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+    qRegisterMetaType<LoadTestReport>();
+}
+
+LoadTestEngine::~LoadTestEngine() {
+    cancel();
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void LoadTestEngine::start() {
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("loadtest");
+    m_thread->start();
+}
+
+void LoadTestEngine::cancel() {
+    m_cancelled = true;
+}
+
+void LoadTestEngine::run() {
+    struct Sent {
+        int item = 0;
+        qint64 due = 0; // ns on the clock
+    };
+
+    const bool rateMode = m_options.mode == Mode::Rate;
+    LoadTestReport report;
+    report.started = QDateTime::currentDateTime();
+    report.mode = rateMode ? QString("%1 req/s").arg(m_options.rate)
+                           : QString("%1 concurrent").arg(m_options.concurrency);
+    for (const LoadTestRequest& request : m_requests) {
+        LoadTestReport::Item item;
+        item.dbId = request.dbId;
+        item.name = request.name;
+        report.items.append(item);
+    }
+    if (m_requests.isEmpty()) {
+        emit finished(report);
+        return;
+    }
+
+    QEventLoop loop;
+    HttpClientPool pool;
+    const int connections = rateMode ? m_options.connections : m_options.concurrency;
+    pool.setMaxConnections(connections);
+    pool.setMaxConnectionsPerHost(connections);
+    pool.setTimeout(m_options.timeout);
+    pool.setVerifyPeer(m_options.verifyPeer);
+
+    // Queued requests wait inside the pool, which is part of their latency;
+    // past this many a due request is counted as missed instead
+    const int maxInFlight = rateMode ? connections * 4 : m_options.concurrency;
+    const qint64 duration = qint64(m_options.duration) * 1000000000;
+    QHash<quint64, Sent> sent;
+    QQueue<Sent> missed; // Not yet charged, oldest first
+    quint64 next = 0; // Requests due so far, sent or missed
+    bool sending = true;
+    qint64 lastResponse = 0;
+    quint64 timingId = 0;
+    HttpClientPool::Timing timing;
+    QElapsedTimer clock;
+    clock.start();
+
+    // A missed request is charged as if it went out when a slot freed up,
+    // so skipping it doesn't hide the stall from the percentiles
+    auto chargeMissed = [&](qint64 now) {
+        const Sent request = missed.dequeue();
+        const qint64 latency = (now - request.due) / 1000;
+        report.items[request.item].latency.record(latency);
+        report.latency.record(latency);
+    };
+
+    auto send = [&](qint64 due) {
+        const int item = int(next % quint64(m_requests.size()));
+        sent.insert(next, {item, due});
+        pool.send(next, m_requests[item].target, m_requests[item].request);
+        ++next;
+    };
+
+    // Sends whatever is due; quits once sending has ended and everything is back
+    auto pump = [&]() {
+        const qint64 now = clock.nsecsElapsed();
+        if (now >= duration) sending = false;
+        if (sending && rateMode) {
+            // Request n is due at n / rate seconds, the first one straight away
+            const quint64 due = quint64(double(now) * m_options.rate / 1e9) + 1;
+            while (next < due) {
+                if (sent.size() >= maxInFlight) {
+                    missed.enqueue({int(next % quint64(m_requests.size())), qint64(double(next) * 1e9 / m_options.rate)});
+                    ++report.missed;
+                    ++next;
+                    continue;
+                }
+                send(qint64(double(next) * 1e9 / m_options.rate));
+            }
+        } else if (sending) {
+            while (sent.size() < m_options.concurrency) {
+                send(now);
+            }
+        }
+        if (!sending && sent.isEmpty()) loop.quit();
+    };
+
+    connect(&pool, &HttpClientPool::timing, &loop, [&](quint64 id, const HttpClientPool::Timing& phases) {
+        timingId = id;
+        timing = phases;
+    });
+    connect(&pool, &HttpClientPool::finished, &loop,
+            [&](quint64 id, const QByteArray& response, qint64, const QString& error) {
+        const auto it = sent.constFind(id);
+        if (it == sent.constEnd()) return;
+        const Sent request = *it;
+        sent.erase(it);
+        lastResponse = clock.nsecsElapsed();
+        if (!missed.isEmpty()) chargeMissed(lastResponse);
+
+        LoadTestReport::Item& item = report.items[request.item];
+        if (!error.isEmpty()) {
+            ++item.failed;
+            report.lastError = error;
+        } else {
+            const qint64 latency = (lastResponse - request.due) / 1000;
+            ++report.responses;
+            if (HttpMessageIndex::parse(response).status() >= 400) {
+                ++item.httpErrors;
+            } else {
+                ++item.ok;
+            }
+            item.latency.record(latency);
+            report.latency.record(latency);
+            if (timingId == id) {
+                // Pooled connections skip connecting, which would only pile zeros on those two
+                if (timing.connect > 0) report.connect.record(timing.connect / 1000);
+                if (timing.tls > 0) report.tls.record(timing.tls / 1000);
+                report.firstByte.record(timing.firstByte / 1000);
+                report.transfer.record(timing.transfer / 1000);
+            }
+        }
+        pump();
+    });
+
+    // Drives the send schedule, so it runs as finely as the platform allows
+    QTimer ticker;
+    ticker.setTimerType(Qt::PreciseTimer);
+    ticker.setInterval(1);
+    QElapsedTimer progressClock;
+    progressClock.start();
+    qint64 reported = 0;
+    connect(&ticker, &QTimer::timeout, &loop, [&]() {
+        if (m_cancelled) {
+            pool.abort();
+            loop.quit();
+            return;
+        }
+        pump();
+        const qint64 ms = progressClock.elapsed();
+        if (ms >= ProgressInterval) {
+            const qint64 completed = report.completed();
+            emit progress(completed, int(sent.size()), (completed - reported) * 1000.0 / ms,
+                          report.latency.valueAtPercentile(99));
+            reported = completed;
+            progressClock.restart();
+        }
+    });
+    ticker.start();
+    QTimer::singleShot(0, &loop, pump);
+    loop.exec();
+
+    // Whatever is left would have gone out once the last slot freed up; a
+    // cancelled run stops the clock where it was cancelled
+    const qint64 end = m_cancelled || lastResponse == 0 ? clock.nsecsElapsed() : lastResponse;
+    while (!missed.isEmpty()) {
+        chargeMissed(end);
+    }
+
+    report.elapsed = (lastResponse > 0 ? lastResponse : clock.nsecsElapsed()) / 1000000;
+    report.cancelled = m_cancelled;
+    emit finished(report);
+}
@@ -0,0 +1,106 @@
+#ifndef LOADTESTENGINE_H
+#define LOADTESTENGINE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include "HttpClientPool.h"
+#include "LatencyHistogram.h"
+
+// One request of a load test; several are sent round-robin
+struct LoadTestRequest {
+    int dbId = -1;
+    QString name;
+    HttpTarget target;
+    QByteArray request;
+};
+
+// Latencies are microseconds. In rate mode a request's latency runs from
+// when it was due, not when it went out, so a stalled server is charged
+// for the requests it held back as well as the ones it was slow to answer.
+// A request skipped because too many were in flight is recorded too, with
+// the time from when it was due until a slot freed up.
+struct LoadTestReport {
+    struct Item {
+        int dbId = -1;
+        QString name;
+        qint64 ok = 0;         // Status below 400
+        qint64 httpErrors = 0; // Status 400 and up
+        qint64 failed = 0;     // No response
+        LatencyHistogram latency{3600LL * 1000 * 1000, 2};
+    };
+
+    QDateTime started;
+    QString mode;            // "100 req/s" or "10 concurrent"
+    qint64 elapsed = 0;      // ms, until the last response
+    qint64 missed = 0;       // Rate mode: sends skipped because too many were in flight
+    qint64 responses = 0;    // Requests answered with a status line
+    bool cancelled = false;
+    QString lastError;
+    QVector<Item> items;
+    LatencyHistogram latency;
+    LatencyHistogram connect;
+    LatencyHistogram tls;
+    LatencyHistogram firstByte;
+    LatencyHistogram transfer;
+
+    qint64 completed() const { return responses; }
+    double throughput() const { return elapsed > 0 ? completed() * 1000.0 / elapsed : 0.0; }
+    // Several lines: totals, percentiles, the phase breakdown and one line per item
+    QString text() const;
+    // One line for item's annotation
+    QString summary(int item) const;
+};
+
+// Fires stored requests at a target rate or with a fixed number in flight
+// for a while, on its own thread with its own HttpClientPool and event
+// loop. Only counters and histograms are kept; responses are dropped as
+// soon as their status is read.
+class LoadTestEngine : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Mode {
+        Rate,       // Open loop: requests go out on schedule whatever the server does
+        Concurrency // Closed loop: a new request as each one comes back
+    };
+
+    struct Options {
+        Mode mode = Mode::Rate;
+        int rate = 50;        // Requests per second
+        int concurrency = 10;
+        int duration = 30;    // Seconds of sending
+        int connections = 64;
+        int timeout = 10000;  // ms without a byte before a request fails
+        bool verifyPeer = false;
+    };
+
+    LoadTestEngine(const QVector<LoadTestRequest>& requests, const Options& options, QObject* parent = nullptr);
+    ~LoadTestEngine();
+
+    void start();
+    // Safe to call from any thread
+    void cancel();
+    bool isRunning() const { return m_thread && m_thread->isRunning(); }
+
+    static constexpr int ProgressInterval = 250; // ms
+
+signals:
+    // latency99 is the running p99 in microseconds
+    void progress(qint64 completed, int inFlight, double requestsPerSecond, qint64 latency99);
+    void finished(const LoadTestReport& report);
+
+private:
+    void run();
+
+    QVector<LoadTestRequest> m_requests;
+    Options m_options;
+    QThread* m_thread;
+    std::atomic_bool m_cancelled;
+};
+
+#endif // LOADTESTENGINE_H
@@ -1,21 +1,42 @@
 #include "MainWindow.h"
+#include "BurpXmlWriter.h"
+#include "CurlSource.h"
+#include "DiffDialog.h"
+#include "FuzzerDialog.h"
+#include "LoadTestDialog.h"
+#include "HarSource.h"
+#include "HarWriter.h"
+#include "OpenApiImporter.h"
+#include "OutboundScheduler.h"
+#include "PcapImporter.h"
+#include "PerfCounters.h"
+#include "PostmanImporter.h"
+#include "RequestExporter.h"
+#include "Trace.h"
+#include <QApplication>
 #include <QByteArray>
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QHeaderView>
 #include <QLabel>
 #include <QTextEdit>
-#include <QXmlStreamReader>
 #include <QFile>
 #include <QFileDialog>
 #include <QDateTime>
-#include <QUrl>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QButtonGroup>
+#include <QComboBox>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QPlainTextEdit>
 #include <QBuffer>
 #include <QImage>
 #include <QPixmap>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <memory>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), m_model(new OrganizerModel(this)) {
@@ -23,7 +44,10 @@ MainWindow::MainWindow(QWidget *parent)
   setupMenuBar();
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow() {
+  // Stop a running import before the model it feeds goes away
+  stopImport();
+}
 
 void MainWindow::setupUI() {
   QWidget *centralWidget = new QWidget(this);
@@ -40,7 +64,7 @@ void MainWindow::setupUI() {
   m_treeView->setModel(m_model);
   m_treeView->setRootIsDecorated(true);
   m_treeView->setAlternatingRowColors(true);
-  m_treeView->setSelectionMode(QAbstractItemView::SingleSelection);
+  m_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
   m_treeView->setContextMenuPolicy(Qt::CustomContextMenu);
     m_treeView->setEditTriggers(QAbstractItemView::DoubleClicked |
                                 QAbstractItemView::SelectedClicked);
@@ -79,6 +103,11 @@ void MainWindow::setupUI() {
   // Screenshot button bar
   QHBoxLayout *screenshotLayout = new QHBoxLayout();
   screenshotLayout->setContentsMargins(5, 5, 5, 5);
+  m_thumbnailLabel = new QLabel(this);
+  m_thumbnailLabel->setFixedSize(ScreenshotLoader::ThumbnailSize);
+  m_thumbnailLabel->setAlignment(Qt::AlignCenter);
+  m_thumbnailLabel->setVisible(false);
+  screenshotLayout->addWidget(m_thumbnailLabel);
   m_screenshotButton = new QPushButton("View Screenshot", this);
   m_screenshotButton->setEnabled(false);
   screenshotLayout->addWidget(m_screenshotButton);
@@ -88,6 +117,10 @@ void MainWindow::setupUI() {
   m_removeScreenshotButton->setEnabled(false);
   screenshotLayout->addWidget(addScreenshotButton);
   screenshotLayout->addWidget(m_removeScreenshotButton);
+  m_decodeCheck = new QCheckBox("Decode bodies", this);
+  m_decodeCheck->setToolTip("Show chunked and gzip/deflate encoded messages decoded (read-only)");
+  m_decodeCheck->setChecked(true);
+  screenshotLayout->addWidget(m_decodeCheck);
   viewerLayout->addLayout(screenshotLayout);
 
   // Horizontal splitter for Request and Response
@@ -105,8 +138,12 @@ void MainWindow::setupUI() {
   requestFont.setPointSize(10);
   m_requestEdit->setFont(requestFont);
   new HttpSyntaxHighlighter(m_requestEdit->document());
+  m_requestHex = new HexView(this);
+  m_requestStack = new QStackedWidget(this);
+  m_requestStack->addWidget(m_requestEdit);
+  m_requestStack->addWidget(m_requestHex);
   requestLayout->addWidget(m_requestLabel);
-  requestLayout->addWidget(m_requestEdit);
+  requestLayout->addWidget(m_requestStack);
 
   // Response panel (right)
   QWidget *responseWidget = new QWidget(this);
@@ -120,8 +157,12 @@ void MainWindow::setupUI() {
   responseFont.setPointSize(10);
   m_responseEdit->setFont(responseFont);
   new HttpSyntaxHighlighter(m_responseEdit->document());
+  m_responseHex = new HexView(this);
+  m_responseStack = new QStackedWidget(this);
+  m_responseStack->addWidget(m_responseEdit);
+  m_responseStack->addWidget(m_responseHex);
   responseLayout->addWidget(m_responseLabel);
-  responseLayout->addWidget(m_responseEdit);
+  responseLayout->addWidget(m_responseStack);
 
   m_requestResponseSplitter->addWidget(requestWidget);
   m_requestResponseSplitter->addWidget(responseWidget);
@@ -152,8 +193,23 @@ void MainWindow::setupUI() {
   connect(m_screenshotButton, &QPushButton::clicked, this, &MainWindow::onScreenshotClicked);
   connect(addScreenshotButton, &QPushButton::clicked, this, &MainWindow::onAddScreenshot);
   connect(m_removeScreenshotButton, &QPushButton::clicked, this, &MainWindow::onRemoveScreenshot);
+  connect(m_model->screenshotLoader(), &ScreenshotLoader::thumbnailReady, this, &MainWindow::onThumbnailReady);
+  connect(m_model->screenshotLoader(), &ScreenshotLoader::imageReady, this, &MainWindow::onScreenshotDecoded);
+  connect(m_decodeCheck, &QCheckBox::toggled, this, [this]() { updateRequestViewer(m_currentIndex); });
   
   m_updatingViewer = false;
+  m_pendingScreenshotId = -1;
+  m_import = nullptr;
+  m_importProgress = nullptr;
+  m_importDuplicates = ImportPipeline::Duplicates::ImportAll;
+
+  m_replay = nullptr;
+  m_replayProgress = nullptr;
+  m_replayCopies = false;
+
+  m_diagnostics = new DiagnosticsPanel(m_model, this);
+  addDockWidget(Qt::BottomDockWidgetArea, m_diagnostics);
+  m_diagnostics->hide();
 
   setWindowTitle("Request Organizer");
   resize(1000, 800);
@@ -161,10 +217,33 @@ void MainWindow::setupUI() {
 
 void MainWindow::setupMenuBar() {
   QMenu *fileMenu = menuBar()->addMenu("File");
-  QAction *importAction = fileMenu->addAction("Import Burp XML...");
+  QAction *importBurpAction = fileMenu->addAction("Import Burp XML...");
+  QAction *importHarAction = fileMenu->addAction("Import HAR...");
+  QAction *importCurlAction = fileMenu->addAction("Import cURL...");
+  QAction *importPostmanAction = fileMenu->addAction("Import Postman Collection...");
+  QAction *importOpenApiAction = fileMenu->addAction("Import OpenAPI...");
+  QAction *importPcapAction = fileMenu->addAction("Import PCAP...");
+  m_importActions = {importBurpAction, importHarAction, importCurlAction, importPostmanAction, importOpenApiAction,
+                     importPcapAction};
+  fileMenu->addSeparator();
+  QAction *exportHarAction = fileMenu->addAction("Export to HAR...");
+  QAction *exportBurpAction = fileMenu->addAction("Export to Burp XML...");
+  QMenu *exportMenu = fileMenu->addMenu("Export Requests As");
+  const QList<ExportFormat> &formats = RequestExporter::formats();
+  for (int i = 0; i < formats.size(); ++i) {
+    QAction *action = exportMenu->addAction(formats[i].name + "...");
+    connect(action, &QAction::triggered, this, [this, i]() { onExportRequests(i); });
+  }
   fileMenu->addSeparator();
   QAction *exitAction = fileMenu->addAction("Exit");
-  connect(importAction, &QAction::triggered, this, &MainWindow::onImportBurp);
+  connect(importBurpAction, &QAction::triggered, this, &MainWindow::onImportBurp);
+  connect(importHarAction, &QAction::triggered, this, &MainWindow::onImportHar);
+  connect(importCurlAction, &QAction::triggered, this, &MainWindow::onImportCurl);
+  connect(importPostmanAction, &QAction::triggered, this, &MainWindow::onImportPostman);
+  connect(importOpenApiAction, &QAction::triggered, this, &MainWindow::onImportOpenApi);
+  connect(importPcapAction, &QAction::triggered, this, &MainWindow::onImportPcap);
+  connect(exportHarAction, &QAction::triggered, this, &MainWindow::onExportHar);
+  connect(exportBurpAction, &QAction::triggered, this, &MainWindow::onExportBurp);
   connect(exitAction, &QAction::triggered, this, &QWidget::close);
 
   QMenu *editMenu = menuBar()->addMenu("Edit");
@@ -176,6 +255,15 @@ void MainWindow::setupMenuBar() {
   QAction *removeColorAction = editMenu->addAction("Remove Color");
   QAction *editRequestAction = editMenu->addAction("Edit Request");
   QAction *editResponseAction = editMenu->addAction("Edit Response");
+  editMenu->addSeparator();
+  QAction *compareAction = editMenu->addAction("Compare Selected");
+  QAction *replayAction = editMenu->addAction("Replay Selected...");
+  QAction *fuzzAction = editMenu->addAction("Fuzz Request...");
+  QAction *loadTestAction = editMenu->addAction("Load Test Selected...");
+  QAction *findAction = editMenu->addAction("Find in Bodies...");
+  findAction->setShortcut(QKeySequence::Find);
+  QAction *findNextAction = editMenu->addAction("Find Next");
+  findNextAction->setShortcut(QKeySequence::FindNext);
 
   connect(addFolderAction, &QAction::triggered, this, &MainWindow::onAddFolder);
   connect(addRequestAction, &QAction::triggered, this,
@@ -187,9 +275,34 @@ void MainWindow::setupMenuBar() {
           &MainWindow::onEditRequest);
   connect(editResponseAction, &QAction::triggered, this,
           &MainWindow::onEditResponse);
+  connect(compareAction, &QAction::triggered, this, &MainWindow::onCompareItems);
+  connect(replayAction, &QAction::triggered, this, &MainWindow::onReplay);
+  connect(fuzzAction, &QAction::triggered, this, &MainWindow::onFuzz);
+  connect(loadTestAction, &QAction::triggered, this, &MainWindow::onLoadTest);
+  connect(findAction, &QAction::triggered, this, &MainWindow::onFindInBodies);
+  connect(findNextAction, &QAction::triggered, this, &MainWindow::onFindNext);
+
+  QMenu *toolsMenu = menuBar()->addMenu("Tools");
+  toolsMenu->addAction(m_diagnostics->toggleViewAction());
+  QAction *limitsAction = toolsMenu->addAction("Outbound Limits...");
+  connect(limitsAction, &QAction::triggered, this, &MainWindow::onOutboundLimits);
+  toolsMenu->addSeparator();
+  QAction *recordTraceAction = toolsMenu->addAction("Record Trace");
+  recordTraceAction->setCheckable(true);
+  recordTraceAction->setChecked(Trace::enabled());
+  QAction *saveTraceAction = toolsMenu->addAction("Save Trace...");
+  connect(recordTraceAction, &QAction::toggled, this, [](bool checked) {
+    // A new recording starts from an empty trace
+    if (checked) Trace::clear();
+    Trace::setEnabled(checked);
+  });
+  connect(saveTraceAction, &QAction::triggered, this, &MainWindow::onSaveTrace);
 }
 
 void MainWindow::onAddFolder() {
+  if (!checkSingleSelection("Add Folder")) {
+    return;
+  }
   QModelIndex parentIndex = getSelectedIndex();
   bool ok;
   QString name = QInputDialog::getText(
@@ -202,6 +315,9 @@ void MainWindow::onAddFolder() {
 }
 
 void MainWindow::onAddRequest() {
+  if (!checkSingleSelection("Add Request")) {
+    return;
+  }
   QModelIndex parentIndex = getSelectedIndex();
   bool ok;
   QString name = QInputDialog::getText(this, "Add Request",
@@ -216,61 +332,66 @@ void MainWindow::onAddRequest() {
 }
 
 void MainWindow::onDeleteItem() {
-  QModelIndex index = getSelectedIndex();
-  if (!index.isValid()) {
+  const QModelIndexList selected = getSelectedTopmost();
+  if (selected.isEmpty()) {
     QMessageBox::information(this, "Delete",
                              "Please select an item to delete.");
     return;
   }
 
-  int ret = QMessageBox::question(this, "Delete",
-                                  "Are you sure you want to delete this item?",
-                                  QMessageBox::Yes | QMessageBox::No);
+  const QString question = selected.size() == 1
+                               ? QString("Are you sure you want to delete this item?")
+                               : QString("Are you sure you want to delete these %1 items?").arg(selected.size());
+  int ret = QMessageBox::question(this, "Delete", question, QMessageBox::Yes | QMessageBox::No);
   if (ret == QMessageBox::Yes) {
-    m_model->removeRow(index.row(), index.parent());
+    // Rows shift as siblings go, so hold on to them persistently
+    QList<QPersistentModelIndex> rows;
+    for (const QModelIndex &index : selected) {
+      rows.append(index);
+    }
+    for (const QPersistentModelIndex &index : rows) {
+      if (index.isValid()) {
+        m_model->removeRow(index.row(), index.parent());
+      }
+    }
   }
 }
 
 void MainWindow::onSetColor() {
-  QModelIndex index = getSelectedIndex();
-  if (!index.isValid()) {
-    QMessageBox::information(this, "Set Color", "Please select an item.");
-    return;
-  }
-
-  OrganizerItem *item = m_model->getItem(index);
-  if (item->type() == ItemType::Folder) {
-    QMessageBox::information(this, "Set Color", "Folders cannot have colors.");
+  const QModelIndexList requests = getSelectedRequests();
+  if (requests.isEmpty()) {
+    QMessageBox::information(this, "Set Color", "Please select request items; folders cannot have colors.");
     return;
   }
 
-  QColor color = QColorDialog::getColor(item->color(), this, "Select Color");
+  QColor color = QColorDialog::getColor(m_model->getItem(requests.first())->color(), this, "Select Color");
   if (color.isValid()) {
-    item->setColor(color);
-    m_model->saveItem(index);
-    m_model->dataChanged(index, index);
+    for (const QModelIndex &index : requests) {
+      m_model->getItem(index)->setColor(color);
+      m_model->saveItem(index);
+      m_model->dataChanged(index, index);
+    }
   }
 }
 
 void MainWindow::onRemoveColor() {
-  QModelIndex index = getSelectedIndex();
-  if (!index.isValid()) {
-    QMessageBox::information(this, "Remove Color", "Please select an item.");
+  const QModelIndexList requests = getSelectedRequests();
+  if (requests.isEmpty()) {
+    QMessageBox::information(this, "Remove Color", "Please select request items; folders cannot have colors.");
     return;
   }
 
-  OrganizerItem *item = m_model->getItem(index);
-  if (item->type() == ItemType::Folder) {
-    QMessageBox::information(this, "Remove Color", "Folders cannot have colors.");
-    return;
+  for (const QModelIndex &index : requests) {
+    m_model->getItem(index)->setColor(Qt::white);
+    m_model->saveItem(index);
+    m_model->dataChanged(index, index);
   }
-
-  item->setColor(Qt::white);
-  m_model->saveItem(index);
-  m_model->dataChanged(index, index);
 }
 
 void MainWindow::onAddScreenshot() {
+  if (!checkSingleSelection("Add Screenshot")) {
+    return;
+  }
   QModelIndex index = getSelectedIndex();
   if (!index.isValid()) {
     QMessageBox::information(this, "Add Screenshot", "Please select a request item.");
@@ -304,11 +425,14 @@ void MainWindow::onAddScreenshot() {
 
   item->setScreenshot(base64Screenshot);
   m_model->saveItem(index);
-  m_screenshotButton->setEnabled(true);
-  m_removeScreenshotButton->setEnabled(true);
+  m_model->refreshThumbnail(index);
+  updateScreenshotBar(item);
 }
 
 void MainWindow::onRemoveScreenshot() {
+  if (!checkSingleSelection("Remove Screenshot")) {
+    return;
+  }
   QModelIndex index = getSelectedIndex();
   if (!index.isValid()) {
     QMessageBox::information(this, "Remove Screenshot", "Please select a request item.");
@@ -323,12 +447,13 @@ void MainWindow::onRemoveScreenshot() {
 
   item->setScreenshot("");
   m_model->saveItem(index);
-  m_screenshotButton->setEnabled(false);
-  m_removeScreenshotButton->setEnabled(false);
+  m_model->refreshThumbnail(index);
+  updateScreenshotBar(item);
 }
 
 void MainWindow::onScreenshotClicked() {
-  QModelIndex index = getSelectedIndex();
+  // The screenshot bar shows the current item
+  QModelIndex index = m_treeView->currentIndex();
   if (!index.isValid()) {
     return;
   }
@@ -338,10 +463,23 @@ void MainWindow::onScreenshotClicked() {
     return;
   }
 
-  // Decode screenshot
-  QByteArray imageData = QByteArray::fromBase64(item->screenshot().toUtf8());
-  QImage image = QImage::fromData(imageData);
-  
+  // Decode off the GUI thread; the dialog opens once the scaled image is ready
+  m_pendingScreenshotId = item->dbId();
+  m_screenshotButton->setEnabled(false);
+  m_screenshotButton->setText("Loading Screenshot...");
+  m_model->screenshotLoader()->requestImage(item->dbId(), item->screenshot(), QSize(780, 580));
+}
+
+void MainWindow::onScreenshotDecoded(int dbId, const QImage &image) {
+  if (dbId != m_pendingScreenshotId) {
+    return;
+  }
+  m_pendingScreenshotId = -1;
+  m_screenshotButton->setText("View Screenshot");
+  if (m_currentIndex.isValid()) {
+    updateScreenshotBar(m_model->getItem(m_currentIndex));
+  }
+
   if (image.isNull()) {
     QMessageBox::warning(this, "View Screenshot", "Could not load screenshot.");
     return;
@@ -356,11 +494,8 @@ void MainWindow::onScreenshotClicked() {
   QLabel *imageLabel = new QLabel(&dialog);
   imageLabel->setAlignment(Qt::AlignCenter);
   
-  // Scale image to fit dialog while maintaining aspect ratio
-  QPixmap pixmap = QPixmap::fromImage(image);
-  QSize labelSize(780, 580);
-  QPixmap scaledPixmap = pixmap.scaled(labelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-  imageLabel->setPixmap(scaledPixmap);
+  // Image already arrives scaled to fit the dialog
+  imageLabel->setPixmap(QPixmap::fromImage(image));
   
   layout->addWidget(imageLabel);
   
@@ -372,7 +507,41 @@ void MainWindow::onScreenshotClicked() {
   dialog.exec();
 }
 
+void MainWindow::onThumbnailReady(int dbId) {
+  if (!m_currentIndex.isValid()) {
+    return;
+  }
+  OrganizerItem *item = m_model->getItem(m_currentIndex);
+  if (item->dbId() == dbId) {
+    updateScreenshotBar(item);
+  }
+}
+
+void MainWindow::updateScreenshotBar(OrganizerItem *item) {
+  bool hasScreenshot = item && item->type() == ItemType::Request && item->hasScreenshot();
+  m_screenshotButton->setEnabled(hasScreenshot && m_pendingScreenshotId == -1);
+  m_removeScreenshotButton->setEnabled(hasScreenshot);
+  m_thumbnailLabel->setVisible(hasScreenshot);
+  if (!hasScreenshot) {
+    m_thumbnailLabel->clear();
+    return;
+  }
+
+  if (item->hasThumbnail()) {
+    QPixmap thumbnail;
+    thumbnail.loadFromData(item->thumbnail(), "JPG");
+    m_thumbnailLabel->setPixmap(thumbnail);
+  } else if (item->isThumbnailUnavailable()) {
+    m_thumbnailLabel->setText("Preview unavailable");
+  } else {
+    m_thumbnailLabel->setText("Generating preview...");
+  }
+}
+
 void MainWindow::onEditRequest() {
+  if (!checkSingleSelection("Edit Request")) {
+    return;
+  }
   QModelIndex index = getSelectedIndex();
   if (!index.isValid()) {
     QMessageBox::information(this, "Edit Request",
@@ -387,16 +556,19 @@ void MainWindow::onEditRequest() {
     return;
   }
 
-  QString currentRequest = item->request();
-  QByteArray decoded = QByteArray::fromBase64(currentRequest.toUtf8());
-  QString decodedText = QString::fromUtf8(decoded);
+  BodyCodec::Decoded decoded = BodyCodec::decode(item->request());
+  if (decoded.binary) {
+    QMessageBox::information(this, "Edit Request",
+                             "The request is binary and can only be viewed.");
+    return;
+  }
 
   QDialog dialog(this);
   dialog.setWindowTitle("Edit Request");
   QVBoxLayout *layout = new QVBoxLayout(&dialog);
-  QLabel *label = new QLabel("Request (will be saved as base64):", &dialog);
+  QLabel *label = new QLabel(QString("Request (%1):").arg(QString::fromLatin1(decoded.encoding)), &dialog);
   QTextEdit *textEdit = new QTextEdit(&dialog);
-  textEdit->setPlainText(decodedText.isEmpty() ? currentRequest : decodedText);
+  textEdit->setPlainText(decoded.text);
   QDialogButtonBox *buttonBox = new QDialogButtonBox(
       QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
 
@@ -408,14 +580,15 @@ void MainWindow::onEditRequest() {
   connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
 
   if (dialog.exec() == QDialog::Accepted) {
-    QString request = textEdit->toPlainText();
-    QString base64Request = request.toUtf8().toBase64();
-    m_model->setRequest(index, base64Request);
+    m_model->setRequest(index, BodyCodec::encode(textEdit->toPlainText(), decoded));
     updateRequestViewer(index);
   }
 }
 
 void MainWindow::onEditResponse() {
+  if (!checkSingleSelection("Edit Response")) {
+    return;
+  }
   QModelIndex index = getSelectedIndex();
   if (!index.isValid()) {
     QMessageBox::information(this, "Edit Response",
@@ -430,16 +603,19 @@ void MainWindow::onEditResponse() {
     return;
   }
 
-  QString currentResponse = item->response();
-  QByteArray decoded = QByteArray::fromBase64(currentResponse.toUtf8());
-  QString decodedText = QString::fromUtf8(decoded);
+  BodyCodec::Decoded decoded = BodyCodec::decode(item->response());
+  if (decoded.binary) {
+    QMessageBox::information(this, "Edit Response",
+                             "The response is binary and can only be viewed.");
+    return;
+  }
 
   QDialog dialog(this);
   dialog.setWindowTitle("Edit Response");
   QVBoxLayout *layout = new QVBoxLayout(&dialog);
-  QLabel *label = new QLabel("Response (will be saved as base64):", &dialog);
+  QLabel *label = new QLabel(QString("Response (%1):").arg(QString::fromLatin1(decoded.encoding)), &dialog);
   QTextEdit *textEdit = new QTextEdit(&dialog);
-  textEdit->setPlainText(decodedText.isEmpty() ? currentResponse : decodedText);
+  textEdit->setPlainText(decoded.text);
   QDialogButtonBox *buttonBox = new QDialogButtonBox(
       QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
 
@@ -451,9 +627,7 @@ void MainWindow::onEditResponse() {
   connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
 
   if (dialog.exec() == QDialog::Accepted) {
-    QString response = textEdit->toPlainText();
-    QString base64Response = response.toUtf8().toBase64();
-    m_model->setResponse(index, base64Response);
+    m_model->setResponse(index, BodyCodec::encode(textEdit->toPlainText(), decoded));
     updateRequestViewer(index);
   }
 }
@@ -484,6 +658,16 @@ void MainWindow::showContextMenu(const QPoint &pos) {
       contextMenu.addAction("Edit Request", this, &MainWindow::onEditRequest);
       contextMenu.addAction("Edit Response", this, &MainWindow::onEditResponse);
     }
+    contextMenu.addAction("Replay...", this, &MainWindow::onReplay);
+    if (item->type() == ItemType::Request) {
+      contextMenu.addAction("Fuzz...", this, &MainWindow::onFuzz);
+    }
+    contextMenu.addAction("Load Test...", this, &MainWindow::onLoadTest);
+
+    if (getSelectedRequests().size() == 2) {
+      contextMenu.addSeparator();
+      contextMenu.addAction("Compare", this, &MainWindow::onCompareItems);
+    }
   }
 
   contextMenu.exec(m_treeView->mapToGlobal(pos));
@@ -496,50 +680,80 @@ void MainWindow::onSelectionChanged(const QModelIndex &current,
 }
 
 void MainWindow::updateRequestViewer(const QModelIndex &index) {
+  RO_TRACE("MainWindow::updateRequestViewer");
   m_updatingViewer = true;
   m_currentIndex = index;
+  // Only the shown item keeps its decoded bodies cached
+  if (m_decodedIndex.isValid() && m_decodedIndex != index) {
+    m_model->getItem(m_decodedIndex)->releaseDecoded();
+  }
+  m_decodedIndex = index;
   
   if (!index.isValid()) {
-    m_requestEdit->clear();
-    m_responseEdit->clear();
+    showBody(QByteArray(), QStringList(), m_requestEdit, m_requestHex, m_requestStack, m_requestLabel, "Request", m_requestDecoded);
+    showBody(QByteArray(), QStringList(), m_responseEdit, m_responseHex, m_responseStack, m_responseLabel, "Response", m_responseDecoded);
+    updateScreenshotBar(nullptr);
     m_updatingViewer = false;
     return;
   }
 
   OrganizerItem *item = m_model->getItem(index);
   if (item->type() != ItemType::Request) {
-    m_requestEdit->clear();
-    m_responseEdit->clear();
-    m_screenshotButton->setEnabled(false);
-    m_removeScreenshotButton->setEnabled(false);
+    showBody(QByteArray(), QStringList(), m_requestEdit, m_requestHex, m_requestStack, m_requestLabel, "Request", m_requestDecoded);
+    showBody(QByteArray(), QStringList(), m_responseEdit, m_responseHex, m_responseStack, m_responseLabel, "Response", m_responseDecoded);
+    updateScreenshotBar(nullptr);
     m_updatingViewer = false;
     return;
   }
   
-  // Update screenshot button state
-  bool hasScreenshot = item->hasScreenshot();
-  m_screenshotButton->setEnabled(hasScreenshot);
-  m_removeScreenshotButton->setEnabled(hasScreenshot);
+  updateScreenshotBar(item);
 
-  // Decode and display request
-  QString requestBase64 = item->request();
-  if (!requestBase64.isEmpty()) {
-    QByteArray decoded = QByteArray::fromBase64(requestBase64.toUtf8());
-    m_requestEdit->setPlainText(QString::fromUtf8(decoded));
+  if (m_decodeCheck->isChecked()) {
+    showBody(item->decodedRequest(), item->requestCodings(), m_requestEdit, m_requestHex, m_requestStack,
+             m_requestLabel, "Request", m_requestDecoded);
+    showBody(item->decodedResponse(), item->responseCodings(), m_responseEdit, m_responseHex, m_responseStack,
+             m_responseLabel, "Response", m_responseDecoded);
   } else {
-    m_requestEdit->setPlainText("");
+    showBody(item->request(), QStringList(), m_requestEdit, m_requestHex, m_requestStack,
+             m_requestLabel, "Request", m_requestDecoded);
+    showBody(item->response(), QStringList(), m_responseEdit, m_responseHex, m_responseStack,
+             m_responseLabel, "Response", m_responseDecoded);
+  }
+  
+  m_updatingViewer = false;
+}
+
+void MainWindow::showBody(const QByteArray &data, const QStringList &codings, QTextEdit *edit, HexView *hex,
+                          QStackedWidget *stack, QLabel *label, const QString &title, BodyCodec::Decoded &decoded) {
+  decoded = BodyCodec::decode(data);
+  QString heading = title;
+  if (!codings.isEmpty()) {
+    heading += QString(" [decoded %1]").arg(codings.join(", "));
+  }
+  // A decoded view is a derived copy; editing it would overwrite the original bytes
+  edit->setReadOnly(!codings.isEmpty());
+
+  if (decoded.binary) {
+    // Binary content is shown as-is and can't be edited, so it is never re-encoded
+    edit->clear();
+    hex->setData(data);
+    stack->setCurrentWidget(hex);
+    label->setText(QString("%1 (binary, %2 bytes):").arg(heading).arg(data.size()));
+    return;
   }
 
-  // Decode and display response
-  QString responseBase64 = item->response();
-  if (!responseBase64.isEmpty()) {
-    QByteArray decoded = QByteArray::fromBase64(responseBase64.toUtf8());
-    m_responseEdit->setPlainText(QString::fromUtf8(decoded));
+  hex->clear();
+  {
+    // The highlighter runs synchronously inside setPlainText
+    RO_TRACE("HttpSyntaxHighlighter run");
+    edit->setPlainText(decoded.text);
+  }
+  stack->setCurrentWidget(edit);
+  if (data.isEmpty() || decoded.encoding == "UTF-8") {
+    label->setText(heading + ":");
   } else {
-    m_responseEdit->setPlainText("");
+    label->setText(QString("%1 (%2):").arg(heading, QString::fromLatin1(decoded.encoding)));
   }
-  
-  m_updatingViewer = false;
 }
 
 void MainWindow::onRequestChanged() {
@@ -549,9 +763,7 @@ void MainWindow::onRequestChanged() {
   
   OrganizerItem *item = m_model->getItem(m_currentIndex);
   if (item && item->type() == ItemType::Request) {
-    QString text = m_requestEdit->toPlainText();
-    QString base64Text = text.toUtf8().toBase64();
-    m_model->setRequest(m_currentIndex, base64Text);
+    m_model->setRequest(m_currentIndex, BodyCodec::encode(m_requestEdit->toPlainText(), m_requestDecoded));
   }
 }
 
@@ -562,24 +774,222 @@ void MainWindow::onResponseChanged() {
   
   OrganizerItem *item = m_model->getItem(m_currentIndex);
   if (item && item->type() == ItemType::Request) {
-    QString text = m_responseEdit->toPlainText();
-    QString base64Text = text.toUtf8().toBase64();
-    m_model->setResponse(m_currentIndex, base64Text);
+    m_model->setResponse(m_currentIndex, BodyCodec::encode(m_responseEdit->toPlainText(), m_responseDecoded));
   }
 }
 
 QModelIndex MainWindow::getSelectedIndex() {
-  QModelIndexList selected = m_treeView->selectionModel()->selectedIndexes();
+  QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
   if (!selected.isEmpty()) {
     return selected.first();
   }
   return QModelIndex();
 }
 
-void MainWindow::onImportBurp() {
+bool MainWindow::checkSingleSelection(const QString &title) {
+  if (m_treeView->selectionModel()->selectedRows().size() <= 1) {
+    return true;
+  }
+  QMessageBox::information(this, title, "This works on one item at a time. Select a single row.");
+  return false;
+}
+
+QModelIndexList MainWindow::getSelectedTopmost() {
+  // A selected folder already covers whatever is selected inside it
+  const QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
+  QModelIndexList topmost;
+  for (const QModelIndex &index : selected) {
+    bool covered = false;
+    for (QModelIndex parent = index.parent(); parent.isValid() && !covered; parent = parent.parent()) {
+      covered = selected.contains(parent.siblingAtColumn(0));
+    }
+    if (!covered) {
+      topmost.append(index);
+    }
+  }
+  return topmost;
+}
+
+QModelIndexList MainWindow::getSelectedRequests() {
+  QModelIndexList requests;
+  const QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
+  for (const QModelIndex &index : selected) {
+    if (m_model->getItem(index)->type() == ItemType::Request) {
+      requests.append(index);
+    }
+  }
+  return requests;
+}
+
+void MainWindow::onFindInBodies() {
+  bool ok;
+  QString term = QInputDialog::getText(this, "Find in Bodies",
+                                       "Search decoded requests and responses for:",
+                                       QLineEdit::Normal, m_searchTerm, &ok);
+  if (!ok || term.isEmpty()) {
+    return;
+  }
+  m_searchTerm = term;
+  onFindNext();
+}
+
+void MainWindow::onFindNext() {
+  if (m_searchTerm.isEmpty()) {
+    onFindInBodies();
+    return;
+  }
+
+  QModelIndex found = m_model->findNext(m_treeView->currentIndex(), m_searchTerm.toUtf8());
+  if (!found.isValid()) {
+    QMessageBox::information(this, "Find in Bodies",
+                             QString("No request or response contains \"%1\".").arg(m_searchTerm));
+    return;
+  }
+  m_treeView->setCurrentIndex(found);
+  m_treeView->scrollTo(found);
+}
+
+void MainWindow::onCompareItems() {
+  QModelIndexList requests = getSelectedRequests();
+  if (requests.size() != 2) {
+    QMessageBox::information(this, "Compare",
+                             "Please select exactly two request items.");
+    return;
+  }
+
+  auto toSide = [this](const QModelIndex &index) {
+    OrganizerItem *item = m_model->getItem(index);
+    DiffDialog::Side side;
+    side.title = item->name();
+    side.request = item->decodedRequestUncached();
+    side.response = item->decodedResponseUncached();
+    return side;
+  };
+
+  // Non-modal so large diffs never hold up the rest of the window
+  DiffDialog *dialog = new DiffDialog(toSide(requests.at(0)), toSide(requests.at(1)), this);
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->show();
+}
+
+void MainWindow::onFuzz() {
+  if (!checkSingleSelection("Fuzzer")) {
+    return;
+  }
+  QModelIndex index = m_treeView->currentIndex();
+  OrganizerItem *item = index.isValid() ? m_model->getItem(index) : nullptr;
+  if (!item || item->type() != ItemType::Request || item->request().isEmpty()) {
+    QMessageBox::information(this, "Fuzzer", "Select a request with a saved raw request to fuzz.");
+    return;
+  }
+
+  // Non-modal, one window per attack; results never become items
+  FuzzerDialog *dialog = new FuzzerDialog(item, this);
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->show();
+}
+
+void MainWindow::onLoadTest() {
+  // Selected requests, and every request under selected folders, sent round-robin
+  QList<const OrganizerItem *> items;
+  std::function<void(const OrganizerItem *)> collect = [&](const OrganizerItem *item) {
+    if (item->type() == ItemType::Request && !item->request().isEmpty()) {
+      items.append(item);
+    }
+    for (const OrganizerItem *child : item->children()) {
+      collect(child);
+    }
+  };
+  const QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
+  for (const QModelIndex &index : selected) {
+    collect(m_model->getItem(index));
+  }
+  if (items.isEmpty()) {
+    QMessageBox::information(this, "Load Test", "Select requests with saved raw requests, or folders holding them.");
+    return;
+  }
+
+  LoadTestDialog *dialog = new LoadTestDialog(items, m_model, this);
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->show();
+}
+
+void MainWindow::onOutboundLimits() {
+  OutboundScheduler::Limits limits = OutboundScheduler::instance().limits();
+
+  QDialog dialog(this);
+  dialog.setWindowTitle("Outbound Limits");
+  QFormLayout *layout = new QFormLayout(&dialog);
+  auto rateSpin = [&dialog](double value) {
+    QDoubleSpinBox *spin = new QDoubleSpinBox(&dialog);
+    spin->setRange(0, 1000000);
+    spin->setDecimals(1);
+    spin->setSuffix(" req/s");
+    spin->setSpecialValueText("Unlimited");
+    spin->setValue(value);
+    return spin;
+  };
+  auto burstSpin = [&dialog](int value) {
+    QSpinBox *spin = new QSpinBox(&dialog);
+    spin->setRange(1, 100000);
+    spin->setValue(value);
+    return spin;
+  };
+  QDoubleSpinBox *hostRateSpin = rateSpin(limits.hostRate);
+  QSpinBox *hostBurstSpin = burstSpin(limits.hostBurst);
+  QDoubleSpinBox *globalRateSpin = rateSpin(limits.globalRate);
+  QSpinBox *globalBurstSpin = burstSpin(limits.globalBurst);
+  QPlainTextEdit *overridesEdit = new QPlainTextEdit(&dialog);
+  overridesEdit->setPlaceholderText("One host and its rate per line:\napi.example.com 5");
+  overridesEdit->setMaximumHeight(100);
+  QStringList overrides;
+  for (auto it = limits.hostRates.cbegin(); it != limits.hostRates.cend(); ++it) {
+    overrides << QString("%1 %2").arg(it.key()).arg(it.value());
+  }
+  overrides.sort();
+  overridesEdit->setPlainText(overrides.join('\n'));
+  QCheckBox *backoffCheck = new QCheckBox("Pause hosts answering 429 or 503, for their Retry-After if given", &dialog);
+  backoffCheck->setChecked(limits.backoff);
+  QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+  layout->addRow("Rate per host:", hostRateSpin);
+  layout->addRow("Burst per host:", hostBurstSpin);
+  layout->addRow("Rate in total:", globalRateSpin);
+  layout->addRow("Burst in total:", globalBurstSpin);
+  layout->addRow("Hosts with their own rate:", overridesEdit);
+  layout->addRow(backoffCheck);
+  layout->addRow(buttons);
+  connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+  connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+
+  // Replay, fuzzing and load tests all go through these until the application exits
+  limits.hostRate = hostRateSpin->value();
+  limits.hostBurst = hostBurstSpin->value();
+  limits.globalRate = globalRateSpin->value();
+  limits.globalBurst = globalBurstSpin->value();
+  limits.backoff = backoffCheck->isChecked();
+  limits.hostRates.clear();
+  for (const QString &line : overridesEdit->toPlainText().split('\n', Qt::SkipEmptyParts)) {
+    const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+    if (parts.isEmpty()) continue;
+    bool ok = false;
+    const double rate = parts.size() == 2 ? parts[1].toDouble(&ok) : 0;
+    if (!ok || rate < 0) {
+      QMessageBox::warning(this, "Outbound Limits", QString("\"%1\" is not a host and a rate.").arg(line.trimmed()));
+      return;
+    }
+    limits.hostRates.insert(parts[0].toLower(), rate);
+  }
+  OutboundScheduler::instance().setLimits(limits);
+}
+
+bool MainWindow::chooseImportInput(const QString &title, const QString &what, const QString &filter,
+                                   QString &fileName, QByteArray &content) {
   // Dialog to choose import method
   QDialog dialog(this);
-  dialog.setWindowTitle("Import Burp XML");
+  dialog.setWindowTitle(title);
   dialog.setMinimumWidth(400);
   
   QVBoxLayout *layout = new QVBoxLayout(&dialog);
@@ -588,7 +998,7 @@ void MainWindow::onImportBurp() {
   layout->addWidget(label);
   
   QPushButton *fileButton = new QPushButton("Import from File...", &dialog);
-  QPushButton *pasteButton = new QPushButton("Paste XML", &dialog);
+  QPushButton *pasteButton = new QPushButton("Paste " + what, &dialog);
   QPushButton *cancelButton = new QPushButton("Cancel", &dialog);
   
   layout->addWidget(fileButton);
@@ -608,36 +1018,23 @@ void MainWindow::onImportBurp() {
   });
   
   if (dialog.exec() != QDialog::Accepted) {
-    return;
+    return false;
   }
   
   QString method = dialog.property("method").toString();
-  QString xmlContent;
   
   if (method == "file") {
-    QString fileName = QFileDialog::getOpenFileName(this, "Import Burp XML", "", "XML Files (*.xml)");
-    if (fileName.isEmpty()) {
-      return;
-    }
-    
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-      QMessageBox::warning(this, "Import Error", "Could not open file: " + fileName);
-      return;
-    }
-    
-    QTextStream in(&file);
-    xmlContent = in.readAll();
-    file.close();
+    fileName = QFileDialog::getOpenFileName(this, title, "", filter);
+    return !fileName.isEmpty();
   } else if (method == "paste") {
-    // Dialog with textarea for pasting XML
+    // Dialog with textarea for pasting
     QDialog pasteDialog(this);
-    pasteDialog.setWindowTitle("Paste Burp XML");
+    pasteDialog.setWindowTitle("Paste " + what);
     pasteDialog.setMinimumSize(600, 400);
     
     QVBoxLayout *pasteLayout = new QVBoxLayout(&pasteDialog);
     
-    QLabel *pasteLabel = new QLabel("Paste XML content:", &pasteDialog);
+    QLabel *pasteLabel = new QLabel(QString("Paste %1 content:").arg(what), &pasteDialog);
     pasteLayout->addWidget(pasteLabel);
     
     QTextEdit *textEdit = new QTextEdit(&pasteDialog);
@@ -651,183 +1048,485 @@ void MainWindow::onImportBurp() {
     connect(buttonBox, &QDialogButtonBox::rejected, &pasteDialog, &QDialog::reject);
     
     if (pasteDialog.exec() != QDialog::Accepted) {
-      return;
+      return false;
     }
     
-    xmlContent = textEdit->toPlainText();
-    if (xmlContent.isEmpty()) {
-      QMessageBox::warning(this, "Import Error", "No XML content provided.");
-      return;
+    content = textEdit->toPlainText().toUtf8();
+    if (content.isEmpty()) {
+      QMessageBox::warning(this, "Import Error", QString("No %1 content provided.").arg(what));
+      return false;
     }
-  } else {
+    return true;
+  }
+  return false;
+}
+
+void MainWindow::onImportBurp() {
+  QString fileName;
+  QByteArray xmlContent;
+  if (!chooseImportInput("Import Burp XML", "XML", "XML Files (*.xml)", fileName, xmlContent)) {
     return;
   }
-  
-  // Parse XML from string
-  QXmlStreamReader xml(xmlContent);
-  QModelIndex parentIndex = getSelectedIndex();
-  
-  int importedCount = 0;
-  int errorCount = 0;
+  startImport(new BurpXmlSource(fileName, xmlContent), "Importing Burp XML...");
+}
 
-  while (!xml.atEnd() && !xml.hasError()) {
-    QXmlStreamReader::TokenType token = xml.readNext();
-    
-    if (token == QXmlStreamReader::StartElement && xml.name() == QLatin1String("item")) {
-      QString timeStr, urlStr, hostStr, portStr, protocolStr, methodStr, pathStr;
-      QString requestBase64, responseBase64, commentStr;
-      int status = 0;
-      qint64 responseLength = 0;
-      QString mimeType;
-
-      while (!(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == QLatin1String("item"))) {
-        xml.readNext();
-        
-        if (xml.tokenType() == QXmlStreamReader::StartElement) {
-          QString elementName = xml.name().toString();
-          
-          if (elementName == "time") {
-            timeStr = xml.readElementText();
-          } else if (elementName == "url") {
-            urlStr = xml.readElementText();
-          } else if (elementName == "host") {
-            hostStr = xml.readElementText();
-          } else if (elementName == "port") {
-            portStr = xml.readElementText();
-          } else if (elementName == "protocol") {
-            protocolStr = xml.readElementText();
-          } else if (elementName == "method") {
-            methodStr = xml.readElementText();
-          } else if (elementName == "path") {
-            pathStr = xml.readElementText();
-          } else if (elementName == "request") {
-            QString base64Attr = xml.attributes().value("base64").toString();
-            if (base64Attr == "true") {
-              requestBase64 = xml.readElementText();
-            } else {
-              // If not base64, encode it
-              QString text = xml.readElementText();
-              requestBase64 = text.toUtf8().toBase64();
-            }
-          } else if (elementName == "status") {
-            status = xml.readElementText().toInt();
-          } else if (elementName == "responselength") {
-            responseLength = xml.readElementText().toLongLong();
-          } else if (elementName == "mimetype") {
-            mimeType = xml.readElementText();
-          } else if (elementName == "response") {
-            QString base64Attr = xml.attributes().value("base64").toString();
-            if (base64Attr == "true") {
-              responseBase64 = xml.readElementText();
-            } else {
-              // If not base64, encode it
-              QString text = xml.readElementText();
-              responseBase64 = text.toUtf8().toBase64();
-            }
-          } else if (elementName == "comment") {
-            commentStr = xml.readElementText();
-          }
-        }
-      }
+void MainWindow::onImportCurl() {
+  QString fileName;
+  QByteArray commands;
+  if (!chooseImportInput("Import cURL Commands", "cURL", "Shell Scripts (*.sh *.txt);;All Files (*)", fileName, commands)) {
+    return;
+  }
+  startImport(new CurlSource(fileName, commands), "Importing cURL commands...");
+}
 
-      // Create request item
-      if (!methodStr.isEmpty() && !urlStr.isEmpty()) {
-        // Generate name from URL and method
-        QUrl url(urlStr);
-        QString path = url.path();
-        if (path.isEmpty()) {
-          path = "/";
-        }
-        QString name = methodStr + " " + path;
-        if (name.length() > 50) {
-          name = name.left(47) + "...";
-        }
-        
-        // Extract query string from URL
-        QString queryStr = url.query();
-        
-        // Use pathStr if available, otherwise extract from URL
-        QString pathToUse = pathStr.isEmpty() ? path : pathStr;
-
-        QModelIndex newIndex = m_model->addRequest(name, parentIndex);
-        OrganizerItem* item = m_model->getItem(newIndex);
-        
-        if (item) {
-          // Set basic fields
-          item->setHost(hostStr);
-          item->setUrl(pathToUse);  // URL field contains only the path
-          item->setMethod(methodStr);
-          item->setQuery(queryStr);
-          item->setStatus(status);
-          item->setLength(responseLength);
-          item->setAnnotation(commentStr);
-          
-          // Set request and response (already base64)
-          if (!requestBase64.isEmpty()) {
-            item->setRequest(requestBase64);
-          }
-          if (!responseBase64.isEmpty()) {
-            item->setResponse(responseBase64);
-          }
-          
-          // Parse timestamp
-          if (!timeStr.isEmpty()) {
-            QDateTime dateTime;
-            // Try different date formats
-            QStringList formats = {
-              "ddd MMM dd hh:mm:ss 'CST' yyyy",
-              "ddd MMM dd hh:mm:ss 'EST' yyyy",
-              "ddd MMM dd hh:mm:ss 'PST' yyyy",
-              "ddd MMM dd hh:mm:ss 'GMT' yyyy",
-              "ddd MMM dd hh:mm:ss yyyy"
-            };
-            
-            for (const QString& format : formats) {
-              dateTime = QDateTime::fromString(timeStr, format);
-              if (dateTime.isValid()) {
-                break;
-              }
-            }
-            
-            // Try ISO format if other formats failed
-            if (!dateTime.isValid()) {
-              dateTime = QDateTime::fromString(timeStr, Qt::ISODate);
-            }
-            
-            if (dateTime.isValid()) {
-              item->setTimestamp(dateTime.toSecsSinceEpoch());
-            } else {
-              // If parsing fails, use current time
-              item->setTimestamp(QDateTime::currentDateTime().toSecsSinceEpoch());
-            }
-          } else {
-            // If no time, use current time
-            item->setTimestamp(QDateTime::currentDateTime().toSecsSinceEpoch());
-          }
-          
-          // Save to database
-          m_model->saveItem(newIndex);
-          importedCount++;
+void MainWindow::onImportHar() {
+  QString fileName = QFileDialog::getOpenFileName(this, "Import HAR", "", "HAR Files (*.har *.json)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+  startImport(new HarSource(fileName), "Importing HAR...");
+}
+
+void MainWindow::onImportPostman() {
+  QString fileName = QFileDialog::getOpenFileName(this, "Import Postman Collection", "", "Postman Collections (*.json)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+  startTreeImport("Importing Postman collection...",
+                  [fileName](QString *error, const std::atomic_bool *) { return PostmanImporter::importFile(fileName, error); });
+}
+
+void MainWindow::onImportOpenApi() {
+  QString fileName = QFileDialog::getOpenFileName(this, "Import OpenAPI", "", "OpenAPI Specs (*.json)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+  startTreeImport("Importing OpenAPI spec...",
+                  [fileName](QString *error, const std::atomic_bool *) { return OpenApiImporter::importFile(fileName, error); });
+}
+
+void MainWindow::onImportPcap() {
+  QString fileName = QFileDialog::getOpenFileName(this, "Import PCAP", "", "Captures (*.pcap *.pcapng *.cap)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+  startTreeImport("Reassembling HTTP from capture...", [fileName](QString *error, const std::atomic_bool *cancel) {
+    return PcapImporter::importFile(fileName, error, cancel);
+  });
+}
+
+void MainWindow::startTreeImport(const QString &label,
+                                 const std::function<OrganizerItem *(QString *, const std::atomic_bool *)> &build) {
+  if (!checkSingleSelection(label)) {
+    return;
+  }
+  QPersistentModelIndex parent = getSelectedIndex();
+  for (QAction *action : m_importActions) {
+    action->setEnabled(false);
+  }
+  std::shared_ptr<std::atomic_bool> cancel = std::make_shared<std::atomic_bool>(false);
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  QProgressDialog *progress = new QProgressDialog(label, "Cancel", 0, 0, this);
+  progress->setWindowModality(Qt::WindowModal);
+  progress->setMinimumDuration(500);
+  connect(progress, &QProgressDialog::canceled, this, [cancel]() { cancel->store(true); });
+
+  // The tree is built off the GUI thread, then saved and shown in one step
+  typedef QPair<OrganizerItem *, QString> Result;
+  QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
+  connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher, progress, cancel, parent, elapsed]() {
+    watcher->deleteLater();
+    progress->deleteLater();
+    for (QAction *action : m_importActions) {
+      action->setEnabled(true);
+    }
+
+    Result result = watcher->result();
+    if (cancel->load()) {
+      delete result.first;
+      return;
+    }
+    if (!result.first) {
+      QMessageBox::warning(this, "Import Error", result.second);
+      return;
+    }
+
+    int folders = 0;
+    int requests = 0;
+    std::function<void(const OrganizerItem *)> count = [&](const OrganizerItem *item) {
+      for (const OrganizerItem *child : item->children()) {
+        if (child->type() == ItemType::Folder) {
+          ++folders;
         } else {
-          errorCount++;
+          ++requests;
         }
+        count(child);
+      }
+    };
+    count(result.first);
+
+    m_model->addTree(parent, result.first);
+    if (parent.isValid()) {
+      m_treeView->expand(parent);
+    }
+    PerfCounters::import.record(elapsed.nsecsElapsed());
+    PerfCounters::lastImportItems = requests;
+    QMessageBox::information(this, "Import Complete",
+      QString("Imported %1 requests in %2 folders.").arg(requests).arg(folders));
+  });
+  watcher->setFuture(QtConcurrent::run([build, cancel]() {
+    QString error;
+    OrganizerItem *root = build(&error, cancel.get());
+    return Result(root, error);
+  }));
+}
+
+void MainWindow::onExportHar() {
+  // Exports the selected folder or request, or everything when nothing is selected
+  if (!checkSingleSelection("Export to HAR")) {
+    return;
+  }
+  QModelIndex index = getSelectedIndex();
+  OrganizerItem *root = index.isValid() ? m_model->getItem(index) : m_model->rootItem();
+
+  QString fileName = QFileDialog::getSaveFileName(this, "Export to HAR", "", "HAR Files (*.har)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+
+  QList<HarEntry> entries = HarWriter::snapshot(root);
+  runExport(QString("Exporting %1 requests...").arg(entries.size()),
+            [entries, fileName](const std::atomic_bool *cancel) {
+    QString error;
+    HarWriter::exportEntries(entries, fileName, &error, cancel);
+    return error;
+  });
+}
+
+void MainWindow::onExportRequests(int formatIndex) {
+  const ExportFormat &format = RequestExporter::formats().at(formatIndex);
+  if (!checkSingleSelection("Export as " + format.name)) {
+    return;
+  }
+  QModelIndex index = getSelectedIndex();
+  OrganizerItem *root = index.isValid() ? m_model->getItem(index) : m_model->rootItem();
+
+  QString fileName = QFileDialog::getSaveFileName(this, "Export as " + format.name, "", format.fileFilter);
+  if (fileName.isEmpty()) {
+    return;
+  }
+
+  // Snapshots share the items' bytes; decoding and rendering run on a worker
+  QList<RequestSnapshot> snapshots = RequestExporter::snapshot(root);
+  runExport(QString("Exporting %1 requests...").arg(snapshots.size()),
+            [&format, snapshots, fileName](const std::atomic_bool *cancel) {
+    QString error;
+    RequestExporter::exportRequests(format, snapshots, fileName, &error, cancel);
+    return error;
+  });
+}
+
+void MainWindow::onExportBurp() {
+  if (!checkSingleSelection("Export to Burp XML")) {
+    return;
+  }
+  QModelIndex index = getSelectedIndex();
+  OrganizerItem *root = index.isValid() ? m_model->getItem(index) : m_model->rootItem();
+
+  QString fileName = QFileDialog::getSaveFileName(this, "Export to Burp XML", "", "XML Files (*.xml)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+
+  // Only ids are taken here; the worker pages bodies in from the database
+  QList<int> ids = BurpXmlWriter::collectIds(root);
+  runExport(QString("Exporting %1 requests...").arg(ids.size()),
+            [ids, fileName](const std::atomic_bool *cancel) {
+    QString error;
+    BurpXmlWriter::exportItems(ids, fileName, &error, cancel);
+    return error;
+  });
+}
+
+void MainWindow::onSaveTrace() {
+  QString fileName = QFileDialog::getSaveFileName(this, "Save Trace", "", "Trace Files (*.json)");
+  if (fileName.isEmpty()) {
+    return;
+  }
+  QString error;
+  if (!Trace::writeJson(fileName, &error)) {
+    QMessageBox::warning(this, "Save Trace", error);
+  }
+}
+
+void MainWindow::onReplay() {
+  if (m_replay) {
+    QMessageBox::information(this, "Replay", "A replay is already running.");
+    return;
+  }
+
+  // Selected requests, and every request under selected folders
+  QList<const OrganizerItem *> items;
+  std::function<void(const OrganizerItem *)> collect = [&](const OrganizerItem *item) {
+    if (item->type() == ItemType::Request) {
+      items.append(item);
+    }
+    for (const OrganizerItem *child : item->children()) {
+      collect(child);
+    }
+  };
+  const QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
+  for (const QModelIndex &index : selected) {
+    collect(m_model->getItem(index));
+  }
+  if (items.isEmpty()) {
+    QMessageBox::information(this, "Replay", "Select requests or folders to replay.");
+    return;
+  }
+
+  QDialog dialog(this);
+  dialog.setWindowTitle("Replay Requests");
+  QFormLayout *layout = new QFormLayout(&dialog);
+  QComboBox *modeCombo = new QComboBox(&dialog);
+  modeCombo->addItems({"Update the saved responses", "Add the results as copies"});
+  QComboBox *schemeCombo = new QComboBox(&dialog);
+  schemeCombo->addItems({"HTTPS", "HTTP"});
+  QSpinBox *connectionsSpin = new QSpinBox(&dialog);
+  connectionsSpin->setRange(1, 256);
+  connectionsSpin->setValue(32);
+  QSpinBox *perHostSpin = new QSpinBox(&dialog);
+  perHostSpin->setRange(1, 64);
+  perHostSpin->setValue(6);
+  QCheckBox *verifyCheck = new QCheckBox("Verify TLS certificates", &dialog);
+  QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+  layout->addRow(QString("Replay %1 requests:").arg(items.size()), modeCombo);
+  layout->addRow("Scheme when the Host has no port:", schemeCombo);
+  layout->addRow("Connections:", connectionsSpin);
+  layout->addRow("Connections per host:", perHostSpin);
+  layout->addRow(verifyCheck);
+  layout->addRow(buttons);
+  connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+  connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+
+  ReplayEngine::Options options;
+  options.tls = schemeCombo->currentIndex() == 0;
+  options.maxConnections = connectionsSpin->value();
+  options.maxConnectionsPerHost = perHostSpin->value();
+  options.verifyPeer = verifyCheck->isChecked();
+  m_replayCopies = modeCombo->currentIndex() == 1;
+
+  m_replay = new ReplayEngine(options, this);
+  connect(m_replay, &ReplayEngine::resultsReady, this, &MainWindow::onReplayResults);
+  connect(m_replay, &ReplayEngine::finished, this, &MainWindow::onReplayFinished);
+  m_replayProgress = new QProgressDialog("Replaying requests...", "Cancel", 0, items.size(), this);
+  m_replayProgress->setWindowModality(Qt::WindowModal);
+  m_replayProgress->setMinimumDuration(500);
+  connect(m_replay, &ReplayEngine::progress, m_replayProgress, [this](int done, int total) {
+    m_replayProgress->setMaximum(total);
+    m_replayProgress->setValue(done);
+  });
+  connect(m_replayProgress, &QProgressDialog::canceled, this, [this]() {
+    m_replay->cancel();
+    onReplayFinished(-1, 0, QString());
+  });
+
+  for (const OrganizerItem *item : items) {
+    m_replay->replay(item);
+  }
+  if (!m_replay->isRunning()) {
+    onReplayFinished(0, 0, "None of the selected requests could be sent: they need a saved request with a host.");
+  }
+}
+
+void MainWindow::onReplayResults(const QList<QPair<int, OrganizerItem *>> &results) {
+  if (m_replayCopies) {
+    // Copies go next to their originals, one insert per parent folder
+    QMap<QPersistentModelIndex, QList<OrganizerItem *>> byParent;
+    for (const auto &result : results) {
+      QModelIndex original = m_model->indexForDbId(result.first);
+      if (original.isValid()) {
+        byParent[original.parent()].append(result.second);
       } else {
-        errorCount++;
+        delete result.second;
       }
     }
+    for (auto it = byParent.cbegin(); it != byParent.cend(); ++it) {
+      m_model->addRequests(it.key(), it.value());
+    }
+    return;
   }
 
-  if (xml.hasError()) {
-    QMessageBox::warning(this, "Import Error", "XML parsing error: " + xml.errorString());
+  // One transaction for the batch, then the items in memory
+  if (!DatabaseManager::instance().replaceItems(DatabaseManager::instance().database(), results)) {
+    for (const auto &result : results) {
+      delete result.second;
+    }
     return;
   }
+  OrganizerItem *current = m_currentIndex.isValid() ? m_model->getItem(m_currentIndex) : nullptr;
+  bool currentChanged = false;
+  for (const auto &result : results) {
+    currentChanged = currentChanged || (current && current->dbId() == result.first);
+  }
+  m_model->replaceItems(results);
+  if (currentChanged) {
+    updateRequestViewer(m_currentIndex);
+  }
+}
+
+void MainWindow::onReplayFinished(int succeeded, int failed, const QString &lastError) {
+  if (!m_replay) {
+    return;
+  }
+  m_replay->deleteLater();
+  m_replay = nullptr;
+  m_replayProgress->deleteLater();
+  m_replayProgress = nullptr;
+
+  if (succeeded < 0) {
+    return; // Cancelled
+  }
+  QString message = QString("Replayed %1 requests.").arg(succeeded);
+  if (failed > 0) {
+    message += QString("\n%1 failed; the last error was: %2").arg(failed).arg(lastError);
+    QMessageBox::warning(this, "Replay", message);
+  } else if (!lastError.isEmpty()) {
+    QMessageBox::warning(this, "Replay", lastError);
+  } else {
+    QMessageBox::information(this, "Replay", message);
+  }
+}
+
+void MainWindow::runExport(const QString &label, const std::function<QString(const std::atomic_bool *)> &job) {
+  std::shared_ptr<std::atomic_bool> cancel = std::make_shared<std::atomic_bool>(false);
+
+  QProgressDialog *progress = new QProgressDialog(label, "Cancel", 0, 0, this);
+  progress->setWindowModality(Qt::WindowModal);
+  progress->setMinimumDuration(500);
+  connect(progress, &QProgressDialog::canceled, this, [cancel]() { cancel->store(true); });
+
+  QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+  connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, progress, cancel]() {
+    watcher->deleteLater();
+    progress->deleteLater();
+    QString error = watcher->result();
+    if (!error.isEmpty() && !cancel->load()) {
+      QMessageBox::warning(this, "Export Error", error);
+    }
+  });
+  watcher->setFuture(QtConcurrent::run([job, cancel]() { return job(cancel.get()); }));
+}
+
+bool MainWindow::chooseDuplicates(ImportPipeline::Duplicates &duplicates) {
+  const QStringList choices = {"Skip requests already in the project",
+                               "Skip only exact duplicates (request and response)",
+                               "Replace the saved response", "Import everything as new"};
+  bool ok = false;
+  QString choice = QInputDialog::getItem(this, "Duplicate Requests",
+                                         "Requests that are already in the project:", choices, 0, false, &ok);
+  if (!ok) {
+    return false;
+  }
+  const ImportPipeline::Duplicates policies[] = {
+      ImportPipeline::Duplicates::SkipRequest, ImportPipeline::Duplicates::SkipExchange,
+      ImportPipeline::Duplicates::Replace, ImportPipeline::Duplicates::ImportAll};
+  duplicates = policies[choices.indexOf(choice)];
+  return true;
+}
+
+void MainWindow::startImport(ImportSource *source, const QString &title) {
+  if (!checkSingleSelection(title)) {
+    delete source;
+    return;
+  }
+  // An empty project has nothing to collide with
+  ImportPipeline::Duplicates duplicates = ImportPipeline::Duplicates::ImportAll;
+  if (m_model->rootItem()->childCount() > 0 && !chooseDuplicates(duplicates)) {
+    delete source;
+    return;
+  }
+
+  m_importParent = getSelectedIndex();
+  for (QAction *action : m_importActions) {
+    action->setEnabled(false);
+  }
+
+  // Parsing, decoding and saving all run off the GUI thread; saved batches arrive here
+  OrganizerItem *parentItem = m_model->getItem(m_importParent);
+  m_import = new ImportPipeline(source, parentItem ? parentItem->dbId() : -1, this);
+  m_importDuplicates = duplicates;
+  m_import->setDuplicates(duplicates);
+  connect(m_import, &ImportPipeline::batchReady, this, &MainWindow::onImportBatch);
+  connect(m_import, &ImportPipeline::itemsReplaced, m_model, &OrganizerModel::replaceItems);
+  connect(m_import, &ImportPipeline::progress, this, &MainWindow::onImportProgress);
+  connect(m_import, &ImportPipeline::finished, this, &MainWindow::onImportFinished);
+
+  m_importProgress = new QProgressDialog(title, "Cancel", 0, 1000, this);
+  m_importProgress->setWindowModality(Qt::WindowModal);
+  m_importProgress->setMinimumDuration(0);
+  m_importProgress->setAutoClose(false);
+  m_importProgress->setAutoReset(false);
+  connect(m_importProgress, &QProgressDialog::canceled, this, [this]() {
+    if (m_import) {
+      m_import->cancel();
+    }
+  });
+
+  m_import->start();
+}
+
+void MainWindow::stopImport() {
+  // Joins the pipeline's threads; finished is always their last signal
+  delete m_import;
+  m_import = nullptr;
+}
+
+void MainWindow::onImportBatch(const QList<OrganizerItem *> &items) {
+  RO_TRACE("MainWindow::onImportBatch");
+  // Adds the whole batch with one row insertion and one transaction
+  m_model->addRequests(m_importParent, items);
+  if (m_import) {
+    m_import->batchConsumed();
+  }
+}
+
+void MainWindow::onImportProgress(qint64 bytesRead, qint64 totalBytes) {
+  if (m_importProgress && totalBytes > 0) {
+    m_importProgress->setValue(int(bytesRead * 1000 / totalBytes));
+  }
+}
+
+void MainWindow::onImportFinished(int imported, int duplicates, int errors, bool cancelled, const QString &error) {
+  stopImport();
+  m_importProgress->close();
+  m_importProgress->deleteLater();
+  m_importProgress = nullptr;
+  for (QAction *action : m_importActions) {
+    action->setEnabled(true);
+  }
 
   // Expand parent if valid
-  if (parentIndex.isValid()) {
-    m_treeView->expand(parentIndex);
+  if (m_importParent.isValid()) {
+    m_treeView->expand(m_importParent);
   }
 
-  QMessageBox::information(this, "Import Complete", 
-    QString("Imported %1 requests successfully.\n%2 errors occurred.")
-    .arg(importedCount).arg(errorCount));
+  if (!error.isEmpty()) {
+    QMessageBox::warning(this, "Import Error",
+      QString("%1\n%2 requests were imported before the error.").arg(error).arg(imported));
+  } else if (cancelled) {
+    QMessageBox::information(this, "Import Cancelled",
+      QString("Import cancelled after %1 requests.").arg(imported));
+  } else {
+    QString message = QString("Imported %1 requests successfully.\n").arg(imported);
+    if (duplicates > 0) {
+      message += QString("%1 duplicates were %2.\n")
+        .arg(duplicates).arg(m_importDuplicates == ImportPipeline::Duplicates::Replace ? "replaced" : "skipped");
+    }
+    QMessageBox::information(this, "Import Complete", message + QString("%1 errors occurred.").arg(errors));
+  }
 }
@@ -21,8 +21,20 @@
 #include <QPushButton>
 #include <QPixmap>
 #include <QImage>
+#include <QStackedWidget>
+#include <QCheckBox>
+#include <QPersistentModelIndex>
+#include <QProgressDialog>
+#include <atomic>
+#include <functional>
 #include "OrganizerModel.h"
 #include "HttpSyntaxHighlighter.h"
+#include "HexView.h"
+#include "DiagnosticsPanel.h"
+#include "BodyCodec.h"
+#include "BurpXmlSource.h"
+#include "ImportPipeline.h"
+#include "ReplayEngine.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -48,12 +60,54 @@ private slots:
     void onScreenshotClicked();
     void onAddScreenshot();
     void onRemoveScreenshot();
+    void onThumbnailReady(int dbId);
+    void onScreenshotDecoded(int dbId, const QImage& image);
+    void onCompareItems();
+    void onFindInBodies();
+    void onFindNext();
+    void onImportHar();
+    void onImportCurl();
+    void onImportPostman();
+    void onImportOpenApi();
+    void onImportPcap();
+    void onExportHar();
+    void onExportRequests(int formatIndex);
+    void onExportBurp();
+    void onSaveTrace();
+    void onReplay();
+    void onReplayResults(const QList<QPair<int, OrganizerItem*>>& results);
+    void onReplayFinished(int succeeded, int failed, const QString& lastError);
+    void onFuzz();
+    void onLoadTest();
+    void onOutboundLimits();
+    void onImportBatch(const QList<OrganizerItem*>& items);
+    void onImportProgress(qint64 bytesRead, qint64 totalBytes);
+    void onImportFinished(int imported, int duplicates, int errors, bool cancelled, const QString& error);
 
 private:
     void setupUI();
     void setupMenuBar();
     void updateRequestViewer(const QModelIndex& index);
+    // First selected row; single-item actions call checkSingleSelection() first
     QModelIndex getSelectedIndex();
+    QModelIndexList getSelectedRequests();
+    // Selected rows without those inside another selected row
+    QModelIndexList getSelectedTopmost();
+    // Warns and returns false when more than one row is selected
+    bool checkSingleSelection(const QString& title);
+    bool chooseImportInput(const QString& title, const QString& what, const QString& filter,
+                           QString& fileName, QByteArray& content);
+    bool chooseDuplicates(ImportPipeline::Duplicates& duplicates);
+    void startImport(ImportSource* source, const QString& title);
+    void stopImport();
+    // Builds a detached tree on a worker, then adds it under the selection
+    void startTreeImport(const QString& label,
+                         const std::function<OrganizerItem*(QString*, const std::atomic_bool*)>& build);
+    // Runs an export on a worker behind a cancellable progress dialog; job returns an error or nothing
+    void runExport(const QString& label, const std::function<QString(const std::atomic_bool*)>& job);
+    void updateScreenshotBar(OrganizerItem* item);
+    void showBody(const QByteArray& data, const QStringList& codings, QTextEdit* edit, HexView* hex,
+                  QStackedWidget* stack, QLabel* label, const QString& title, BodyCodec::Decoded& decoded);
 
     QTreeView* m_treeView;
     OrganizerModel* m_model;
@@ -61,12 +115,32 @@ private:
     QSplitter* m_requestResponseSplitter;
     QTextEdit* m_requestEdit;
     QTextEdit* m_responseEdit;
+    HexView* m_requestHex;
+    HexView* m_responseHex;
+    QStackedWidget* m_requestStack;
+    QStackedWidget* m_responseStack;
+    BodyCodec::Decoded m_requestDecoded;  // How the viewer text was decoded, to re-encode edits
+    BodyCodec::Decoded m_responseDecoded;
+    QCheckBox* m_decodeCheck;
+    QString m_searchTerm;
     QLabel* m_requestLabel;
     QLabel* m_responseLabel;
     QPushButton* m_screenshotButton;
     QPushButton* m_removeScreenshotButton;
+    QLabel* m_thumbnailLabel;
+    int m_pendingScreenshotId;
     QModelIndex m_currentIndex;
+    QPersistentModelIndex m_decodedIndex; // Item whose decoded bodies the viewer keeps cached
     bool m_updatingViewer;
+    QList<QAction*> m_importActions;
+    ImportPipeline* m_import;
+    QProgressDialog* m_importProgress;
+    QPersistentModelIndex m_importParent;
+    ImportPipeline::Duplicates m_importDuplicates;
+    DiagnosticsPanel* m_diagnostics;
+    ReplayEngine* m_replay;
+    QProgressDialog* m_replayProgress;
+    bool m_replayCopies;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,434 @@
+#include "OpenApiImporter.h"
+#include "ImportPipeline.h"
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QUrl>
+
+namespace {
+    typedef QList<QPair<QByteArray, QByteArray>> Headers;
+
+    // Schemas nest and recurse; samples stop here
+    const int MaxSampleDepth = 8;
+
+    const char* const Methods[] = {"get", "put", "post", "delete", "options", "head", "patch", "trace"};
+
+    QString scalarText(const QJsonValue& value) {
+        switch (value.type()) {
+        case QJsonValue::String: return value.toString();
+        case QJsonValue::Double: return value.toVariant().toString();
+        case QJsonValue::Bool: return value.toBool() ? "true" : "false";
+        case QJsonValue::Array: return QString::fromUtf8(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+        case QJsonValue::Object: return QString::fromUtf8(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+        default: return QString();
+        }
+    }
+
+    class Builder {
+    public:
+        explicit Builder(const QJsonObject& spec) : m_spec(spec) {}
+
+        OrganizerItem* build();
+
+    private:
+        QJsonObject resolve(const QJsonValue& value) const;
+        QJsonValue sample(const QJsonValue& schema, int depth, QSet<QString>& refs) const;
+        QJsonValue exampleFor(const QJsonObject& holder) const;
+        QString baseUrl(const QJsonObject& operation, const QJsonObject& pathItem) const;
+        OrganizerItem* folderFor(const QJsonObject& operation, const QString& path);
+        OrganizerItem* buildOperation(const QString& path, const QString& method, const QJsonObject& pathItem,
+                                      const QJsonObject& operation) const;
+        void applySecurity(const QJsonObject& operation, Headers& headers, QStringList& query,
+                           QStringList& cookies) const;
+        QByteArray body(const QJsonObject& operation, const QList<QJsonObject>& parameters, Headers& headers) const;
+
+        QJsonObject m_spec;
+        OrganizerItem* m_root = nullptr;
+        QHash<QString, OrganizerItem*> m_folders;
+    };
+}
+
+QJsonObject Builder::resolve(const QJsonValue& value) const {
+    // Follows local "$ref": "#/components/..." pointers, a few levels deep
+    QJsonObject object = value.toObject();
+    for (int hops = 0; hops < 16 && object.contains("$ref"); ++hops) {
+        QString ref = object.value("$ref").toString();
+        if (!ref.startsWith("#/")) return QJsonObject();
+        QJsonValue target = m_spec;
+        for (QString part : ref.mid(2).split('/')) {
+            part.replace("~1", "/").replace("~0", "~");
+            target = target.toObject().value(part);
+        }
+        object = target.toObject();
+    }
+    return object;
+}
+
+QJsonValue Builder::sample(const QJsonValue& schemaValue, int depth, QSet<QString>& refs) const {
+    if (depth > MaxSampleDepth) return QJsonValue();
+
+    // Cyclic schemas end in null where the cycle closes
+    QString ref = schemaValue.toObject().value("$ref").toString();
+    if (!ref.isEmpty()) {
+        if (refs.contains(ref)) return QJsonValue();
+        refs.insert(ref);
+    }
+    QJsonObject schema = resolve(schemaValue);
+    QJsonValue result;
+
+    if (schema.contains("example")) {
+        result = schema.value("example");
+    } else if (schema.contains("default")) {
+        result = schema.value("default");
+    } else if (schema.value("enum").isArray() && !schema.value("enum").toArray().isEmpty()) {
+        result = schema.value("enum").toArray().first();
+    } else if (schema.value("allOf").isArray()) {
+        QJsonObject merged;
+        for (const QJsonValue& part : schema.value("allOf").toArray()) {
+            QJsonObject object = sample(part, depth + 1, refs).toObject();
+            for (auto it = object.constBegin(); it != object.constEnd(); ++it) merged.insert(it.key(), it.value());
+        }
+        result = merged;
+    } else if (schema.value("oneOf").isArray() || schema.value("anyOf").isArray()) {
+        QJsonArray choices = schema.value(schema.contains("oneOf") ? "oneOf" : "anyOf").toArray();
+        if (!choices.isEmpty()) result = sample(choices.first(), depth + 1, refs);
+    } else {
+        QJsonValue typeValue = schema.value("type");
+        // 3.1 allows a list of types; the first non-null one is used
+        QString type = typeValue.toString();
+        for (const QJsonValue& entry : typeValue.toArray()) {
+            if (entry.toString() != "null") {
+                type = entry.toString();
+                break;
+            }
+        }
+        if (type.isEmpty() && schema.contains("properties")) type = "object";
+
+        if (type == "object") {
+            QJsonObject object;
+            QJsonObject properties = schema.value("properties").toObject();
+            for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+                object.insert(it.key(), sample(it.value(), depth + 1, refs));
+            }
+            result = object;
+        } else if (type == "array") {
+            QJsonValue item = sample(schema.value("items"), depth + 1, refs);
+            result = item.isNull() ? QJsonArray() : QJsonArray{item};
+        } else if (type == "integer" || type == "number") {
+            result = schema.contains("minimum") ? schema.value("minimum") : QJsonValue(0);
+        } else if (type == "boolean") {
+            result = true;
+        } else if (type == "string") {
+            QString format = schema.value("format").toString();
+            if (format == "date-time") result = "2024-01-01T00:00:00Z";
+            else if (format == "date") result = "2024-01-01";
+            else if (format == "uuid") result = "00000000-0000-0000-0000-000000000000";
+            else if (format == "email") result = "user@example.com";
+            else if (format == "uri" || format == "url") result = "https://example.com";
+            else result = "string";
+        }
+    }
+
+    if (!ref.isEmpty()) refs.remove(ref);
+    return result;
+}
+
+QJsonValue Builder::exampleFor(const QJsonObject& holder) const {
+    // Parameters and media types carry example, examples{...} or a schema
+    if (holder.contains("example")) return holder.value("example");
+    QJsonObject examples = holder.value("examples").toObject();
+    if (!examples.isEmpty()) {
+        QJsonObject first = resolve(examples.constBegin().value());
+        if (first.contains("value")) return first.value("value");
+    }
+    QSet<QString> refs;
+    return sample(holder.value("schema"), 0, refs);
+}
+
+QString Builder::baseUrl(const QJsonObject& operation, const QJsonObject& pathItem) const {
+    if (m_spec.contains("swagger")) {
+        QJsonArray schemes = m_spec.value("schemes").toArray();
+        QString scheme = schemes.isEmpty() ? "https" : schemes.first().toString();
+        QString host = m_spec.value("host").toString("localhost");
+        QString basePath = m_spec.value("basePath").toString();
+        if (basePath.endsWith('/')) basePath.chop(1);
+        return scheme + "://" + host + basePath;
+    }
+
+    // The most specific servers list wins
+    QJsonArray servers = operation.value("servers").toArray();
+    if (servers.isEmpty()) servers = pathItem.value("servers").toArray();
+    if (servers.isEmpty()) servers = m_spec.value("servers").toArray();
+    QJsonObject server = servers.isEmpty() ? QJsonObject() : servers.first().toObject();
+
+    QString url = server.value("url").toString();
+    QJsonObject variables = server.value("variables").toObject();
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it) {
+        url.replace("{" + it.key() + "}", it.value().toObject().value("default").toVariant().toString());
+    }
+    if (url.startsWith("//")) url.prepend("https:");
+    else if (!url.contains("://")) url.prepend("http://localhost" + QString(url.startsWith('/') || url.isEmpty() ? "" : "/"));
+    if (url.endsWith('/')) url.chop(1);
+    return url;
+}
+
+OrganizerItem* Builder::folderFor(const QJsonObject& operation, const QString& path) {
+    QString name;
+    QJsonArray tags = operation.value("tags").toArray();
+    if (!tags.isEmpty()) {
+        name = tags.first().toString();
+    } else {
+        for (const QString& segment : path.split('/', Qt::SkipEmptyParts)) {
+            if (!segment.startsWith('{')) {
+                name = segment;
+                break;
+            }
+        }
+    }
+    if (name.isEmpty()) name = "default";
+
+    OrganizerItem*& folder = m_folders[name];
+    if (!folder) {
+        folder = new OrganizerItem(ItemType::Folder, name);
+        m_root->appendChild(folder);
+    }
+    return folder;
+}
+
+void Builder::applySecurity(const QJsonObject& operation, Headers& headers, QStringList& query,
+                            QStringList& cookies) const {
+    QJsonValue security = operation.contains("security") ? operation.value("security") : m_spec.value("security");
+    QJsonArray requirements = security.toArray();
+    if (requirements.isEmpty()) return;
+
+    // Only the first alternative is applied; its schemes are all required
+    QJsonObject schemes = m_spec.contains("swagger") ? m_spec.value("securityDefinitions").toObject()
+                                                     : m_spec.value("components").toObject().value("securitySchemes").toObject();
+    QJsonObject requirement = requirements.first().toObject();
+    for (auto it = requirement.constBegin(); it != requirement.constEnd(); ++it) {
+        QJsonObject scheme = resolve(schemes.value(it.key()));
+        QString type = scheme.value("type").toString();
+        QString httpScheme = scheme.value("scheme").toString().toLower();
+        if ((type == "http" && httpScheme == "basic") || type == "basic") {
+            headers.append({"Authorization", "Basic " + QByteArray("username:password").toBase64()});
+        } else if (type == "http" || type == "oauth2" || type == "openIdConnect") {
+            headers.append({"Authorization", "Bearer <token>"});
+        } else if (type == "apiKey") {
+            QString name = scheme.value("name").toString();
+            QString in = scheme.value("in").toString();
+            if (in == "query") query.append(QString::fromLatin1(QUrl::toPercentEncoding(name)) + "=%3Capi-key%3E");
+            else if (in == "cookie") cookies.append(name + "=<api-key>");
+            else headers.append({name.toLatin1(), "<api-key>"});
+        }
+    }
+}
+
+QByteArray Builder::body(const QJsonObject& operation, const QList<QJsonObject>& parameters, Headers& headers) const {
+    QString contentType;
+    QJsonValue example;
+    bool hasBody = false;
+
+    if (operation.contains("requestBody")) {
+        QJsonObject content = resolve(operation.value("requestBody")).value("content").toObject();
+        if (content.isEmpty()) return QByteArray();
+        contentType = content.contains("application/json") ? "application/json" : content.constBegin().key();
+        example = exampleFor(resolve(content.value(contentType)));
+        hasBody = true;
+    } else {
+        // Swagger 2: one "body" parameter, or "formData" parameters
+        QJsonObject form;
+        for (const QJsonObject& parameter : parameters) {
+            QString in = parameter.value("in").toString();
+            if (in == "body") {
+                QSet<QString> refs;
+                example = sample(parameter.value("schema"), 0, refs);
+                QJsonArray consumes = operation.value("consumes").toArray();
+                if (consumes.isEmpty()) consumes = m_spec.value("consumes").toArray();
+                contentType = consumes.isEmpty() ? "application/json" : consumes.first().toString();
+                hasBody = true;
+            } else if (in == "formData") {
+                QSet<QString> refs;
+                form.insert(parameter.value("name").toString(),
+                            parameter.contains("default") ? parameter.value("default") : sample(parameter, 0, refs));
+            }
+        }
+        if (!form.isEmpty() && !hasBody) {
+            example = form;
+            contentType = "application/x-www-form-urlencoded";
+            hasBody = true;
+        }
+    }
+    if (!hasBody) return QByteArray();
+
+    QByteArray data;
+    QString mediaType = contentType.section(';', 0, 0).trimmed().toLower();
+    if (mediaType == "application/x-www-form-urlencoded" || mediaType == "multipart/form-data") {
+        QJsonObject fields = example.toObject();
+        if (mediaType == "multipart/form-data") {
+            const QByteArray boundary = "----RequestOrganizerBoundary";
+            for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+                data += "--" + boundary + "\r\nContent-Disposition: form-data; name=\"" + it.key().toUtf8() +
+                        "\"\r\n\r\n" + scalarText(it.value()).toUtf8() + "\r\n";
+            }
+            data += "--" + boundary + "--\r\n";
+            contentType = "multipart/form-data; boundary=" + boundary;
+        } else {
+            QList<QByteArray> pairs;
+            for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+                pairs.append(QUrl::toPercentEncoding(it.key()) + "=" + QUrl::toPercentEncoding(scalarText(it.value())));
+            }
+            data = pairs.join('&');
+        }
+    } else if (example.isString() && !mediaType.contains("json")) {
+        data = example.toString().toUtf8();
+    } else if (example.isObject()) {
+        data = QJsonDocument(example.toObject()).toJson(QJsonDocument::Indented);
+    } else if (example.isArray()) {
+        data = QJsonDocument(example.toArray()).toJson(QJsonDocument::Indented);
+    } else if (!example.isNull() && !example.isUndefined()) {
+        data = scalarText(example).toUtf8();
+    }
+
+    bool hasContentType = false;
+    for (const auto& header : headers) {
+        if (qstricmp(header.first.constData(), "content-type") == 0) hasContentType = true;
+    }
+    if (!hasContentType) headers.append({"Content-Type", contentType.toLatin1()});
+    return data;
+}
+
+OrganizerItem* Builder::buildOperation(const QString& path, const QString& method, const QJsonObject& pathItem,
+                                       const QJsonObject& operation) const {
+    // Operation parameters override path-level ones with the same name and location
+    QList<QJsonObject> parameters;
+    QSet<QString> seen;
+    for (const QJsonValue& value : operation.value("parameters").toArray()) {
+        QJsonObject parameter = resolve(value);
+        seen.insert(parameter.value("in").toString() + ":" + parameter.value("name").toString());
+        parameters.append(parameter);
+    }
+    for (const QJsonValue& value : pathItem.value("parameters").toArray()) {
+        QJsonObject parameter = resolve(value);
+        if (!seen.contains(parameter.value("in").toString() + ":" + parameter.value("name").toString())) {
+            parameters.append(parameter);
+        }
+    }
+
+    QString resolvedPath = path;
+    QStringList query;
+    QStringList cookies;
+    Headers headers;
+    for (const QJsonObject& parameter : parameters) {
+        QString name = parameter.value("name").toString();
+        QString in = parameter.value("in").toString();
+        if (in == "body" || in == "formData") continue;
+
+        // Swagger 2 keeps type and default on the parameter itself
+        QJsonValue example = parameter.contains("schema") || parameter.contains("example") || parameter.contains("examples")
+                                 ? exampleFor(parameter) : (parameter.contains("default") ? parameter.value("default") : QJsonValue());
+        if (example.isNull() && !parameter.contains("schema")) {
+            QSet<QString> refs;
+            example = sample(parameter, 0, refs);
+        }
+        QString value = scalarText(example);
+
+        if (in == "path") {
+            resolvedPath.replace("{" + name + "}", QString::fromLatin1(QUrl::toPercentEncoding(value.isEmpty() ? name : value)));
+        } else if (in == "query") {
+            if (parameter.value("required").toBool() || parameter.contains("example") || !value.isEmpty()) {
+                query.append(QString::fromLatin1(QUrl::toPercentEncoding(name) + "=" + QUrl::toPercentEncoding(value)));
+            }
+        } else if (in == "header") {
+            headers.append({name.toLatin1(), value.toUtf8()});
+        } else if (in == "cookie") {
+            cookies.append(name + "=" + value);
+        }
+    }
+
+    applySecurity(operation, headers, query, cookies);
+    if (!cookies.isEmpty()) headers.append({"Cookie", cookies.join("; ").toUtf8()});
+
+    QByteArray upperMethod = method.toUpper().toLatin1();
+    QByteArray data = body(operation, parameters, headers);
+    QByteArray url = (baseUrl(operation, pathItem) + resolvedPath).toUtf8();
+    if (!query.isEmpty()) url += "?" + query.join('&').toUtf8();
+
+    ImportRecord record;
+    record.name = operation.value("summary").toString();
+    if (record.name.isEmpty()) record.name = operation.value("operationId").toString();
+    if (record.name.isEmpty()) record.name = QString::fromLatin1(upperMethod) + " " + path;
+    record.method = QString::fromLatin1(upperMethod);
+    record.url = QString::fromUtf8(url);
+    record.comment = operation.value("description").toString();
+    record.request = ImportPipeline::buildRequest(upperMethod, url, headers, data);
+    return ImportPipeline::createItem(record);
+}
+
+OrganizerItem* Builder::build() {
+    QJsonObject info = m_spec.value("info").toObject();
+    QString title = info.value("title").toString();
+    QString version = info.value("version").toString();
+    if (title.isEmpty()) title = "OpenAPI";
+    m_root = new OrganizerItem(ItemType::Folder, version.isEmpty() ? title : title + " " + version);
+    m_root->setAnnotation(info.value("description").toString());
+
+    // Declared tags keep their declared order and descriptions
+    for (const QJsonValue& value : m_spec.value("tags").toArray()) {
+        QJsonObject tag = value.toObject();
+        QString name = tag.value("name").toString();
+        if (name.isEmpty() || m_folders.contains(name)) continue;
+        OrganizerItem* folder = new OrganizerItem(ItemType::Folder, name);
+        folder->setAnnotation(tag.value("description").toString());
+        m_root->appendChild(folder);
+        m_folders.insert(name, folder);
+    }
+
+    QJsonObject paths = m_spec.value("paths").toObject();
+    for (auto it = paths.constBegin(); it != paths.constEnd(); ++it) {
+        QJsonObject pathItem = resolve(it.value());
+        for (const char* method : Methods) {
+            QJsonValue operationValue = pathItem.value(QLatin1String(method));
+            if (!operationValue.isObject()) continue;
+            QJsonObject operationObject = operationValue.toObject();
+            OrganizerItem* item = buildOperation(it.key(), QString::fromLatin1(method), pathItem, operationObject);
+            if (item) folderFor(operationObject, it.key())->appendChild(item);
+        }
+    }
+
+    // Declared tags nothing used
+    for (int i = m_root->childCount() - 1; i >= 0; --i) {
+        OrganizerItem* folder = m_root->child(i);
+        if (folder->childCount() == 0) {
+            m_root->removeChild(i);
+        }
+    }
+    return m_root;
+}
+
+OrganizerItem* OpenApiImporter::importFile(const QString& fileName, QString* error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Could not open file: " + fileName;
+        return nullptr;
+    }
+    return importSpec(file.readAll(), error);
+}
+
+OrganizerItem* OpenApiImporter::importSpec(const QByteArray& json, QString* error) {
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (document.isNull()) {
+        // YAML specs need converting first, e.g. with the Swagger editor
+        if (error) *error = "JSON parsing error: " + parseError.errorString() + "\nOnly JSON specs are supported.";
+        return nullptr;
+    }
+    QJsonObject spec = document.object();
+    if (!spec.contains("openapi") && !spec.contains("swagger")) {
+        if (error) *error = "Not an OpenAPI document";
+        return nullptr;
+    }
+    return Builder(spec).build();
+}
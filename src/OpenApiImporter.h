@@ -0,0 +1,21 @@
+#ifndef OPENAPIIMPORTER_H
+#define OPENAPIIMPORTER_H
+
+#include <QByteArray>
+#include <QString>
+#include "OrganizerItem.h"
+
+// Turns an OpenAPI 3 (or Swagger 2) JSON document into a folder tree: one
+// folder per tag (or first path segment for untagged operations) and one
+// request per operation. Parameters, bodies and security are filled from
+// examples, defaults or a sample generated from the schema. Like
+// PostmanImporter, nothing touches the model or the database.
+namespace OpenApiImporter {
+
+// Returns the spec folder, or null with error set
+OrganizerItem* importFile(const QString& fileName, QString* error = nullptr);
+OrganizerItem* importSpec(const QByteArray& json, QString* error = nullptr);
+
+} // namespace OpenApiImporter
+
+#endif // OPENAPIIMPORTER_H
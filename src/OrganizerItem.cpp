@@ -1,4 +1,6 @@
 #include "OrganizerItem.h"
+#include "ContentHash.h"
+#include "HttpDecoder.h"
 
 OrganizerItem::OrganizerItem(ItemType type, const QString& name, OrganizerItem* parent)
     : m_type(type)
@@ -8,10 +10,17 @@ OrganizerItem::OrganizerItem(ItemType type, const QString& name, OrganizerItem*
     , m_requestDetails("")
     , m_expanded(true)
     , m_dbId(-1)
-    , m_request("")
-    , m_response("")
+    , m_decodedRequestValid(false)
+    , m_decodedResponseValid(false)
+    , m_requestIndexValid(false)
+    , m_responseIndexValid(false)
+    , m_requestHash(0)
+    , m_responseHash(0)
+    , m_requestHashValid(false)
+    , m_responseHashValid(false)
     , m_host("")
     , m_url("")
+    , m_port(0)
     , m_method("")
     , m_responseTime(0)
     , m_query("")
@@ -19,6 +28,7 @@ OrganizerItem::OrganizerItem(ItemType type, const QString& name, OrganizerItem*
     , m_length(0)
     , m_timestamp(0)
     , m_screenshot("")
+    , m_thumbnailUnavailable(false)
     , m_parent(parent)
 {
 }
@@ -27,6 +37,73 @@ OrganizerItem::~OrganizerItem() {
     qDeleteAll(m_children);
 }
 
+const HttpMessageIndex& OrganizerItem::requestIndex() const {
+    if (!m_requestIndexValid) {
+        m_requestIndex = HttpMessageIndex::parse(m_request);
+        m_requestIndexValid = true;
+    }
+    return m_requestIndex;
+}
+
+const HttpMessageIndex& OrganizerItem::responseIndex() const {
+    if (!m_responseIndexValid) {
+        m_responseIndex = HttpMessageIndex::parse(m_response);
+        m_responseIndexValid = true;
+    }
+    return m_responseIndex;
+}
+
+quint64 OrganizerItem::requestHash() const {
+    if (!m_requestHashValid) {
+        m_requestHash = ContentHash::hash(m_request);
+        m_requestHashValid = true;
+    }
+    return m_requestHash;
+}
+
+quint64 OrganizerItem::responseHash() const {
+    if (!m_responseHashValid) {
+        m_responseHash = ContentHash::hash(m_response);
+        m_responseHashValid = true;
+    }
+    return m_responseHash;
+}
+
+QByteArray OrganizerItem::decodedRequest() const {
+    if (!m_decodedRequestValid) {
+        m_requestCodings.clear();
+        m_decodedRequest = HttpDecoder::decode(m_request, requestIndex(), &m_requestCodings);
+        m_decodedRequestValid = true;
+    }
+    return m_decodedRequest;
+}
+
+QByteArray OrganizerItem::decodedResponse() const {
+    if (!m_decodedResponseValid) {
+        m_responseCodings.clear();
+        m_decodedResponse = HttpDecoder::decode(m_response, responseIndex(), &m_responseCodings);
+        m_decodedResponseValid = true;
+    }
+    return m_decodedResponse;
+}
+
+QByteArray OrganizerItem::decodedRequestUncached() const {
+    return m_decodedRequestValid ? m_decodedRequest : HttpDecoder::decode(m_request, requestIndex());
+}
+
+QByteArray OrganizerItem::decodedResponseUncached() const {
+    return m_decodedResponseValid ? m_decodedResponse : HttpDecoder::decode(m_response, responseIndex());
+}
+
+void OrganizerItem::releaseDecoded() const {
+    m_decodedRequest = QByteArray();
+    m_decodedResponse = QByteArray();
+    m_requestCodings.clear();
+    m_responseCodings.clear();
+    m_decodedRequestValid = false;
+    m_decodedResponseValid = false;
+}
+
 void OrganizerItem::appendChild(OrganizerItem* child) {
     if (child) {
         child->setParent(this);
@@ -250,3 +327,23 @@ OrganizerItem* OrganizerItem::parent() {
 const OrganizerItem* OrganizerItem::parent() const {
     return m_parent;
 }
+
+void OrganizerItem::addMemoryUsage(MemoryUsage& usage) const {
+    usage.bodies += m_request.capacity() + m_response.capacity();
+    if (m_decodedRequestValid && m_decodedRequest.constData() != m_request.constData()) {
+        usage.decoded += m_decodedRequest.capacity();
+    }
+    if (m_decodedResponseValid && m_decodedResponse.constData() != m_response.constData()) {
+        usage.decoded += m_decodedResponse.capacity();
+    }
+    if (m_requestIndexValid) {
+        usage.indexes += m_requestIndex.headers().capacity() * qint64(sizeof(HttpMessageIndex::Header));
+    }
+    if (m_responseIndexValid) {
+        usage.indexes += m_responseIndex.headers().capacity() * qint64(sizeof(HttpMessageIndex::Header));
+    }
+    usage.screenshots += m_screenshot.capacity() * qint64(sizeof(QChar)) + m_thumbnail.capacity();
+    usage.metadata += qint64(sizeof(OrganizerItem)) + m_children.capacity() * qint64(sizeof(OrganizerItem*))
+        + (m_name.capacity() + m_annotation.capacity() + m_requestDetails.capacity() + m_host.capacity()
+           + m_url.capacity() + m_scheme.capacity() + m_method.capacity() + m_query.capacity()) * qint64(sizeof(QChar));
+}
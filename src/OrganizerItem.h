@@ -2,11 +2,14 @@
 #define ORGANIZERITEM_H
 
 #include <QString>
+#include <QByteArray>
 #include <QColor>
 #include <QList>
+#include <QStringList>
 #include <QVariant>
 #include <QtGlobal>
 #include <QDateTime>
+#include "HttpMessageIndex.h"
 
 enum class ItemType {
     Folder,
@@ -50,11 +53,36 @@ public:
     int dbId() const { return m_dbId; }
     void setDbId(int id) { m_dbId = id; }
     
-    QString request() const { return m_request; }
-    void setRequest(const QString& request) { m_request = request; }
-    
-    QString response() const { return m_response; }
-    void setResponse(const QString& response) { m_response = response; }
+    // Raw message bytes exactly as captured; never round-tripped through text
+    QByteArray request() const { return m_request; }
+    void setRequest(const QByteArray& request) { m_request = request; m_decodedRequestValid = false; m_requestIndexValid = false; m_requestHashValid = false; }
+    
+    QByteArray response() const { return m_response; }
+    void setResponse(const QByteArray& response) { m_response = response; m_decodedResponseValid = false; m_responseIndexValid = false; m_responseHashValid = false; }
+    
+    // Parsed start line, headers and body offset of the raw bytes, built once
+    // per body so lookups never re-scan the message
+    const HttpMessageIndex& requestIndex() const;
+    const HttpMessageIndex& responseIndex() const;
+    
+    // ContentHash of the raw bytes, computed on first use; what duplicate
+    // detection compares against the stored request_hash/response_hash
+    quint64 requestHash() const;
+    quint64 responseHash() const;
+    
+    // De-chunked and inflated copies for display, search and export. Computed
+    // on first use and cached until the raw bytes change; shares the raw data
+    // when there was nothing to decode.
+    QByteArray decodedRequest() const;
+    QByteArray decodedResponse() const;
+    QStringList requestCodings() const { decodedRequest(); return m_requestCodings; }
+    QStringList responseCodings() const { decodedResponse(); return m_responseCodings; }
+    // The same bytes for one-off scans (search, export): taken from the cache
+    // when it is filled, otherwise decoded into a copy that isn't kept
+    QByteArray decodedRequestUncached() const;
+    QByteArray decodedResponseUncached() const;
+    // Drops the cached decoded copies; the viewer keeps only its current item's
+    void releaseDecoded() const;
     
     QString host() const { return m_host; }
     void setHost(const QString& host) { m_host = host; }
@@ -62,6 +90,13 @@ public:
     QString url() const { return m_url; }
     void setUrl(const QString& url) { m_url = url; }
     
+    // Where the request was sent, as captured: "http" or "https" and the
+    // port; empty and 0 when the source didn't say (see RequestOrigin)
+    QString scheme() const { return m_scheme; }
+    void setScheme(const QString& scheme) { m_scheme = scheme; }
+    int port() const { return m_port; }
+    void setPort(int port) { m_port = port; }
+    
     QString method() const { return m_method; }
     void setMethod(const QString& method) { m_method = method; }
     
@@ -84,9 +119,28 @@ public:
     void setScreenshot(const QString& screenshot) { m_screenshot = screenshot; }
     bool hasScreenshot() const { return !m_screenshot.isEmpty(); }
 
+    // Small JPEG preview of the screenshot, generated in the background
+    QByteArray thumbnail() const { return m_thumbnail; }
+    void setThumbnail(const QByteArray& thumbnail) { m_thumbnail = thumbnail; }
+    bool hasThumbnail() const { return !m_thumbnail.isEmpty(); }
+    // The screenshot couldn't be decoded, so no thumbnail is coming
+    bool isThumbnailUnavailable() const { return m_thumbnailUnavailable; }
+    void setThumbnailUnavailable(bool unavailable) { m_thumbnailUnavailable = unavailable; }
+
     bool isExpanded() const { return m_expanded; }
     void setExpanded(bool expanded) { m_expanded = expanded; }
 
+    // Estimated heap use of this item alone, not its children, by what holds
+    // it. Decoded copies that share the raw bytes count nothing.
+    struct MemoryUsage {
+        qint64 bodies = 0;      // Raw request and response
+        qint64 decoded = 0;     // Cached dechunked/inflated copies
+        qint64 indexes = 0;     // Cached header indexes
+        qint64 screenshots = 0; // Base64 screenshots and thumbnails
+        qint64 metadata = 0;    // The item, its strings and child list
+    };
+    void addMemoryUsage(MemoryUsage& usage) const;
+
 private:
     ItemType m_type;
     QString m_name;
@@ -95,10 +149,26 @@ private:
     QString m_requestDetails;
     bool m_expanded;
     int m_dbId;
-    QString m_request;
-    QString m_response;
+    QByteArray m_request;
+    QByteArray m_response;
+    mutable QByteArray m_decodedRequest;
+    mutable QByteArray m_decodedResponse;
+    mutable QStringList m_requestCodings;
+    mutable QStringList m_responseCodings;
+    mutable bool m_decodedRequestValid;
+    mutable bool m_decodedResponseValid;
+    mutable HttpMessageIndex m_requestIndex;
+    mutable HttpMessageIndex m_responseIndex;
+    mutable bool m_requestIndexValid;
+    mutable bool m_responseIndexValid;
+    mutable quint64 m_requestHash;
+    mutable quint64 m_responseHash;
+    mutable bool m_requestHashValid;
+    mutable bool m_responseHashValid;
     QString m_host;
     QString m_url;
+    QString m_scheme;
+    int m_port;
     QString m_method;
     qint64 m_responseTime;
     QString m_query;
@@ -106,6 +176,8 @@ private:
     qint64 m_length;
     qint64 m_timestamp;
     QString m_screenshot;
+    QByteArray m_thumbnail;
+    bool m_thumbnailUnavailable;
     
     OrganizerItem* m_parent;
     QList<OrganizerItem*> m_children;
@@ -1,4 +1,5 @@
 #include "OrganizerModel.h"
+#include "Trace.h"
 #include <QSqlQuery>
 #include <QDebug>
 #include <QDataStream>
@@ -6,14 +7,20 @@
 #include <QByteArray>
 #include <QIODevice>
 #include <QSet>
+#include <QPixmap>
 
 OrganizerModel::OrganizerModel(QObject* parent)
     : QAbstractItemModel(parent)
+    , m_screenshotLoader(new ScreenshotLoader(this))
+    , m_thumbnailIcons(256)
 {
     m_rootItem = new OrganizerItem(ItemType::Folder, "Root");
     
+    connect(m_screenshotLoader, &ScreenshotLoader::thumbnailReady, this, &OrganizerModel::onThumbnailReady);
+    
     if (DatabaseManager::instance().initialize()) {
         loadItemsFromDatabase();
+        queueMissingThumbnails(m_rootItem);
     }
 }
 
@@ -39,6 +46,17 @@ QVariant OrganizerModel::data(const QModelIndex& index, int role) const {
             int brightness = (bgColor.red() + bgColor.green() + bgColor.blue()) / 3;
             return brightness < 128 ? QColor(Qt::white) : QColor(Qt::black);
         }
+    } else if (role == Qt::DecorationRole) {
+        if (index.column() == 0 && item->hasThumbnail()) {
+            QIcon* icon = m_thumbnailIcons.object(item->dbId());
+            if (!icon) {
+                QPixmap pixmap;
+                pixmap.loadFromData(item->thumbnail(), "JPG");
+                icon = new QIcon(pixmap);
+                m_thumbnailIcons.insert(item->dbId(), icon);
+            }
+            return *icon;
+        }
     }
 
     return QVariant();
@@ -264,7 +282,77 @@ QModelIndex OrganizerModel::addRequest(const QString& name, const QModelIndex& p
     return index(row, 0, parent);
 }
 
-void OrganizerModel::setRequest(const QModelIndex& index, const QString& request) {
+void OrganizerModel::addRequests(const QModelIndex& parent, const QList<OrganizerItem*>& items) {
+    if (items.isEmpty()) return;
+
+    OrganizerItem* parentItem = getItem(parent);
+    int row = parentItem->childCount();
+
+    QList<OrganizerItem*> unsaved;
+    for (OrganizerItem* item : items) {
+        if (item->dbId() == -1) unsaved.append(item);
+    }
+    if (!unsaved.isEmpty()) {
+        // One transaction for the whole batch
+        DatabaseManager::instance().insertItems(DatabaseManager::instance().database(), unsaved, getParentDbId(parent));
+    }
+
+    beginInsertRows(parent, row, row + items.size() - 1);
+    for (OrganizerItem* item : items) {
+        parentItem->appendChild(item);
+        if (item->dbId() != -1) {
+            m_itemsById[item->dbId()] = item;
+        }
+    }
+    endInsertRows();
+}
+
+void OrganizerModel::addTree(const QModelIndex& parent, OrganizerItem* root) {
+    OrganizerItem* parentItem = getItem(parent);
+    int row = parentItem->childCount();
+
+    // One transaction for the whole tree
+    DatabaseManager::instance().insertTree(DatabaseManager::instance().database(), root, getParentDbId(parent));
+
+    // A single inserted row carries the whole subtree into the view
+    beginInsertRows(parent, row, row);
+    parentItem->appendChild(root);
+    registerTree(root);
+    endInsertRows();
+}
+
+void OrganizerModel::replaceItems(const QList<QPair<int, OrganizerItem*>>& replacements) {
+    for (const auto& replacement : replacements) {
+        OrganizerItem* imported = replacement.second;
+        OrganizerItem* item = m_itemsById.value(replacement.first, nullptr);
+        if (item) {
+            item->setRequest(imported->request());
+            item->setResponse(imported->response());
+            item->setResponseTime(imported->responseTime());
+            item->setStatus(imported->status());
+            item->setLength(imported->length());
+            item->setTimestamp(imported->timestamp());
+            emit dataChanged(createIndex(item->row(), 0, item), createIndex(item->row(), columnCount() - 1, item));
+        }
+        delete imported;
+    }
+}
+
+QModelIndex OrganizerModel::indexForDbId(int dbId) const {
+    OrganizerItem* item = m_itemsById.value(dbId, nullptr);
+    return item ? createIndex(item->row(), 0, item) : QModelIndex();
+}
+
+void OrganizerModel::registerTree(OrganizerItem* item) {
+    if (item->dbId() != -1) {
+        m_itemsById[item->dbId()] = item;
+    }
+    for (OrganizerItem* child : item->children()) {
+        registerTree(child);
+    }
+}
+
+void OrganizerModel::setRequest(const QModelIndex& index, const QByteArray& request) {
     OrganizerItem* item = getItem(index);
     if (item && item->type() == ItemType::Request) {
         item->setRequest(request);
@@ -273,7 +361,7 @@ void OrganizerModel::setRequest(const QModelIndex& index, const QString& request
     }
 }
 
-void OrganizerModel::setResponse(const QModelIndex& index, const QString& response) {
+void OrganizerModel::setResponse(const QModelIndex& index, const QByteArray& response) {
     OrganizerItem* item = getItem(index);
     if (item && item->type() == ItemType::Request) {
         item->setResponse(response);
@@ -283,82 +371,16 @@ void OrganizerModel::setResponse(const QModelIndex& index, const QString& respon
 }
 
 void OrganizerModel::loadItemsFromDatabase() {
-    QSqlQuery query("SELECT id, type, name, annotation, color, request, response, parent_id, "
-                    "COALESCE(host, '') as host, COALESCE(url, '') as url, "
-                    "COALESCE(method, '') as method, COALESCE(response_time, 0) as response_time, "
-                    "COALESCE(query, '') as query, COALESCE(status, 0) as status, "
-                    "COALESCE(length, 0) as length, COALESCE(timestamp, 0) as timestamp, "
-                    "COALESCE(screenshot, '') as screenshot "
-                    "FROM items ORDER BY id", 
-                    DatabaseManager::instance().database());
-    
-    QMap<int, OrganizerItem*> itemsMap;
-    QMap<int, int> parentMap; // Maps item id to parent id
-    
-    // First pass: create all items
-    while (query.next()) {
-        int id = query.value(0).toInt();
-        ItemType type = static_cast<ItemType>(query.value(1).toInt());
-        QString name = query.value(2).toString();
-        QString annotation = query.value(3).toString();
-        QColor color = QColor(query.value(4).toString());
-        QString request = query.value(5).toString();
-        QString response = query.value(6).toString();
-        int parentId = query.value(7).toInt();
-        QString host = query.value(8).toString();
-        QString url = query.value(9).toString();
-        QString method = query.value(10).toString();
-        qint64 responseTime = query.value(11).toLongLong();
-        QString queryStr = query.value(12).toString();
-        int status = query.value(13).toInt();
-        qint64 length = query.value(14).toLongLong();
-        qint64 timestamp = query.value(15).toLongLong();
-        QString screenshot = query.value(16).toString();
-        
-        OrganizerItem* item = new OrganizerItem(type, name);
-        item->setDbId(id);
-        item->setAnnotation(annotation);
-        item->setColor(color);
-        item->setRequest(request);
-        item->setResponse(response);
-        item->setHost(host);
-        item->setUrl(url);
-        item->setMethod(method);
-        item->setResponseTime(responseTime);
-        item->setQuery(queryStr);
-        item->setStatus(status);
-        item->setLength(length);
-        item->setTimestamp(timestamp);
-        item->setScreenshot(screenshot);
-        
-        itemsMap[id] = item;
-        m_itemsById[id] = item;
-        parentMap[id] = parentId;
-    }
-    
-    // Second pass: establish parent-child relationships
-    for (auto it = itemsMap.begin(); it != itemsMap.end(); ++it) {
-        int id = it.key();
-        OrganizerItem* item = it.value();
-        int parentId = parentMap[id];
-        
-        if (parentId == 0 || !itemsMap.contains(parentId)) {
-            // Root level item
-            m_rootItem->appendChild(item);
-        } else {
-            // Child item
-            OrganizerItem* parent = itemsMap[parentId];
-            parent->appendChild(item);
-        }
+    RO_TRACE("OrganizerModel::loadItemsFromDatabase");
+    DatabaseManager::instance().loadTree(m_rootItem);
+    for (OrganizerItem* child : m_rootItem->children()) {
+        registerTree(child);
     }
 }
 
 void OrganizerModel::saveItemToDatabase(OrganizerItem* item, int parentDbId) {
     if (!item) return;
     
-    QString requestBase64 = item->request();
-    QString responseBase64 = item->response();
-    
     int dbId = item->dbId();
     int savedId = DatabaseManager::instance().saveItem(
         dbId,
@@ -366,8 +388,8 @@ void OrganizerModel::saveItemToDatabase(OrganizerItem* item, int parentDbId) {
         item->name(),
         item->annotation(),
         item->color(),
-        requestBase64,
-        responseBase64,
+        item->request(),
+        item->response(),
         parentDbId,
         item->host(),
         item->url(),
@@ -377,7 +399,10 @@ void OrganizerModel::saveItemToDatabase(OrganizerItem* item, int parentDbId) {
         item->status(),
         item->length(),
         item->timestamp(),
-        item->screenshot()
+        item->screenshot(),
+        item->thumbnail(),
+        item->scheme(),
+        item->port()
     );
     
     if (savedId != -1 && dbId == -1) {
@@ -419,6 +444,87 @@ void OrganizerModel::saveItem(const QModelIndex& index) {
     saveItemToDatabase(item, parentDbId);
 }
 
+void OrganizerModel::refreshThumbnail(const QModelIndex& index) {
+    OrganizerItem* item = getItem(index);
+    if (!item || item->type() != ItemType::Request) return;
+    
+    m_thumbnailIcons.remove(item->dbId());
+    item->setThumbnail(QByteArray());
+    item->setThumbnailUnavailable(false);
+    DatabaseManager::instance().saveThumbnail(item->dbId(), QByteArray());
+    if (item->hasScreenshot()) {
+        m_screenshotLoader->requestThumbnail(item->dbId(), item->screenshot());
+    }
+    emit dataChanged(index.siblingAtColumn(0), index.siblingAtColumn(0), {Qt::DecorationRole});
+}
+
+namespace {
+    OrganizerItem* nextInPreOrder(OrganizerItem* item, OrganizerItem* root) {
+        if (item->childCount() > 0) {
+            return item->child(0);
+        }
+        while (item != root) {
+            OrganizerItem* parent = item->parent();
+            int row = item->row();
+            if (row + 1 < parent->childCount()) {
+                return parent->child(row + 1);
+            }
+            item = parent;
+        }
+        return root;
+    }
+
+    bool containsTerm(const QByteArray& body, const QByteArray& term) {
+        // Latin-1 view gives case-insensitive matching on raw bytes without decoding to UTF-16
+        return QLatin1String(body).contains(QLatin1String(term), Qt::CaseInsensitive);
+    }
+}
+
+QModelIndex OrganizerModel::findNext(const QModelIndex& from, const QByteArray& term) const {
+    if (term.isEmpty()) return QModelIndex();
+    
+    OrganizerItem* start = getItem(from);
+    OrganizerItem* item = nextInPreOrder(start, m_rootItem);
+    while (true) {
+        if (item->type() == ItemType::Request &&
+            (containsTerm(item->decodedRequestUncached(), term) ||
+             containsTerm(item->decodedResponseUncached(), term))) {
+            return createIndex(item->row(), 0, item);
+        }
+        if (item == start) break;
+        item = nextInPreOrder(item, m_rootItem);
+    }
+    return QModelIndex();
+}
+
+void OrganizerModel::queueMissingThumbnails(OrganizerItem* item) {
+    if (item->type() == ItemType::Request && item->hasScreenshot() && !item->hasThumbnail()
+        && !item->isThumbnailUnavailable()) {
+        m_screenshotLoader->requestThumbnail(item->dbId(), item->screenshot());
+    }
+    for (OrganizerItem* child : item->children()) {
+        queueMissingThumbnails(child);
+    }
+}
+
+void OrganizerModel::onThumbnailReady(int dbId, const QString& screenshotBase64, const QByteArray& thumbnail) {
+    OrganizerItem* item = m_itemsById.value(dbId, nullptr);
+    // The screenshot may have been replaced or removed while the thumbnail was being generated
+    if (!item || item->screenshot() != screenshotBase64) {
+        return;
+    }
+    
+    // An empty thumbnail means the screenshot couldn't be decoded; remember
+    // that so it isn't retried on every start
+    item->setThumbnail(thumbnail);
+    item->setThumbnailUnavailable(thumbnail.isEmpty());
+    m_thumbnailIcons.remove(dbId);
+    DatabaseManager::instance().saveThumbnail(dbId, thumbnail, thumbnail.isEmpty());
+    
+    QModelIndex index = createIndex(item->row(), 0, item);
+    emit dataChanged(index, index, {Qt::DecorationRole});
+}
+
 QModelIndex OrganizerModel::findIndexForItem(OrganizerItem* item, const QModelIndex& parent) const {
     if (!item) return QModelIndex();
     
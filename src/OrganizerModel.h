@@ -5,8 +5,11 @@
 #include <QColor>
 #include <QMimeData>
 #include <QSet>
+#include <QCache>
+#include <QIcon>
 #include "OrganizerItem.h"
 #include "DatabaseManager.h"
+#include "ScreenshotLoader.h"
 #include <QSqlQuery>
 
 class OrganizerModel : public QAbstractItemModel {
@@ -40,9 +43,27 @@ public:
     OrganizerItem* getItem(const QModelIndex& index) const;
     QModelIndex addFolder(const QString& name, const QModelIndex& parent = QModelIndex());
     QModelIndex addRequest(const QString& name, const QModelIndex& parent = QModelIndex());
-    void setRequest(const QModelIndex& index, const QString& request);
-    void setResponse(const QModelIndex& index, const QString& response);
+    // Takes ownership of the parentless items and appends them under parent.
+    // Items that already have a database id are only attached.
+    void addRequests(const QModelIndex& parent, const QList<OrganizerItem*>& items);
+    // Takes ownership of a parentless tree built off the model, saves it and
+    // appends root under parent
+    void addTree(const QModelIndex& parent, OrganizerItem* root);
+    // Copies each already-saved exchange into the item with that id and
+    // deletes the imported copy
+    void replaceItems(const QList<QPair<int, OrganizerItem*>>& replacements);
+    // Index of a saved item, or invalid when it isn't in the model
+    QModelIndex indexForDbId(int dbId) const;
+    void setRequest(const QModelIndex& index, const QByteArray& request);
+    void setResponse(const QModelIndex& index, const QByteArray& response);
     void saveItem(const QModelIndex& index);
+    void refreshThumbnail(const QModelIndex& index);
+    // Next request after 'from' (wrapping around) whose decoded request or response contains term
+    QModelIndex findNext(const QModelIndex& from, const QByteArray& term) const;
+    ScreenshotLoader* screenshotLoader() const { return m_screenshotLoader; }
+
+private slots:
+    void onThumbnailReady(int dbId, const QString& screenshotBase64, const QByteArray& thumbnail);
 
 private:
     void loadItemsFromDatabase();
@@ -50,10 +71,14 @@ private:
     OrganizerItem* findItemByDbId(int dbId, OrganizerItem* start = nullptr);
     int getParentDbId(const QModelIndex& parent);
     QModelIndex findIndexForItem(OrganizerItem* item, const QModelIndex& parent = QModelIndex()) const;
+    void queueMissingThumbnails(OrganizerItem* item);
+    void registerTree(OrganizerItem* item);
     
     OrganizerItem* m_rootItem;
     QMap<int, OrganizerItem*> m_itemsById;
     QSet<int> m_itemsBeingMoved; // Track items currently being moved to prevent deletion
+    ScreenshotLoader* m_screenshotLoader;
+    mutable QCache<int, QIcon> m_thumbnailIcons; // Only icons for rows actually painted stay resident
 };
 
 #endif // ORGANIZERMODEL_H
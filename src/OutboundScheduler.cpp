@@ -0,0 +1,162 @@
+#include "OutboundScheduler.h"
+#include <QDateTime>
+
+namespace {
+    // Retry-After as delta-seconds or an HTTP date, in ns; -1 when absent or unreadable
+    qint64 retryAfterDelay(QByteArrayView value) {
+        const QByteArray text = value.toByteArray().trimmed();
+        if (text.isEmpty()) return -1;
+        bool ok = false;
+        const qint64 seconds = text.toLongLong(&ok);
+        if (ok) return seconds < 0 ? -1 : seconds * 1000000000LL;
+        const QDateTime date = QDateTime::fromString(QString::fromLatin1(text), Qt::RFC2822Date);
+        if (!date.isValid()) return -1;
+        return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date)) * 1000000LL;
+    }
+}
+
+OutboundScheduler& OutboundScheduler::instance() {
+    static OutboundScheduler scheduler;
+    return scheduler;
+}
+
+OutboundScheduler::OutboundScheduler()
+    : m_nextJob(0)
+{
+    m_clock.start();
+}
+
+void OutboundScheduler::setLimits(const Limits& limits) {
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.nsecsElapsed();
+    m_limits = limits;
+    for (auto it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+        configure(*it, rateFor(it.key()), m_limits.hostBurst, now);
+    }
+    configure(m_global, m_limits.globalRate, m_limits.globalBurst, now);
+}
+
+OutboundScheduler::Limits OutboundScheduler::limits() const {
+    QMutexLocker locker(&m_mutex);
+    return m_limits;
+}
+
+int OutboundScheduler::registerJob() {
+    QMutexLocker locker(&m_mutex);
+    return m_nextJob++;
+}
+
+void OutboundScheduler::unregisterJob(int job) {
+    QMutexLocker locker(&m_mutex);
+    auto forget = [job](Bucket& bucket) {
+        bucket.waiting.removeIf([job](const Waiter& waiter) { return waiter.job == job; });
+    };
+    for (Bucket& bucket : m_hosts) {
+        forget(bucket);
+    }
+    forget(m_global);
+}
+
+qint64 OutboundScheduler::acquire(int job, const QString& host) {
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.nsecsElapsed();
+    Bucket& hostBucket = bucket(host, now);
+    const qint64 delay = qMax(wait(hostBucket, job, now), wait(m_global, job, now));
+    if (delay > 0) return delay;
+    take(hostBucket, job);
+    take(m_global, job);
+    return 0;
+}
+
+void OutboundScheduler::reportOverload(const QString& host, QByteArrayView retryAfter) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_limits.backoff) return;
+    const qint64 now = m_clock.nsecsElapsed();
+    Bucket& paused = bucket(host, now);
+    qint64 delay = retryAfterDelay(retryAfter);
+    if (delay < 0) {
+        // Requests already in flight when the pause began don't lengthen it
+        if (now < paused.pausedUntil) return;
+        // Doubling, starting over once the last pause is well in the past
+        const bool fresh = paused.backoff == 0 || now - paused.pausedUntil > 2 * paused.backoff;
+        paused.backoff = fresh ? MinBackoff : qMin(paused.backoff * 2, MaxBackoff);
+        delay = paused.backoff;
+    }
+    paused.pausedUntil = qMax(paused.pausedUntil, now + qMin(delay, MaxRetryAfter));
+}
+
+double OutboundScheduler::rateFor(const QString& host) const {
+    if (m_limits.hostRates.isEmpty()) return m_limits.hostRate;
+    return m_limits.hostRates.value(host, m_limits.hostRate);
+}
+
+OutboundScheduler::Bucket& OutboundScheduler::bucket(const QString& host, qint64 now) {
+    // Host names are case-insensitive; buckets and hostRates are keyed lower-case
+    const QString key = host.toLower();
+    auto it = m_hosts.find(key);
+    if (it == m_hosts.end()) {
+        it = m_hosts.insert(key, Bucket());
+        configure(*it, rateFor(key), m_limits.hostBurst, now);
+    }
+    return *it;
+}
+
+void OutboundScheduler::configure(Bucket& bucket, double rate, double burst, qint64 now) {
+    const bool wasLimited = bucket.rate > 0;
+    if (wasLimited) {
+        bucket.tokens = qMin(bucket.burst, bucket.tokens + (now - bucket.updated) * bucket.rate / 1e9);
+    }
+    bucket.rate = qMax(0.0, rate);
+    bucket.burst = qMax(1.0, burst);
+    // A bucket that just got a limit starts full
+    bucket.tokens = wasLimited ? qMin(bucket.tokens, bucket.burst) : bucket.burst;
+    bucket.updated = now;
+}
+
+qint64 OutboundScheduler::wait(Bucket& bucket, int job, qint64 now) {
+    qint64 delay = 0;
+    if (now < bucket.pausedUntil) {
+        delay = bucket.pausedUntil - now;
+    } else if (bucket.rate > 0) {
+        bucket.tokens = qMin(bucket.burst, bucket.tokens + (now - bucket.updated) * bucket.rate / 1e9);
+        bucket.updated = now;
+
+        // Jobs ahead in line get their token first; ones that stopped asking lose their place
+        int ahead = 0;
+        for (int i = 0; i < bucket.waiting.size();) {
+            const Waiter& waiter = bucket.waiting.at(i);
+            if (waiter.job == job) break;
+            if (now - waiter.due > StaleAfter) {
+                bucket.waiting.removeAt(i);
+                continue;
+            }
+            ++ahead;
+            ++i;
+        }
+        if (bucket.tokens >= ahead + 1) return 0;
+        delay = qMax<qint64>(1, qint64((ahead + 1 - bucket.tokens) * 1e9 / bucket.rate));
+    } else {
+        return 0;
+    }
+
+    for (Waiter& waiter : bucket.waiting) {
+        if (waiter.job == job) {
+            waiter.due = now + delay;
+            return delay;
+        }
+    }
+    bucket.waiting.append({job, now + delay});
+    return delay;
+}
+
+void OutboundScheduler::take(Bucket& bucket, int job) {
+    if (bucket.rate > 0) bucket.tokens -= 1;
+    if (bucket.waiting.isEmpty()) return;
+    // Served jobs go to the back of the line the next time they are refused
+    for (int i = 0; i < bucket.waiting.size(); ++i) {
+        if (bucket.waiting.at(i).job == job) {
+            bucket.waiting.removeAt(i);
+            return;
+        }
+    }
+}
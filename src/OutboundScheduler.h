@@ -0,0 +1,83 @@
+#ifndef OUTBOUNDSCHEDULER_H
+#define OUTBOUNDSCHEDULER_H
+
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// Decides when outbound requests may go out, for every HttpClientPool in
+// the process whatever thread it runs on. Each host has a token bucket and
+// all hosts share a global one; a host answering 429 or 503 is paused for
+// its Retry-After, or for a doubling backoff without one. When a bucket
+// runs dry, the jobs (pools) waiting on it take turns, one request each,
+// so a fuzzer can't crowd out a replay to the same host.
+//
+// Nothing here blocks or queues requests: acquire() either takes a token
+// or says how long to wait, and the pool asks again then. A call is one
+// short critical section.
+class OutboundScheduler {
+public:
+    struct Limits {
+        double hostRate = 0;   // Requests per second to one host; 0 is unlimited
+        int hostBurst = 10;    // Requests a host that has been quiet may take at once
+        double globalRate = 0; // Requests per second in total; 0 is unlimited
+        int globalBurst = 50;
+        bool backoff = true;   // Pause hosts answering 429 or 503
+        QHash<QString, double> hostRates; // Per-host hostRate overrides, lower-case hosts
+    };
+
+    static OutboundScheduler& instance();
+
+    // Applies to buckets from now on; tokens already earned are kept
+    void setLimits(const Limits& limits);
+    Limits limits() const;
+
+    int registerJob();
+    void unregisterJob(int job);
+
+    // 0 when job may send a request to host now, which uses up a token;
+    // otherwise how long to wait before asking again, in nanoseconds
+    qint64 acquire(int job, const QString& host);
+    // For a 429 or 503 from host; retryAfter is the header value, if any
+    void reportOverload(const QString& host, QByteArrayView retryAfter);
+
+    static constexpr qint64 MinBackoff = 1000000000LL;          // ns
+    static constexpr qint64 MaxBackoff = 60 * 1000000000LL;
+    static constexpr qint64 MaxRetryAfter = 600 * 1000000000LL;
+    static constexpr qint64 StaleAfter = 50000000LL;            // A waiter this late asking again loses its turn
+
+private:
+    struct Waiter {
+        int job = 0;
+        qint64 due = 0; // When it was told to ask again
+    };
+
+    struct Bucket {
+        double rate = 0;
+        double burst = 1;
+        double tokens = 0;
+        qint64 updated = 0;
+        qint64 pausedUntil = 0;
+        qint64 backoff = 0;
+        QVector<Waiter> waiting; // Jobs refused a token, front first
+    };
+
+    OutboundScheduler();
+    double rateFor(const QString& host) const; // host lower-case
+    Bucket& bucket(const QString& host, qint64 now);
+    void configure(Bucket& bucket, double rate, double burst, qint64 now);
+    qint64 wait(Bucket& bucket, int job, qint64 now);
+    void take(Bucket& bucket, int job);
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    Limits m_limits;
+    QHash<QString, Bucket> m_hosts;
+    Bucket m_global;
+    int m_nextJob;
+};
+
+#endif // OUTBOUNDSCHEDULER_H
@@ -0,0 +1,184 @@
+#include "PayloadSet.h"
+#include "WordlistSource.h"
+#include <QCryptographicHash>
+#include <QPair>
+#include <QRegularExpression>
+#include <algorithm>
+
+ListPayloadSource::ListPayloadSource(const QList<QByteArray>& values)
+    : m_values(values)
+    , m_position(0)
+{
+}
+
+bool ListPayloadSource::next(QByteArray& value) {
+    if (m_position >= m_values.size()) return false;
+    value = m_values[m_position++];
+    return true;
+}
+
+RangePayloadSource::RangePayloadSource(qint64 first, qint64 last, qint64 step, int width)
+    : m_first(first)
+    , m_step(step == 0 ? 1 : step)
+    , m_next(0)
+    , m_width(width)
+{
+    // A step pointing away from last gives an empty range
+    const qint64 span = last - first;
+    m_count = (span == 0 || (span > 0) == (m_step > 0)) ? span / m_step + 1 : 0;
+}
+
+bool RangePayloadSource::next(QByteArray& value) {
+    if (m_next >= m_count) return false;
+    const qint64 number = m_first + m_next++ * m_step;
+    value = QByteArray::number(qAbs(number));
+    if (value.size() < m_width) {
+        value.prepend(QByteArray(m_width - value.size(), '0'));
+    }
+    if (number < 0) value.prepend('-');
+    return true;
+}
+
+PayloadSet::PayloadSet(std::unique_ptr<PayloadSource> source, const QList<Transform>& transforms)
+    : m_source(std::move(source))
+    , m_transforms(transforms)
+{
+}
+
+PayloadSet PayloadSet::parse(const QString& spec, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return PayloadSet();
+    };
+
+    const QStringList stages = spec.split(" | ");
+    const QString source = stages.first().trimmed();
+    const int colon = source.indexOf(':');
+    const QString kind = source.left(colon).toLower();
+    const QString argument = colon < 0 ? QString() : source.mid(colon + 1);
+
+    std::unique_ptr<PayloadSource> payloads;
+    if (kind == "file") {
+        auto file = std::make_unique<WordlistSource>(argument);
+        if (!file->open(error)) return PayloadSet();
+        payloads = std::move(file);
+    } else if (kind == "list") {
+        QList<QByteArray> values;
+        for (const QString& value : argument.split(',')) {
+            values.append(value.toUtf8());
+        }
+        payloads = std::make_unique<ListPayloadSource>(values);
+    } else if (kind == "range") {
+        static const QRegularExpression pattern("^\\s*(-?\\d+)-(-?\\d+)(?::(-?\\d+))?\\s*$");
+        const QRegularExpressionMatch match = pattern.match(argument);
+        if (!match.hasMatch()) {
+            return fail(QString("Expected range:FIRST-LAST[:STEP], got \"%1\"").arg(source));
+        }
+        const QString first = match.captured(1);
+        const qint64 step = match.captured(3).isEmpty() ? 1 : match.captured(3).toLongLong();
+        if (step == 0) return fail("A range step can't be 0");
+        const QString digits = first.startsWith('-') ? first.mid(1) : first;
+        const int width = digits.size() > 1 && digits.startsWith('0') ? digits.size() : 0;
+        payloads = std::make_unique<RangePayloadSource>(first.toLongLong(), match.captured(2).toLongLong(), step, width);
+    } else {
+        return fail(QString("Unknown payload source \"%1\"; use file:, list: or range:").arg(source));
+    }
+
+    static const QList<QPair<QString, Transform::Kind>> names = {
+        {"url", Transform::UrlEncode}, {"base64", Transform::Base64}, {"hex", Transform::Hex},
+        {"prefix", Transform::Prefix}, {"suffix", Transform::Suffix}, {"upper", Transform::Upper},
+        {"lower", Transform::Lower}, {"md5", Transform::Md5}, {"sha1", Transform::Sha1},
+        {"sha256", Transform::Sha256}};
+    QList<Transform> transforms;
+    for (int i = 1; i < stages.size(); ++i) {
+        const QString stage = stages[i].trimmed();
+        const int separator = stage.indexOf(':');
+        const QString name = stage.left(separator).toLower();
+        Transform transform;
+        transform.argument = separator < 0 ? QByteArray() : stage.mid(separator + 1).toUtf8();
+        auto found = std::find_if(names.begin(), names.end(), [&name](const auto& entry) { return entry.first == name; });
+        if (found == names.end()) {
+            return fail(QString("Unknown transform \"%1\"").arg(stage));
+        }
+        transform.kind = found->second;
+        transforms.append(transform);
+    }
+    return PayloadSet(std::move(payloads), transforms);
+}
+
+void PayloadSet::reset() {
+    m_source->reset();
+    m_batch.clear();
+    m_position = 0;
+}
+
+bool PayloadSet::next(QByteArray& value) {
+    if (m_position >= m_batch.size() && !fill()) return false;
+    value = std::move(m_batch[m_position++]);
+    return true;
+}
+
+bool PayloadSet::fill() {
+    m_batch.clear();
+    m_position = 0;
+    QByteArray value;
+    while (m_batch.size() < BatchSize && m_source->next(value)) {
+        m_batch.append(value);
+    }
+    if (m_batch.isEmpty()) return false;
+    for (const Transform& transform : m_transforms) {
+        apply(transform, m_batch);
+    }
+    return true;
+}
+
+void PayloadSet::apply(const Transform& transform, QList<QByteArray>& values) {
+    auto hashAll = [&values](QCryptographicHash::Algorithm algorithm) {
+        QCryptographicHash hash(algorithm);
+        for (QByteArray& value : values) {
+            hash.reset();
+            hash.addData(value);
+            value = hash.result().toHex();
+        }
+    };
+
+    switch (transform.kind) {
+    case Transform::UrlEncode:
+        for (QByteArray& value : values) value = value.toPercentEncoding();
+        break;
+    case Transform::Base64:
+        for (QByteArray& value : values) value = value.toBase64();
+        break;
+    case Transform::Hex:
+        for (QByteArray& value : values) value = value.toHex();
+        break;
+    case Transform::Prefix:
+    case Transform::Suffix:
+        // Built fresh rather than prepended, so values pointing into a
+        // mapped wordlist are copied once at their final size
+        for (QByteArray& value : values) {
+            QByteArray joined;
+            joined.reserve(value.size() + transform.argument.size());
+            if (transform.kind == Transform::Prefix) joined.append(transform.argument);
+            joined.append(value);
+            if (transform.kind == Transform::Suffix) joined.append(transform.argument);
+            value = joined;
+        }
+        break;
+    case Transform::Upper:
+        for (QByteArray& value : values) value = value.toUpper();
+        break;
+    case Transform::Lower:
+        for (QByteArray& value : values) value = value.toLower();
+        break;
+    case Transform::Md5:
+        hashAll(QCryptographicHash::Md5);
+        break;
+    case Transform::Sha1:
+        hashAll(QCryptographicHash::Sha1);
+        break;
+    case Transform::Sha256:
+        hashAll(QCryptographicHash::Sha256);
+        break;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef PAYLOADSET_H
+#define PAYLOADSET_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <memory>
+
+// Where a payload set's values come from. Sources are read front to back
+// and produce one value per call, so a wordlist of millions of lines or a
+// range of billions of numbers costs no more memory than a short list.
+class PayloadSource {
+public:
+    virtual ~PayloadSource() {}
+
+    // Fills value with the next payload; false when the source is exhausted
+    virtual bool next(QByteArray& value) = 0;
+    // Starts over from the first payload
+    virtual void reset() = 0;
+    // Number of payloads, or -1 if that can't be known without reading them
+    virtual qint64 count() const = 0;
+};
+
+// Comma separated literal values
+class ListPayloadSource : public PayloadSource {
+public:
+    explicit ListPayloadSource(const QList<QByteArray>& values);
+
+    bool next(QByteArray& value) override;
+    void reset() override { m_position = 0; }
+    qint64 count() const override { return m_values.size(); }
+
+private:
+    QList<QByteArray> m_values;
+    qsizetype m_position;
+};
+
+// Decimal numbers from first to last inclusive, zero-padded to width
+class RangePayloadSource : public PayloadSource {
+public:
+    RangePayloadSource(qint64 first, qint64 last, qint64 step, int width);
+
+    bool next(QByteArray& value) override;
+    void reset() override { m_next = 0; }
+    qint64 count() const override { return m_count; }
+
+private:
+    qint64 m_first;
+    qint64 m_step;
+    qint64 m_count;
+    qint64 m_next;
+    int m_width;
+};
+
+// A source plus the transforms applied to each of its values in order.
+// Values are pulled from the source BatchSize at a time and each transform
+// runs over the whole batch before the next one, so per-transform setup
+// (a hash context, buffer sizing) is paid once per batch, not per value.
+class PayloadSet {
+public:
+    struct Transform {
+        enum Kind { UrlEncode, Base64, Hex, Prefix, Suffix, Upper, Lower, Md5, Sha1, Sha256 };
+        Kind kind = UrlEncode;
+        QByteArray argument; // Text for Prefix and Suffix
+    };
+
+    PayloadSet() = default;
+    PayloadSet(std::unique_ptr<PayloadSource> source, const QList<Transform>& transforms);
+
+    // A one-line description:
+    //   file:PATH | list:A,B,C | range:FIRST-LAST[:STEP]
+    // followed by any number of " | transform" stages:
+    //   url | base64 | hex | prefix:TEXT | suffix:TEXT | upper | lower | md5 | sha1 | sha256
+    // A range whose first number has leading zeros pads every value to its width.
+    // Hashes are written as lowercase hex.
+    static PayloadSet parse(const QString& spec, QString* error);
+
+    bool isValid() const { return m_source != nullptr; }
+    bool next(QByteArray& value);
+    void reset();
+    qint64 count() const { return m_source->count(); }
+
+    static void apply(const Transform& transform, QList<QByteArray>& values);
+
+    static constexpr int BatchSize = 256;
+
+private:
+    bool fill();
+
+    std::unique_ptr<PayloadSource> m_source;
+    QList<Transform> m_transforms;
+    QList<QByteArray> m_batch;
+    qsizetype m_position = 0;
+};
+
+#endif // PAYLOADSET_H
@@ -0,0 +1,512 @@
+#include "PcapImporter.h"
+#include "HttpMessageIndex.h"
+#include "ImportPipeline.h"
+#include "PcapReader.h"
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const qsizetype MaxBufferedBytes = 256 * 1024 * 1024;
+    const int MaxPendingSegments = 1024;
+    const qsizetype CompactThreshold = 1024 * 1024;
+
+    const quint8 TcpFin = 0x01;
+    const quint8 TcpSyn = 0x02;
+    const quint8 TcpRst = 0x04;
+    const quint8 TcpAck = 0x10;
+
+    struct TcpSegment {
+        QByteArrayView sourceAddress;
+        QByteArrayView destinationAddress;
+        quint16 sourcePort = 0;
+        quint16 destinationPort = 0;
+        quint32 seq = 0;
+        quint8 flags = 0;
+        QByteArrayView payload;
+    };
+
+    // Both endpoints of a connection, lower (address, port) first, so the
+    // two directions share one key
+    struct FlowKey {
+        char bytes[36];
+        int length = 0;
+
+        bool operator==(const FlowKey& other) const {
+            return length == other.length && std::memcmp(bytes, other.bytes, length) == 0;
+        }
+    };
+
+    size_t qHash(const FlowKey& key, size_t seed = 0) {
+        return qHashBits(key.bytes, key.length, seed);
+    }
+
+    quint16 read16(QByteArrayView data, qsizetype pos) {
+        return qFromBigEndian<quint16>(data.data() + pos);
+    }
+
+    quint32 read32(QByteArrayView data, qsizetype pos) {
+        return qFromBigEndian<quint32>(data.data() + pos);
+    }
+
+    bool decodeIp(QByteArrayView ip, TcpSegment& segment) {
+        if (ip.isEmpty()) return false;
+        QByteArrayView tcp;
+        int version = uchar(ip[0]) >> 4;
+        if (version == 4) {
+            if (ip.size() < 20) return false;
+            qsizetype headerLength = (uchar(ip[0]) & 0x0F) * 4;
+            qsizetype totalLength = read16(ip, 2);
+            if (headerLength < 20 || totalLength < headerLength || ip.size() < headerLength) return false;
+            if (uchar(ip[9]) != 6) return false;
+            if (read16(ip, 6) & 0x3FFF) return false; // Fragments aren't reassembled
+            segment.sourceAddress = ip.sliced(12, 4);
+            segment.destinationAddress = ip.sliced(16, 4);
+            // Ethernet pads short frames; the IP length is authoritative
+            tcp = ip.sliced(headerLength, qMin(totalLength, ip.size()) - headerLength);
+        } else if (version == 6) {
+            if (ip.size() < 40) return false;
+            qsizetype end = qMin<qsizetype>(40 + read16(ip, 4), ip.size());
+            quint8 next = uchar(ip[6]);
+            qsizetype offset = 40;
+            // Hop-by-hop, routing and destination options
+            while (next == 0 || next == 43 || next == 60) {
+                if (offset + 8 > end) return false;
+                next = uchar(ip[offset]);
+                offset += (uchar(ip[offset + 1]) + 1) * 8;
+            }
+            if (next != 6 || offset > end) return false;
+            segment.sourceAddress = ip.sliced(8, 16);
+            segment.destinationAddress = ip.sliced(24, 16);
+            tcp = ip.sliced(offset, end - offset);
+        } else {
+            return false;
+        }
+
+        if (tcp.size() < 20) return false;
+        qsizetype dataOffset = (uchar(tcp[12]) >> 4) * 4;
+        if (dataOffset < 20 || dataOffset > tcp.size()) return false;
+        segment.sourcePort = read16(tcp, 0);
+        segment.destinationPort = read16(tcp, 2);
+        segment.seq = read32(tcp, 4);
+        segment.flags = uchar(tcp[13]);
+        segment.payload = tcp.sliced(dataOffset);
+        return true;
+    }
+
+    bool decodePacket(const PcapReader::Packet& packet, TcpSegment& segment) {
+        QByteArrayView data = packet.data;
+        switch (packet.linkType) {
+        case 1: { // Ethernet, possibly VLAN tagged
+            if (data.size() < 14) return false;
+            quint16 type = read16(data, 12);
+            qsizetype offset = 14;
+            while ((type == 0x8100 || type == 0x88A8) && data.size() >= offset + 4) {
+                type = read16(data, offset + 2);
+                offset += 4;
+            }
+            if (type != 0x0800 && type != 0x86DD) return false;
+            return decodeIp(data.sliced(offset), segment);
+        }
+        case 113: // Linux cooked capture
+            return data.size() >= 16 && decodeIp(data.sliced(16), segment);
+        case 276: // Linux cooked capture v2
+            return data.size() >= 20 && decodeIp(data.sliced(20), segment);
+        case 0:   // BSD loopback
+        case 108:
+            return data.size() >= 4 && decodeIp(data.sliced(4), segment);
+        case 12:  // Raw IP
+        case 14:
+        case 101:
+        case 228:
+        case 229:
+            return decodeIp(data, segment);
+        default:
+            return false;
+        }
+    }
+
+    QString endpointText(QByteArrayView address, quint16 port) {
+        if (address.size() == 4) {
+            return QString("%1.%2.%3.%4:%5").arg(uchar(address[0])).arg(uchar(address[1]))
+                .arg(uchar(address[2])).arg(uchar(address[3])).arg(port);
+        }
+        QStringList groups;
+        for (int i = 0; i < 8; ++i) {
+            groups.append(QString::number(read16(address, i * 2), 16));
+        }
+        return "[" + groups.join(':') + "]:" + QString::number(port);
+    }
+
+    struct Stream {
+        bool started = false;
+        bool closed = false;
+        quint32 nextSeq = 0;
+        QByteArray data;          // Reassembled bytes from base on
+        qsizetype consumed = 0;   // Bytes of data already turned into messages
+        qint64 base = 0;          // Stream offset of data[0]
+        QList<QPair<qint64, qint64>> times;               // (stream offset, capture time) per segment
+        QMap<quint32, QPair<QByteArray, qint64>> pending; // Out-of-order segments by sequence number
+
+        QByteArrayView unconsumed() const { return QByteArrayView(data).sliced(consumed); }
+        qint64 offset() const { return base + consumed; }
+
+        qint64 timeAt(qint64 offset) const {
+            auto it = std::upper_bound(times.cbegin(), times.cend(), offset,
+                                       [](qint64 value, const QPair<qint64, qint64>& entry) { return value < entry.first; });
+            return it == times.cbegin() ? 0 : (it - 1)->second;
+        }
+
+        void append(QByteArrayView payload, qint32 delta, qint64 timestamp) {
+            // delta <= 0: the segment starts at or before nextSeq (retransmission overlap)
+            qsizetype skip = -qsizetype(delta);
+            if (skip >= payload.size()) return;
+            payload = payload.sliced(skip);
+            times.append({base + data.size(), timestamp});
+            data.append(payload);
+            nextSeq += quint32(payload.size());
+        }
+
+        void compact() {
+            if (consumed == 0 || (consumed < CompactThreshold && consumed < data.size())) return;
+            data.remove(0, consumed);
+            base += consumed;
+            consumed = 0;
+            while (times.size() > 1 && times[1].first <= base) {
+                times.removeFirst();
+            }
+        }
+
+        void clear() {
+            data.clear();
+            pending.clear();
+            times.clear();
+            consumed = 0;
+        }
+    };
+
+    struct Exchange {
+        QByteArray request;
+        qint64 requestStart = 0; // Capture time of the first and last request bytes
+        qint64 requestEnd = 0;
+        bool head = false;
+    };
+
+    struct Flow {
+        Stream streams[2];
+        int client = -1;      // Index of the stream the client sends
+        bool ignored = false; // Not HTTP, or reassembly lost data
+        QString endpoints[2]; // Sender of each stream
+        QQueue<Exchange> exchanges;
+    };
+
+    class Extractor {
+    public:
+        ~Extractor();
+
+        void add(const TcpSegment& segment, qint64 timestamp);
+        void finish();
+        OrganizerItem* takeTree(const QString& name);
+
+    private:
+        void receive(Flow& flow, int direction, const TcpSegment& segment, qint64 timestamp);
+        void detectClient(Flow& flow);
+        void process(Flow& flow);
+        void ignore(Flow& flow);
+        void close(Flow& flow);
+        void addExchange(const Flow& flow, const Exchange& exchange, const QByteArray& response, qint64 responseEnd);
+
+        QHash<FlowKey, Flow*> m_flows;
+        QStringList m_hostOrder;
+        QHash<QString, QList<QPair<qint64, OrganizerItem*>>> m_hosts;
+    };
+}
+
+Extractor::~Extractor() {
+    qDeleteAll(m_flows);
+    for (const auto& items : m_hosts) {
+        for (const auto& entry : items) {
+            delete entry.second;
+        }
+    }
+}
+
+void Extractor::add(const TcpSegment& segment, qint64 timestamp) {
+    const int sourceSize = int(segment.sourceAddress.size());
+    char source[18];
+    char destination[18];
+    std::memcpy(source, segment.sourceAddress.data(), sourceSize);
+    qToBigEndian(segment.sourcePort, source + sourceSize);
+    std::memcpy(destination, segment.destinationAddress.data(), sourceSize);
+    qToBigEndian(segment.destinationPort, destination + sourceSize);
+
+    const int endpointSize = sourceSize + 2;
+    const int direction = std::memcmp(source, destination, endpointSize) <= 0 ? 0 : 1;
+    FlowKey key;
+    key.length = endpointSize * 2;
+    std::memcpy(key.bytes, direction == 0 ? source : destination, endpointSize);
+    std::memcpy(key.bytes + endpointSize, direction == 0 ? destination : source, endpointSize);
+
+    Flow* flow = m_flows.value(key);
+    if (!flow) {
+        // Pure ACKs and FINs of flows we never saw carry nothing
+        if (segment.payload.isEmpty() && !(segment.flags & TcpSyn)) return;
+        flow = new Flow;
+        flow->endpoints[direction] = endpointText(segment.sourceAddress, segment.sourcePort);
+        flow->endpoints[1 - direction] = endpointText(segment.destinationAddress, segment.destinationPort);
+        m_flows.insert(key, flow);
+    }
+
+    receive(*flow, direction, segment, timestamp);
+    process(*flow);
+
+    bool done = (segment.flags & TcpRst) || (flow->streams[0].closed && flow->streams[1].closed);
+    if (done) {
+        close(*flow);
+        m_flows.remove(key);
+        delete flow;
+    }
+}
+
+void Extractor::receive(Flow& flow, int direction, const TcpSegment& segment, qint64 timestamp) {
+    Stream& stream = flow.streams[direction];
+    if (segment.flags & TcpSyn) {
+        // The SYN consumes one sequence number; a bare SYN comes from the client
+        stream.started = true;
+        stream.nextSeq = segment.seq + 1;
+        stream.pending.clear();
+        if (!(segment.flags & TcpAck)) {
+            flow.client = direction;
+        } else if (flow.client < 0) {
+            flow.client = 1 - direction;
+        }
+        return;
+    }
+    if (segment.flags & (TcpFin | TcpRst)) {
+        stream.closed = true;
+    }
+    if (flow.ignored || segment.payload.isEmpty()) return;
+
+    if (!stream.started) {
+        // Capture began mid-connection
+        stream.started = true;
+        stream.nextSeq = segment.seq;
+    }
+
+    qint32 delta = qint32(segment.seq - stream.nextSeq);
+    if (delta > 0) {
+        // A gap that never fills means packets were lost; the flow can't be trusted
+        if (stream.pending.size() >= MaxPendingSegments) {
+            ignore(flow);
+            return;
+        }
+        stream.pending.insert(segment.seq, {segment.payload.toByteArray(), timestamp});
+        return;
+    }
+
+    stream.append(segment.payload, delta, timestamp);
+    bool progress = !stream.pending.isEmpty();
+    while (progress) {
+        progress = false;
+        for (auto it = stream.pending.begin(); it != stream.pending.end();) {
+            qint32 pendingDelta = qint32(it.key() - stream.nextSeq);
+            if (pendingDelta <= 0) {
+                stream.append(it.value().first, pendingDelta, it.value().second);
+                it = stream.pending.erase(it);
+                progress = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (stream.data.size() - stream.consumed > MaxBufferedBytes) {
+        ignore(flow);
+    }
+}
+
+void Extractor::detectClient(Flow& flow) {
+    // Without the handshake, whichever side speaks HTTP first decides
+    for (int direction = 0; direction < 2; ++direction) {
+        QByteArrayView data = flow.streams[direction].unconsumed();
+        if (data.size() < 5) continue;
+        if (data.startsWith("HTTP/")) {
+            flow.client = 1 - direction;
+            return;
+        }
+        if (data[0] >= 'A' && data[0] <= 'Z') {
+            flow.client = direction;
+            return;
+        }
+    }
+    if (flow.streams[0].unconsumed().size() >= 16 || flow.streams[1].unconsumed().size() >= 16) {
+        ignore(flow);
+    }
+}
+
+void Extractor::process(Flow& flow) {
+    if (flow.ignored) return;
+    if (flow.client < 0) {
+        detectClient(flow);
+        if (flow.client < 0) return;
+    }
+    Stream& client = flow.streams[flow.client];
+    Stream& server = flow.streams[1 - flow.client];
+
+    // Requests first, so pipelined responses find theirs in the queue
+    while (!client.unconsumed().isEmpty()) {
+        QByteArrayView pending = client.unconsumed();
+        qint64 length = HttpMessageIndex::messageLength(pending, true, false, client.closed);
+        if (length < 0) {
+            ignore(flow);
+            return;
+        }
+        if (length == 0) break;
+
+        Exchange exchange;
+        exchange.request = pending.first(length).toByteArray();
+        exchange.requestStart = client.timeAt(client.offset());
+        exchange.requestEnd = client.timeAt(client.offset() + length - 1);
+        exchange.head = pending.startsWith("HEAD ");
+        flow.exchanges.enqueue(exchange);
+        client.consumed += length;
+    }
+
+    while (!server.unconsumed().isEmpty()) {
+        QByteArrayView pending = server.unconsumed();
+        bool head = !flow.exchanges.isEmpty() && flow.exchanges.head().head;
+        qint64 length = HttpMessageIndex::messageLength(pending, false, head, server.closed);
+        if (length < 0) {
+            ignore(flow);
+            return;
+        }
+        if (length == 0) break;
+
+        QByteArray response = pending.first(length).toByteArray();
+        qint64 responseEnd = server.timeAt(server.offset() + length - 1);
+        server.consumed += length;
+
+        // "HTTP/1.1 1xx": interim responses precede the final one
+        bool interim = response.size() > 9 && response[9] == '1';
+        bool upgrade = interim && response.mid(9, 3) == "101";
+        if (interim && !upgrade) continue;
+        if (!flow.exchanges.isEmpty()) {
+            addExchange(flow, flow.exchanges.dequeue(), response, responseEnd);
+        }
+        if (upgrade) {
+            // WebSocket or h2c from here on
+            ignore(flow);
+            return;
+        }
+    }
+
+    client.compact();
+    server.compact();
+}
+
+void Extractor::ignore(Flow& flow) {
+    // Requests already complete are kept even without their responses
+    while (!flow.exchanges.isEmpty()) {
+        addExchange(flow, flow.exchanges.dequeue(), QByteArray(), 0);
+    }
+    flow.ignored = true;
+    flow.streams[0].clear();
+    flow.streams[1].clear();
+}
+
+void Extractor::close(Flow& flow) {
+    flow.streams[0].closed = true;
+    flow.streams[1].closed = true;
+    process(flow);
+    ignore(flow);
+}
+
+void Extractor::finish() {
+    for (Flow* flow : std::as_const(m_flows)) {
+        close(*flow);
+        delete flow;
+    }
+    m_flows.clear();
+}
+
+void Extractor::addExchange(const Flow& flow, const Exchange& exchange, const QByteArray& response, qint64 responseEnd) {
+    const QByteArray& request = exchange.request;
+    HttpMessageIndex index = HttpMessageIndex::parse(request);
+    QString server = flow.endpoints[1 - flow.client];
+    QString host = QString::fromLatin1(index.header(request, "host"));
+    if (host.isEmpty()) host = server;
+    QString target = QString::fromLatin1(index.target(request));
+
+    ImportRecord record;
+    record.method = QString::fromLatin1(index.method(request));
+    // Proxied requests already carry an absolute-form target
+    record.url = target.startsWith('/') ? "http://" + host + target : target;
+    record.host = host;
+    if (target.startsWith('/')) {
+        // Captured in the clear, on the server's end of the connection
+        record.scheme = "http";
+        record.port = server.mid(server.lastIndexOf(':') + 1).toInt();
+    }
+    record.comment = flow.endpoints[flow.client] + " -> " + server;
+    record.request = request;
+    record.response = response;
+    record.timestamp = exchange.requestStart / 1000000;
+    record.responseLength = response.size();
+    record.responseTime = response.isEmpty() ? 0 : qMax<qint64>(0, (responseEnd - exchange.requestEnd) / 1000);
+
+    OrganizerItem* item = ImportPipeline::createItem(record);
+    if (!item) return;
+    auto it = m_hosts.find(host);
+    if (it == m_hosts.end()) {
+        m_hostOrder.append(host);
+        it = m_hosts.insert(host, {});
+    }
+    it->append({exchange.requestStart, item});
+}
+
+OrganizerItem* Extractor::takeTree(const QString& name) {
+    OrganizerItem* root = new OrganizerItem(ItemType::Folder, name);
+    for (const QString& host : std::as_const(m_hostOrder)) {
+        // Exchanges complete out of order across flows; show them by request time
+        QList<QPair<qint64, OrganizerItem*>>& items = m_hosts[host];
+        std::stable_sort(items.begin(), items.end(),
+                         [](const QPair<qint64, OrganizerItem*>& a, const QPair<qint64, OrganizerItem*>& b) { return a.first < b.first; });
+        OrganizerItem* folder = new OrganizerItem(ItemType::Folder, host);
+        for (const auto& entry : std::as_const(items)) {
+            folder->appendChild(entry.second);
+        }
+        root->appendChild(folder);
+    }
+    m_hosts.clear();
+    m_hostOrder.clear();
+    return root;
+}
+
+OrganizerItem* PcapImporter::importFile(const QString& fileName, QString* error, const std::atomic_bool* cancel) {
+    PcapReader reader(fileName);
+    if (!reader.open()) {
+        if (error) *error = reader.errorString();
+        return nullptr;
+    }
+
+    Extractor extractor;
+    PcapReader::Packet packet;
+    TcpSegment segment;
+    quint64 packets = 0;
+    while (reader.next(packet)) {
+        if (cancel && (++packets & 0x3FF) == 0 && cancel->load()) {
+            if (error) *error = "Import cancelled";
+            return nullptr;
+        }
+        if (decodePacket(packet, segment)) {
+            extractor.add(segment, packet.timestamp);
+        }
+    }
+    // A cut-off last record is common in live captures; keep everything before it
+    extractor.finish();
+    return extractor.takeTree(QFileInfo(fileName).fileName());
+}
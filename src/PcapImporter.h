@@ -0,0 +1,23 @@
+#ifndef PCAPIMPORTER_H
+#define PCAPIMPORTER_H
+
+#include <QString>
+#include <atomic>
+#include "OrganizerItem.h"
+
+// Extracts HTTP/1.x exchanges from a pcap or pcapng capture. Packets are
+// read through PcapReader, TCP flows are reassembled in sequence order, and
+// requests are paired with responses in pipeline order. Host, URL, method,
+// status, length, timestamp and response time come from the messages and
+// the capture timing. The result is a folder for the capture with one
+// subfolder per host, built off the model like the other tree importers.
+namespace PcapImporter {
+
+// Returns the capture folder, or null with error set. cancel is polled
+// between packets.
+OrganizerItem* importFile(const QString& fileName, QString* error = nullptr,
+                          const std::atomic_bool* cancel = nullptr);
+
+} // namespace PcapImporter
+
+#endif // PCAPIMPORTER_H
@@ -0,0 +1,198 @@
+#include "PcapReader.h"
+#include <QtEndian>
+
+namespace {
+    const quint32 SectionHeaderBlock = 0x0A0D0D0A;
+    const quint32 InterfaceDescriptionBlock = 1;
+    const quint32 ObsoletePacketBlock = 2;
+    const quint32 SimplePacketBlock = 3;
+    const quint32 EnhancedPacketBlock = 6;
+
+    const quint16 OptionEnd = 0;
+    const quint16 OptionTimestampResolution = 9;
+}
+
+PcapReader::PcapReader(const QString& fileName)
+    : m_file(fileName)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_pos(0)
+    , m_bigEndian(false)
+    , m_pcapng(false)
+    , m_nanoseconds(false)
+    , m_linkType(0)
+{
+}
+
+bool PcapReader::open() {
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = "Could not open file: " + m_file.fileName();
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || m_size < 24) {
+        m_error = m_data ? "Not a capture file: " + m_file.fileName() : "Could not map file: " + m_file.fileName();
+        return false;
+    }
+
+    // The magic number gives both the format and the writer's byte order
+    const uchar* magic = m_data;
+    if (magic[0] == 0xD4 && magic[1] == 0xC3 && magic[2] == 0xB2 && magic[3] == 0xA1) {
+        m_bigEndian = false;
+    } else if (magic[0] == 0xA1 && magic[1] == 0xB2 && magic[2] == 0xC3 && magic[3] == 0xD4) {
+        m_bigEndian = true;
+    } else if (magic[0] == 0x4D && magic[1] == 0x3C && magic[2] == 0xB2 && magic[3] == 0xA1) {
+        m_bigEndian = false;
+        m_nanoseconds = true;
+    } else if (magic[0] == 0xA1 && magic[1] == 0xB2 && magic[2] == 0x3C && magic[3] == 0x4D) {
+        m_bigEndian = true;
+        m_nanoseconds = true;
+    } else if (qFromLittleEndian<quint32>(magic) == SectionHeaderBlock) {
+        m_pcapng = true;
+        return readSectionHeader(0);
+    } else {
+        m_error = "Not a pcap or pcapng file: " + m_file.fileName();
+        return false;
+    }
+
+    m_linkType = int(read32(m_data + 20) & 0x0FFFFFFF); // Upper bits hold FCS flags
+    m_pos = 24;
+    return true;
+}
+
+quint16 PcapReader::read16(const uchar* p) const {
+    return m_bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+}
+
+quint32 PcapReader::read32(const uchar* p) const {
+    return m_bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+}
+
+qint64 PcapReader::toMicroseconds(quint64 units, qint64 unitsPerSecond) {
+    // Split so nanosecond timestamps don't overflow
+    qint64 seconds = qint64(units / quint64(unitsPerSecond));
+    qint64 fraction = qint64(units % quint64(unitsPerSecond));
+    return seconds * 1000000 + fraction * 1000000 / unitsPerSecond;
+}
+
+bool PcapReader::next(Packet& packet) {
+    return m_pcapng ? nextPcapng(packet) : nextPcap(packet);
+}
+
+bool PcapReader::nextPcap(Packet& packet) {
+    if (m_pos + 16 > m_size) return false;
+    const uchar* record = m_data + m_pos;
+    quint32 seconds = read32(record);
+    quint32 fraction = read32(record + 4);
+    quint32 capturedLength = read32(record + 8);
+    if (m_pos + 16 + capturedLength > m_size) {
+        m_error = "Truncated packet record";
+        return false;
+    }
+
+    packet.timestamp = qint64(seconds) * 1000000 + (m_nanoseconds ? fraction / 1000 : fraction);
+    packet.linkType = m_linkType;
+    packet.data = QByteArrayView(reinterpret_cast<const char*>(record + 16), capturedLength);
+    m_pos += 16 + capturedLength;
+    return true;
+}
+
+bool PcapReader::readSectionHeader(qint64 pos) {
+    if (pos + 28 > m_size) {
+        m_error = "Truncated section header";
+        return false;
+    }
+    // The byte-order magic decides how the rest of the section is read
+    const uchar* magic = m_data + pos + 8;
+    if (qFromLittleEndian<quint32>(magic) == 0x1A2B3C4D) {
+        m_bigEndian = false;
+    } else if (qFromBigEndian<quint32>(magic) == 0x1A2B3C4D) {
+        m_bigEndian = true;
+    } else {
+        m_error = "Bad pcapng byte-order magic";
+        return false;
+    }
+    quint32 length = read32(m_data + pos + 4);
+    if (length < 28 || (length & 3)) {
+        m_error = "Malformed pcapng section header";
+        return false;
+    }
+    m_interfaces.clear();
+    m_pos = pos + length;
+    return true;
+}
+
+void PcapReader::readInterface(const uchar* body, qint64 length) {
+    Interface iface{int(read16(body)), 1000000};
+    // Options follow link type, reserved and snap length
+    qint64 offset = 8;
+    while (offset + 4 <= length) {
+        quint16 code = read16(body + offset);
+        quint16 optionLength = read16(body + offset + 2);
+        if (code == OptionEnd || offset + 4 + optionLength > length) break;
+        if (code == OptionTimestampResolution && optionLength >= 1) {
+            uchar resolution = body[offset + 4];
+            int exponent = resolution & 0x7F;
+            qint64 units = 1;
+            for (int i = 0; i < exponent && units < (qint64(1) << 56); ++i) {
+                units *= (resolution & 0x80) ? 2 : 10;
+            }
+            iface.unitsPerSecond = units;
+        }
+        offset += 4 + ((optionLength + 3) & ~3);
+    }
+    m_interfaces.append(iface);
+}
+
+bool PcapReader::nextPcapng(Packet& packet) {
+    while (m_pos + 12 <= m_size) {
+        const uchar* block = m_data + m_pos;
+        quint32 type = read32(block);
+        if (type == SectionHeaderBlock) {
+            if (!readSectionHeader(m_pos)) return false;
+            continue;
+        }
+        quint32 length = read32(block + 4);
+        if (length < 12 || (length & 3) || m_pos + length > m_size) {
+            m_error = "Malformed pcapng block";
+            return false;
+        }
+        const uchar* body = block + 8;
+        const qint64 bodyLength = length - 12;
+        m_pos += length;
+
+        if (type == InterfaceDescriptionBlock && bodyLength >= 8) {
+            readInterface(body, bodyLength);
+        } else if (type == EnhancedPacketBlock && bodyLength >= 20) {
+            quint32 interfaceId = read32(body);
+            quint32 capturedLength = read32(body + 12);
+            if (interfaceId >= quint32(m_interfaces.size()) || 20 + qint64(capturedLength) > bodyLength) continue;
+            const Interface& iface = m_interfaces[interfaceId];
+            quint64 units = (quint64(read32(body + 4)) << 32) | read32(body + 8);
+            packet.timestamp = toMicroseconds(units, iface.unitsPerSecond);
+            packet.linkType = iface.linkType;
+            packet.data = QByteArrayView(reinterpret_cast<const char*>(body + 20), capturedLength);
+            return true;
+        } else if (type == SimplePacketBlock && bodyLength >= 4 && !m_interfaces.isEmpty()) {
+            // No timestamp; the packet keeps the previous one
+            quint32 originalLength = read32(body);
+            qint64 capturedLength = qMin<qint64>(originalLength, bodyLength - 4);
+            packet.linkType = m_interfaces.first().linkType;
+            packet.data = QByteArrayView(reinterpret_cast<const char*>(body + 4), capturedLength);
+            return true;
+        } else if (type == ObsoletePacketBlock && bodyLength >= 20) {
+            quint16 interfaceId = read16(body);
+            quint32 capturedLength = read32(body + 12);
+            if (interfaceId >= m_interfaces.size() || 20 + qint64(capturedLength) > bodyLength) continue;
+            const Interface& iface = m_interfaces[interfaceId];
+            quint64 units = (quint64(read32(body + 4)) << 32) | read32(body + 8);
+            packet.timestamp = toMicroseconds(units, iface.unitsPerSecond);
+            packet.linkType = iface.linkType;
+            packet.data = QByteArrayView(reinterpret_cast<const char*>(body + 20), capturedLength);
+            return true;
+        }
+        // Name resolution, statistics and custom blocks are skipped
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+#ifndef PCAPREADER_H
+#define PCAPREADER_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+// Sequential reader over a libpcap or pcapng capture. The file is memory
+// mapped and packets are handed out as views into the mapping, so reading
+// copies nothing and runs at the speed the OS can page the file in.
+class PcapReader {
+public:
+    struct Packet {
+        qint64 timestamp = 0;   // Microseconds since the epoch
+        int linkType = 0;       // LINKTYPE_* value of the capturing interface
+        QByteArrayView data;    // Valid until the reader is destroyed
+    };
+
+    explicit PcapReader(const QString& fileName);
+
+    bool open();
+    // False at the end of the file or on a malformed block
+    bool next(Packet& packet);
+    qint64 position() const { return m_pos; }
+    qint64 size() const { return m_size; }
+    // Empty unless open() or next() failed
+    QString errorString() const { return m_error; }
+
+private:
+    struct Interface {
+        int linkType;
+        qint64 unitsPerSecond;
+    };
+
+    bool nextPcap(Packet& packet);
+    bool nextPcapng(Packet& packet);
+    bool readSectionHeader(qint64 pos);
+    void readInterface(const uchar* body, qint64 length);
+    quint16 read16(const uchar* p) const;
+    quint32 read32(const uchar* p) const;
+    static qint64 toMicroseconds(quint64 units, qint64 unitsPerSecond);
+
+    QFile m_file;
+    const uchar* m_data;
+    qint64 m_size;
+    qint64 m_pos;
+    bool m_bigEndian;
+    bool m_pcapng;
+    bool m_nanoseconds;
+    int m_linkType;                 // libpcap: one link type for the file
+    QList<Interface> m_interfaces;  // pcapng: per interface, reset per section
+    QString m_error;
+};
+
+#endif // PCAPREADER_H
@@ -0,0 +1,138 @@
+#include "PcapWriter.h"
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+    const quint8 TcpFin = 0x01;
+    const quint8 TcpSyn = 0x02;
+    const quint8 TcpPsh = 0x08;
+    const quint8 TcpAck = 0x10;
+
+    const int EthernetHeader = 14;
+    const int IpHeader = 20;
+    const int TcpHeader = 20;
+
+    quint32 sumWords(const uchar* data, qsizetype length, quint32 sum) {
+        for (qsizetype i = 0; i + 1 < length; i += 2) {
+            sum += qFromBigEndian<quint16>(data + i);
+        }
+        if (length & 1) sum += quint32(data[length - 1]) << 8;
+        return sum;
+    }
+
+    quint16 foldChecksum(quint32 sum) {
+        while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+        return quint16(~sum);
+    }
+
+    // Locally administered MACs derived from the address, so flows look distinct
+    void writeMac(uchar* out, quint32 address) {
+        out[0] = 0x02;
+        out[1] = 0x00;
+        qToBigEndian(address, out + 2);
+    }
+}
+
+PcapWriter::PcapWriter(QIODevice* device)
+    : m_device(device)
+    , m_ipId(1)
+    , m_error(false)
+{
+    m_packet.reserve(16 + EthernetHeader + IpHeader + TcpHeader + Mss);
+}
+
+void PcapWriter::writeHeader() {
+    uchar header[24];
+    qToLittleEndian<quint32>(0xA1B2C3D4, header);
+    qToLittleEndian<quint16>(2, header + 4);
+    qToLittleEndian<quint16>(4, header + 6);
+    qToLittleEndian<quint32>(0, header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    qToLittleEndian<quint32>(65535, header + 16);
+    qToLittleEndian<quint32>(1, header + 20); // LINKTYPE_ETHERNET
+    if (m_device->write(reinterpret_cast<const char*>(header), sizeof(header)) != qint64(sizeof(header))) {
+        m_error = true;
+    }
+}
+
+void PcapWriter::writeSegment(Endpoint& from, const Endpoint& to, quint8 flags, QByteArrayView payload, qint64 time) {
+    const int frameLength = EthernetHeader + IpHeader + TcpHeader + int(payload.size());
+    m_packet.resize(16 + frameLength);
+    uchar* record = reinterpret_cast<uchar*>(m_packet.data());
+
+    qToLittleEndian<quint32>(quint32(time / 1000000), record);
+    qToLittleEndian<quint32>(quint32(time % 1000000), record + 4);
+    qToLittleEndian<quint32>(quint32(frameLength), record + 8);
+    qToLittleEndian<quint32>(quint32(frameLength), record + 12);
+
+    uchar* ethernet = record + 16;
+    writeMac(ethernet, to.address);
+    writeMac(ethernet + 6, from.address);
+    qToBigEndian<quint16>(0x0800, ethernet + 12);
+
+    uchar* ip = ethernet + EthernetHeader;
+    ip[0] = 0x45;
+    ip[1] = 0;
+    qToBigEndian<quint16>(quint16(IpHeader + TcpHeader + payload.size()), ip + 2);
+    qToBigEndian<quint16>(m_ipId++, ip + 4);
+    qToBigEndian<quint16>(0x4000, ip + 6); // Don't fragment
+    ip[8] = 64;
+    ip[9] = 6;
+    qToBigEndian<quint16>(0, ip + 10);
+    qToBigEndian(from.address, ip + 12);
+    qToBigEndian(to.address, ip + 16);
+    qToBigEndian(foldChecksum(sumWords(ip, IpHeader, 0)), ip + 10);
+
+    uchar* tcp = ip + IpHeader;
+    qToBigEndian(from.port, tcp);
+    qToBigEndian(to.port, tcp + 2);
+    qToBigEndian(from.seq, tcp + 4);
+    qToBigEndian((flags & TcpAck) ? to.seq : quint32(0), tcp + 8);
+    tcp[12] = (TcpHeader / 4) << 4;
+    tcp[13] = flags;
+    qToBigEndian<quint16>(65535, tcp + 14);
+    qToBigEndian<quint16>(0, tcp + 16);
+    qToBigEndian<quint16>(0, tcp + 18);
+    std::copy(payload.begin(), payload.end(), reinterpret_cast<char*>(tcp + TcpHeader));
+
+    // Pseudo-header, then the segment
+    const quint16 tcpLength = quint16(TcpHeader + payload.size());
+    quint32 sum = (from.address >> 16) + (from.address & 0xFFFF) + (to.address >> 16) + (to.address & 0xFFFF) + 6 + tcpLength;
+    qToBigEndian(foldChecksum(sumWords(tcp, tcpLength, sum)), tcp + 16);
+
+    if (m_device->write(m_packet) != m_packet.size()) {
+        m_error = true;
+    }
+    from.seq += quint32(payload.size()) + ((flags & (TcpSyn | TcpFin)) ? 1 : 0);
+}
+
+void PcapWriter::writeData(Endpoint& from, Endpoint& to, const QByteArray& data, qint64 time) {
+    for (qsizetype pos = 0; pos < data.size(); pos += Mss) {
+        QByteArrayView segment = QByteArrayView(data).sliced(pos, qMin<qsizetype>(Mss, data.size() - pos));
+        bool last = pos + segment.size() >= data.size();
+        writeSegment(from, to, TcpAck | (last ? TcpPsh : 0), segment, time);
+        // Delayed ACK every other segment, as a receiver would
+        if (last || (pos / Mss) % 2 == 1) {
+            writeSegment(to, from, TcpAck, QByteArrayView(), time);
+        }
+    }
+}
+
+void PcapWriter::writeExchange(quint32 clientAddress, quint16 clientPort, quint32 serverAddress, quint16 serverPort,
+                               const QByteArray& request, const QByteArray& response, qint64 startTime, qint64 responseDelay) {
+    // Initial sequence numbers only need to differ between connections
+    Endpoint client{clientAddress, clientPort, quint32(startTime) * 2654435761u};
+    Endpoint server{serverAddress, serverPort, quint32(startTime) ^ 0x5A5A5A5A};
+
+    writeSegment(client, server, TcpSyn, QByteArrayView(), startTime);
+    writeSegment(server, client, TcpSyn | TcpAck, QByteArrayView(), startTime + 100);
+    writeSegment(client, server, TcpAck, QByteArrayView(), startTime + 200);
+
+    writeData(client, server, request, startTime + 300);
+    const qint64 responseTime = startTime + 300 + qMax<qint64>(responseDelay, 1);
+    writeData(server, client, response, responseTime);
+
+    writeSegment(client, server, TcpFin | TcpAck, QByteArrayView(), responseTime + 100);
+    writeSegment(server, client, TcpFin | TcpAck, QByteArrayView(), responseTime + 200);
+    writeSegment(client, server, TcpAck, QByteArrayView(), responseTime + 300);
+}
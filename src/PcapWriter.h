@@ -0,0 +1,39 @@
+#ifndef PCAPWRITER_H
+#define PCAPWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+// Writes a libpcap capture (Ethernet, microsecond timestamps) of HTTP
+// exchanges, each on its own TCP connection: handshake, the request and
+// the response cut into MSS-sized segments, then FIN/ACK teardown. The
+// counterpart of PcapReader, used to make synthetic captures.
+class PcapWriter {
+public:
+    explicit PcapWriter(QIODevice* device);
+
+    void writeHeader();
+    // Addresses are IPv4 in host byte order; times in microseconds since the epoch
+    void writeExchange(quint32 clientAddress, quint16 clientPort, quint32 serverAddress, quint16 serverPort,
+                       const QByteArray& request, const QByteArray& response, qint64 startTime, qint64 responseDelay);
+    bool hasError() const { return m_error; }
+
+    static constexpr int Mss = 1460;
+
+private:
+    struct Endpoint {
+        quint32 address;
+        quint16 port;
+        quint32 seq;
+    };
+
+    void writeSegment(Endpoint& from, const Endpoint& to, quint8 flags, QByteArrayView payload, qint64 time);
+    void writeData(Endpoint& from, Endpoint& to, const QByteArray& data, qint64 time);
+
+    QIODevice* m_device;
+    QByteArray m_packet;
+    quint16 m_ipId;
+    bool m_error;
+};
+
+#endif // PCAPWRITER_H
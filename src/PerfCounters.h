@@ -0,0 +1,54 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QElapsedTimer>
+#include <atomic>
+
+// Process-wide counters behind the diagnostics panel. Any thread may update
+// them; they are relaxed atomics, so a reader can see one counter a moment
+// ahead of another, which is fine for a live display.
+namespace PerfCounters {
+
+class Latency {
+public:
+    void record(qint64 nanoseconds) {
+        m_last.store(nanoseconds, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        qint64 max = m_max.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+        }
+    }
+    // -1 until something was recorded
+    qint64 last() const { return m_last.load(std::memory_order_relaxed); }
+    qint64 max() const { return m_max.load(std::memory_order_relaxed); }
+    qint64 count() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_last{-1};
+    std::atomic<qint64> m_max{0};
+    std::atomic<qint64> m_count{0};
+};
+
+// Records the lifetime of the scope into a Latency
+class Timer {
+public:
+    explicit Timer(Latency& latency) : m_latency(latency) { m_timer.start(); }
+    ~Timer() { m_latency.record(m_timer.nsecsElapsed()); }
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+private:
+    Latency& m_latency;
+    QElapsedTimer m_timer;
+};
+
+inline Latency saveItem;        // DatabaseManager::saveItem, one edited item
+inline Latency insertBatch;     // DatabaseManager::insertItems, one import batch
+inline Latency import;          // Whole imports, start to finish
+inline Latency eventLoopStall;  // How late the GUI watchdog ticked, counting only stalls
+inline std::atomic<qint64> lastImportItems{0};
+inline std::atomic<qint64> pendingWrites{0}; // Imported items parsed but not yet in the database
+
+} // namespace PerfCounters
+
+#endif // PERFCOUNTERS_H
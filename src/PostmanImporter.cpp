@@ -0,0 +1,301 @@
+#include "PostmanImporter.h"
+#include "ImportPipeline.h"
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+
+namespace {
+    typedef QList<QPair<QByteArray, QByteArray>> Headers;
+
+    class Builder {
+    public:
+        explicit Builder(const QHash<QString, QString>& variables) : m_variables(variables) {}
+
+        void addItems(const QJsonArray& items, OrganizerItem* folder, const QJsonObject& auth);
+
+    private:
+        QString resolve(const QString& text) const;
+        QByteArray url(const QJsonValue& value) const;
+        QByteArray body(const QJsonObject& body, Headers& headers) const;
+        void applyAuth(const QJsonObject& auth, Headers& headers, QByteArray& url) const;
+        OrganizerItem* request(const QString& name, const QJsonValue& value, const QJsonObject& auth) const;
+
+        QHash<QString, QString> m_variables;
+    };
+
+    bool isEnabled(const QJsonObject& entry) {
+        return !entry.value("disabled").toBool();
+    }
+
+    QString description(const QJsonValue& value) {
+        // A plain string, or {"content": ..., "type": "text/markdown"}
+        return value.isObject() ? value.toObject().value("content").toString() : value.toString();
+    }
+
+    QString authValue(const QJsonObject& auth, const QString& type, const QString& key) {
+        // v2.1 stores [{"key": ..., "value": ...}], v2.0 a plain object
+        QJsonValue params = auth.value(type);
+        if (params.isObject()) return params.toObject().value(key).toVariant().toString();
+        for (const QJsonValue& param : params.toArray()) {
+            QJsonObject entry = param.toObject();
+            if (entry.value("key").toString() == key) return entry.value("value").toVariant().toString();
+        }
+        return QString();
+    }
+
+    QByteArray formEncode(const QString& text) {
+        return QUrl::toPercentEncoding(text);
+    }
+}
+
+QString Builder::resolve(const QString& text) const {
+    if (m_variables.isEmpty() || !text.contains(QLatin1String("{{"))) return text;
+
+    QString resolved;
+    resolved.reserve(text.size());
+    qsizetype pos = 0;
+    forever {
+        qsizetype open = text.indexOf(QLatin1String("{{"), pos);
+        qsizetype close = open < 0 ? -1 : text.indexOf(QLatin1String("}}"), open + 2);
+        if (close < 0) break;
+        resolved += QStringView(text).mid(pos, open - pos);
+        QString name = text.mid(open + 2, close - open - 2).trimmed();
+        auto it = m_variables.constFind(name);
+        // Unknown and dynamic ({{$guid}}) variables are left for the user
+        resolved += it != m_variables.constEnd() ? it.value() : text.mid(open, close + 2 - open);
+        pos = close + 2;
+    }
+    resolved += QStringView(text).mid(pos);
+    return resolved;
+}
+
+QByteArray Builder::url(const QJsonValue& value) const {
+    if (!value.isObject()) return resolve(value.toString()).toUtf8();
+
+    QJsonObject url = value.toObject();
+    QJsonValue host = url.value("host");
+    if (!host.isArray() && !host.isString()) {
+        return resolve(url.value("raw").toString()).toUtf8();
+    }
+
+    // Rebuilt from the parts so disabled query parameters stay out
+    QString text;
+    QString protocol = url.value("protocol").toString();
+    if (!protocol.isEmpty()) text += protocol + "://";
+    if (host.isArray()) {
+        QStringList parts;
+        for (const QJsonValue& part : host.toArray()) parts.append(part.toString());
+        text += parts.join('.');
+    } else {
+        text += host.toString();
+    }
+    QString port = url.value("port").toVariant().toString();
+    if (!port.isEmpty()) text += ":" + port;
+
+    QHash<QString, QString> pathVariables;
+    for (const QJsonValue& variable : url.value("variable").toArray()) {
+        QJsonObject entry = variable.toObject();
+        pathVariables.insert(entry.value("key").toString(), entry.value("value").toVariant().toString());
+    }
+    QJsonValue path = url.value("path");
+    QStringList segments;
+    if (path.isArray()) {
+        for (const QJsonValue& part : path.toArray()) {
+            QString segment = part.isObject() ? part.toObject().value("value").toString() : part.toString();
+            if (segment.startsWith(':') && pathVariables.contains(segment.mid(1))) {
+                segment = pathVariables.value(segment.mid(1));
+            }
+            segments.append(segment);
+        }
+    } else if (path.isString()) {
+        segments.append(path.toString());
+    }
+    text += "/" + segments.join('/');
+
+    QStringList query;
+    for (const QJsonValue& param : url.value("query").toArray()) {
+        QJsonObject entry = param.toObject();
+        if (!isEnabled(entry)) continue;
+        QJsonValue paramValue = entry.value("value");
+        query.append(paramValue.isNull() ? entry.value("key").toString()
+                                         : entry.value("key").toString() + "=" + paramValue.toString());
+    }
+    if (!query.isEmpty()) text += "?" + query.join('&');
+    return resolve(text).toUtf8();
+}
+
+QByteArray Builder::body(const QJsonObject& body, Headers& headers) const {
+    QString mode = body.value("mode").toString();
+    QByteArray contentType;
+    QByteArray data;
+
+    if (mode == "raw") {
+        data = resolve(body.value("raw").toString()).toUtf8();
+        QString language = body.value("options").toObject().value("raw").toObject().value("language").toString();
+        if (language == "json") contentType = "application/json";
+        else if (language == "xml") contentType = "application/xml";
+        else if (language == "html") contentType = "text/html";
+        else contentType = "text/plain";
+    } else if (mode == "urlencoded") {
+        QList<QByteArray> pairs;
+        for (const QJsonValue& param : body.value("urlencoded").toArray()) {
+            QJsonObject entry = param.toObject();
+            if (!isEnabled(entry)) continue;
+            pairs.append(formEncode(resolve(entry.value("key").toString())) + "=" +
+                         formEncode(resolve(entry.value("value").toString())));
+        }
+        data = pairs.join('&');
+        contentType = "application/x-www-form-urlencoded";
+    } else if (mode == "formdata") {
+        const QByteArray boundary = "----RequestOrganizerBoundary";
+        for (const QJsonValue& param : body.value("formdata").toArray()) {
+            QJsonObject entry = param.toObject();
+            if (!isEnabled(entry)) continue;
+            QByteArray name = resolve(entry.value("key").toString()).toUtf8();
+            data += "--" + boundary + "\r\n";
+            if (entry.value("type").toString() == "file") {
+                // Files aren't part of the collection; an empty part keeps the field
+                QString source = entry.value("src").toVariant().toString();
+                data += "Content-Disposition: form-data; name=\"" + name + "\"; filename=\"" +
+                        source.section('/', -1).toUtf8() + "\"\r\n";
+                data += "Content-Type: application/octet-stream\r\n\r\n\r\n";
+            } else {
+                data += "Content-Disposition: form-data; name=\"" + name + "\"\r\n\r\n" +
+                        resolve(entry.value("value").toString()).toUtf8() + "\r\n";
+            }
+        }
+        if (data.isEmpty()) return data;
+        data += "--" + boundary + "--\r\n";
+        contentType = "multipart/form-data; boundary=" + boundary;
+    } else if (mode == "graphql") {
+        QJsonObject graphql = body.value("graphql").toObject();
+        QJsonObject payload;
+        payload.insert("query", resolve(graphql.value("query").toString()));
+        QJsonDocument variables = QJsonDocument::fromJson(resolve(graphql.value("variables").toString()).toUtf8());
+        if (variables.isObject()) payload.insert("variables", variables.object());
+        data = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+        contentType = "application/json";
+    }
+
+    if (!data.isEmpty()) {
+        bool hasContentType = false;
+        for (const auto& header : headers) {
+            if (qstricmp(header.first.constData(), "content-type") == 0) hasContentType = true;
+        }
+        if (!hasContentType) headers.append({"Content-Type", contentType});
+    }
+    return data;
+}
+
+void Builder::applyAuth(const QJsonObject& auth, Headers& headers, QByteArray& url) const {
+    QString type = auth.value("type").toString();
+    if (type == "bearer") {
+        headers.append({"Authorization", "Bearer " + resolve(authValue(auth, type, "token")).toUtf8()});
+    } else if (type == "basic") {
+        QByteArray credentials = resolve(authValue(auth, type, "username")).toUtf8() + ":" +
+                                 resolve(authValue(auth, type, "password")).toUtf8();
+        headers.append({"Authorization", "Basic " + credentials.toBase64()});
+    } else if (type == "apikey") {
+        QByteArray key = resolve(authValue(auth, type, "key")).toUtf8();
+        QByteArray value = resolve(authValue(auth, type, "value")).toUtf8();
+        if (authValue(auth, type, "in") == "query") {
+            url += (url.contains('?') ? "&" : "?") + formEncode(key) + "=" + formEncode(value);
+        } else if (!key.isEmpty()) {
+            headers.append({key, value});
+        }
+    }
+}
+
+OrganizerItem* Builder::request(const QString& name, const QJsonValue& value, const QJsonObject& auth) const {
+    // A request can also be given as just its URL
+    QJsonObject request = value.isObject() ? value.toObject() : QJsonObject{{"url", value}};
+
+    QByteArray method = request.value("method").toString("GET").toUpper().toLatin1();
+    QByteArray requestUrl = url(request.value("url"));
+    if (!requestUrl.contains("://")) requestUrl.prepend("http://");
+
+    Headers headers;
+    QJsonValue headerList = request.value("header");
+    for (const QJsonValue& header : headerList.toArray()) {
+        QJsonObject entry = header.toObject();
+        if (!isEnabled(entry)) continue;
+        headers.append({resolve(entry.value("key").toString()).toLatin1(),
+                        resolve(entry.value("value").toString()).toUtf8()});
+    }
+
+    QJsonValue ownAuth = request.value("auth");
+    applyAuth(ownAuth.isObject() ? ownAuth.toObject() : auth, headers, requestUrl);
+    QByteArray data = body(request.value("body").toObject(), headers);
+
+    ImportRecord record;
+    record.name = name;
+    record.method = QString::fromLatin1(method);
+    record.url = QString::fromUtf8(requestUrl);
+    record.comment = description(request.value("description"));
+    record.request = ImportPipeline::buildRequest(method, requestUrl, headers, data);
+    return ImportPipeline::createItem(record);
+}
+
+void Builder::addItems(const QJsonArray& items, OrganizerItem* folder, const QJsonObject& auth) {
+    for (const QJsonValue& value : items) {
+        QJsonObject entry = value.toObject();
+        QString name = entry.value("name").toString();
+
+        // Folders and requests can both override the auth they inherit
+        QJsonValue ownAuth = entry.value("auth");
+        QJsonObject effectiveAuth = ownAuth.isObject() ? ownAuth.toObject() : auth;
+
+        if (entry.contains("item")) {
+            OrganizerItem* child = new OrganizerItem(ItemType::Folder, name);
+            child->setAnnotation(description(entry.value("description")));
+            folder->appendChild(child);
+            addItems(entry.value("item").toArray(), child, effectiveAuth);
+        } else if (entry.contains("request")) {
+            OrganizerItem* child = request(name, entry.value("request"), effectiveAuth);
+            if (child) folder->appendChild(child);
+        }
+    }
+}
+
+OrganizerItem* PostmanImporter::importFile(const QString& fileName, QString* error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Could not open file: " + fileName;
+        return nullptr;
+    }
+    return importCollection(file.readAll(), error);
+}
+
+OrganizerItem* PostmanImporter::importCollection(const QByteArray& json, QString* error) {
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (document.isNull()) {
+        if (error) *error = "JSON parsing error: " + parseError.errorString();
+        return nullptr;
+    }
+    QJsonObject collection = document.object();
+    if (!collection.value("item").isArray()) {
+        if (error) *error = "Not a Postman collection";
+        return nullptr;
+    }
+
+    QHash<QString, QString> variables;
+    for (const QJsonValue& variable : collection.value("variable").toArray()) {
+        QJsonObject entry = variable.toObject();
+        if (isEnabled(entry)) {
+            variables.insert(entry.value("key").toString(), entry.value("value").toVariant().toString());
+        }
+    }
+
+    QJsonObject info = collection.value("info").toObject();
+    QString name = info.value("name").toString();
+    OrganizerItem* root = new OrganizerItem(ItemType::Folder, name.isEmpty() ? "Postman Collection" : name);
+    root->setAnnotation(description(info.value("description")));
+
+    Builder builder(variables);
+    builder.addItems(collection.value("item").toArray(), root, collection.value("auth").toObject());
+    return root;
+}
@@ -0,0 +1,21 @@
+#ifndef POSTMANIMPORTER_H
+#define POSTMANIMPORTER_H
+
+#include <QByteArray>
+#include <QString>
+#include "OrganizerItem.h"
+
+// Turns a Postman v2.0/v2.1 collection into a folder tree: collection
+// folders become folders and requests get synthesized raw HTTP/1.1
+// messages. Collection variables ({{name}}) and inherited auth are applied.
+// The tree is built without touching the model or the database, so it can
+// run on a worker and be added in one go.
+namespace PostmanImporter {
+
+// Returns the collection folder, or null with error set
+OrganizerItem* importFile(const QString& fileName, QString* error = nullptr);
+OrganizerItem* importCollection(const QByteArray& json, QString* error = nullptr);
+
+} // namespace PostmanImporter
+
+#endif // POSTMANIMPORTER_H
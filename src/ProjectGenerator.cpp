@@ -0,0 +1,283 @@
+#include "ProjectGenerator.h"
+#include "BurpXmlWriter.h"
+#include "DatabaseManager.h"
+#include "HarWriter.h"
+#include "PcapWriter.h"
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QScopeGuard>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QXmlStreamWriter>
+#include <cmath>
+#include <memory>
+
+namespace {
+    const char* const Words[] = {
+        "account", "order", "invoice", "user", "session", "product", "cart", "search", "report", "token",
+        "profile", "settings", "upload", "image", "comment", "message", "group", "event", "payment", "status"
+    };
+    const int WordCount = int(sizeof(Words) / sizeof(Words[0]));
+
+    const char* const HostPrefixes[] = {"api", "www", "cdn", "auth", "static", "admin"};
+    const int HostPrefixCount = int(sizeof(HostPrefixes) / sizeof(HostPrefixes[0]));
+
+    const qint64 PoolSize = 4 * 1024 * 1024;
+    const qint64 StartTime = 1700000000LL * 1000000;
+    const int ScreenshotCount = 4;
+
+    QByteArray reasonPhrase(int status) {
+        switch (status) {
+        case 200: return "OK";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 404: return "Not Found";
+        default: return "Internal Server Error";
+        }
+    }
+}
+
+ProjectGenerator::ProjectGenerator(const GeneratorOptions& options)
+    : m_options(options)
+    , m_random(options.seed)
+    , m_clock(StartTime)
+    , m_clientPort(49152)
+{
+    m_options.minBody = qMax(0, m_options.minBody);
+    m_options.maxBody = qMax(m_options.minBody, m_options.maxBody);
+    m_options.fanOut = qMax(1, m_options.fanOut);
+    m_options.depth = qMax(0, m_options.depth);
+    m_options.hosts = qMax(1, m_options.hosts);
+
+    // Bodies are slices of two pools made once, so a million requests
+    // cost no more generation time than a few thousand bytes each
+    const qint64 poolSize = qMax(PoolSize, (2 * qint64(m_options.maxBody) + 3) & ~qint64(3));
+    m_text.reserve(poolSize + 256);
+    while (m_text.size() < poolSize) {
+        m_text.append("{\"id\": ").append(QByteArray::number(m_random.bounded(1000000)))
+            .append(", \"type\": \"").append(Words[m_random.bounded(WordCount)])
+            .append("\", \"name\": \"").append(Words[m_random.bounded(WordCount)]).append(' ')
+            .append(Words[m_random.bounded(WordCount)])
+            .append("\", \"value\": ").append(QByteArray::number(m_random.bounded(100000) / 100.0))
+            .append(", \"active\": ").append(m_random.bounded(2) ? "true" : "false").append("},\n");
+    }
+    m_binary.resize(poolSize);
+    m_random.fillRange(reinterpret_cast<quint32*>(m_binary.data()), poolSize / sizeof(quint32));
+
+    for (int i = 0; i < ScreenshotCount; ++i) {
+        QImage image(320, 200, QImage::Format_RGB32);
+        image.fill(QColor::fromHsv(i * 360 / ScreenshotCount, 60, 240));
+        QPainter painter(&image);
+        for (int r = 0; r < 12; ++r) {
+            painter.fillRect(m_random.bounded(300), m_random.bounded(180), 20 + m_random.bounded(120),
+                             6 + m_random.bounded(20), QColor::fromRgb(m_random.generate()));
+        }
+        painter.end();
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        m_screenshots.append(QString::fromLatin1(png.toBase64()));
+    }
+}
+
+void ProjectGenerator::buildFolders(OrganizerItem* folder, int depth, QList<OrganizerItem*>& leaves) {
+    if (depth == 0) {
+        leaves.append(folder);
+        return;
+    }
+    for (int i = 0; i < m_options.fanOut; ++i) {
+        OrganizerItem* child = new OrganizerItem(ItemType::Folder,
+                                                 QString("%1 %2").arg(Words[(i + depth) % WordCount]).arg(i + 1));
+        folder->appendChild(child);
+        buildFolders(child, depth - 1, leaves);
+    }
+}
+
+QByteArray ProjectGenerator::slice(const QByteArray& pool, int size) {
+    const qsizetype start = m_random.bounded(pool.size() - size + 1);
+    return pool.mid(start, size);
+}
+
+OrganizerItem* ProjectGenerator::makeRequest(qint64 index, quint32* serverAddress) {
+    // A handful of hosts get most of the traffic, as in a real proxy history
+    const int hostIndex = int(m_options.hosts * std::pow(m_random.generateDouble(), 3.0));
+    const QString host = QString("%1%2.example.com").arg(HostPrefixes[hostIndex % HostPrefixCount]).arg(hostIndex);
+    *serverAddress = 0xAC100000 + quint32(hostIndex) + 1; // 172.16.0.0/12
+    // Plain HTTP, so the pcap can carry the same requests as the Burp and
+    // HAR files; every fifth host listens on 8080
+    const int port = hostIndex % 5 == 4 ? 8080 : 80;
+    const QString authority = port == 80 ? host : host + ":" + QString::number(port);
+
+    const int methodRoll = m_random.bounded(100);
+    const QString method = methodRoll < 70 ? "GET" : methodRoll < 90 ? "POST" : methodRoll < 95 ? "PUT" : "DELETE";
+    QString path = QString("/%1/%2").arg(Words[m_random.bounded(WordCount)]).arg(index);
+    if (m_random.bounded(3) == 0) path += "/" + QString(Words[m_random.bounded(WordCount)]);
+    const QString query = method == "GET" && m_random.bounded(2)
+        ? QString("page=%1&sort=%2").arg(m_random.bounded(100)).arg(Words[m_random.bounded(WordCount)])
+        : QString();
+
+    QByteArray requestBody;
+    if (method == "POST" || method == "PUT") {
+        requestBody = slice(m_text, 64 + m_random.bounded(1024));
+    }
+    QByteArray request = method.toLatin1() + ' ' + path.toLatin1() + (query.isEmpty() ? QByteArray() : "?" + query.toLatin1())
+        + " HTTP/1.1\r\nHost: " + authority.toLatin1() + "\r\n"
+          "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+          "Accept: */*\r\n"
+          "Cookie: session=" + QByteArray::number(m_random.generate64(), 16) + "\r\n";
+    if (!requestBody.isEmpty()) {
+        request += "Content-Type: application/json\r\nContent-Length: " + QByteArray::number(requestBody.size()) + "\r\n";
+    }
+    request += "\r\n" + requestBody;
+
+    const int statusRoll = m_random.bounded(100);
+    const int status = statusRoll < 75 ? 200 : statusRoll < 83 ? 404 : statusRoll < 89 ? 302 : statusRoll < 95 ? 304 : 500;
+    QByteArray responseBody;
+    QByteArray contentType = "application/json";
+    if (status != 302 && status != 304) {
+        const double skewed = std::pow(m_random.generateDouble(), m_options.bodySkew);
+        const int size = m_options.minBody + int((m_options.maxBody - m_options.minBody) * skewed);
+        if (status == 200 && m_random.generateDouble() < m_options.binaryRatio) {
+            contentType = "application/octet-stream";
+            responseBody = slice(m_binary, size);
+        } else {
+            responseBody = slice(m_text, size);
+        }
+    }
+
+    // Response time: mostly quick, with a long tail
+    const qint64 responseDelay = 5000 + qint64(2000000 * std::pow(m_random.generateDouble(), 4.0));
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n"
+        "Date: " + QDateTime::fromMSecsSinceEpoch((m_clock + responseDelay) / 1000, Qt::UTC)
+                       .toString("ddd, dd MMM yyyy hh:mm:ss 'GMT'").toLatin1() + "\r\n"
+        "Server: nginx\r\n";
+    if (status == 302) {
+        response += "Location: /" + QByteArray(Words[m_random.bounded(WordCount)]) + "\r\n";
+    }
+    if (status != 304) {
+        response += "Content-Type: " + contentType + "\r\nContent-Length: " + QByteArray::number(responseBody.size()) + "\r\n";
+    }
+    response += "\r\n" + responseBody;
+
+    QString name = method + " " + path;
+    if (name.length() > 50) {
+        name = name.left(47) + "...";
+    }
+    OrganizerItem* item = new OrganizerItem(ItemType::Request, name);
+    item->setHost(host);
+    item->setUrl(path);
+    item->setScheme("http");
+    item->setPort(port);
+    item->setMethod(method);
+    item->setQuery(query);
+    item->setStatus(status);
+    item->setLength(response.size());
+    item->setResponseTime(responseDelay / 1000);
+    item->setTimestamp(m_clock / 1000000);
+    item->setRequest(request);
+    item->setResponse(response);
+    if (m_random.generateDouble() < m_options.screenshotRatio) {
+        item->setScreenshot(m_screenshots[m_random.bounded(ScreenshotCount)]);
+    }
+    return item;
+}
+
+bool ProjectGenerator::generate(QSqlDatabase& db, int parentId, QString* error,
+                                const std::function<void(qint64, qint64)>& progress) {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    // Optional exports, written alongside the inserts
+    std::unique_ptr<QFile> burpFile, harFile, pcapFile;
+    std::unique_ptr<QXmlStreamWriter> burp;
+    std::unique_ptr<HarWriter> har;
+    std::unique_ptr<PcapWriter> pcap;
+    auto open = [&fail](std::unique_ptr<QFile>& file, const QString& fileName) {
+        file = std::make_unique<QFile>(fileName);
+        return file->open(QIODevice::WriteOnly | QIODevice::Truncate) || fail("Could not open file: " + fileName);
+    };
+    if (!m_options.burpFile.isEmpty()) {
+        if (!open(burpFile, m_options.burpFile)) return false;
+        burp = std::make_unique<QXmlStreamWriter>(burpFile.get());
+        BurpXmlWriter::writeStart(*burp);
+    }
+    if (!m_options.harFile.isEmpty()) {
+        if (!open(harFile, m_options.harFile)) return false;
+        har = std::make_unique<HarWriter>(harFile.get());
+        har->writeStart();
+    }
+    if (!m_options.pcapFile.isEmpty()) {
+        if (!open(pcapFile, m_options.pcapFile)) return false;
+        pcap = std::make_unique<PcapWriter>(pcapFile.get());
+        pcap->writeHeader();
+    }
+
+    // The generated project is disposable, so skip the syncs; the previous
+    // setting comes back when we are done
+    QSqlQuery pragma(db);
+    int synchronous = 2;
+    if (pragma.exec("PRAGMA synchronous") && pragma.next()) {
+        synchronous = pragma.value(0).toInt();
+    }
+    pragma.exec("PRAGMA synchronous = OFF");
+    auto restore = qScopeGuard([&pragma, synchronous]() {
+        pragma.exec(QString("PRAGMA synchronous = %1").arg(synchronous));
+    });
+
+    std::unique_ptr<OrganizerItem> top(new OrganizerItem(ItemType::Folder,
+        QString("Generated %1 (seed %2)").arg(m_options.items).arg(m_options.seed)));
+    QList<OrganizerItem*> leaves;
+    buildFolders(top.get(), m_options.depth, leaves);
+    if (!DatabaseManager::instance().insertTree(db, top.get(), parentId)) {
+        return fail("Could not save folders: " + db.lastError().text());
+    }
+
+    // Requests are spread evenly and contiguously across the leaf folders
+    qint64 done = 0;
+    QList<OrganizerItem*> batch;
+    for (int leaf = 0; leaf < leaves.size(); ++leaf) {
+        const qint64 count = m_options.items / leaves.size() + (leaf < m_options.items % leaves.size() ? 1 : 0);
+        for (qint64 i = 0; i < count; ++i) {
+            quint32 serverAddress = 0;
+            OrganizerItem* item = makeRequest(done + batch.size(), &serverAddress);
+            const qint64 responseDelay = item->responseTime() * 1000;
+            if (burp) BurpXmlWriter::writeItem(*burp, item);
+            if (har) har->writeEntry(item);
+            if (pcap) {
+                const quint32 clientAddress = 0x0A000000 + quint32((done + batch.size()) % 250) + 1; // 10.0.0.0/8
+                pcap->writeExchange(clientAddress, m_clientPort, serverAddress, quint16(item->port()),
+                                    item->request(), item->response(), m_clock, responseDelay);
+                m_clientPort = m_clientPort == 65535 ? 49152 : m_clientPort + 1;
+            }
+            m_clock += 1000 + m_random.bounded(200000);
+            batch.append(item);
+
+            if (batch.size() == BatchSize || i == count - 1) {
+                const bool saved = DatabaseManager::instance().insertItems(db, batch, leaves[leaf]->dbId());
+                done += batch.size();
+                qDeleteAll(batch);
+                batch.clear();
+                if (!saved) {
+                    return fail("Could not save requests: " + db.lastError().text());
+                }
+                if ((burp && burp->hasError()) || (har && har->hasError()) || (pcap && pcap->hasError())) {
+                    return fail("Could not write export files");
+                }
+                if (progress) progress(done, m_options.items);
+            }
+        }
+    }
+
+    if (burp) BurpXmlWriter::writeEnd(*burp);
+    if (har) har->writeEnd();
+    if ((burp && burp->hasError()) || (har && har->hasError()) || (pcap && pcap->hasError())) {
+        return fail("Could not write export files");
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PROJECTGENERATOR_H
+#define PROJECTGENERATOR_H
+
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "OrganizerItem.h"
+
+struct GeneratorOptions {
+    quint32 seed = 1;
+    qint64 items = 10000;
+    int fanOut = 10;             // Subfolders per folder
+    int depth = 2;               // Folder levels under the top folder; 0 puts every request in it
+    int hosts = 50;              // Distinct hosts; a few popular ones get most requests
+    int minBody = 128;           // Response body sizes are min + (max - min) * u^skew,
+    int maxBody = 16 * 1024;     // so with skew > 1 most bodies are small
+    double bodySkew = 3.0;
+    double screenshotRatio = 0.01;
+    double binaryRatio = 0.05;   // Responses with binary bodies
+    QString burpFile;            // Matching exports, written in the same pass when set
+    QString harFile;
+    QString pcapFile;
+};
+
+// Fills a project with synthetic but realistic traffic for scale testing.
+// Output depends only on the options, so a seed reproduces a project
+// exactly. Requests go in with prepared bulk inserts, a few thousand per
+// transaction, and are streamed to the optional Burp XML, HAR and pcap
+// files as they are made; nothing is kept in memory.
+class ProjectGenerator {
+public:
+    explicit ProjectGenerator(const GeneratorOptions& options);
+
+    // Creates the folder tree and its requests under parentId (-1 for the
+    // top level). progress gets (done, total) after every batch.
+    bool generate(QSqlDatabase& db, int parentId, QString* error = nullptr,
+                  const std::function<void(qint64, qint64)>& progress = nullptr);
+
+    static constexpr int BatchSize = 5000;
+
+private:
+    void buildFolders(OrganizerItem* folder, int depth, QList<OrganizerItem*>& leaves);
+    OrganizerItem* makeRequest(qint64 index, quint32* serverAddress);
+    QByteArray slice(const QByteArray& pool, int size);
+
+    GeneratorOptions m_options;
+    QRandomGenerator m_random;
+    QByteArray m_text;           // Bodies are cut from these pools
+    QByteArray m_binary;
+    QStringList m_screenshots;   // Base64 PNGs, as the GUI stores them
+    qint64 m_clock;              // Microseconds since the epoch
+    quint16 m_clientPort;
+};
+
+#endif // PROJECTGENERATOR_H
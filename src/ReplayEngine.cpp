@@ -0,0 +1,128 @@
+#include "ReplayEngine.h"
+#include "HttpMessageIndex.h"
+#include <QDateTime>
+
+ReplayEngine::ReplayEngine(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_defaultTls(options.tls)
+    , m_nextId(0)
+    , m_total(0)
+    , m_done(0)
+    , m_failed(0)
+{
+    m_pool.setMaxConnections(options.maxConnections);
+    m_pool.setMaxConnectionsPerHost(options.maxConnectionsPerHost);
+    m_pool.setTimeout(options.timeout);
+    m_pool.setVerifyPeer(options.verifyPeer);
+    connect(&m_pool, &HttpClientPool::finished, this, &ReplayEngine::onFinished);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ReplayEngine::flush);
+}
+
+ReplayEngine::~ReplayEngine() {
+    cancel();
+}
+
+HttpTarget ReplayEngine::targetFor(const OrganizerItem* item, bool defaultTls) {
+    const QByteArray request = item->request();
+    const HttpMessageIndex& index = item->requestIndex();
+    QString authority = QString::fromLatin1(index.header(request, "host").toByteArray().trimmed());
+    if (authority.isEmpty()) authority = item->host();
+
+    HttpTarget target;
+    target.tls = defaultTls;
+    target.port = defaultTls ? 443 : 80;
+    target.host = authority;
+    // A trailing :port, but not the inside of a bracketed IPv6 address
+    const int colon = authority.lastIndexOf(':');
+    if (colon > 0 && !authority.endsWith(']')) {
+        bool ok = false;
+        const int port = authority.mid(colon + 1).toInt(&ok);
+        if (ok && port > 0 && port < 65536) {
+            target.host = authority.left(colon);
+            target.port = quint16(port);
+            if (port == 80) target.tls = false;
+            if (port == 443) target.tls = true;
+        }
+    }
+    if (target.host.startsWith('[') && target.host.endsWith(']')) {
+        target.host = target.host.mid(1, target.host.size() - 2);
+    }
+    return target;
+}
+
+void ReplayEngine::replay(const OrganizerItem* item) {
+    if (item->type() != ItemType::Request || item->dbId() == -1 || item->request().isEmpty()) return;
+    const HttpTarget target = targetFor(item, m_defaultTls);
+    if (target.host.isEmpty()) return;
+
+    // The copy carries everything but the old response
+    OrganizerItem* copy = new OrganizerItem(ItemType::Request, item->name());
+    copy->setDbId(item->dbId());
+    copy->setHost(item->host());
+    copy->setUrl(item->url());
+    copy->setMethod(item->method());
+    copy->setQuery(item->query());
+    copy->setRequest(item->request());
+
+    const quint64 id = ++m_nextId;
+    m_inFlight.insert(id, copy);
+    ++m_total;
+    m_pool.send(id, target, copy->request());
+    emit progress(m_done, m_total);
+}
+
+void ReplayEngine::cancel() {
+    m_pool.abort();
+    qDeleteAll(m_inFlight);
+    m_inFlight.clear();
+    m_flushTimer.stop();
+    for (const auto& result : m_results) {
+        delete result.second;
+    }
+    m_results.clear();
+    m_done = m_total;
+}
+
+void ReplayEngine::onFinished(quint64 id, const QByteArray& response, qint64 elapsed, const QString& error) {
+    OrganizerItem* item = m_inFlight.take(id);
+    if (!item) return;
+    ++m_done;
+
+    if (!error.isEmpty()) {
+        ++m_failed;
+        m_lastError = error;
+        delete item;
+    } else {
+        const HttpMessageIndex index = HttpMessageIndex::parse(response);
+        item->setResponse(response);
+        item->setStatus(index.status());
+        item->setLength(response.size());
+        item->setResponseTime(elapsed / 1000000);
+        item->setTimestamp(QDateTime::currentSecsSinceEpoch());
+        const int originalId = item->dbId();
+        item->setDbId(-1);
+        m_results.append({originalId, item});
+        if (m_results.size() >= BatchSize) {
+            flush();
+        } else if (!m_flushTimer.isActive()) {
+            m_flushTimer.start();
+        }
+    }
+
+    emit progress(m_done, m_total);
+    if (m_done == m_total) {
+        flush();
+        emit finished(m_done - m_failed, m_failed, m_lastError);
+    }
+}
+
+void ReplayEngine::flush() {
+    m_flushTimer.stop();
+    if (m_results.isEmpty()) return;
+    QList<QPair<int, OrganizerItem*>> results;
+    results.swap(m_results);
+    emit resultsReady(results);
+}
@@ -0,0 +1,68 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QTimer>
+#include "HttpClientPool.h"
+#include "OrganizerItem.h"
+
+// Re-sends stored requests and turns the answers into items. Each result is
+// a detached copy of the original carrying the new response, status,
+// length, response time and timestamp, keyed by the original's id. Results
+// are handed over in batches, so the receiver can persist them with one
+// transaction either onto the originals (DatabaseManager::replaceItems) or
+// as new siblings (OrganizerModel::addRequests).
+class ReplayEngine : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        bool tls = true;          // For requests whose Host header names no port
+        int maxConnections = 32;
+        int maxConnectionsPerHost = 6;
+        int timeout = 30000;      // ms without a byte before a request fails
+        bool verifyPeer = false;
+    };
+
+    explicit ReplayEngine(const Options& options, QObject* parent = nullptr);
+    ~ReplayEngine();
+
+    // Queues the item's raw request; items without an id or request are skipped
+    void replay(const OrganizerItem* item);
+    void cancel();
+    bool isRunning() const { return m_done < m_total; }
+
+    // Host header first, then the host column; an explicit port 80 or 443
+    // decides the scheme, otherwise defaultTls does
+    static HttpTarget targetFor(const OrganizerItem* item, bool defaultTls);
+
+    static constexpr int BatchSize = 250;
+    static constexpr int FlushInterval = 200; // ms
+
+signals:
+    // Ownership of the items passes to the receiver
+    void resultsReady(const QList<QPair<int, OrganizerItem*>>& results);
+    void progress(int done, int total);
+    void finished(int succeeded, int failed, const QString& lastError);
+
+private slots:
+    void onFinished(quint64 id, const QByteArray& response, qint64 elapsed, const QString& error);
+    void flush();
+
+private:
+    HttpClientPool m_pool;
+    QHash<quint64, OrganizerItem*> m_inFlight; // Copies waiting for their response
+    QList<QPair<int, OrganizerItem*>> m_results;
+    QTimer m_flushTimer;
+    bool m_defaultTls;
+    quint64 m_nextId;
+    int m_total;
+    int m_done;
+    int m_failed;
+    QString m_lastError;
+};
+
+#endif // REPLAYENGINE_H
@@ -0,0 +1,396 @@
+#include "RequestExporter.h"
+#include "HttpDecoder.h"
+#include "HttpMessageIndex.h"
+#include "RequestOrigin.h"
+#include <QFile>
+
+namespace {
+    const char HexDigits[] = "0123456789abcdef";
+
+    // POSIX single quotes: everything is literal except the quote itself
+    QByteArray shellQuote(QByteArrayView value) {
+        QByteArray quoted;
+        quoted.reserve(value.size() + 2);
+        quoted.append('\'');
+        for (char c : value) {
+            if (c == '\'') {
+                quoted.append("'\\''");
+            } else {
+                quoted.append(c);
+            }
+        }
+        quoted.append('\'');
+        return quoted;
+    }
+
+    // Python string/bytes literal body; the template adds a b prefix for bytes
+    QByteArray pythonQuote(QByteArrayView value) {
+        QByteArray quoted;
+        quoted.reserve(value.size() + 2);
+        quoted.append('"');
+        for (char c : value) {
+            uchar byte = uchar(c);
+            switch (c) {
+            case '"': quoted.append("\\\""); break;
+            case '\\': quoted.append("\\\\"); break;
+            case '\n': quoted.append("\\n"); break;
+            case '\r': quoted.append("\\r"); break;
+            case '\t': quoted.append("\\t"); break;
+            default:
+                if (byte < 0x20 || byte >= 0x7F) {
+                    const char escape[] = {'\\', 'x', HexDigits[byte >> 4], HexDigits[byte & 0xF]};
+                    quoted.append(escape, 4);
+                } else {
+                    quoted.append(c);
+                }
+                break;
+            }
+        }
+        quoted.append('"');
+        return quoted;
+    }
+
+    // C string literal; octal escapes can't swallow a following hex digit
+    QByteArray cQuote(QByteArrayView value) {
+        QByteArray quoted;
+        quoted.reserve(value.size() + 2);
+        quoted.append('"');
+        for (char c : value) {
+            uchar byte = uchar(c);
+            switch (c) {
+            case '"': quoted.append("\\\""); break;
+            case '\\': quoted.append("\\\\"); break;
+            case '?': quoted.append("\\?"); break; // No trigraphs
+            case '\n': quoted.append("\\n"); break;
+            case '\r': quoted.append("\\r"); break;
+            case '\t': quoted.append("\\t"); break;
+            default:
+                if (byte < 0x20 || byte >= 0x7F) {
+                    const char escape[] = {'\\', char('0' + (byte >> 6)), char('0' + ((byte >> 3) & 7)), char('0' + (byte & 7))};
+                    quoted.append(escape, 4);
+                } else {
+                    quoted.append(c);
+                }
+                break;
+            }
+        }
+        quoted.append('"');
+        return quoted;
+    }
+
+    const char PythonHeaders[] =
+        "{{#headers}}        {{name}}: {{value}},\n{{/headers}}";
+
+    QList<ExportFormat> buildFormats() {
+        QList<ExportFormat> formats;
+
+        formats.append({"cURL", "Shell Scripts (*.sh)",
+            "#!/bin/sh\n\n",
+            ExportTemplate(
+                "# {{title}}\n"
+                "curl -i -s -k -X {{method}}"
+                "{{#headers}} \\\n    -H {{header}}{{/headers}}"
+                "{{#body}} \\\n    --data-binary {{body}}{{/body}}"
+                " \\\n    {{url}}\n\n"),
+            "", shellQuote, ""});
+
+        formats.append({"ffuf", "Shell Scripts (*.sh)",
+            "#!/bin/sh\n# Put FUZZ where the payloads go\n\n",
+            ExportTemplate(
+                "# {{title}}\n"
+                "ffuf -w wordlist.txt -X {{method}}"
+                "{{#headers}} \\\n    -H {{header}}{{/headers}}"
+                "{{#body}} \\\n    -d {{body}}{{/body}}"
+                " \\\n    -u {{url}}\n\n"),
+            "", shellQuote, ""});
+
+        formats.append({"wfuzz", "Shell Scripts (*.sh)",
+            "#!/bin/sh\n# Put FUZZ where the payloads go\n\n",
+            ExportTemplate(
+                "# {{title}}\n"
+                "wfuzz -z file,wordlist.txt -X {{method}}"
+                "{{#headers}} \\\n    -H {{header}}{{/headers}}"
+                "{{#body}} \\\n    -d {{body}}{{/body}}"
+                " \\\n    {{url}}\n\n"),
+            "", shellQuote, ""});
+
+        formats.append({"Python requests", "Python Scripts (*.py)",
+            "import requests\n\n",
+            ExportTemplate(QByteArray(
+                "# {{title}}\n"
+                "response = requests.request(\n"
+                "    {{method}},\n"
+                "    {{url}},\n"
+                "    headers={\n") + PythonHeaders + QByteArray(
+                "    },\n"
+                "{{#body}}    data=b{{body}},\n{{/body}}"
+                "    allow_redirects=False,\n"
+                ")\n"
+                "print(response.status_code, len(response.content))\n\n")),
+            "", pythonQuote, ""});
+
+        formats.append({"Python aiohttp", "Python Scripts (*.py)",
+            "import asyncio\n"
+            "\n"
+            "import aiohttp\n"
+            "\n"
+            "\n"
+            "async def main():\n"
+            "    async with aiohttp.ClientSession() as session:\n"
+            "        pass\n\n",
+            ExportTemplate(QByteArray(
+                "        # {{title}}\n"
+                "        async with session.request(\n"
+                "            {{method}},\n"
+                "            {{url}},\n"
+                "            headers={\n") + QByteArray(PythonHeaders).replace("        ", "                ") + QByteArray(
+                "            },\n"
+                "{{#body}}            data=b{{body}},\n{{/body}}"
+                "            allow_redirects=False,\n"
+                "        ) as response:\n"
+                "            print(response.status, len(await response.read()))\n\n")),
+            "\nasyncio.run(main())\n", pythonQuote, ""});
+
+        formats.append({"C libcurl", "C Sources (*.c)",
+            "#include <stdio.h>\n"
+            "#include <curl/curl.h>\n"
+            "\n"
+            "static void perform(CURL *curl, struct curl_slist *headers)\n"
+            "{\n"
+            "    CURLcode res = curl_easy_perform(curl);\n"
+            "    if (res != CURLE_OK)\n"
+            "        fprintf(stderr, \"curl_easy_perform() failed: %s\\n\", curl_easy_strerror(res));\n"
+            "    curl_slist_free_all(headers);\n"
+            "    curl_easy_cleanup(curl);\n"
+            "}\n"
+            "\n"
+            "int main(void)\n"
+            "{\n"
+            "    CURL *curl;\n"
+            "    struct curl_slist *headers;\n"
+            "\n"
+            "    curl_global_init(CURL_GLOBAL_DEFAULT);\n"
+            "\n",
+            ExportTemplate(
+                "    /* {{title}} */\n"
+                "    curl = curl_easy_init();\n"
+                "    headers = NULL;\n"
+                "{{#headers}}    headers = curl_slist_append(headers, {{header}});\n{{/headers}}"
+                "    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, {{method}});\n"
+                "    curl_easy_setopt(curl, CURLOPT_URL, {{url}});\n"
+                "    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);\n"
+                "    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);\n"
+                "{{#body}}    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t){{bodySize}});\n"
+                "    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, {{body}});\n{{/body}}"
+                "    perform(curl, headers);\n\n"),
+            "    curl_global_cleanup();\n"
+            "    return 0;\n"
+            "}\n", cQuote, "*/"});
+
+        return formats;
+    }
+
+    // Parses source from pos up to the closing tag of section (or the end)
+    QList<ExportTemplate::Segment> compileSegments(QByteArrayView source, qsizetype& pos,
+                                                    ExportTemplate::Section section) {
+        QList<ExportTemplate::Segment> segments;
+        while (pos < source.size()) {
+            qsizetype open = source.indexOf("{{", pos);
+            if (open < 0) open = source.size();
+            if (open > pos) {
+                ExportTemplate::Segment text;
+                text.text = source.sliced(pos, open - pos).toByteArray();
+                segments.append(text);
+            }
+            if (open >= source.size()) {
+                pos = open;
+                break;
+            }
+
+            qsizetype close = source.indexOf("}}", open + 2);
+            Q_ASSERT(close >= 0);
+            QByteArrayView tag = source.sliced(open + 2, close - open - 2);
+            pos = close + 2;
+
+            if (tag.startsWith('/')) {
+                Q_ASSERT(section != ExportTemplate::Section::None);
+                return segments;
+            }
+
+            ExportTemplate::Segment segment;
+            if (tag.startsWith('#')) {
+                segment.section = tag == "#headers" ? ExportTemplate::Section::Headers : ExportTemplate::Section::Body;
+                segment.children = compileSegments(source, pos, segment.section);
+            } else {
+                segment.isField = true;
+                if (tag == "method") segment.field = ExportTemplate::Field::Method;
+                else if (tag == "url") segment.field = ExportTemplate::Field::Url;
+                else if (tag == "title") segment.field = ExportTemplate::Field::Title;
+                else if (tag == "body") segment.field = ExportTemplate::Field::Body;
+                else if (tag == "bodySize") segment.field = ExportTemplate::Field::BodySize;
+                else if (tag == "header") segment.field = ExportTemplate::Field::Header;
+                else if (tag == "name") segment.field = ExportTemplate::Field::HeaderName;
+                else if (tag == "value") segment.field = ExportTemplate::Field::HeaderValue;
+                else Q_ASSERT_X(false, "ExportTemplate", "unknown field");
+            }
+            segments.append(segment);
+        }
+        return segments;
+    }
+
+    void collectSnapshots(const OrganizerItem* item, QList<RequestSnapshot>& snapshots) {
+        if (item->type() == ItemType::Request) {
+            snapshots.append({item->name(), item->host(), item->url(), item->query(), item->scheme(), item->port(),
+                              item->method(), item->request()});
+        }
+        for (const OrganizerItem* child : item->children()) {
+            collectSnapshots(child, snapshots);
+        }
+    }
+}
+
+ExportTemplate::ExportTemplate(QByteArrayView source) {
+    qsizetype pos = 0;
+    m_segments = compileSegments(source, pos, Section::None);
+}
+
+RequestExporter::RequestExporter(const ExportFormat& format, QIODevice* device)
+    : m_format(format)
+    , m_device(device)
+    , m_error(false)
+{
+}
+
+const QList<ExportFormat>& RequestExporter::formats() {
+    static const QList<ExportFormat> formats = buildFormats();
+    return formats;
+}
+
+QList<RequestSnapshot> RequestExporter::snapshot(const OrganizerItem* root) {
+    QList<RequestSnapshot> snapshots;
+    collectSnapshots(root, snapshots);
+    return snapshots;
+}
+
+bool RequestExporter::exportRequests(const ExportFormat& format, const QList<RequestSnapshot>& snapshots,
+                                     const QString& fileName, QString* error, const std::atomic_bool* cancel) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = "Could not open file: " + fileName;
+        return false;
+    }
+
+    RequestExporter exporter(format, &file);
+    exporter.writeStart();
+    for (const RequestSnapshot& snapshot : snapshots) {
+        if (exporter.hasError()) break;
+        if (cancel && cancel->load()) {
+            file.remove();
+            return false;
+        }
+        exporter.writeEntry(snapshot);
+    }
+    exporter.writeEnd();
+    if (exporter.hasError()) {
+        if (error) *error = "Error writing file: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void RequestExporter::write(QByteArrayView data) {
+    if (m_error) return;
+    if (m_device->write(data.data(), data.size()) != data.size()) {
+        m_error = true;
+    }
+}
+
+void RequestExporter::writeStart() {
+    write(m_format.prologue);
+}
+
+void RequestExporter::writeEnd() {
+    write(m_format.epilogue);
+}
+
+void RequestExporter::writeEntry(const RequestSnapshot& snapshot) {
+    render(m_format.entry.segments(), prepare(snapshot), nullptr);
+}
+
+void RequestExporter::render(const QList<ExportTemplate::Segment>& segments, const Request& request,
+                             const QPair<QByteArray, QByteArray>* header) {
+    for (const ExportTemplate::Segment& segment : segments) {
+        if (segment.section == ExportTemplate::Section::Headers) {
+            for (const auto& requestHeader : request.headers) {
+                render(segment.children, request, &requestHeader);
+            }
+            continue;
+        }
+        if (segment.section == ExportTemplate::Section::Body) {
+            if (!request.body.isEmpty()) render(segment.children, request, header);
+            continue;
+        }
+        if (!segment.isField) {
+            write(segment.text);
+            continue;
+        }
+
+        switch (segment.field) {
+        case ExportTemplate::Field::Method: write(m_format.quote(request.method)); break;
+        case ExportTemplate::Field::Url: write(m_format.quote(request.url)); break;
+        case ExportTemplate::Field::Body: write(m_format.quote(request.body)); break;
+        case ExportTemplate::Field::BodySize: write(QByteArray::number(request.body.size())); break;
+        case ExportTemplate::Field::Title: {
+            QByteArray title = request.title;
+            if (!m_format.commentEnd.isEmpty()) title.replace(m_format.commentEnd, " ");
+            write(title);
+            break;
+        }
+        case ExportTemplate::Field::Header:
+            if (header) write(m_format.quote(header->first + ": " + header->second));
+            break;
+        case ExportTemplate::Field::HeaderName:
+            if (header) write(m_format.quote(header->first));
+            break;
+        case ExportTemplate::Field::HeaderValue:
+            if (header) write(m_format.quote(header->second));
+            break;
+        }
+    }
+}
+
+RequestExporter::Request RequestExporter::prepare(const RequestSnapshot& snapshot) {
+    // Decoded copy: the tools re-frame the body themselves
+    const QByteArray message = HttpDecoder::decode(snapshot.request);
+    HttpMessageIndex index = HttpMessageIndex::parse(message);
+    const bool parsed = index.isValid() && index.isRequest();
+
+    Request request;
+    request.title = snapshot.name.toUtf8();
+    request.title.replace('\r', ' ').replace('\n', ' ');
+    request.method = parsed ? index.method(message).toByteArray() : snapshot.method.toLatin1();
+    if (request.method.isEmpty()) request.method = "GET";
+
+    QByteArray target = parsed ? index.target(message).toByteArray() : QByteArray();
+    if (target.isEmpty()) {
+        target = snapshot.url.toUtf8();
+        if (!snapshot.query.isEmpty()) target += "?" + snapshot.query.toUtf8();
+    }
+    const QString hostHeader = parsed ? QString::fromLatin1(index.header(message, "host")) : QString();
+    request.url = RequestOrigin::resolve(snapshot.scheme, snapshot.port, snapshot.host, hostHeader)
+                      .url(QString::fromUtf8(target)).toUtf8();
+
+    if (parsed) {
+        // The tools derive Host and the framing headers from the URL and body
+        for (const HttpMessageIndex::Header& header : index.headers()) {
+            QByteArrayView name = HttpMessageIndex::view(message, header.name);
+            if (HttpMessageIndex::nameEquals(name, "host") || HttpMessageIndex::nameEquals(name, "content-length") ||
+                HttpMessageIndex::nameEquals(name, "transfer-encoding")) {
+                continue;
+            }
+            request.headers.append({name.toByteArray(), HttpMessageIndex::view(message, header.value).toByteArray()});
+        }
+        request.body = index.body(message).toByteArray();
+    }
+    return request;
+}
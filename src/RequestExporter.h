@@ -0,0 +1,114 @@
+#ifndef REQUESTEXPORTER_H
+#define REQUESTEXPORTER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <atomic>
+#include "OrganizerItem.h"
+
+// What an exporter needs from one request, taken on the GUI thread. The byte
+// arrays share their data with the item, so a snapshot of a large subtree
+// costs a few pointers per request.
+struct RequestSnapshot {
+    QString name;
+    QString host;
+    QString url;
+    QString query;
+    QString scheme;
+    int port = 0;
+    QString method;
+    QByteArray request;
+};
+
+// A template compiled once into literal text, fields and repeated sections.
+//   {{field}}               method, url, title, body, bodySize
+//   {{#headers}}..{{/headers}}  repeated per header; name, value, header inside
+//   {{#body}}..{{/body}}    only emitted when the request has a body
+// Fields other than title and bodySize are written as quoted literals of the
+// target language.
+class ExportTemplate {
+public:
+    enum class Field { Method, Url, Title, Body, BodySize, Header, HeaderName, HeaderValue };
+    enum class Section { None, Headers, Body };
+
+    struct Segment {
+        QByteArray text;        // Literal text, when field and section are unset
+        Field field = Field::Method;
+        bool isField = false;
+        Section section = Section::None;
+        QList<Segment> children;
+    };
+
+    ExportTemplate() = default;
+    explicit ExportTemplate(QByteArrayView source);
+
+    const QList<Segment>& segments() const { return m_segments; }
+
+private:
+    QList<Segment> m_segments;
+};
+
+// One output format: file-level text around a per-request template, plus how
+// strings are quoted and comments made safe in the target language
+struct ExportFormat {
+    typedef QByteArray (*QuoteFunction)(QByteArrayView value);
+
+    QString name;
+    QString fileFilter;
+    QByteArray prologue;
+    ExportTemplate entry;
+    QByteArray epilogue;
+    QuoteFunction quote;
+    QByteArray commentEnd; // Sequence that would close a comment early, e.g. "*/"
+};
+
+// Renders requests in one of the registered formats straight to a device, one
+// request at a time, so memory stays flat however many requests are exported.
+class RequestExporter {
+public:
+    RequestExporter(const ExportFormat& format, QIODevice* device);
+
+    void writeStart();
+    void writeEntry(const RequestSnapshot& snapshot);
+    void writeEnd();
+    bool hasError() const { return m_error; }
+
+    // cURL, ffuf, wfuzz, python requests, python aiohttp and C libcurl;
+    // built and compiled on first use
+    static const QList<ExportFormat>& formats();
+
+    // Snapshots every request in the subtree under root, depth first.
+    // Must run on the thread that owns the items.
+    static QList<RequestSnapshot> snapshot(const OrganizerItem* root);
+
+    // Decodes and writes the snapshots to fileName; safe to run on a worker
+    static bool exportRequests(const ExportFormat& format, const QList<RequestSnapshot>& snapshots,
+                               const QString& fileName, QString* error = nullptr,
+                               const std::atomic_bool* cancel = nullptr);
+
+private:
+    typedef QList<QPair<QByteArray, QByteArray>> Headers;
+
+    struct Request {
+        QByteArray title;
+        QByteArray method;
+        QByteArray url;
+        Headers headers;
+        QByteArray body;
+    };
+
+    void write(QByteArrayView data);
+    void render(const QList<ExportTemplate::Segment>& segments, const Request& request,
+                const QPair<QByteArray, QByteArray>* header);
+    static Request prepare(const RequestSnapshot& snapshot);
+
+    const ExportFormat& m_format;
+    QIODevice* m_device;
+    bool m_error;
+};
+
+#endif // REQUESTEXPORTER_H
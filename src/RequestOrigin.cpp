@@ -0,0 +1,37 @@
+#include "RequestOrigin.h"
+
+QString RequestOrigin::authority() const {
+    return port == defaultPort(scheme) ? host : host + ':' + QString::number(port);
+}
+
+QString RequestOrigin::url(const QString& target) const {
+    if (target.startsWith(QLatin1String("http://")) || target.startsWith(QLatin1String("https://"))) return target;
+    return scheme + "://" + authority() + target;
+}
+
+RequestOrigin RequestOrigin::resolve(const QString& scheme, int port, const QString& host, const QString& hostHeader) {
+    const QString header = hostHeader.trimmed();
+    const QString authority = header.isEmpty() ? host : header;
+
+    RequestOrigin origin;
+    origin.host = authority;
+    int authorityPort = 0;
+    // A trailing :port, but not the inside of a bracketed IPv6 address
+    const int colon = authority.lastIndexOf(':');
+    if (colon > 0 && !authority.endsWith(']')) {
+        bool ok = false;
+        const int value = authority.mid(colon + 1).toInt(&ok);
+        if (ok && value > 0 && value < 65536) {
+            origin.host = authority.left(colon);
+            authorityPort = value;
+        }
+    }
+
+    const int knownPort = port > 0 ? port : authorityPort;
+    origin.scheme = scheme.toLower();
+    if (!isKnownScheme(origin.scheme)) {
+        origin.scheme = knownPort == 80 ? "http" : "https";
+    }
+    origin.port = knownPort > 0 ? knownPort : defaultPort(origin.scheme);
+    return origin;
+}
@@ -0,0 +1,30 @@
+#ifndef REQUESTORIGIN_H
+#define REQUESTORIGIN_H
+
+#include <QString>
+
+// Scheme, host and port a stored request went to, for exporters that need
+// an absolute URL. Items keep the scheme and port they were captured with;
+// rows saved before those were kept, and requests typed in by hand, fall
+// back to the port in the Host header: 80 is http, anything else https.
+struct RequestOrigin {
+    QString scheme; // "http" or "https"
+    QString host;   // Without the port; IPv6 addresses keep their brackets
+    int port = 443;
+
+    // host, plus :port unless it is the scheme's default
+    QString authority() const;
+    // target as an absolute URL; ones that already are come back unchanged
+    QString url(const QString& target) const;
+
+    // scheme and port as stored (empty and 0 when unknown); the Host header
+    // is preferred over the host column, which may lack the port
+    static RequestOrigin resolve(const QString& scheme, int port, const QString& host,
+                                 const QString& hostHeader = QString());
+    static int defaultPort(const QString& scheme) { return scheme == QLatin1String("http") ? 80 : 443; }
+    static bool isKnownScheme(const QString& scheme) {
+        return scheme == QLatin1String("http") || scheme == QLatin1String("https");
+    }
+};
+
+#endif // REQUESTORIGIN_H
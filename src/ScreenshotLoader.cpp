@@ -0,0 +1,94 @@
+#include "ScreenshotLoader.h"
+#include <QBuffer>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QThread>
+
+const QSize ScreenshotLoader::ThumbnailSize(160, 90);
+
+namespace {
+    // Reads the image at (at most) boundingSize. Letting the reader scale means
+    // formats like JPEG never materialize the full 4K bitmap at all.
+    QImage readScaled(const QString& screenshotBase64, const QSize& boundingSize) {
+        QByteArray imageData = QByteArray::fromBase64(screenshotBase64.toLatin1());
+        QBuffer buffer(&imageData);
+        buffer.open(QIODevice::ReadOnly);
+
+        QImageReader reader(&buffer);
+        reader.setAutoTransform(true);
+        QSize originalSize = reader.size();
+        if (originalSize.isValid() && boundingSize.isValid() &&
+            (originalSize.width() > boundingSize.width() || originalSize.height() > boundingSize.height())) {
+            reader.setScaledSize(originalSize.scaled(boundingSize, Qt::KeepAspectRatio));
+        }
+        return reader.read();
+    }
+}
+
+ScreenshotLoader::ScreenshotLoader(QObject* parent)
+    : QObject(parent)
+{
+    // Leave one core for the GUI thread so a backlog of thumbnails never makes the UI sluggish
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    m_pool.setThreadPriority(QThread::LowPriority);
+}
+
+ScreenshotLoader::~ScreenshotLoader() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ScreenshotLoader::requestThumbnail(int dbId, const QString& screenshotBase64) {
+    if (dbId == -1 || screenshotBase64.isEmpty()) {
+        return;
+    }
+    auto pending = m_pendingThumbnails.constFind(dbId);
+    if (pending != m_pendingThumbnails.constEnd() && *pending == screenshotBase64) {
+        return;
+    }
+    m_pendingThumbnails.insert(dbId, screenshotBase64);
+
+    m_pool.start([this, dbId, screenshotBase64]() {
+        QByteArray thumbnail = createThumbnail(screenshotBase64);
+        QMetaObject::invokeMethod(this, [this, dbId, screenshotBase64, thumbnail]() {
+            if (m_pendingThumbnails.value(dbId) == screenshotBase64) {
+                m_pendingThumbnails.remove(dbId);
+            }
+            emit thumbnailReady(dbId, screenshotBase64, thumbnail);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ScreenshotLoader::requestImage(int dbId, const QString& screenshotBase64, const QSize& boundingSize) {
+    // Full-size decodes are user initiated, so they jump ahead of queued thumbnails
+    m_pool.start([this, dbId, screenshotBase64, boundingSize]() {
+        QImage image = decodeImage(screenshotBase64, boundingSize);
+        QMetaObject::invokeMethod(this, [this, dbId, image]() {
+            emit imageReady(dbId, image);
+        }, Qt::QueuedConnection);
+    }, 1);
+}
+
+QByteArray ScreenshotLoader::createThumbnail(const QString& screenshotBase64) {
+    QImage image = readScaled(screenshotBase64, ThumbnailSize);
+    if (image.isNull()) {
+        return QByteArray();
+    }
+    if (image.hasAlphaChannel()) {
+        image = image.convertToFormat(QImage::Format_RGB32);
+    }
+
+    QByteArray thumbnail;
+    QBuffer buffer(&thumbnail);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "JPG");
+    writer.setQuality(85);
+    if (!writer.write(image)) {
+        return QByteArray();
+    }
+    return thumbnail;
+}
+
+QImage ScreenshotLoader::decodeImage(const QString& screenshotBase64, const QSize& boundingSize) {
+    return readScaled(screenshotBase64, boundingSize);
+}
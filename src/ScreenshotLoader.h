@@ -0,0 +1,41 @@
+#ifndef SCREENSHOTLOADER_H
+#define SCREENSHOTLOADER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QImage>
+#include <QSize>
+#include <QHash>
+#include <QThreadPool>
+
+// Decodes screenshots off the GUI thread. Thumbnails are small JPEGs meant to
+// be persisted with the item; full images are only decoded when requested and
+// come back already scaled to the size they will be shown at.
+class ScreenshotLoader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ScreenshotLoader(QObject* parent = nullptr);
+    ~ScreenshotLoader();
+
+    static const QSize ThumbnailSize;
+
+    void requestThumbnail(int dbId, const QString& screenshotBase64);
+    void requestImage(int dbId, const QString& screenshotBase64, const QSize& boundingSize);
+    bool isThumbnailPending(int dbId) const { return m_pendingThumbnails.contains(dbId); }
+    int pendingThumbnailCount() const { return m_pendingThumbnails.size(); }
+
+    static QByteArray createThumbnail(const QString& screenshotBase64);
+    static QImage decodeImage(const QString& screenshotBase64, const QSize& boundingSize);
+
+signals:
+    void thumbnailReady(int dbId, const QString& screenshotBase64, const QByteArray& thumbnail);
+    void imageReady(int dbId, const QImage& image);
+
+private:
+    QThreadPool m_pool;
+    QHash<int, QString> m_pendingThumbnails; // dbId -> screenshot being thumbnailed
+};
+
+#endif // SCREENSHOTLOADER_H
@@ -0,0 +1,315 @@
+#include "TextDiff.h"
+#include <QHash>
+#include <QStringView>
+#include <algorithm>
+#include <climits>
+
+namespace TextDiff {
+
+namespace {
+    struct Context {
+        const int* a;
+        const int* b;
+        int* fd; // Forward furthest-reaching x per diagonal
+        int* bd; // Backward furthest-reaching x per diagonal
+        bool* changedA;
+        bool* changedB;
+        int tooExpensive;
+        const std::atomic_bool* cancel;
+    };
+
+    struct Partition {
+        int xmid;
+        int ymid;
+    };
+
+    // Finds the midpoint of the shortest edit script for a[xoff, xlim) and
+    // b[yoff, ylim) by running the forward and backward searches until they overlap
+    Partition findMiddleSnake(Context& ctx, int xoff, int xlim, int yoff, int ylim) {
+        int* fd = ctx.fd;
+        int* bd = ctx.bd;
+        const int* xv = ctx.a;
+        const int* yv = ctx.b;
+        const int dmin = xoff - ylim;
+        const int dmax = xlim - yoff;
+        const int fmid = xoff - yoff;
+        const int bmid = xlim - ylim;
+        int fmin = fmid, fmax = fmid;
+        int bmin = bmid, bmax = bmid;
+        const bool odd = (fmid - bmid) & 1;
+
+        fd[fmid] = xoff;
+        bd[bmid] = xlim;
+
+        for (int cost = 1;; ++cost) {
+            // Extend the forward search by one edit
+            if (fmin > dmin) fd[--fmin - 1] = -1; else ++fmin;
+            if (fmax < dmax) fd[++fmax + 1] = -1; else --fmax;
+            for (int d = fmax; d >= fmin; d -= 2) {
+                int tlo = fd[d - 1];
+                int thi = fd[d + 1];
+                int x = tlo >= thi ? tlo + 1 : thi;
+                int y = x - d;
+                while (x < xlim && y < ylim && xv[x] == yv[y]) {
+                    ++x;
+                    ++y;
+                }
+                fd[d] = x;
+                if (odd && bmin <= d && d <= bmax && bd[d] <= x) {
+                    return {x, y};
+                }
+            }
+
+            // Extend the backward search by one edit
+            if (bmin > dmin) bd[--bmin - 1] = INT_MAX; else ++bmin;
+            if (bmax < dmax) bd[++bmax + 1] = INT_MAX; else --bmax;
+            for (int d = bmax; d >= bmin; d -= 2) {
+                int tlo = bd[d - 1];
+                int thi = bd[d + 1];
+                int x = tlo < thi ? tlo : thi - 1;
+                int y = x - d;
+                while (xoff < x && yoff < y && xv[x - 1] == yv[y - 1]) {
+                    --x;
+                    --y;
+                }
+                bd[d] = x;
+                if (!odd && fmin <= d && d <= fmax && x <= fd[d]) {
+                    return {x, y};
+                }
+            }
+
+            bool cancelled = ctx.cancel && ctx.cancel->load(std::memory_order_relaxed);
+            if (cost < ctx.tooExpensive && !cancelled) {
+                continue;
+            }
+
+            // Too expensive: split at whichever search got furthest along
+            int fxybest = -1, fxbest = xoff;
+            for (int d = fmax; d >= fmin; d -= 2) {
+                int x = std::min(fd[d], xlim);
+                int y = x - d;
+                if (ylim < y) {
+                    x = ylim + d;
+                    y = ylim;
+                }
+                if (fxybest < x + y) {
+                    fxybest = x + y;
+                    fxbest = x;
+                }
+            }
+            int bxybest = INT_MAX, bxbest = xlim;
+            for (int d = bmax; d >= bmin; d -= 2) {
+                int x = std::max(xoff, bd[d]);
+                int y = x - d;
+                if (y < yoff) {
+                    x = yoff + d;
+                    y = yoff;
+                }
+                if (x + y < bxybest) {
+                    bxybest = x + y;
+                    bxbest = x;
+                }
+            }
+            if ((xlim + ylim) - bxybest < fxybest - (xoff + yoff)) {
+                return {fxbest, fxybest - fxbest};
+            }
+            return {bxbest, bxybest - bxbest};
+        }
+    }
+
+    void compareSequences(Context& ctx, int xoff, int xlim, int yoff, int ylim) {
+        // Common prefix and suffix never need the search
+        while (xoff < xlim && yoff < ylim && ctx.a[xoff] == ctx.b[yoff]) {
+            ++xoff;
+            ++yoff;
+        }
+        while (xoff < xlim && yoff < ylim && ctx.a[xlim - 1] == ctx.b[ylim - 1]) {
+            --xlim;
+            --ylim;
+        }
+
+        if (xoff == xlim) {
+            std::fill(ctx.changedB + yoff, ctx.changedB + ylim, true);
+        } else if (yoff == ylim) {
+            std::fill(ctx.changedA + xoff, ctx.changedA + xlim, true);
+        } else {
+            Partition part = findMiddleSnake(ctx, xoff, xlim, yoff, ylim);
+            compareSequences(ctx, xoff, part.xmid, yoff, part.ymid);
+            compareSequences(ctx, part.xmid, xlim, part.ymid, ylim);
+        }
+    }
+
+    QStringList splitLines(const QString& text) {
+        QStringList lines = text.split(QLatin1Char('\n'));
+        for (QString& line : lines) {
+            if (line.endsWith(QLatin1Char('\r'))) {
+                line.chop(1);
+            }
+        }
+        return lines;
+    }
+
+    // Words, whitespace runs and single punctuation characters
+    QVector<Span> tokenizeWords(QStringView line) {
+        QVector<Span> tokens;
+        const int n = line.size();
+        int i = 0;
+        while (i < n) {
+            QChar c = line[i];
+            int j = i + 1;
+            if (c.isLetterOrNumber() || c == QLatin1Char('_')) {
+                while (j < n && (line[j].isLetterOrNumber() || line[j] == QLatin1Char('_'))) ++j;
+            } else if (c.isSpace()) {
+                while (j < n && line[j].isSpace()) ++j;
+            }
+            tokens.append({i, j - i});
+            i = j;
+        }
+        return tokens;
+    }
+
+    QVector<Span> mergeChanged(const QVector<Span>& tokens, const QVector<bool>& changed) {
+        QVector<Span> spans;
+        for (int i = 0; i < tokens.size(); ++i) {
+            if (!changed[i]) continue;
+            const Span& token = tokens[i];
+            if (!spans.isEmpty() && spans.last().start + spans.last().length == token.start) {
+                spans.last().length += token.length;
+            } else {
+                spans.append(token);
+            }
+        }
+        return spans;
+    }
+
+    void diffWords(const QString& left, const QString& right, Row& row, const std::atomic_bool* cancel) {
+        QVector<Span> leftTokens = tokenizeWords(left);
+        QVector<Span> rightTokens = tokenizeWords(right);
+
+        QHash<QStringView, int> ids;
+        auto toIds = [&ids](const QString& line, const QVector<Span>& tokens) {
+            QVector<int> wordIds;
+            wordIds.reserve(tokens.size());
+            for (const Span& token : tokens) {
+                QStringView word = QStringView(line).mid(token.start, token.length);
+                auto it = ids.constFind(word);
+                if (it == ids.constEnd()) {
+                    it = ids.insert(word, ids.size());
+                }
+                wordIds.append(it.value());
+            }
+            return wordIds;
+        };
+
+        QVector<bool> changedLeft, changedRight;
+        diffTokens(toIds(left, leftTokens), toIds(right, rightTokens), changedLeft, changedRight, cancel);
+        row.leftSpans = mergeChanged(leftTokens, changedLeft);
+        row.rightSpans = mergeChanged(rightTokens, changedRight);
+    }
+}
+
+void diffTokens(const QVector<int>& a, const QVector<int>& b,
+                QVector<bool>& changedA, QVector<bool>& changedB,
+                const std::atomic_bool* cancel) {
+    const int n = a.size();
+    const int m = b.size();
+    changedA.fill(false, n);
+    changedB.fill(false, m);
+
+    // Diagonals range over [-m - 1, n + 1]
+    QVector<int> forward(n + m + 3);
+    QVector<int> backward(n + m + 3);
+
+    // Roughly sqrt(number of diagonals), as GNU diff does, but never below 4096
+    int tooExpensive = 1;
+    for (int diags = n + m + 3; diags != 0; diags >>= 2) {
+        tooExpensive <<= 1;
+    }
+
+    Context ctx;
+    ctx.a = a.constData();
+    ctx.b = b.constData();
+    ctx.fd = forward.data() + m + 1;
+    ctx.bd = backward.data() + m + 1;
+    ctx.changedA = changedA.data();
+    ctx.changedB = changedB.data();
+    ctx.tooExpensive = std::max(4096, tooExpensive);
+    ctx.cancel = cancel;
+
+    compareSequences(ctx, 0, n, 0, m);
+}
+
+Result compare(const QString& left, const QString& right, Granularity granularity,
+               const std::atomic_bool* cancel) {
+    Result result;
+    result.leftLines = splitLines(left);
+    result.rightLines = splitLines(right);
+
+    // Intern lines so the diff compares integers instead of strings
+    QHash<QStringView, int> ids;
+    auto toIds = [&ids](const QStringList& lines) {
+        QVector<int> lineIds;
+        lineIds.reserve(lines.size());
+        for (const QString& line : lines) {
+            auto it = ids.constFind(line);
+            if (it == ids.constEnd()) {
+                it = ids.insert(line, ids.size());
+            }
+            lineIds.append(it.value());
+        }
+        return lineIds;
+    };
+    QVector<int> leftIds = toIds(result.leftLines);
+    QVector<int> rightIds = toIds(result.rightLines);
+    ids.clear();
+
+    QVector<bool> changedLeft, changedRight;
+    diffTokens(leftIds, rightIds, changedLeft, changedRight, cancel);
+
+    const int leftCount = result.leftLines.size();
+    const int rightCount = result.rightLines.size();
+    int i = 0;
+    int j = 0;
+    while (i < leftCount || j < rightCount) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            result.cancelled = true;
+            return result;
+        }
+
+        if (i < leftCount && j < rightCount && !changedLeft[i] && !changedRight[j]) {
+            result.rows.append({Row::Equal, i++, j++, {}, {}});
+            continue;
+        }
+
+        int leftEnd = i;
+        while (leftEnd < leftCount && changedLeft[leftEnd]) ++leftEnd;
+        int rightEnd = j;
+        while (rightEnd < rightCount && changedRight[rightEnd]) ++rightEnd;
+
+        // Pair up removed and added lines so they sit side by side
+        int pairs = std::min(leftEnd - i, rightEnd - j);
+        for (int k = 0; k < pairs; ++k) {
+            Row row{Row::Changed, i, j, {}, {}};
+            if (granularity == Granularity::Word) {
+                diffWords(result.leftLines[i], result.rightLines[j], row, cancel);
+            }
+            result.rows.append(row);
+            ++result.changed;
+            ++i;
+            ++j;
+        }
+        for (; i < leftEnd; ++i) {
+            result.rows.append({Row::Removed, i, -1, {}, {}});
+            ++result.removed;
+        }
+        for (; j < rightEnd; ++j) {
+            result.rows.append({Row::Added, -1, j, {}, {}});
+            ++result.added;
+        }
+    }
+
+    result.cancelled = cancel && cancel->load(std::memory_order_relaxed);
+    return result;
+}
+
+} // namespace TextDiff
@@ -0,0 +1,59 @@
+#ifndef TEXTDIFF_H
+#define TEXTDIFF_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+namespace TextDiff {
+
+// Myers' O(ND) diff in linear space (divide and conquer on the middle snake).
+// Marks the tokens of a and b that are not part of the common subsequence.
+// Once a sub-problem costs more than ~sqrt(N) edits the middle snake is
+// approximated, trading minimality for bounded run time on unrelated inputs.
+void diffTokens(const QVector<int>& a, const QVector<int>& b,
+                QVector<bool>& changedA, QVector<bool>& changedB,
+                const std::atomic_bool* cancel = nullptr);
+
+enum class Granularity {
+    Line,
+    Word
+};
+
+// Character range within a line
+struct Span {
+    int start;
+    int length;
+};
+
+struct Row {
+    enum Kind {
+        Equal,
+        Removed,
+        Added,
+        Changed
+    };
+    Kind kind;
+    int leftLine;  // -1 when the row only exists on the right
+    int rightLine; // -1 when the row only exists on the left
+    QVector<Span> leftSpans;  // Changed words, only for Word granularity
+    QVector<Span> rightSpans;
+};
+
+struct Result {
+    QStringList leftLines;
+    QStringList rightLines;
+    QVector<Row> rows;
+    int removed = 0;
+    int added = 0;
+    int changed = 0;
+    bool cancelled = false;
+};
+
+Result compare(const QString& left, const QString& right, Granularity granularity,
+               const std::atomic_bool* cancel = nullptr);
+
+} // namespace TextDiff
+
+#endif // TEXTDIFF_H
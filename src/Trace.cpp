@@ -0,0 +1,215 @@
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+    const quint64 Capacity = 1 << 16;
+    // Slots the owner may be overwriting while the buffer is read; when a
+    // buffer has wrapped these oldest events are left out
+    const quint64 Slack = 64;
+
+    // Fields are atomic so reading a buffer while its thread records is
+    // well defined; the owner is the only writer
+    struct Event {
+        std::atomic<const char*> name;
+        std::atomic<qint64> start;
+        std::atomic<qint64> end;
+    };
+
+    struct Buffer {
+        int tid = 0;
+        QString threadName;
+        std::atomic<quint64> head{0};
+        std::atomic<quint64> floor{0}; // Events before this were cleared
+        // Guarded by the registry mutex
+        quint64 retired = 0;           // Order in which its thread finished; 0 while it runs
+        bool dumped = false;           // Written out since it retired
+        Event events[Capacity];
+    };
+
+    // Buffers outlive their threads, since a trace is usually written after
+    // the threads that made it are gone. A new thread takes over a retired
+    // buffer once its events were written or cleared; with MaxBuffers in use
+    // it takes the one retired longest ago, and without any it records nothing.
+    const size_t MaxBuffers = 64;
+
+    struct Registry {
+        QMutex mutex;
+        std::vector<Buffer*> buffers;
+        int lastTid = 0;
+        quint64 retirements = 0;
+    };
+
+    Registry& registry() {
+        static Registry* instance = new Registry;
+        return *instance;
+    }
+
+    const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+    // Retires the thread's buffer when the thread finishes
+    struct ThreadSlot {
+        Buffer* buffer = nullptr;
+        bool refused = false; // Every buffer belonged to a running thread
+
+        ~ThreadSlot() {
+            if (!buffer) return;
+            Registry& reg = registry();
+            QMutexLocker locker(&reg.mutex);
+            buffer->retired = ++reg.retirements;
+        }
+    };
+
+    thread_local ThreadSlot t_slot;
+
+    // The retired buffer a new thread should take over, or nullptr
+    Buffer* reusableBuffer(const Registry& reg) {
+        Buffer* oldest = nullptr;
+        for (Buffer* buffer : reg.buffers) {
+            if (!buffer->retired) continue;
+            const bool empty = buffer->head.load(std::memory_order_relaxed) == buffer->floor.load(std::memory_order_relaxed);
+            if (buffer->dumped || empty) return buffer;
+            if (!oldest || buffer->retired < oldest->retired) oldest = buffer;
+        }
+        return reg.buffers.size() >= MaxBuffers ? oldest : nullptr;
+    }
+
+    Buffer* threadBuffer() {
+        ThreadSlot& slot = t_slot;
+        if (slot.buffer || slot.refused) return slot.buffer;
+        QThread* thread = QThread::currentThread();
+        Registry& reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        Buffer* buffer = reusableBuffer(reg);
+        if (buffer) {
+            buffer->floor.store(buffer->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            buffer->retired = 0;
+            buffer->dumped = false;
+        } else if (reg.buffers.size() < MaxBuffers) {
+            buffer = new Buffer;
+            reg.buffers.push_back(buffer);
+        } else {
+            slot.refused = true;
+            return nullptr;
+        }
+        // A fresh tid, so a reused buffer doesn't merge with its old thread in the viewer
+        buffer->tid = ++reg.lastTid;
+        buffer->threadName = thread->objectName();
+        if (buffer->threadName.isEmpty()) {
+            const bool isMain = QCoreApplication::instance() && QCoreApplication::instance()->thread() == thread;
+            buffer->threadName = isMain ? QString("main") : QString("thread %1").arg(buffer->tid);
+        }
+        slot.buffer = buffer;
+        return buffer;
+    }
+
+    void appendString(QByteArray& out, const char* text) {
+        out.append('"');
+        for (const char* p = text; *p; ++p) {
+            if (*p == '"' || *p == '\\') out.append('\\');
+            if (uchar(*p) >= 0x20) out.append(*p);
+        }
+        out.append('"');
+    }
+
+    // Microseconds with nanosecond precision, as the format expects
+    QByteArray micros(qint64 nanoseconds) {
+        return QByteArray::number(nanoseconds / 1000) + '.' + QByteArray::number(nanoseconds % 1000).rightJustified(3, '0');
+    }
+}
+
+namespace Trace {
+
+void setEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+QString enableFromEnvironment() {
+    const QString value = qEnvironmentVariable("RO_TRACE");
+    if (value.isEmpty() || value == "0") return QString();
+    setEnabled(true);
+    return value == "1" ? QString() : value;
+}
+
+qint64 now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count();
+}
+
+void record(const char* name, qint64 start, qint64 end) {
+    Buffer* buffer = threadBuffer();
+    if (!buffer) return;
+    const quint64 head = buffer->head.load(std::memory_order_relaxed);
+    Event& event = buffer->events[head % Capacity];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void clear() {
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (Buffer* buffer : reg.buffers) {
+        buffer->floor.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool writeJson(const QString& fileName, QString* error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = "Could not open file: " + fileName;
+        return false;
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&out, &first]() {
+        out.append(first ? "\n" : ",\n");
+        first = false;
+    };
+
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (Buffer* buffer : reg.buffers) {
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        separator();
+        out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(pid).append(",\"tid\":").append(tid)
+            .append(",\"args\":{\"name\":");
+        appendString(out, buffer->threadName.toUtf8().constData());
+        out.append("}}");
+
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        quint64 begin = buffer->floor.load(std::memory_order_relaxed);
+        if (head > Capacity) begin = qMax(begin, head - Capacity + Slack);
+        for (quint64 i = begin; i < head; ++i) {
+            const Event& event = buffer->events[i % Capacity];
+            const qint64 start = event.start.load(std::memory_order_relaxed);
+            separator();
+            out.append("{\"name\":");
+            appendString(out, event.name.load(std::memory_order_relaxed));
+            out.append(",\"ph\":\"X\",\"pid\":").append(pid).append(",\"tid\":").append(tid)
+                .append(",\"ts\":").append(micros(start))
+                .append(",\"dur\":").append(micros(event.end.load(std::memory_order_relaxed) - start)).append('}');
+            if (out.size() > (1 << 20)) {
+                file.write(out);
+                out.clear();
+            }
+        }
+        if (buffer->retired) buffer->dumped = true;
+    }
+    out.append("\n]}\n");
+    if (file.write(out) != out.size() || !file.flush()) {
+        if (error) *error = "Could not write file: " + fileName;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Trace
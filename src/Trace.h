@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <atomic>
+
+// Scoped trace points for finding out where time goes on a user's machine.
+// Each thread records complete events into its own fixed-size ring buffer,
+// so recording takes no lock; the oldest events are overwritten when a
+// buffer wraps. With tracing off a trace point costs one relaxed load.
+//
+//     void OrganizerModel::loadItemsFromDatabase() {
+//         RO_TRACE("OrganizerModel::loadItemsFromDatabase");
+//         ...
+//
+// Names must be string literals (or otherwise outlive the process); only
+// the pointer is stored. Setting RO_TRACE in the environment turns tracing
+// on at startup, and if its value is a file name the trace is written there
+// on exit. The result opens in chrome://tracing and ui.perfetto.dev.
+namespace Trace {
+
+inline std::atomic_bool g_enabled{false};
+
+inline bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+
+// Reads RO_TRACE; returns the file to write at exit, if any
+QString enableFromEnvironment();
+
+// Nanoseconds on a monotonic clock
+qint64 now();
+void record(const char* name, qint64 start, qint64 end);
+
+// Writes every buffered event as Chrome trace-event JSON
+bool writeJson(const QString& fileName, QString* error = nullptr);
+void clear();
+
+class Scope {
+public:
+    explicit Scope(const char* name)
+        : m_name(enabled() ? name : nullptr)
+        , m_start(m_name ? now() : 0)
+    {
+    }
+    ~Scope() {
+        if (m_name) record(m_name, m_start, now());
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_start;
+};
+
+} // namespace Trace
+
+#define RO_TRACE_CONCAT_(a, b) a##b
+#define RO_TRACE_CONCAT(a, b) RO_TRACE_CONCAT_(a, b)
+#define RO_TRACE(name) Trace::Scope RO_TRACE_CONCAT(roTraceScope, __LINE__)(name)
+
+#endif // TRACE_H
@@ -0,0 +1,110 @@
+#include "WordlistSource.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <cstring>
+
+namespace {
+    // Finds the first non-empty line at or after from. Returns the offset
+    // just past it, or -1 when only empty lines are left.
+    qint64 nextLine(const char* data, qint64 size, qint64 from, qint64* start, qint64* length) {
+        while (from < size) {
+            const char* newline = static_cast<const char*>(memchr(data + from, '\n', size_t(size - from)));
+            const qint64 end = newline ? newline - data : size;
+            qint64 lineLength = end - from;
+            if (lineLength > 0 && data[end - 1] == '\r') --lineLength;
+            const qint64 lineStart = from;
+            from = end + 1;
+            if (lineLength > 0) {
+                *start = lineStart;
+                *length = lineLength;
+                return from;
+            }
+        }
+        return -1;
+    }
+}
+
+WordlistSource::WordlistSource(const QString& fileName)
+    : m_file(fileName)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_position(0)
+    , m_indexed(false)
+    , m_cancelled(false)
+    , m_lines(0)
+{
+}
+
+WordlistSource::~WordlistSource() {
+    // The indexer reads the mapping, which goes away with m_file
+    m_cancelled = true;
+    m_indexing.waitForFinished();
+}
+
+bool WordlistSource::open(QString* error) {
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("Could not open %1: %2").arg(m_file.fileName(), m_file.errorString());
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size == 0) {
+        m_indexed = true;
+        return true;
+    }
+    m_data = reinterpret_cast<const char*>(m_file.map(0, m_size));
+    if (!m_data) {
+        if (error) *error = "Could not map file: " + m_file.fileName();
+        return false;
+    }
+    m_indexing = QtConcurrent::run([this]() { buildIndex(); });
+    return true;
+}
+
+void WordlistSource::buildIndex() {
+    QVector<qint64> checkpoints;
+    checkpoints.reserve(int(qMin<qint64>(m_size / (IndexStride * 8) + 1, 1 << 20)));
+    qint64 lines = 0;
+    qint64 from = 0;
+    qint64 start = 0;
+    qint64 length = 0;
+    while ((from = nextLine(m_data, m_size, from, &start, &length)) >= 0) {
+        if (lines % IndexStride == 0) {
+            // Checked once per checkpoint; a cancelled index is simply never published
+            if (m_cancelled.load(std::memory_order_relaxed)) return;
+            checkpoints.append(start);
+        }
+        ++lines;
+    }
+    m_checkpoints.swap(checkpoints);
+    m_lines = lines;
+    m_indexed.store(true, std::memory_order_release);
+}
+
+bool WordlistSource::next(QByteArray& value) {
+    if (!m_data) return false;
+    qint64 start = 0;
+    qint64 length = 0;
+    const qint64 after = nextLine(m_data, m_size, m_position, &start, &length);
+    if (after < 0) {
+        m_position = m_size;
+        return false;
+    }
+    m_position = after;
+    value = QByteArray::fromRawData(m_data + start, length);
+    return true;
+}
+
+qint64 WordlistSource::count() const {
+    return isIndexed() ? m_lines : -1;
+}
+
+bool WordlistSource::line(qint64 n, QByteArray& value) const {
+    if (!isIndexed() || n < 0 || n >= m_lines) return false;
+    qint64 from = m_checkpoints[n / IndexStride];
+    qint64 start = 0;
+    qint64 length = 0;
+    for (qint64 skip = n % IndexStride; skip >= 0; --skip) {
+        from = nextLine(m_data, m_size, from, &start, &length);
+    }
+    value = QByteArray::fromRawData(m_data + start, length);
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef WORDLISTSOURCE_H
+#define WORDLISTSOURCE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QFuture>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "PayloadSet.h"
+
+// One payload per line of a text file; empty lines are skipped and a
+// trailing CR is dropped. The file is memory-mapped and values point
+// straight into the mapping (QByteArray::fromRawData), so iterating a
+// multi-gigabyte wordlist copies nothing and keeps nothing; values stay
+// valid for as long as the source does.
+//
+// open() starts indexing the file on the global thread pool: one pass that
+// counts the lines and records where every IndexStride-th one starts. Until
+// it's done count() is -1 and line() fails, but next() works from the start.
+class WordlistSource : public PayloadSource {
+public:
+    explicit WordlistSource(const QString& fileName);
+    ~WordlistSource();
+
+    bool open(QString* error);
+    bool next(QByteArray& value) override;
+    void reset() override { m_position = 0; }
+    qint64 count() const override;
+
+    // The n-th payload (0-based) through the index; false until the index is
+    // ready or when n is out of range
+    bool line(qint64 n, QByteArray& value) const;
+    bool isIndexed() const { return m_indexed.load(std::memory_order_acquire); }
+
+    static constexpr int IndexStride = 64;
+
+private:
+    void buildIndex();
+
+    QFile m_file;
+    const char* m_data;
+    qint64 m_size;
+    qint64 m_position;
+    QFuture<void> m_indexing;
+    std::atomic_bool m_indexed;
+    std::atomic_bool m_cancelled;
+    QVector<qint64> m_checkpoints; // Offset of every IndexStride-th line; written before m_indexed
+    qint64 m_lines;
+};
+
+#endif // WORDLISTSOURCE_H
@@ -1,11 +1,17 @@
 #include <QApplication>
 #include "MainWindow.h"
+#include "Trace.h"
 
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv);
+    const QString traceFile = Trace::enableFromEnvironment();
 
     MainWindow window;
     window.show();
 
-    return app.exec();
+    const int result = app.exec();
+    if (!traceFile.isEmpty()) {
+        Trace::writeJson(traceFile);
+    }
+    return result;
 }